@@ -30,6 +30,7 @@
 #include "tracker-extract-info.h"
 #include "tracker-module-manager.h"
 #include "tracker-guarantee.h"
+#include "tracker-image-metadata.h"
 #include "tracker-iptc.h"
 #include "tracker-resource-helpers.h"
 #include "tracker-utils.h"
@@ -0,0 +1,468 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include "config-miners.h"
+
+#include "tracker-image-metadata.h"
+#include "tracker-guarantee.h"
+#include "tracker-resource-helpers.h"
+#include "tracker-utils.h"
+
+#define CMS_PER_INCH 2.54
+
+/**
+ * SECTION:tracker-image-metadata
+ * @title: Image metadata
+ * @short_description: Merged EXIF, XMP and IPTC metadata of an image
+ * @stability: Unstable
+ * @include: libtracker-extract/tracker-extract.h
+ *
+ * Image containers store EXIF, XMP and IPTC blocks in their own
+ * ways. Extractors hand the raw blocks they find to a
+ * #TrackerImageMetadata, which parses each kind of block once and
+ * applies the merged result to a #TrackerResource.
+ *
+ * When several blocks provide the same property, XMP data is
+ * preferred over EXIF data, which is preferred over IPTC data. If
+ * the file has no embedded XMP, a sidecar XMP file is looked up.
+ **/
+
+struct _TrackerImageMetadata {
+	GFile *file;
+	gchar *uri;
+	TrackerExifData *exif;
+	TrackerXmpData *xmp;
+	TrackerIptcData *iptc;
+};
+
+/**
+ * tracker_image_metadata_new:
+ * @file: the image file
+ *
+ * Creates an empty #TrackerImageMetadata for @file.
+ *
+ * Returns: (transfer full): a new #TrackerImageMetadata. Free with
+ * tracker_image_metadata_free().
+ **/
+TrackerImageMetadata *
+tracker_image_metadata_new (GFile *file)
+{
+	TrackerImageMetadata *metadata;
+
+	g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+	metadata = g_new0 (TrackerImageMetadata, 1);
+	metadata->file = g_object_ref (file);
+	metadata->uri = g_file_get_uri (file);
+
+	return metadata;
+}
+
+/**
+ * tracker_image_metadata_free:
+ * @metadata: a #TrackerImageMetadata
+ *
+ * Frees @metadata and all the parsed data.
+ **/
+void
+tracker_image_metadata_free (TrackerImageMetadata *metadata)
+{
+	g_return_if_fail (metadata != NULL);
+
+	g_clear_pointer (&metadata->exif, tracker_exif_free);
+	g_clear_pointer (&metadata->xmp, tracker_xmp_free);
+	g_clear_pointer (&metadata->iptc, tracker_iptc_free);
+	g_object_unref (metadata->file);
+	g_free (metadata->uri);
+	g_free (metadata);
+}
+
+/**
+ * tracker_image_metadata_add_exif:
+ * @metadata: a #TrackerImageMetadata
+ * @buffer: an EXIF block
+ * @len: the size of @buffer
+ *
+ * Parses an EXIF block found in the image. Only the first EXIF
+ * block is parsed, further blocks are ignored.
+ *
+ * Returns: %TRUE if the block was parsed.
+ **/
+gboolean
+tracker_image_metadata_add_exif (TrackerImageMetadata *metadata,
+                                 const guchar         *buffer,
+                                 gsize                 len)
+{
+	g_return_val_if_fail (metadata != NULL, FALSE);
+	g_return_val_if_fail (buffer != NULL, FALSE);
+
+	if (metadata->exif || len == 0)
+		return FALSE;
+
+	metadata->exif = tracker_exif_new (buffer, len, metadata->uri);
+
+	return metadata->exif != NULL;
+}
+
+/**
+ * tracker_image_metadata_take_exif:
+ * @metadata: a #TrackerImageMetadata
+ * @data: (transfer full): EXIF data
+ *
+ * Takes EXIF data that was already read by the container library,
+ * e.g. from TIFF image file directories. It is handled like the first
+ * EXIF block of the image.
+ *
+ * Returns: %TRUE if @data was taken, %FALSE if the image already had
+ * EXIF data, @data is freed in that case.
+ **/
+gboolean
+tracker_image_metadata_take_exif (TrackerImageMetadata *metadata,
+                                  TrackerExifData      *data)
+{
+	g_return_val_if_fail (metadata != NULL, FALSE);
+	g_return_val_if_fail (data != NULL, FALSE);
+
+	if (metadata->exif) {
+		tracker_exif_free (data);
+		return FALSE;
+	}
+
+	metadata->exif = data;
+
+	return TRUE;
+}
+
+/**
+ * tracker_image_metadata_add_xmp:
+ * @metadata: a #TrackerImageMetadata
+ * @buffer: an XMP packet
+ * @len: the size of @buffer
+ *
+ * Parses an XMP packet embedded in the image. Only the first
+ * packet is parsed, further packets are ignored.
+ *
+ * Returns: %TRUE if the packet was parsed.
+ **/
+gboolean
+tracker_image_metadata_add_xmp (TrackerImageMetadata *metadata,
+                                const gchar          *buffer,
+                                gsize                 len)
+{
+	g_return_val_if_fail (metadata != NULL, FALSE);
+	g_return_val_if_fail (buffer != NULL, FALSE);
+
+	if (metadata->xmp || len == 0)
+		return FALSE;
+
+	metadata->xmp = tracker_xmp_new (buffer, len, metadata->uri);
+
+	return metadata->xmp != NULL;
+}
+
+/**
+ * tracker_image_metadata_add_iptc:
+ * @metadata: a #TrackerImageMetadata
+ * @buffer: an IPTC block
+ * @len: the size of @buffer
+ *
+ * Parses an IPTC block found in the image. Only the first
+ * block is parsed, further blocks are ignored.
+ *
+ * Returns: %TRUE if the block was parsed.
+ **/
+gboolean
+tracker_image_metadata_add_iptc (TrackerImageMetadata *metadata,
+                                 const guchar         *buffer,
+                                 gsize                 len)
+{
+	g_return_val_if_fail (metadata != NULL, FALSE);
+	g_return_val_if_fail (buffer != NULL, FALSE);
+
+	if (metadata->iptc || len == 0)
+		return FALSE;
+
+	metadata->iptc = tracker_iptc_new (buffer, len, metadata->uri);
+
+	return metadata->iptc != NULL;
+}
+
+static void
+load_sidecar (TrackerImageMetadata *metadata,
+              TrackerResource      *resource)
+{
+	TrackerResource *sidecar_resource;
+	gchar *sidecar = NULL;
+
+	metadata->xmp = tracker_xmp_new_from_sidecar (metadata->file, &sidecar);
+
+	if (!sidecar)
+		return;
+
+	sidecar_resource = tracker_resource_new (sidecar);
+	tracker_resource_add_uri (sidecar_resource, "rdf:type", "nfo:FileDataObject");
+	tracker_resource_add_relation (sidecar_resource, "nie:interpretedAs", resource);
+
+	tracker_resource_add_take_relation (resource, "nie:isStoredAs", sidecar_resource);
+	g_free (sidecar);
+}
+
+static void
+set_uri_relation (TrackerResource *resource,
+                  const gchar     *property,
+                  const gchar     *uri)
+{
+	TrackerResource *value;
+
+	value = tracker_resource_new (uri);
+	tracker_resource_set_relation (resource, property, value);
+	g_object_unref (value);
+}
+
+static void
+set_resolution (TrackerResource *resource,
+                const gchar     *property,
+                const gchar     *resolution,
+                gint             unit)
+{
+	gdouble value;
+
+	value = g_strtod (resolution, NULL);
+
+	if (unit == EXIF_RESOLUTION_UNIT_PER_CENTIMETER)
+		value *= CMS_PER_INCH;
+
+	tracker_resource_set_double (resource, property, value);
+}
+
+/**
+ * tracker_image_metadata_apply_to_resource:
+ * @metadata: a #TrackerImageMetadata
+ * @resource: the #TrackerResource of the image
+ *
+ * Merges the EXIF, XMP and IPTC data of the image and applies it
+ * to @resource. The title and the creation date fall back to the
+ * file name and modification time.
+ *
+ * Container specific properties, like the image dimensions, are
+ * left to the caller. Those may be set after this call in order
+ * to override the values applied here, like the resolution.
+ **/
+void
+tracker_image_metadata_apply_to_resource (TrackerImageMetadata *metadata,
+                                          TrackerResource      *resource)
+{
+	TrackerExifData *ed;
+	TrackerXmpData *xd;
+	TrackerIptcData *id;
+	const gchar *make, *model, *title, *orientation, *copyright;
+	const gchar *white_balance, *fnumber, *flash, *focal_length;
+	const gchar *artist, *exposure_time, *iso_speed_ratings, *date;
+	const gchar *description, *metering_mode, *creator;
+	const gchar *city, *state, *address, *country;
+	const gchar *gps_altitude, *gps_latitude, *gps_longitude, *gps_direction;
+	GPtrArray *keywords;
+	guint i;
+
+	g_return_if_fail (metadata != NULL);
+	g_return_if_fail (TRACKER_IS_RESOURCE (resource));
+
+	if (!metadata->xmp)
+		load_sidecar (metadata, resource);
+
+	if (!metadata->exif)
+		metadata->exif = g_new0 (TrackerExifData, 1);
+	if (!metadata->xmp)
+		metadata->xmp = g_new0 (TrackerXmpData, 1);
+	if (!metadata->iptc)
+		metadata->iptc = g_new0 (TrackerIptcData, 1);
+
+	ed = metadata->exif;
+	xd = metadata->xmp;
+	id = metadata->iptc;
+
+	title = tracker_coalesce_strip (4, xd->title, ed->document_name, xd->title2, xd->pdf_title);
+	orientation = tracker_coalesce_strip (3, xd->orientation, ed->orientation, id->image_orientation);
+	copyright = tracker_coalesce_strip (4, xd->copyright, xd->rights, ed->copyright, id->copyright_notice);
+	white_balance = tracker_coalesce_strip (2, xd->white_balance, ed->white_balance);
+	fnumber = tracker_coalesce_strip (2, xd->fnumber, ed->fnumber);
+	flash = tracker_coalesce_strip (2, xd->flash, ed->flash);
+	focal_length = tracker_coalesce_strip (2, xd->focal_length, ed->focal_length);
+	artist = tracker_coalesce_strip (3, xd->artist, ed->artist, xd->contributor);
+	exposure_time = tracker_coalesce_strip (2, xd->exposure_time, ed->exposure_time);
+	iso_speed_ratings = tracker_coalesce_strip (2, xd->iso_speed_ratings, ed->iso_speed_ratings);
+	date = tracker_coalesce_strip (5, xd->date, xd->time_original, ed->time, id->date_created, ed->time_original);
+	description = tracker_coalesce_strip (2, xd->description, ed->description);
+	metering_mode = tracker_coalesce_strip (2, xd->metering_mode, ed->metering_mode);
+	city = tracker_coalesce_strip (2, xd->city, id->city);
+	state = tracker_coalesce_strip (2, xd->state, id->state);
+	address = tracker_coalesce_strip (2, xd->address, id->sublocation);
+	country = tracker_coalesce_strip (2, xd->country, id->country_name);
+
+	/* FIXME We are not handling the altitude ref here for xmp */
+	gps_altitude = tracker_coalesce_strip (2, xd->gps_altitude, ed->gps_altitude);
+	gps_latitude = tracker_coalesce_strip (2, xd->gps_latitude, ed->gps_latitude);
+	gps_longitude = tracker_coalesce_strip (2, xd->gps_longitude, ed->gps_longitude);
+	gps_direction = tracker_coalesce_strip (2, xd->gps_direction, ed->gps_direction);
+	creator = tracker_coalesce_strip (3, xd->creator, id->byline, id->credit);
+	make = tracker_coalesce_strip (2, xd->make, ed->make);
+	model = tracker_coalesce_strip (2, xd->model, ed->model);
+
+	if (id->contact) {
+		TrackerResource *contact = tracker_extract_new_contact (id->contact);
+		tracker_resource_add_relation (resource, "nco:contributor", contact);
+		g_object_unref (contact);
+	}
+
+	keywords = g_ptr_array_new_with_free_func ((GDestroyNotify) g_free);
+
+	if (xd->keywords)
+		tracker_keywords_parse (keywords, xd->keywords);
+	if (xd->pdf_keywords)
+		tracker_keywords_parse (keywords, xd->pdf_keywords);
+	if (xd->subject)
+		tracker_keywords_parse (keywords, xd->subject);
+	if (id->keywords)
+		tracker_keywords_parse (keywords, id->keywords);
+
+	for (i = 0; i < keywords->len; i++) {
+		TrackerResource *tag;
+
+		tag = tracker_extract_new_tag (g_ptr_array_index (keywords, i));
+		tracker_resource_add_relation (resource, "nao:hasTag", tag);
+		g_object_unref (tag);
+	}
+
+	g_ptr_array_free (keywords, TRUE);
+
+	if (xd->publisher) {
+		TrackerResource *publisher = tracker_extract_new_contact (xd->publisher);
+		tracker_resource_set_relation (resource, "nco:publisher", publisher);
+		g_object_unref (publisher);
+	}
+
+	if (xd->type)
+		tracker_resource_set_string (resource, "dc:type", xd->type);
+	if (xd->rating)
+		tracker_resource_set_string (resource, "nao:numericRating", xd->rating);
+	if (xd->format)
+		tracker_resource_set_string (resource, "dc:format", xd->format);
+	if (xd->identifier)
+		tracker_resource_set_string (resource, "dc:identifier", xd->identifier);
+	if (xd->source)
+		tracker_resource_set_string (resource, "dc:source", xd->source);
+	if (xd->language)
+		tracker_resource_set_string (resource, "dc:language", xd->language);
+	if (xd->relation)
+		tracker_resource_set_string (resource, "dc:relation", xd->relation);
+	if (xd->coverage)
+		tracker_resource_set_string (resource, "dc:coverage", xd->coverage);
+	if (xd->license)
+		tracker_resource_set_string (resource, "nie:license", xd->license);
+
+	if (xd->regions)
+		tracker_xmp_apply_regions_to_resource (resource, xd);
+
+	if (make || model) {
+		TrackerResource *equipment = tracker_extract_new_equipment (make, model);
+		tracker_resource_set_relation (resource, "nfo:equipment", equipment);
+		g_object_unref (equipment);
+	}
+
+	tracker_guarantee_resource_title_from_file (resource,
+	                                            "nie:title",
+	                                            title,
+	                                            metadata->uri,
+	                                            NULL);
+
+	if (orientation)
+		set_uri_relation (resource, "nfo:orientation", orientation);
+
+	if (copyright)
+		tracker_guarantee_resource_utf8_string (resource, "nie:copyright", copyright);
+
+	if (white_balance)
+		set_uri_relation (resource, "nmm:whiteBalance", white_balance);
+
+	if (fnumber)
+		tracker_resource_set_double (resource, "nmm:fnumber", g_strtod (fnumber, NULL));
+
+	if (flash)
+		set_uri_relation (resource, "nmm:flash", flash);
+
+	if (focal_length)
+		tracker_resource_set_double (resource, "nmm:focalLength", g_strtod (focal_length, NULL));
+
+	if (artist) {
+		TrackerResource *contact = tracker_extract_new_contact (artist);
+		tracker_resource_add_relation (resource, "nco:contributor", contact);
+		g_object_unref (contact);
+	}
+
+	if (exposure_time)
+		tracker_resource_set_double (resource, "nmm:exposureTime", g_strtod (exposure_time, NULL));
+
+	if (iso_speed_ratings)
+		tracker_resource_set_double (resource, "nmm:isoSpeed", g_strtod (iso_speed_ratings, NULL));
+
+	tracker_guarantee_resource_date_from_file_mtime (resource,
+	                                                 "nie:contentCreated",
+	                                                 date,
+	                                                 metadata->uri);
+
+	if (description)
+		tracker_guarantee_resource_utf8_string (resource, "nie:description", description);
+
+	if (metering_mode)
+		set_uri_relation (resource, "nmm:meteringMode", metering_mode);
+
+	if (creator) {
+		TrackerResource *contact = tracker_extract_new_contact (creator);
+		tracker_resource_add_relation (resource, "nco:creator", contact);
+		g_object_unref (contact);
+	}
+
+	if (ed->user_comment)
+		tracker_guarantee_resource_utf8_string (resource, "nie:comment", ed->user_comment);
+
+	if (address || state || country || city ||
+	    gps_altitude || gps_latitude || gps_longitude) {
+		TrackerResource *location;
+
+		location = tracker_extract_new_location (address, state, city, country,
+		                                         gps_altitude, gps_latitude,
+		                                         gps_longitude);
+		tracker_resource_set_relation (resource, "slo:location", location);
+		g_object_unref (location);
+	}
+
+	if (gps_direction)
+		tracker_resource_set_string (resource, "nfo:heading", gps_direction);
+
+	if (ed->x_resolution) {
+		set_resolution (resource, "nfo:horizontalResolution",
+		                ed->x_resolution, ed->resolution_unit);
+	}
+
+	if (ed->y_resolution) {
+		set_resolution (resource, "nfo:verticalResolution",
+		                ed->y_resolution, ed->resolution_unit);
+	}
+}
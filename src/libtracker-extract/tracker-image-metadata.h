@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __LIBTRACKER_EXTRACT_IMAGE_METADATA_H__
+#define __LIBTRACKER_EXTRACT_IMAGE_METADATA_H__
+
+#if !defined (__LIBTRACKER_EXTRACT_INSIDE__) && !defined (TRACKER_COMPILATION)
+#error "only <libtracker-extract/tracker-extract.h> must be included directly."
+#endif
+
+#include <tinysparql.h>
+
+#include "tracker-exif.h"
+#include "tracker-iptc.h"
+#include "tracker-xmp.h"
+
+G_BEGIN_DECLS
+
+typedef struct _TrackerImageMetadata TrackerImageMetadata;
+
+TrackerImageMetadata * tracker_image_metadata_new       (GFile                *file);
+void                   tracker_image_metadata_free      (TrackerImageMetadata *metadata);
+
+gboolean               tracker_image_metadata_add_exif  (TrackerImageMetadata *metadata,
+                                                         const guchar         *buffer,
+                                                         gsize                 len);
+gboolean               tracker_image_metadata_add_xmp   (TrackerImageMetadata *metadata,
+                                                         const gchar          *buffer,
+                                                         gsize                 len);
+gboolean               tracker_image_metadata_add_iptc  (TrackerImageMetadata *metadata,
+                                                         const guchar         *buffer,
+                                                         gsize                 len);
+gboolean               tracker_image_metadata_take_exif (TrackerImageMetadata *metadata,
+                                                         TrackerExifData      *data);
+
+void                   tracker_image_metadata_apply_to_resource (TrackerImageMetadata *metadata,
+                                                                 TrackerResource      *resource);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (TrackerImageMetadata, tracker_image_metadata_free)
+
+G_END_DECLS
+
+#endif /* __LIBTRACKER_EXTRACT_IMAGE_METADATA_H__ */
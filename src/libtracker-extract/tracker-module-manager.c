@@ -601,6 +601,40 @@ tracker_extract_module_manager_get_hash (const gchar *mimetype)
 	return NULL;
 }
 
+/**
+ * tracker_extract_module_manager_get_rules_checksum:
+ *
+ * Returns a checksum of all loaded extractor rules, it changes
+ * whenever a rule is added, removed or modified.
+ *
+ * Returns: (transfer full): the checksum
+ **/
+gchar *
+tracker_extract_module_manager_get_rules_checksum (void)
+{
+	g_autoptr (GChecksum) checksum = NULL;
+	guint i;
+
+	if (!tracker_extract_module_manager_init ()) {
+		return NULL;
+	}
+
+	checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+	for (i = 0; i < rules->len; i++) {
+		RuleInfo *info = &g_array_index (rules, RuleInfo, i);
+		g_autofree gchar *contents = NULL;
+		gsize len;
+
+		g_checksum_update (checksum, (const guchar *) info->rule_path, -1);
+
+		if (g_file_get_contents (info->rule_path, &contents, &len, NULL))
+			g_checksum_update (checksum, (const guchar *) contents, len);
+	}
+
+	return g_strdup (g_checksum_get_string (checksum));
+}
+
 void
 tracker_module_manager_shutdown_modules (void)
 {
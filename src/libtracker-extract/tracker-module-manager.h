@@ -44,6 +44,7 @@ gboolean  tracker_extract_module_manager_init                (void);
 GStrv     tracker_extract_module_manager_get_rdf_types (const gchar *mimetype);
 const gchar * tracker_extract_module_manager_get_graph (const gchar *mimetype);
 const gchar * tracker_extract_module_manager_get_hash  (const gchar *mimetype);
+gchar *       tracker_extract_module_manager_get_rules_checksum (void);
 
 gboolean tracker_extract_module_manager_check_fallback_rdf_type (const gchar *mimetype,
                                                                  const gchar *rdf_type);
@@ -21,6 +21,9 @@
 
 #include <locale.h>
 #include <string.h>
+#include <time.h>
+
+#include <glib/gstdio.h>
 
 #include <libtracker-miners-common/tracker-utils.h>
 
@@ -663,6 +666,26 @@ register_namespace (const gchar *ns_uri,
         }
 }
 
+/* Initializing the XMP toolkit is expensive, and xmp_terminate()
+ * tears it down again once the last user is gone. Keep it around
+ * for the lifetime of the process instead of paying that per file.
+ */
+static void
+ensure_initialized (void)
+{
+	static gsize initialized = 0;
+
+	if (g_once_init_enter (&initialized)) {
+		xmp_init ();
+
+		register_namespace (NS_XMP_REGIONS, "mwg-rs");
+		register_namespace (NS_ST_DIM, "stDim");
+		register_namespace (NS_ST_AREA, "stArea");
+
+		g_once_init_leave (&initialized, 1);
+	}
+}
+
 #endif /* HAVE_EXEMPI */
 
 static gboolean
@@ -679,11 +702,7 @@ parse_xmp (const gchar    *buffer,
 
 #ifdef HAVE_EXEMPI
 
-	xmp_init ();
-
-        register_namespace (NS_XMP_REGIONS, "mwg-rs");
-        register_namespace (NS_ST_DIM, "stDim");
-        register_namespace (NS_ST_AREA, "stArea");
+	ensure_initialized ();
 
 	xmp = xmp_new_empty ();
 	xmp_parse (xmp, buffer, len);
@@ -696,8 +715,6 @@ parse_xmp (const gchar    *buffer,
 		xmp_iterator_free (iter);
 		xmp_free (xmp);
 	}
-
-	xmp_terminate ();
 #endif /* HAVE_EXEMPI */
 
 	return TRUE;
@@ -797,21 +814,173 @@ tracker_xmp_new (const gchar *buffer,
 	return data;
 }
 
-gchar *
-replace_extension (gchar *path)
+/* Photo libraries put many images in a directory and most of them have
+ * no sidecar, so list the sidecars of each directory being extracted once
+ * instead of probing the filesystem for each image. The listings are kept
+ * across batches of files to extract, and checked again against the
+ * directory modification time the first time they are used in a batch
+ * (see tracker_xmp_reset_sidecar_cache()).
+ */
+typedef struct {
+	/* Sidecar file names in the directory */
+	GHashTable *names;
+	time_t mtime;
+	time_t listed;
+	guint generation;
+} SidecarListing;
+
+typedef struct {
+	GMutex mutex;
+	/* Directory path -> SidecarListing */
+	GHashTable *directories;
+	guint generation;
+} SidecarCache;
+
+static SidecarCache sidecar_cache;
+
+static void
+sidecar_listing_free (SidecarListing *listing)
+{
+	g_hash_table_unref (listing->names);
+	g_free (listing);
+}
+
+static gboolean
+sidecar_listing_is_current (SidecarListing *listing,
+                            const gchar    *path)
+{
+	GStatBuf st;
+
+	if (listing->generation == sidecar_cache.generation)
+		return TRUE;
+
+	if (g_stat (path, &st) != 0)
+		return FALSE;
+
+	/* Changes within the second the listing was made may not
+	 * show up in a seconds resolution mtime, so do not trust it.
+	 */
+	if (st.st_mtime != listing->mtime ||
+	    listing->mtime >= listing->listed)
+		return FALSE;
+
+	listing->generation = sidecar_cache.generation;
+
+	return TRUE;
+}
+
+static GHashTable *
+sidecar_cache_lookup (GFile *directory)
+{
+	g_autofree gchar *path = NULL;
+	SidecarListing *listing;
+	const gchar *name;
+	GStatBuf st;
+	GDir *dir;
+
+	path = g_file_get_path (directory);
+	if (!path)
+		return NULL;
+
+	if (!sidecar_cache.directories) {
+		sidecar_cache.directories =
+			g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+			                       (GDestroyNotify) sidecar_listing_free);
+	}
+
+	listing = g_hash_table_lookup (sidecar_cache.directories, path);
+	if (listing && sidecar_listing_is_current (listing, path))
+		return listing->names;
+
+	listing = g_new0 (SidecarListing, 1);
+	listing->names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	listing->generation = sidecar_cache.generation;
+
+	if (g_stat (path, &st) == 0)
+		listing->mtime = st.st_mtime;
+	listing->listed = time (NULL);
+
+	dir = g_dir_open (path, 0, NULL);
+
+	while (dir && (name = g_dir_read_name (dir)) != NULL) {
+		if (g_str_has_suffix (name, ".xmp"))
+			g_hash_table_add (listing->names, g_strdup (name));
+	}
+
+	g_clear_pointer (&dir, g_dir_close);
+	g_hash_table_insert (sidecar_cache.directories,
+	                     g_steal_pointer (&path), listing);
+
+	return listing->names;
+}
+
+static GFile *
+lookup_sidecar (GFile *orig_file)
 {
+	g_autoptr (GFile) directory = NULL;
+	g_autofree gchar *basename = NULL, *sidecar_name = NULL;
+	GHashTable *sidecars;
+	GFile *sidecar = NULL;
 	const gchar *dot;
-	gchar *prefix, *xmp_path;
 
-	dot = strrchr (path, '.');
+	basename = g_file_get_basename (orig_file);
+	dot = basename ? strrchr (basename, '.') : NULL;
 	if (!dot)
 		return NULL;
 
-	prefix = g_strndup (path, dot - path);
-	xmp_path = g_strdup_printf ("%s.xmp", prefix);
-	g_free (prefix);
+	directory = g_file_get_parent (orig_file);
+	if (!directory)
+		return NULL;
+
+	g_mutex_lock (&sidecar_cache.mutex);
+
+	sidecars = sidecar_cache_lookup (directory);
 
-	return xmp_path;
+	if (sidecars && g_hash_table_size (sidecars) > 0) {
+		sidecar_name = g_strdup_printf ("%.*s.xmp", (int) (dot - basename), basename);
+
+		if (g_hash_table_contains (sidecars, sidecar_name))
+			sidecar = g_file_get_child (directory, sidecar_name);
+	}
+
+	g_mutex_unlock (&sidecar_cache.mutex);
+
+	return sidecar;
+}
+
+/**
+ * tracker_xmp_reset_sidecar_cache:
+ *
+ * Starts a new batch for the directory listings used by
+ * tracker_xmp_new_from_sidecar(). Changes in sidecars make their images
+ * be extracted again in a later batch, so each listing is checked again
+ * with a stat of its directory the first time it is used after this call,
+ * and listed again if the directory changed. Listings that were not used
+ * since the previous call are dropped.
+ *
+ * This should be called before extracting each batch of files.
+ *
+ * Since: 3.8
+ **/
+void
+tracker_xmp_reset_sidecar_cache (void)
+{
+	GHashTableIter iter;
+	SidecarListing *listing;
+
+	g_mutex_lock (&sidecar_cache.mutex);
+
+	if (sidecar_cache.directories) {
+		g_hash_table_iter_init (&iter, sidecar_cache.directories);
+
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &listing)) {
+			if (listing->generation != sidecar_cache.generation)
+				g_hash_table_iter_remove (&iter);
+		}
+	}
+
+	sidecar_cache.generation++;
+	g_mutex_unlock (&sidecar_cache.mutex);
 }
 
 TrackerXmpData *
@@ -820,32 +989,33 @@ tracker_xmp_new_from_sidecar (GFile  *orig_file,
 {
 	g_autoptr (GMappedFile) mapped_file = NULL;
 	TrackerXmpData *xmp_data;
-	g_autofree gchar *path = NULL, *xmp_path = NULL, *uri = NULL;
+	g_autoptr (GFile) sidecar = NULL;
+	g_autofree gchar *xmp_path = NULL, *uri = NULL;
 	g_autoptr (GBytes) bytes = NULL;
 
 	if (sidecar_uri)
 		*sidecar_uri = NULL;
 
-	path = g_file_get_path (orig_file);
-	xmp_path = replace_extension (path);
-	if (!xmp_path)
-		return NULL;
-
-	if (!g_file_test (xmp_path, G_FILE_TEST_IS_REGULAR))
+	sidecar = lookup_sidecar (orig_file);
+	if (!sidecar)
 		return NULL;
 
+	xmp_path = g_file_get_path (sidecar);
 	mapped_file = g_mapped_file_new (xmp_path, FALSE, NULL);
 	if (!mapped_file)
 		return NULL;
 
 	bytes = g_mapped_file_get_bytes (mapped_file);
+	if (g_bytes_get_size (bytes) == 0)
+		return NULL;
+
 	uri = g_file_get_uri (orig_file);
 	xmp_data = tracker_xmp_new (g_bytes_get_data (bytes, NULL),
 	                            g_bytes_get_size (bytes),
 	                            uri);
 
 	if (sidecar_uri)
-		*sidecar_uri = g_filename_to_uri (xmp_path, NULL, NULL);
+		*sidecar_uri = g_file_get_uri (sidecar);
 
 	return xmp_data;
 }
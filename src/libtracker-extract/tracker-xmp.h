@@ -172,6 +172,7 @@ TrackerXmpData *tracker_xmp_new           (const gchar          *buffer,
                                            const gchar          *uri);
 TrackerXmpData *tracker_xmp_new_from_sidecar (GFile             *orig_file,
                                               gchar            **sidecar_uri);
+void            tracker_xmp_reset_sidecar_cache (void);
 void            tracker_xmp_free          (TrackerXmpData       *data);
 
 
@@ -721,3 +721,26 @@ tracker_filename_casecmp_without_extension (const gchar *a,
 
 	return g_ascii_strncasecmp (a, b, len_a) == 0;
 }
+
+/* Returns the filesystem ID part of a content identifier, or %NULL
+ * if @content_id is not in the format the file miner creates.
+ */
+gchar *
+tracker_content_identifier_get_filesystem_id (const gchar *content_id)
+{
+	const gchar *start, *end;
+
+	/* Format:
+	 * 'urn:fileid:' [uuid] ':' [inode]
+	 */
+	if (!content_id || !g_str_has_prefix (content_id, "urn:fileid:"))
+		return NULL;
+
+	start = content_id + strlen ("urn:fileid:");
+	end = strrchr (start, ':');
+
+	if (!end || end == start)
+		return NULL;
+
+	return g_strndup (start, end - start);
+}
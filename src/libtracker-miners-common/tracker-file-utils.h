@@ -57,6 +57,7 @@ gboolean tracker_filename_casecmp_without_extension         (const gchar *a,
 /* File system utils */
 guint64  tracker_file_system_get_remaining_space            (const gchar *path);
 gdouble  tracker_file_system_get_remaining_space_percentage (const gchar *path);
+gchar *  tracker_content_identifier_get_filesystem_id       (const gchar *content_id);
 
 G_END_DECLS
 
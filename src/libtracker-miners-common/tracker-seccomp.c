@@ -42,6 +42,10 @@
 #include <linux/btrfs.h>
 #endif
 
+#ifdef HAVE_FIEMAP
+#include <linux/fs.h>
+#endif
+
 #include <seccomp.h>
 
 #include <libtracker-miners-common/valgrind.h>
@@ -301,6 +305,11 @@ tracker_seccomp_init (void)
 	CUSTOM_RULE (ioctl, SCMP_ACT_ALLOW, SCMP_CMP(1, SCMP_CMP_EQ, BTRFS_IOC_INO_LOOKUP));
 #endif
 
+#ifdef HAVE_FIEMAP
+	/* Reading the file layout, used to sort files for readahead */
+	CUSTOM_RULE (ioctl, SCMP_ACT_ALLOW, SCMP_CMP(1, SCMP_CMP_EQ, FS_IOC_FIEMAP));
+#endif
+
 	/* Special requirements for open/openat, allow O_RDONLY calls,
          * but fail if write permissions are requested.
 	 */
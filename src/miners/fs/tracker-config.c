@@ -48,6 +48,8 @@
 #define DEFAULT_LOW_DISK_SPACE_LIMIT             1        /* 0->100 / -1 */
 #define DEFAULT_CRAWLING_INTERVAL                -1       /* 0->365 / -1 / -2 */
 #define DEFAULT_REMOVABLE_DAYS_THRESHOLD         3        /* 1->365 / 0  */
+#define DEFAULT_MEMORY_BUDGET                    0        /* 0->65536 */
+#define DEFAULT_QUERY_CACHE_SIZE                 0        /* 0->1024 */
 
 typedef struct {
 	/* IMPORTANT: There are 3 versions of the directories:
@@ -110,6 +112,10 @@ enum {
 	PROP_IGNORED_FILES,
 	PROP_CRAWLING_INTERVAL,
 	PROP_REMOVABLE_DAYS_THRESHOLD,
+	PROP_MEMORY_BUDGET,
+
+	/* Queries */
+	PROP_QUERY_CACHE_SIZE,
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (TrackerConfig, tracker_config, G_TYPE_SETTINGS)
@@ -264,6 +270,28 @@ tracker_config_class_init (TrackerConfigClass *klass)
 	                                                   365,
 	                                                   DEFAULT_REMOVABLE_DAYS_THRESHOLD,
 	                                                   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+	g_object_class_install_property (object_class,
+	                                 PROP_MEMORY_BUDGET,
+	                                 g_param_spec_int ("memory-budget",
+	                                                   "Memory budget",
+	                                                   " Memory in MiB for queued indexing work,"
+	                                                   " 0 means no limit, maximum is 65536.",
+	                                                   0,
+	                                                   65536,
+	                                                   DEFAULT_MEMORY_BUDGET,
+	                                                   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/* Queries */
+	g_object_class_install_property (object_class,
+	                                 PROP_QUERY_CACHE_SIZE,
+	                                 g_param_spec_int ("query-cache-size",
+	                                                   "Query cache size",
+	                                                   " Memory in MiB used to cache query results,"
+	                                                   " 0 disables the cache, maximum is 1024.",
+	                                                   0,
+	                                                   1024,
+	                                                   DEFAULT_QUERY_CACHE_SIZE,
+	                                                   G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -406,6 +434,14 @@ config_get_property (GObject    *object,
 	case PROP_REMOVABLE_DAYS_THRESHOLD:
 		g_value_set_int (value, tracker_config_get_removable_days_threshold (config));
 		break;
+	case PROP_MEMORY_BUDGET:
+		g_value_set_int (value, tracker_config_get_memory_budget (config));
+		break;
+
+		/* Queries */
+	case PROP_QUERY_CACHE_SIZE:
+		g_value_set_int (value, tracker_config_get_query_cache_size (config));
+		break;
 
 	/* Did we miss any new properties? */
 	default:
@@ -521,6 +557,8 @@ config_constructed (GObject *object)
 	g_settings_bind (settings, "crawling-interval", object, "crawling-interval", G_SETTINGS_BIND_GET);
 	g_settings_bind (settings, "low-disk-space-limit", object, "low-disk-space-limit", G_SETTINGS_BIND_GET);
 	g_settings_bind (settings, "removable-days-threshold", object, "removable-days-threshold", G_SETTINGS_BIND_GET);
+	g_settings_bind (settings, "memory-budget", object, "memory-budget", G_SETTINGS_BIND_GET);
+	g_settings_bind (settings, "query-cache-size", object, "query-cache-size", G_SETTINGS_BIND_GET);
 	g_settings_bind (settings, "enable-monitors", object, "enable-monitors", G_SETTINGS_BIND_GET);
 	g_settings_bind (settings, "index-removable-devices", object, "index-removable-devices", G_SETTINGS_BIND_GET);
 	g_settings_bind (settings, "index-optical-discs", object, "index-optical-discs", G_SETTINGS_BIND_GET);
@@ -723,6 +761,22 @@ tracker_config_get_removable_days_threshold (TrackerConfig *config)
 	return g_settings_get_int (G_SETTINGS (config), "removable-days-threshold");
 }
 
+gint
+tracker_config_get_memory_budget (TrackerConfig *config)
+{
+	g_return_val_if_fail (TRACKER_IS_CONFIG (config), DEFAULT_MEMORY_BUDGET);
+
+	return g_settings_get_int (G_SETTINGS (config), "memory-budget");
+}
+
+gint
+tracker_config_get_query_cache_size (TrackerConfig *config)
+{
+	g_return_val_if_fail (TRACKER_IS_CONFIG (config), DEFAULT_QUERY_CACHE_SIZE);
+
+	return g_settings_get_int (G_SETTINGS (config), "query-cache-size");
+}
+
 void
 tracker_config_set_initial_sleep (TrackerConfig *config,
                                   gint           value)
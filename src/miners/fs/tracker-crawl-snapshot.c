@@ -0,0 +1,537 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config-miners.h"
+
+#ifdef HAVE_BTRFS_IOCTL
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/ioctl.h>
+#include <linux/btrfs.h>
+#endif
+
+#include "tracker-crawl-snapshot.h"
+
+#define SNAPSHOT_VERSION 2
+/* Version, timestamp, root URI, checksum, volume ID, volume
+ * generation, entries.
+ */
+#define SNAPSHOT_VARIANT_TYPE "(uxsssta(sxxt))"
+
+typedef struct {
+	gint64 mtime;
+	gint64 ctime;
+	guint64 inode;
+} SnapshotEntry;
+
+struct _TrackerCrawlSnapshot {
+	GFile *root;
+	gchar *checksum;
+	/* Crawl start, in seconds since the epoch */
+	gint64 timestamp;
+	/* Volume holding all recorded directories and its generation
+	 * at crawl start, the ID is empty if there is none.
+	 */
+	gchar *volume_id;
+	guint64 volume_generation;
+	/* Device of the recorded directories, and whether they
+	 * are spread across several.
+	 */
+	guint64 device;
+	gboolean mixed_devices;
+	/* Path relative to the root -> SnapshotEntry, "" is the root */
+	GHashTable *entries;
+};
+
+static void
+entry_from_info (SnapshotEntry *entry,
+                 GFileInfo     *info)
+{
+	entry->mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	entry->ctime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_CHANGED);
+	entry->inode = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE);
+}
+
+static void
+note_device (TrackerCrawlSnapshot *snapshot,
+             GFileInfo            *info)
+{
+	guint64 device;
+
+	device = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE);
+
+	if (snapshot->device == 0)
+		snapshot->device = device;
+	else if (device != snapshot->device)
+		snapshot->mixed_devices = TRUE;
+}
+
+static gchar *
+query_volume (GFile   *root,
+              guint64 *generation)
+{
+#if defined (HAVE_BTRFS_IOCTL) && defined (BTRFS_IOC_GET_SUBVOL_INFO)
+	struct btrfs_ioctl_get_subvol_info_args args = { 0, };
+	GString *id;
+	const gchar *path;
+	gint fd, res;
+	guint i;
+
+	path = g_file_peek_path (root);
+	if (!path)
+		return NULL;
+
+	fd = open (path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0)
+		return NULL;
+
+	/* Unlike the tree search ioctls, this needs no privileges.
+	 * The generation of a subvolume changes with every transaction
+	 * that modifies anything in it.
+	 */
+	res = ioctl (fd, BTRFS_IOC_GET_SUBVOL_INFO, &args);
+	close (fd);
+
+	if (res < 0)
+		return NULL;
+
+	id = g_string_new ("btrfs:");
+
+	for (i = 0; i < G_N_ELEMENTS (args.uuid); i++)
+		g_string_append_printf (id, "%02x", args.uuid[i]);
+
+	*generation = args.generation;
+
+	return g_string_free (id, FALSE);
+#else
+	return NULL;
+#endif
+}
+
+static gchar *
+get_relative_path (TrackerCrawlSnapshot *snapshot,
+                   GFile                *file)
+{
+	if (g_file_equal (file, snapshot->root))
+		return g_strdup ("");
+
+	return g_file_get_relative_path (snapshot->root, file);
+}
+
+/**
+ * tracker_crawl_snapshot_new:
+ * @root: the index root
+ * @checksum: checksum of the configuration the crawl happens with
+ *
+ * Creates an empty snapshot for @root. Snapshots are only valid for
+ * the configuration they were recorded with, @checksum should change
+ * whenever the set of indexed files or their extracted data may.
+ *
+ * Returns: (transfer full): a #TrackerCrawlSnapshot
+ **/
+TrackerCrawlSnapshot *
+tracker_crawl_snapshot_new (GFile       *root,
+                            const gchar *checksum)
+{
+	TrackerCrawlSnapshot *snapshot;
+
+	snapshot = g_new0 (TrackerCrawlSnapshot, 1);
+	snapshot->root = g_object_ref (root);
+	snapshot->checksum = g_strdup (checksum ? checksum : "");
+	snapshot->volume_id = g_strdup ("");
+	snapshot->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                           g_free, g_free);
+
+	return snapshot;
+}
+
+/**
+ * tracker_crawl_snapshot_load:
+ * @root: the index root
+ * @checksum: checksum of the current configuration
+ * @bytes: serialized snapshot
+ * @error: location for a #GError
+ *
+ * Loads a snapshot previously serialized with
+ * tracker_crawl_snapshot_serialize(). Truncated or otherwise
+ * corrupt data, and snapshots recorded for another root,
+ * version or configuration are rejected with
+ * %G_IO_ERROR_INVALID_DATA.
+ *
+ * Returns: (transfer full) (nullable): a #TrackerCrawlSnapshot
+ **/
+TrackerCrawlSnapshot *
+tracker_crawl_snapshot_load (GFile        *root,
+                             const gchar  *checksum,
+                             GBytes       *bytes,
+                             GError      **error)
+{
+	TrackerCrawlSnapshot *snapshot;
+	g_autoptr (GVariant) variant = NULL, entries = NULL;
+	g_autofree gchar *root_uri = NULL;
+	const gchar *uri, *stored_checksum, *volume_id, *path;
+	GVariantIter iter;
+	gint64 timestamp, mtime, ctime;
+	guint64 volume_generation, inode;
+	guint32 version;
+
+	variant = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (SNAPSHOT_VARIANT_TYPE),
+	                                                        bytes, FALSE));
+
+	if (!g_variant_is_normal_form (variant)) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		             "Corrupt crawl snapshot");
+		return NULL;
+	}
+
+	g_variant_get (variant, "(ux&s&s&st@a(sxxt))",
+	               &version, &timestamp, &uri, &stored_checksum,
+	               &volume_id, &volume_generation, &entries);
+	root_uri = g_file_get_uri (root);
+
+	if (version != SNAPSHOT_VERSION ||
+	    g_strcmp0 (uri, root_uri) != 0 ||
+	    g_strcmp0 (stored_checksum, checksum ? checksum : "") != 0) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		             "Crawl snapshot is stale");
+		return NULL;
+	}
+
+	snapshot = tracker_crawl_snapshot_new (root, checksum);
+	snapshot->timestamp = timestamp;
+	g_free (snapshot->volume_id);
+	snapshot->volume_id = g_strdup (volume_id);
+	snapshot->volume_generation = volume_generation;
+	/* Directories were only recorded on a single device
+	 * if a volume was, the device itself may differ now.
+	 */
+	snapshot->mixed_devices = volume_id[0] == '\0';
+
+	g_variant_iter_init (&iter, entries);
+
+	while (g_variant_iter_next (&iter, "(&sxxt)", &path, &mtime, &ctime, &inode)) {
+		SnapshotEntry *entry;
+
+		entry = g_new (SnapshotEntry, 1);
+		entry->mtime = mtime;
+		entry->ctime = ctime;
+		entry->inode = inode;
+		g_hash_table_replace (snapshot->entries, g_strdup (path), entry);
+	}
+
+	if (!g_hash_table_contains (snapshot->entries, "")) {
+		tracker_crawl_snapshot_free (snapshot);
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		             "Crawl snapshot misses the index root");
+		return NULL;
+	}
+
+	return snapshot;
+}
+
+void
+tracker_crawl_snapshot_free (TrackerCrawlSnapshot *snapshot)
+{
+	g_hash_table_unref (snapshot->entries);
+	g_object_unref (snapshot->root);
+	g_free (snapshot->checksum);
+	g_free (snapshot->volume_id);
+	g_free (snapshot);
+}
+
+/**
+ * tracker_crawl_snapshot_serialize:
+ * @snapshot: a #TrackerCrawlSnapshot
+ *
+ * Serializes @snapshot so it can be stored on disk, and loaded
+ * back with tracker_crawl_snapshot_load().
+ *
+ * Returns: (transfer full): the serialized snapshot
+ **/
+GBytes *
+tracker_crawl_snapshot_serialize (TrackerCrawlSnapshot *snapshot)
+{
+	g_autoptr (GVariant) variant = NULL;
+	g_autofree gchar *root_uri = NULL;
+	GVariantBuilder builder;
+	GHashTableIter iter;
+	const gchar *path;
+	SnapshotEntry *entry;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sxxt)"));
+	g_hash_table_iter_init (&iter, snapshot->entries);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &path, (gpointer *) &entry)) {
+		g_variant_builder_add (&builder, "(sxxt)",
+		                       path, entry->mtime, entry->ctime, entry->inode);
+	}
+
+	root_uri = g_file_get_uri (snapshot->root);
+	variant = g_variant_ref_sink (g_variant_new (SNAPSHOT_VARIANT_TYPE,
+	                                             SNAPSHOT_VERSION,
+	                                             snapshot->timestamp,
+	                                             root_uri,
+	                                             snapshot->checksum,
+	                                             snapshot->mixed_devices ?
+	                                             "" : snapshot->volume_id,
+	                                             snapshot->volume_generation,
+	                                             &builder));
+
+	return g_variant_get_data_as_bytes (variant);
+}
+
+/**
+ * tracker_crawl_snapshot_set_timestamp:
+ * @snapshot: a #TrackerCrawlSnapshot
+ * @timestamp: time the crawl started, in seconds since the epoch
+ *
+ * Sets the time the directories were recorded at. Directories
+ * modified within that second or later cannot be told apart from
+ * the recorded state, those will be considered changed on the
+ * next check.
+ **/
+void
+tracker_crawl_snapshot_set_timestamp (TrackerCrawlSnapshot *snapshot,
+                                      gint64                timestamp)
+{
+	snapshot->timestamp = timestamp;
+}
+
+/**
+ * tracker_crawl_snapshot_stamp_volume:
+ * @snapshot: a #TrackerCrawlSnapshot
+ *
+ * Records the generation of the btrfs subvolume holding the index
+ * root, this must happen before the crawl starts. If the subvolume
+ * is unchanged on the next check, and all directories were recorded
+ * within it, none of them need to be looked at. This does blocking
+ * I/O, so it is best called from a thread.
+ **/
+void
+tracker_crawl_snapshot_stamp_volume (TrackerCrawlSnapshot *snapshot)
+{
+	gchar *volume_id;
+	guint64 generation = 0;
+
+	volume_id = query_volume (snapshot->root, &generation);
+
+	g_free (snapshot->volume_id);
+	snapshot->volume_id = volume_id ? volume_id : g_strdup ("");
+	snapshot->volume_generation = generation;
+}
+
+/**
+ * tracker_crawl_snapshot_add_directory:
+ * @snapshot: a #TrackerCrawlSnapshot
+ * @directory: a directory in the index root
+ * @info: #GFileInfo of @directory, queried with at least
+ *        %TRACKER_CRAWL_SNAPSHOT_ATTRIBUTES
+ *
+ * Records the current state of @directory. This must happen
+ * before or while its contents are reconciled with the store.
+ **/
+void
+tracker_crawl_snapshot_add_directory (TrackerCrawlSnapshot *snapshot,
+                                      GFile                *directory,
+                                      GFileInfo            *info)
+{
+	SnapshotEntry *entry;
+	gchar *path;
+
+	path = get_relative_path (snapshot, directory);
+	if (!path)
+		return;
+
+	entry = g_new (SnapshotEntry, 1);
+	entry_from_info (entry, info);
+	g_hash_table_replace (snapshot->entries, path, entry);
+	note_device (snapshot, info);
+}
+
+/**
+ * tracker_crawl_snapshot_remove_directory:
+ * @snapshot: a #TrackerCrawlSnapshot
+ * @directory: a directory in the index root
+ *
+ * Forgets about @directory. Descendants are left in place, those
+ * will be found missing on the next check.
+ **/
+void
+tracker_crawl_snapshot_remove_directory (TrackerCrawlSnapshot *snapshot,
+                                         GFile                *directory)
+{
+	g_autofree gchar *path = NULL;
+
+	path = get_relative_path (snapshot, directory);
+	if (path)
+		g_hash_table_remove (snapshot->entries, path);
+}
+
+static gint
+compare_paths (gconstpointer a,
+               gconstpointer b)
+{
+	return g_strcmp0 (g_file_peek_path (G_FILE (a)),
+	                  g_file_peek_path (G_FILE (b)));
+}
+
+static gboolean
+entry_is_racy (TrackerCrawlSnapshot *snapshot,
+               SnapshotEntry        *entry)
+{
+	/* Timestamps have second granularity, changes happening in
+	 * the same second the directory was recorded go unnoticed.
+	 */
+	return (entry->mtime >= snapshot->timestamp ||
+	        entry->ctime >= snapshot->timestamp);
+}
+
+/**
+ * tracker_crawl_snapshot_check:
+ * @snapshot: a #TrackerCrawlSnapshot
+ * @cancellable: (nullable): a #GCancellable
+ * @error: location for a #GError
+ *
+ * Compares all recorded directories with their current state on
+ * disk. Directories that are gone are dropped from the snapshot,
+ * their parent directory will be reported changed. If the volume
+ * recorded with tracker_crawl_snapshot_stamp_volume() did not change
+ * at all, only the index root is looked at. The volume is stamped
+ * again for the next check. This does blocking I/O, so it is best
+ * called from a thread.
+ *
+ * If the index root itself was replaced, the snapshot is useless
+ * and %G_IO_ERROR_INVALID_DATA is returned.
+ *
+ * Returns: (transfer full) (element-type GFile): the directories
+ *   that changed, excluding the index root, sorted by path.
+ **/
+GList *
+tracker_crawl_snapshot_check (TrackerCrawlSnapshot  *snapshot,
+                              GCancellable          *cancellable,
+                              GError               **error)
+{
+	g_autofree gchar *volume_id = NULL;
+	GHashTableIter iter;
+	const gchar *path;
+	SnapshotEntry *entry, current;
+	GList *changed = NULL;
+	guint64 generation = 0;
+	gboolean volume_unchanged;
+
+	volume_id = query_volume (snapshot->root, &generation);
+	volume_unchanged = (volume_id &&
+	                    !snapshot->mixed_devices &&
+	                    g_strcmp0 (volume_id, snapshot->volume_id) == 0 &&
+	                    generation == snapshot->volume_generation);
+
+	g_free (snapshot->volume_id);
+	snapshot->volume_id = volume_id ? g_steal_pointer (&volume_id) : g_strdup ("");
+	snapshot->volume_generation = generation;
+
+	g_hash_table_iter_init (&iter, snapshot->entries);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &path, (gpointer *) &entry)) {
+		g_autoptr (GFileInfo) info = NULL;
+		g_autoptr (GFile) file = NULL;
+		gboolean is_root = path[0] == '\0';
+
+		if (volume_unchanged && !is_root)
+			continue;
+
+		if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+			g_list_free_full (changed, g_object_unref);
+			return NULL;
+		}
+
+		file = is_root ? g_object_ref (snapshot->root) :
+			g_file_resolve_relative_path (snapshot->root, path);
+		info = g_file_query_info (file,
+		                          TRACKER_CRAWL_SNAPSHOT_ATTRIBUTES,
+		                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+		                          cancellable, NULL);
+
+		if (info &&
+		    g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+			entry_from_info (&current, info);
+		} else {
+			current.inode = 0;
+		}
+
+		if (is_root) {
+			if (current.inode != entry->inode) {
+				g_list_free_full (changed, g_object_unref);
+				g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+				             "Index root was replaced");
+				return NULL;
+			}
+
+			/* Directories added from now on must be in the same place */
+			snapshot->device = 0;
+			note_device (snapshot, info);
+		} else if (current.inode == 0) {
+			g_hash_table_iter_remove (&iter);
+		} else if (current.inode != entry->inode ||
+		           current.mtime != entry->mtime ||
+		           current.ctime != entry->ctime ||
+		           entry_is_racy (snapshot, entry)) {
+			changed = g_list_prepend (changed, g_steal_pointer (&file));
+		}
+	}
+
+	return g_list_sort (changed, compare_paths);
+}
+
+guint
+tracker_crawl_snapshot_get_n_directories (TrackerCrawlSnapshot *snapshot)
+{
+	return g_hash_table_size (snapshot->entries);
+}
+
+/**
+ * tracker_crawl_snapshot_get_directories:
+ * @snapshot: a #TrackerCrawlSnapshot
+ *
+ * Returns all recorded directories, including the index root.
+ * After tracker_crawl_snapshot_check(), these are the directories
+ * still present on disk.
+ *
+ * Returns: (transfer full) (element-type GFile): the directories,
+ *   sorted by path.
+ **/
+GList *
+tracker_crawl_snapshot_get_directories (TrackerCrawlSnapshot *snapshot)
+{
+	GHashTableIter iter;
+	const gchar *path;
+	GList *directories = NULL;
+
+	g_hash_table_iter_init (&iter, snapshot->entries);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &path, NULL)) {
+		GFile *file;
+
+		file = path[0] == '\0' ? g_object_ref (snapshot->root) :
+			g_file_resolve_relative_path (snapshot->root, path);
+		directories = g_list_prepend (directories, file);
+	}
+
+	return g_list_sort (directories, compare_paths);
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_CRAWL_SNAPSHOT_H__
+#define __TRACKER_CRAWL_SNAPSHOT_H__
+
+#include <gio/gio.h>
+
+/* File attributes needed to record and check directories */
+#define TRACKER_CRAWL_SNAPSHOT_ATTRIBUTES \
+	G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+	G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+	G_FILE_ATTRIBUTE_TIME_CHANGED "," \
+	G_FILE_ATTRIBUTE_UNIX_INODE "," \
+	G_FILE_ATTRIBUTE_UNIX_DEVICE
+
+/* Records the modification time, change time and inode of every
+ * directory in an index root as of the last complete crawl. Any
+ * directory whose entries changed since then will have a different
+ * mtime or ctime, so only those need to be enumerated again. On
+ * btrfs, the subvolume generation tells whether anything changed
+ * at all, so not even those need to be looked at.
+ */
+typedef struct _TrackerCrawlSnapshot TrackerCrawlSnapshot;
+
+TrackerCrawlSnapshot * tracker_crawl_snapshot_new  (GFile        *root,
+                                                    const gchar  *checksum);
+TrackerCrawlSnapshot * tracker_crawl_snapshot_load (GFile        *root,
+                                                    const gchar  *checksum,
+                                                    GBytes       *bytes,
+                                                    GError      **error);
+void                   tracker_crawl_snapshot_free (TrackerCrawlSnapshot *snapshot);
+
+GBytes * tracker_crawl_snapshot_serialize (TrackerCrawlSnapshot *snapshot);
+
+void tracker_crawl_snapshot_set_timestamp (TrackerCrawlSnapshot *snapshot,
+                                           gint64                timestamp);
+void tracker_crawl_snapshot_stamp_volume  (TrackerCrawlSnapshot *snapshot);
+
+void tracker_crawl_snapshot_add_directory    (TrackerCrawlSnapshot *snapshot,
+                                              GFile                *directory,
+                                              GFileInfo            *info);
+void tracker_crawl_snapshot_remove_directory (TrackerCrawlSnapshot *snapshot,
+                                              GFile                *directory);
+
+GList * tracker_crawl_snapshot_check (TrackerCrawlSnapshot  *snapshot,
+                                      GCancellable          *cancellable,
+                                      GError               **error);
+
+guint   tracker_crawl_snapshot_get_n_directories (TrackerCrawlSnapshot *snapshot);
+GList * tracker_crawl_snapshot_get_directories   (TrackerCrawlSnapshot *snapshot);
+
+#endif /* __TRACKER_CRAWL_SNAPSHOT_H__ */
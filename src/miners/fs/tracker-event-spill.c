@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config-miners.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+
+#include "tracker-event-spill.h"
+
+typedef struct {
+	guint8 type;
+	guint8 flags;
+	guint16 reserved;
+	/* URI lengths, 0 if there is no file */
+	guint32 uri_len;
+	guint32 other_uri_len;
+} SpillRecord;
+
+struct _TrackerEventSpill {
+	gchar *directory;
+	FILE *file;
+	/* Records are appended at the write offset and
+	 * consumed from the read offset.
+	 */
+	off_t read_offset;
+	off_t write_offset;
+	guint length;
+};
+
+static void
+set_error_from_errno (GError      **error,
+                      const gchar  *message)
+{
+	int saved_errno = errno;
+
+	g_set_error (error, G_IO_ERROR,
+	             g_io_error_from_errno (saved_errno),
+	             "%s: %s", message, g_strerror (saved_errno));
+}
+
+/**
+ * tracker_event_spill_new:
+ * @directory: (nullable): directory to keep the backing file in, or
+ *   %NULL for the temporary directory
+ *
+ * Creates an empty event spill. The backing file is only created
+ * once events are pushed.
+ *
+ * Returns: (transfer full): a #TrackerEventSpill
+ **/
+TrackerEventSpill *
+tracker_event_spill_new (GFile *directory)
+{
+	TrackerEventSpill *spill;
+
+	g_return_val_if_fail (!directory || G_IS_FILE (directory), NULL);
+
+	spill = g_new0 (TrackerEventSpill, 1);
+
+	if (directory)
+		spill->directory = g_file_get_path (directory);
+	else
+		spill->directory = g_strdup (g_get_tmp_dir ());
+
+	return spill;
+}
+
+void
+tracker_event_spill_free (TrackerEventSpill *spill)
+{
+	g_return_if_fail (spill != NULL);
+
+	if (spill->file)
+		fclose (spill->file);
+
+	g_free (spill->directory);
+	g_free (spill);
+}
+
+static gint
+spill_open_unlinked (TrackerEventSpill  *spill,
+                     GError            **error)
+{
+	g_autofree gchar *path = NULL;
+	gint fd;
+
+	if (g_mkdir_with_parents (spill->directory, 0700) < 0) {
+		set_error_from_errno (error, "Could not create event spill directory");
+		return -1;
+	}
+
+#ifdef O_TMPFILE
+	fd = g_open (spill->directory, O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+	if (fd >= 0)
+		return fd;
+
+	/* Not every filesystem supports it */
+#endif
+
+	path = g_build_filename (spill->directory, "localsearch-events-XXXXXX", NULL);
+	fd = g_mkstemp_full (path, O_RDWR | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		set_error_from_errno (error, "Could not create event spill file");
+		return -1;
+	}
+
+	/* Nobody else needs to find it, and it goes away with us */
+	g_unlink (path);
+
+	return fd;
+}
+
+static gboolean
+spill_ensure_file (TrackerEventSpill  *spill,
+                   GError            **error)
+{
+	gint fd;
+
+	if (spill->file)
+		return TRUE;
+
+	fd = spill_open_unlinked (spill, error);
+	if (fd < 0)
+		return FALSE;
+
+	spill->file = fdopen (fd, "w+b");
+	if (!spill->file) {
+		set_error_from_errno (error, "Could not open event spill file");
+		close (fd);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* Gives the disk space back once everything was read */
+static void
+spill_reset (TrackerEventSpill *spill)
+{
+	spill->read_offset = spill->write_offset = 0;
+	spill->length = 0;
+
+	if (spill->file) {
+		fflush (spill->file);
+		if (ftruncate (fileno (spill->file), 0) < 0)
+			g_debug ("Could not truncate event spill file: %s", g_strerror (errno));
+	}
+}
+
+/**
+ * tracker_event_spill_push:
+ * @spill: a #TrackerEventSpill
+ * @type: caller defined event type, up to 255
+ * @flags: caller defined event flags, up to 255
+ * @file: the file the event is about
+ * @other_file: (nullable): the other file of the event, e.g. the
+ *   destination of a move
+ * @error: return location for errors
+ *
+ * Appends an event to @spill.
+ *
+ * Returns: %TRUE if the event was stored
+ **/
+gboolean
+tracker_event_spill_push (TrackerEventSpill  *spill,
+                          guint               type,
+                          guint               flags,
+                          GFile              *file,
+                          GFile              *other_file,
+                          GError            **error)
+{
+	g_autofree gchar *uri = NULL, *other_uri = NULL;
+	SpillRecord record = { 0, };
+
+	g_return_val_if_fail (spill != NULL, FALSE);
+	g_return_val_if_fail (type <= G_MAXUINT8 && flags <= G_MAXUINT8, FALSE);
+	g_return_val_if_fail (G_IS_FILE (file), FALSE);
+	g_return_val_if_fail (!other_file || G_IS_FILE (other_file), FALSE);
+
+	if (!spill_ensure_file (spill, error))
+		return FALSE;
+
+	uri = g_file_get_uri (file);
+	if (other_file)
+		other_uri = g_file_get_uri (other_file);
+
+	record.type = type;
+	record.flags = flags;
+	record.uri_len = strlen (uri);
+	record.other_uri_len = other_uri ? strlen (other_uri) : 0;
+
+	if (fseeko (spill->file, spill->write_offset, SEEK_SET) < 0 ||
+	    fwrite (&record, sizeof (record), 1, spill->file) != 1 ||
+	    fwrite (uri, 1, record.uri_len, spill->file) != record.uri_len ||
+	    (other_uri &&
+	     fwrite (other_uri, 1, record.other_uri_len, spill->file) != record.other_uri_len)) {
+		set_error_from_errno (error, "Could not write event spill file");
+		return FALSE;
+	}
+
+	spill->write_offset = ftello (spill->file);
+	spill->length++;
+
+	return TRUE;
+}
+
+static gchar *
+read_uri (FILE  *file,
+          gsize  len)
+{
+	g_autofree gchar *uri = NULL;
+
+	uri = g_malloc (len + 1);
+
+	if (fread (uri, 1, len, file) != len)
+		return NULL;
+
+	uri[len] = '\0';
+
+	return g_steal_pointer (&uri);
+}
+
+/**
+ * tracker_event_spill_pop:
+ * @spill: a #TrackerEventSpill
+ * @type: (out): return location for the event type
+ * @flags: (out): return location for the event flags
+ * @file: (out) (transfer full): return location for the file
+ * @other_file: (out) (transfer full) (nullable): return location for
+ *   the other file
+ * @error: return location for errors
+ *
+ * Takes the oldest event out of @spill. If the event could not be
+ * read back, the events left in @spill are lost and @error is set.
+ *
+ * Returns: %TRUE if an event was returned, %FALSE if @spill is
+ *   empty or on error
+ **/
+gboolean
+tracker_event_spill_pop (TrackerEventSpill  *spill,
+                         guint              *type,
+                         guint              *flags,
+                         GFile             **file,
+                         GFile             **other_file,
+                         GError            **error)
+{
+	g_autofree gchar *uri = NULL, *other_uri = NULL;
+	SpillRecord record;
+
+	g_return_val_if_fail (spill != NULL, FALSE);
+
+	if (spill->length == 0)
+		return FALSE;
+
+	if (fseeko (spill->file, spill->read_offset, SEEK_SET) < 0 ||
+	    fread (&record, sizeof (record), 1, spill->file) != 1 ||
+	    !(uri = read_uri (spill->file, record.uri_len)) ||
+	    (record.other_uri_len > 0 &&
+	     !(other_uri = read_uri (spill->file, record.other_uri_len)))) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+		             "Could not read event spill file, %u events lost",
+		             spill->length);
+		spill_reset (spill);
+		return FALSE;
+	}
+
+	spill->read_offset = ftello (spill->file);
+
+	if (--spill->length == 0)
+		spill_reset (spill);
+
+	*type = record.type;
+	*flags = record.flags;
+	*file = g_file_new_for_uri (uri);
+	*other_file = other_uri ? g_file_new_for_uri (other_uri) : NULL;
+
+	return TRUE;
+}
+
+guint
+tracker_event_spill_get_length (TrackerEventSpill *spill)
+{
+	g_return_val_if_fail (spill != NULL, 0);
+
+	return spill->length;
+}
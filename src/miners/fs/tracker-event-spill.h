@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_EVENT_SPILL_H__
+#define __TRACKER_EVENT_SPILL_H__
+
+#include <gio/gio.h>
+
+/* A FIFO of file events kept in an unlinked file, so events can
+ * be held back without holding on to memory.
+ */
+typedef struct _TrackerEventSpill TrackerEventSpill;
+
+TrackerEventSpill * tracker_event_spill_new  (GFile             *directory);
+void                tracker_event_spill_free (TrackerEventSpill *spill);
+
+gboolean tracker_event_spill_push (TrackerEventSpill  *spill,
+                                   guint               type,
+                                   guint               flags,
+                                   GFile              *file,
+                                   GFile              *other_file,
+                                   GError            **error);
+gboolean tracker_event_spill_pop  (TrackerEventSpill  *spill,
+                                   guint              *type,
+                                   guint              *flags,
+                                   GFile             **file,
+                                   GFile             **other_file,
+                                   GError            **error);
+
+guint tracker_event_spill_get_length (TrackerEventSpill *spill);
+
+#endif /* __TRACKER_EVENT_SPILL_H__ */
@@ -24,8 +24,12 @@
 #include <libtracker-miners-common/tracker-common.h>
 #include <libtracker-extract/tracker-extract.h>
 
+#include "tracker-crawl-snapshot.h"
+#include "tracker-event-spill.h"
 #include "tracker-file-notifier.h"
+#include "tracker-memory-estimates.h"
 #include "tracker-monitor-glib.h"
+#include "tracker-slab.h"
 #include "tracker-utils.h"
 
 #include <tinysparql.h>
@@ -59,17 +63,20 @@ enum {
 };
 
 typedef struct {
-	GList *node;
+	/* Embedded link in the root queue */
+	GList link;
 	GFile *file;
 	guint in_disk : 1;
 	guint in_store : 1;
 	guint is_dir_in_disk : 1;
 	guint is_dir_in_store : 1;
 	guint state : 3;
-	GDateTime *store_mtime;
-	GDateTime *disk_mtime;
-	gchar *extractor_hash;
-	gchar *mimetype;
+	/* Modification times, in microseconds since the epoch */
+	gint64 store_mtime;
+	gint64 disk_mtime;
+	/* Interned strings */
+	const gchar *extractor_hash;
+	const gchar *mimetype;
 } TrackerFileData;
 
 typedef struct {
@@ -83,7 +90,16 @@ typedef struct {
 	GQueue deleted_dirs;
 	GFile *current_dir;
 	GQueue *pending_dirs;
+	/* Snapshot recorded along the crawl, and directories whose
+	 * store contents are pending to be queried when resuming
+	 * from a previous snapshot.
+	 */
+	TrackerCrawlSnapshot *snapshot;
+	GQueue changed_dirs;
+	GFile *query_dir;
 	GTimer *timer;
+	gdouble query_elapsed;
+	gint64 crawl_started;
 	guint flags;
 	guint cursor_idle_id;
 	guint directories_found;
@@ -92,6 +108,8 @@ typedef struct {
 	guint files_ignored;
 	guint ignore_root : 1;
 	guint cursor_has_content : 1;
+	guint from_snapshot : 1;
+	guint waiting_snapshots : 1;
 } TrackerIndexRoot;
 
 typedef struct {
@@ -103,6 +121,7 @@ typedef struct {
 	TrackerMonitor *monitor;
 
 	TrackerSparqlStatement *content_query;
+	TrackerSparqlStatement *directory_query;
 	TrackerSparqlStatement *deleted_query;
 
 	gchar *file_attributes;
@@ -113,17 +132,66 @@ typedef struct {
 	GList *pending_index_roots;
 	TrackerIndexRoot *current_index_root;
 
+	/* File data of the roots being processed, all of it is
+	 * released in bulk as roots finish.
+	 */
+	TrackerSlab *file_data_slab;
+
+	/* Accumulated over all finished roots */
+	gdouble query_time;
+	gdouble crawl_time;
+
+	/* Crawl snapshots of finished index roots, and snapshot
+	 * files read ahead before being invalidated on disk. Files
+	 * in the snapshot directory are accessed from threads with
+	 * the lock held.
+	 */
+	GFile *snapshot_dir;
+	gchar *snapshot_checksum;
+	GHashTable *snapshots;
+	GHashTable *snapshot_data;
+	GMutex snapshot_lock;
+	guint snapshot_saves;
+	guint n_snapshot_invalidations;
+
+	/* Monitor events held back while over the memory budget */
+	GFile *spill_dir;
+	TrackerEventSpill *spill;
+	guint spill_replay_id;
+	/* Indexing roots with events in the spill */
+	GHashTable *spilled_roots;
+
 	guint stopped : 1;
 	guint high_water : 1;
+	guint over_budget : 1;
+	guint replaying_spill : 1;
 	guint active : 1;
+	guint monitors_suspended : 1;
+	guint snapshots_on_disk : 1;
+	guint snapshots_dirty : 1;
 } TrackerFileNotifierPrivate;
 
 #define N_CURSOR_BATCH_ITEMS 200
 #define N_ENUMERATOR_BATCH_ITEMS 200
+#define N_SPILL_REPLAY_BATCH_ITEMS 200
+
+typedef enum {
+	MONITOR_EVENT_CREATED,
+	MONITOR_EVENT_UPDATED,
+	MONITOR_EVENT_ATTRIBUTE_UPDATED,
+	MONITOR_EVENT_DELETED,
+	MONITOR_EVENT_MOVED,
+} MonitorEventType;
+
+enum {
+	MONITOR_EVENT_FLAG_IS_DIRECTORY = 1 << 0,
+	MONITOR_EVENT_FLAG_IS_SOURCE_MONITORED = 1 << 1,
+};
 
 static gboolean tracker_index_root_query_contents (TrackerIndexRoot *root);
 static gboolean tracker_index_root_crawl_next (TrackerIndexRoot *root);
 static gboolean tracker_index_root_continue_cursor (TrackerIndexRoot *root);
+static gboolean tracker_index_root_query_next_directory (TrackerIndexRoot *root);
 static void tracker_index_root_continue (TrackerIndexRoot *root);
 
 static TrackerSparqlStatement * sparql_contents_ensure_statement (TrackerFileNotifier  *notifier,
@@ -184,14 +252,11 @@ tracker_file_notifier_get_property (GObject    *object,
 }
 
 static void
-file_data_free (TrackerFileData *file_data)
+file_data_free (TrackerFileData *file_data,
+                TrackerSlab     *slab)
 {
 	g_object_unref (file_data->file);
-	g_clear_pointer (&file_data->store_mtime, g_date_time_unref);
-	g_clear_pointer (&file_data->disk_mtime, g_date_time_unref);
-	g_free (file_data->extractor_hash);
-	g_free (file_data->mimetype);
-	g_slice_free (TrackerFileData, file_data);
+	tracker_slab_release (slab, file_data);
 }
 
 static TrackerIndexRoot *
@@ -211,11 +276,10 @@ tracker_index_root_new (TrackerFileNotifier *notifier,
 	data->timer = g_timer_new ();
 
 	g_queue_init (&data->deleted_dirs);
+	g_queue_init (&data->changed_dirs);
 	g_queue_init (&data->queue);
-	data->cache = g_hash_table_new_full (g_file_hash,
-	                                     (GEqualFunc) g_file_equal,
-	                                     NULL,
-	                                     (GDestroyNotify) file_data_free);
+	data->cache = g_hash_table_new (g_file_hash,
+	                                (GEqualFunc) g_file_equal);
 
 	return data;
 }
@@ -223,10 +287,23 @@ tracker_index_root_new (TrackerFileNotifier *notifier,
 static void
 tracker_index_root_free (TrackerIndexRoot *data)
 {
+	TrackerFileNotifierPrivate *priv;
+	TrackerFileData *file_data;
+
+	priv = tracker_file_notifier_get_instance_private (data->notifier);
+
 	g_queue_free_full (data->pending_dirs, (GDestroyNotify) g_object_unref);
 	g_timer_destroy (data->timer);
-	g_queue_clear (&data->queue);
 	g_queue_clear_full (&data->deleted_dirs, g_object_unref);
+	g_queue_clear_full (&data->changed_dirs, g_object_unref);
+	g_clear_pointer (&data->snapshot, tracker_crawl_snapshot_free);
+	g_clear_object (&data->query_dir);
+
+	while ((file_data = g_queue_peek_head (&data->queue)) != NULL) {
+		g_queue_unlink (&data->queue, &file_data->link);
+		file_data_free (file_data, priv->file_data_slab);
+	}
+
 	g_hash_table_destroy (data->cache);
 	g_clear_object (&data->enumerator);
 	g_clear_object (&data->current_dir);
@@ -362,14 +439,27 @@ notifier_check_next_root (TrackerFileNotifier *notifier)
 	return FALSE;
 }
 
+static void
+tracker_index_root_remove_file_data (TrackerIndexRoot *root,
+                                     TrackerFileData  *file_data)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	priv = tracker_file_notifier_get_instance_private (root->notifier);
+
+	g_queue_unlink (&root->queue, &file_data->link);
+	g_hash_table_remove (root->cache, file_data->file);
+	file_data_free (file_data, priv->file_data_slab);
+}
+
 static void
 tracker_index_root_notify_changes (TrackerIndexRoot *root)
 {
 	TrackerFileData *data;
 
-	while ((data = g_queue_pop_tail (&root->queue)) != NULL) {
+	while ((data = g_queue_peek_tail (&root->queue)) != NULL) {
 		tracker_file_notifier_notify (root->notifier, data, NULL);
-		g_hash_table_remove (root->cache, data->file);
+		tracker_index_root_remove_file_data (root, data);
 	}
 }
 
@@ -380,7 +470,7 @@ update_state (TrackerFileData *data)
 
 	if (data->in_disk) {
 		if (data->in_store) {
-			if (!g_date_time_equal (data->store_mtime, data->disk_mtime)) {
+			if (data->store_mtime != data->disk_mtime) {
 				data->state = FILE_STATE_UPDATE;
 			} else if (data->mimetype) {
 				const gchar *current_hash;
@@ -401,20 +491,31 @@ update_state (TrackerFileData *data)
 	}
 }
 
+static gint64
+datetime_to_usec (GDateTime *datetime)
+{
+	if (!datetime)
+		return 0;
+
+	return (g_date_time_to_unix (datetime) * G_USEC_PER_SEC +
+	        g_date_time_get_microsecond (datetime));
+}
+
 static TrackerFileData *
 ensure_file_data (TrackerIndexRoot *root,
                   GFile            *file)
 {
+	TrackerFileNotifierPrivate *priv;
 	TrackerFileData *file_data;
 
 	file_data = g_hash_table_lookup (root->cache, file);
 	if (!file_data) {
-		file_data = g_slice_new0 (TrackerFileData);
+		priv = tracker_file_notifier_get_instance_private (root->notifier);
+		file_data = tracker_slab_alloc (priv->file_data_slab);
 		file_data->file = g_object_ref (file);
 		g_hash_table_insert (root->cache, file_data->file, file_data);
-		file_data->node = g_list_alloc ();
-		file_data->node->data = file_data;
-		g_queue_push_head_link (&root->queue, file_data->node);
+		file_data->link.data = file_data;
+		g_queue_push_head_link (&root->queue, &file_data->link);
 	}
 
 	return file_data;
@@ -431,8 +532,7 @@ _insert_disk_info (TrackerIndexRoot *root,
 	file_data = ensure_file_data (root, file);
 	file_data->in_disk = TRUE;
 	file_data->is_dir_in_disk = file_type == G_FILE_TYPE_DIRECTORY;
-	g_clear_pointer (&file_data->disk_mtime, g_date_time_unref);
-	file_data->disk_mtime = g_date_time_ref (datetime);
+	file_data->disk_mtime = datetime_to_usec (datetime);
 	update_state (file_data);
 
 	return file_data;
@@ -451,14 +551,31 @@ _insert_store_info (TrackerIndexRoot *root,
 	file_data = ensure_file_data (root, file);
 	file_data->in_store = TRUE;
 	file_data->is_dir_in_store = file_type == G_FILE_TYPE_DIRECTORY;
-	file_data->extractor_hash = g_strdup (extractor_hash);
-	file_data->mimetype = g_strdup (mimetype);
-	file_data->store_mtime = g_date_time_ref (datetime);
+	file_data->extractor_hash = g_intern_string (extractor_hash);
+	file_data->mimetype = g_intern_string (mimetype);
+	file_data->store_mtime = datetime_to_usec (datetime);
 	update_state (file_data);
 
 	return file_data;
 }
 
+static void
+tracker_index_root_track_directory (TrackerIndexRoot *root,
+                                    GFile            *directory,
+                                    GFileInfo        *info)
+{
+	if (root->snapshot && info)
+		tracker_crawl_snapshot_add_directory (root->snapshot, directory, info);
+}
+
+static void
+tracker_index_root_untrack_directory (TrackerIndexRoot *root,
+                                      GFile            *directory)
+{
+	if (root->snapshot)
+		tracker_crawl_snapshot_remove_directory (root->snapshot, directory);
+}
+
 static gboolean
 check_high_water (TrackerFileNotifier *notifier)
 {
@@ -466,7 +583,7 @@ check_high_water (TrackerFileNotifier *notifier)
 
 	priv = tracker_file_notifier_get_instance_private (notifier);
 
-	if (priv->high_water) {
+	if (priv->high_water || priv->over_budget) {
 		priv->active = FALSE;
 		return TRUE;
 	}
@@ -498,11 +615,11 @@ handle_file_from_filesystem (TrackerIndexRoot *root,
 	    !g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_UNIX_IS_MOUNTPOINT)) {
 		/* Queue child dirs for later processing */
 		g_queue_push_tail (root->pending_dirs, g_object_ref (file));
+		tracker_index_root_track_directory (root, file, info);
 	}
 
 	tracker_file_notifier_notify (root->notifier, file_data, info);
-	g_queue_delete_link (&root->queue, file_data->node);
-	g_hash_table_remove (root->cache, file);
+	tracker_index_root_remove_file_data (root, file_data);
 }
 
 static void
@@ -528,7 +645,9 @@ enumerator_next_files_cb (GObject      *object,
 		g_warning ("Got error crawling '%s': %s\n",
 		           uri, error->message);
 
-		tracker_index_root_continue (user_data);
+		root = user_data;
+		g_clear_pointer (&root->snapshot, tracker_crawl_snapshot_free);
+		tracker_index_root_continue (root);
 		return;
 	} else if (!infos) {
 		/* Directory contents were fully obtained */
@@ -603,6 +722,9 @@ enumerate_children_cb (GObject      *object,
 			uri = g_file_get_uri (G_FILE (object));
 			g_warning ("Got error crawling '%s': %s\n",
 			           uri, error->message);
+
+			root = user_data;
+			g_clear_pointer (&root->snapshot, tracker_crawl_snapshot_free);
 		}
 
 		tracker_index_root_continue (user_data);
@@ -655,6 +777,7 @@ query_root_info_cb (GObject      *object,
 	priv = tracker_file_notifier_get_instance_private (notifier);
 
 	handle_file_from_filesystem (root, G_FILE (object), info);
+	tracker_index_root_track_directory (root, G_FILE (object), info);
 
 	g_file_enumerate_children_async (G_FILE (object),
 	                                 priv->file_attributes,
@@ -718,6 +841,15 @@ static void
 tracker_file_notifier_emit_directory_finished (TrackerFileNotifier *notifier,
                                                TrackerIndexRoot    *root)
 {
+	TrackerFileNotifierPrivate *priv;
+	gdouble elapsed;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+	elapsed = g_timer_elapsed (root->timer, NULL);
+	priv->query_time += root->query_elapsed;
+	priv->crawl_time += MAX (elapsed - root->query_elapsed, 0);
+	root->query_elapsed = 0;
+
 	g_signal_emit (notifier, signals[DIRECTORY_FINISHED], 0,
 	               root->root,
 	               root->directories_found,
@@ -738,16 +870,40 @@ tracker_file_notifier_emit_directory_finished (TrackerFileNotifier *notifier,
 	                         root->files_ignored));
 }
 
+static void
+tracker_index_root_finish_snapshot (TrackerIndexRoot *root)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	priv = tracker_file_notifier_get_instance_private (root->notifier);
+
+	if (!root->snapshot)
+		return;
+
+	TRACKER_NOTE (STATISTICS,
+	              g_message ("  Recorded %d directories in crawl snapshot",
+	                         tracker_crawl_snapshot_get_n_directories (root->snapshot)));
+
+	g_hash_table_replace (priv->snapshots,
+	                      g_object_ref (root->root),
+	                      g_steal_pointer (&root->snapshot));
+	priv->snapshots_dirty = TRUE;
+}
+
 static void
 tracker_index_root_continue (TrackerIndexRoot *root)
 {
 	if (tracker_index_root_continue_cursor (root))
 		return;
 
+	if (tracker_index_root_query_next_directory (root))
+		return;
+
 	if (tracker_index_root_crawl_next (root))
 		return;
 
 	tracker_index_root_notify_changes (root);
+	tracker_index_root_finish_snapshot (root);
 	tracker_file_notifier_emit_directory_finished (root->notifier, root);
 	notifier_check_next_root (root->notifier);
 }
@@ -801,6 +957,22 @@ sparql_contents_ensure_statement (TrackerFileNotifier  *notifier,
 	return priv->content_query;
 }
 
+static TrackerSparqlStatement *
+sparql_directory_ensure_statement (TrackerFileNotifier  *notifier,
+                                   GError              **error)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	if (priv->directory_query)
+		return priv->directory_query;
+
+	priv->directory_query =
+		tracker_load_statement (priv->connection, "get-directory-content.rq", error);
+	return priv->directory_query;
+}
+
 static TrackerSparqlStatement *
 sparql_deleted_ensure_statement (TrackerFileNotifier  *notifier,
                                  GError              **error)
@@ -844,6 +1016,25 @@ file_is_equal_or_descendant (gconstpointer a,
 	return (g_file_equal (file, deleted_file) || g_file_has_prefix (file, deleted_file)) ? 0 : -1;
 }
 
+static void
+tracker_index_root_discard_snapshot (TrackerIndexRoot *root)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	if (!root->from_snapshot)
+		return;
+
+	priv = tracker_file_notifier_get_instance_private (root->notifier);
+
+	/* The store does not know about the root, start over */
+	g_queue_clear_full (&root->changed_dirs, g_object_unref);
+	tracker_crawl_snapshot_free (root->snapshot);
+	root->snapshot = tracker_crawl_snapshot_new (root->root,
+	                                             priv->snapshot_checksum);
+	tracker_crawl_snapshot_set_timestamp (root->snapshot, root->crawl_started);
+	root->from_snapshot = FALSE;
+}
+
 static void
 handle_file_from_cursor (TrackerIndexRoot    *root,
                          TrackerSparqlCursor *cursor)
@@ -901,6 +1092,7 @@ handle_file_from_cursor (TrackerIndexRoot    *root,
 	    (file_data->is_dir_in_store || file_data->is_dir_in_disk)) {
 		/* Cache deleted dir, in order to skip children */
 		g_queue_push_head (&root->deleted_dirs, g_object_ref (file));
+		tracker_index_root_untrack_directory (root, file);
 	} else if (file_data->is_dir_in_disk &&
 	           ((!!(root->flags & TRACKER_DIRECTORY_FLAG_RECURSE) &&
 	             !g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_UNIX_IS_MOUNTPOINT)) ||
@@ -917,6 +1109,11 @@ handle_file_from_cursor (TrackerIndexRoot    *root,
 			/* Updated directory, needs crawling */
 			g_queue_push_head (root->pending_dirs, g_object_ref (file));
 		}
+
+		tracker_index_root_track_directory (root, file, info);
+	} else if (file_data->is_dir_in_disk) {
+		/* Directory contents are not indexed */
+		tracker_index_root_untrack_directory (root, file);
 	}
 
 	parent = g_file_get_parent (file);
@@ -930,8 +1127,7 @@ handle_file_from_cursor (TrackerIndexRoot    *root,
 	    !g_queue_find_custom (root->pending_dirs, parent,
 	                          file_is_equal_or_child)) {
 		tracker_file_notifier_notify (notifier, file_data, info);
-		g_queue_delete_link (&root->queue, file_data->node);
-		g_hash_table_remove (root->cache, file);
+		tracker_index_root_remove_file_data (root, file_data);
 	}
 }
 
@@ -963,12 +1159,18 @@ handle_cursor (TrackerIndexRoot *root)
 			uri = g_file_get_uri (root->root);
 			g_critical ("Error iterating cursor for indexed folder '%s': %s",
 			            uri, error->message);
-		} else if (!root->cursor_has_content) {
+			g_clear_pointer (&root->snapshot, tracker_crawl_snapshot_free);
+		} else if (!root->cursor_has_content &&
+		           (!root->query_dir || g_file_equal (root->query_dir, root->root))) {
 			/* Indexing from scratch, crawl root dir */
-			g_queue_push_tail (root->pending_dirs, g_object_ref (root->root));
+			tracker_index_root_discard_snapshot (root);
+
+			if (!g_queue_find_custom (root->pending_dirs, root->root, file_is_equal))
+				g_queue_push_tail (root->pending_dirs, g_object_ref (root->root));
 		}
 
 		g_clear_object (&root->cursor);
+		root->query_elapsed = g_timer_elapsed (root->timer, NULL);
 	}
 
 	stop = finished || check_high_water (root->notifier);
@@ -1016,6 +1218,8 @@ query_execute_cb (TrackerSparqlStatement *statement,
 			g_critical ("Could not query contents for indexed folder '%s': %s",
 			            uri, error->message);
 
+			root->query_elapsed = g_timer_elapsed (root->timer, NULL);
+
 			tracker_file_notifier_emit_directory_finished (root->notifier,
 			                                               root);
 		}
@@ -1027,6 +1231,326 @@ query_execute_cb (TrackerSparqlStatement *statement,
 	tracker_index_root_continue_cursor (root);
 }
 
+static void
+tracker_index_root_query_store (TrackerIndexRoot       *root,
+                                TrackerSparqlStatement *statement,
+                                const gchar            *binding,
+                                GFile                  *directory)
+{
+	TrackerFileNotifierPrivate *priv;
+	g_autofree gchar *uri = NULL;
+
+	priv = tracker_file_notifier_get_instance_private (root->notifier);
+
+	uri = g_file_get_uri (directory);
+	tracker_sparql_statement_bind_string (statement, binding, uri);
+
+	priv->active = TRUE;
+
+	tracker_sparql_statement_execute_async (statement,
+	                                        root->cancellable,
+	                                        (GAsyncReadyCallback) query_execute_cb,
+	                                        root);
+}
+
+static gboolean
+tracker_index_root_query_next_directory (TrackerIndexRoot *root)
+{
+	TrackerSparqlStatement *statement;
+	g_autoptr (GFile) directory = NULL;
+	g_autoptr (GError) error = NULL;
+
+	if (g_queue_is_empty (&root->changed_dirs))
+		return FALSE;
+
+	statement = sparql_directory_ensure_statement (root->notifier, &error);
+	if (!statement) {
+		g_critical ("Could not load directory content query: %s",
+		            error->message);
+		return FALSE;
+	}
+
+	directory = g_queue_pop_head (&root->changed_dirs);
+	g_set_object (&root->query_dir, directory);
+	root->cursor_has_content = FALSE;
+
+	/* The directory changed, its contents need crawling. Files
+	 * within are held until then, so store and disk info are
+	 * compared together.
+	 */
+	if (!g_queue_find_custom (root->pending_dirs, directory, file_is_equal))
+		g_queue_push_tail (root->pending_dirs, g_object_ref (directory));
+
+	tracker_index_root_query_store (root, statement, "folder", directory);
+
+	return TRUE;
+}
+
+typedef struct {
+	GFile *root;
+	/* Snapshot file to load, if there is no data read ahead */
+	GFile *file;
+	GBytes *bytes;
+	gchar *checksum;
+	TrackerCrawlSnapshot *snapshot;
+	GList *changed;
+	guint on_fixed_storage : 1;
+} SnapshotCheck;
+
+static void
+snapshot_check_free (SnapshotCheck *check)
+{
+	g_object_unref (check->root);
+	g_clear_object (&check->file);
+	g_clear_pointer (&check->bytes, g_bytes_unref);
+	g_free (check->checksum);
+	g_clear_pointer (&check->snapshot, tracker_crawl_snapshot_free);
+	g_list_free_full (check->changed, g_object_unref);
+	g_free (check);
+}
+
+static gboolean
+file_is_on_fixed_storage (GFile        *file,
+                          GCancellable *cancellable)
+{
+	g_autoptr (GFileInfo) info = NULL;
+	g_autoptr (GMount) mount = NULL;
+
+	info = g_file_query_filesystem_info (file,
+	                                     G_FILE_ATTRIBUTE_FILESYSTEM_REMOTE,
+	                                     cancellable, NULL);
+	if (!info ||
+	    g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_FILESYSTEM_REMOTE))
+		return FALSE;
+
+	/* Only user visible mounts are found, as removable devices are */
+	mount = g_file_find_enclosing_mount (file, cancellable, NULL);
+
+	return mount == NULL;
+}
+
+static void
+snapshot_check_thread (GTask        *task,
+                       gpointer      source_object,
+                       gpointer      task_data,
+                       GCancellable *cancellable)
+{
+	TrackerFileNotifierPrivate *priv;
+	SnapshotCheck *check = task_data;
+	GError *error = NULL;
+	gchar *contents;
+	gsize len;
+
+	priv = tracker_file_notifier_get_instance_private (source_object);
+
+	/* Files in removable and remote filesystems may be edited
+	 * elsewhere while the miner is not running, those keep being
+	 * checked one by one.
+	 */
+	if (!file_is_on_fixed_storage (check->root, cancellable)) {
+		g_task_return_boolean (task, FALSE);
+		return;
+	}
+
+	check->on_fixed_storage = TRUE;
+
+	if (!check->bytes && check->file) {
+		g_mutex_lock (&priv->snapshot_lock);
+
+		if (g_file_load_contents (check->file, cancellable,
+		                          &contents, &len, NULL, NULL))
+			check->bytes = g_bytes_new_take (contents, len);
+
+		g_mutex_unlock (&priv->snapshot_lock);
+	}
+
+	if (check->bytes) {
+		check->snapshot = tracker_crawl_snapshot_load (check->root,
+		                                               check->checksum,
+		                                               check->bytes,
+		                                               &error);
+		if (check->snapshot) {
+			check->changed = tracker_crawl_snapshot_check (check->snapshot,
+			                                               cancellable,
+			                                               &error);
+			if (!error) {
+				g_task_return_boolean (task, TRUE);
+				return;
+			}
+		}
+
+		g_clear_pointer (&check->snapshot, tracker_crawl_snapshot_free);
+	}
+
+	/* The root is crawled from scratch, recording a new snapshot */
+	check->snapshot = tracker_crawl_snapshot_new (check->root, check->checksum);
+	tracker_crawl_snapshot_stamp_volume (check->snapshot);
+
+	if (error)
+		g_task_return_error (task, error);
+	else
+		g_task_return_boolean (task, FALSE);
+}
+
+static void
+snapshot_check_cb (GObject      *object,
+                   GAsyncResult *res,
+                   gpointer      user_data)
+{
+	TrackerIndexRoot *root;
+	TrackerFileNotifierPrivate *priv;
+	SnapshotCheck *check;
+	g_autoptr (GError) error = NULL;
+	GList *directories, *l;
+
+	if (!g_task_propagate_boolean (G_TASK (res), &error)) {
+		/* Caller already commanded the way to continue */
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			return;
+
+		root = user_data;
+		priv = tracker_file_notifier_get_instance_private (root->notifier);
+		check = g_task_get_task_data (G_TASK (res));
+
+		if (error) {
+			g_autofree gchar *uri = NULL;
+
+			uri = g_file_get_uri (root->root);
+			g_info ("Crawl snapshot for '%s' is not usable: %s",
+			        uri, error->message);
+		}
+
+		if (check->on_fixed_storage) {
+			g_clear_pointer (&root->snapshot, tracker_crawl_snapshot_free);
+			root->snapshot = g_steal_pointer (&check->snapshot);
+			tracker_crawl_snapshot_set_timestamp (root->snapshot, root->crawl_started);
+		}
+
+		tracker_index_root_query_store (root, priv->content_query,
+		                                "root", root->root);
+		return;
+	}
+
+	root = user_data;
+	priv = tracker_file_notifier_get_instance_private (root->notifier);
+	check = g_task_get_task_data (G_TASK (res));
+
+	root->snapshot = g_steal_pointer (&check->snapshot);
+	tracker_crawl_snapshot_set_timestamp (root->snapshot, root->crawl_started);
+	root->from_snapshot = TRUE;
+
+	/* Unchanged directories are not crawled, so monitors would not
+	 * be added to them otherwise.
+	 */
+	directories = tracker_crawl_snapshot_get_directories (root->snapshot);
+
+	for (l = directories; l; l = l->next) {
+		TrackerDirectoryFlags flags;
+
+		tracker_indexing_tree_get_root (priv->indexing_tree,
+		                                l->data, &flags);
+
+		if ((flags & TRACKER_DIRECTORY_FLAG_MONITOR) != 0)
+			tracker_monitor_add (priv->monitor, l->data);
+	}
+
+	g_list_free_full (directories, g_object_unref);
+
+	TRACKER_NOTE (STATISTICS,
+	              g_message ("  Crawl snapshot has %d changed directories out of %d",
+	                         g_list_length (check->changed),
+	                         tracker_crawl_snapshot_get_n_directories (root->snapshot)));
+
+	/* The root goes first, it tells whether the store is in sync
+	 * with the snapshot at all.
+	 */
+	g_queue_push_tail (&root->changed_dirs, g_object_ref (root->root));
+
+	for (l = check->changed; l; l = l->next)
+		g_queue_push_tail (&root->changed_dirs, g_steal_pointer (&l->data));
+	g_clear_pointer (&check->changed, g_list_free);
+
+	tracker_index_root_continue (root);
+}
+
+static GFile *
+get_snapshot_file (TrackerFileNotifier *notifier,
+                   GFile               *root)
+{
+	TrackerFileNotifierPrivate *priv;
+	g_autofree gchar *uri = NULL, *checksum = NULL, *basename = NULL;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	uri = g_file_get_uri (root);
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+	basename = g_strconcat (checksum, ".snapshot", NULL);
+
+	return g_file_get_child (priv->snapshot_dir, basename);
+}
+
+static void
+tracker_index_root_check_snapshot (TrackerIndexRoot *root)
+{
+	TrackerFileNotifierPrivate *priv;
+	g_autoptr (GTask) task = NULL;
+	SnapshotCheck *check;
+
+	priv = tracker_file_notifier_get_instance_private (root->notifier);
+	priv->active = TRUE;
+
+	/* Snapshot files are being read ahead before their removal,
+	 * wait for those to be available.
+	 */
+	if (priv->n_snapshot_invalidations > 0) {
+		root->waiting_snapshots = TRUE;
+		return;
+	}
+
+	check = g_new0 (SnapshotCheck, 1);
+	check->root = g_object_ref (root->root);
+	check->checksum = g_strdup (priv->snapshot_checksum);
+
+	/* Snapshots only describe the state after the previous run,
+	 * roots crawled again in this one are checked thoroughly.
+	 */
+	if (!g_hash_table_contains (priv->snapshots, root->root)) {
+		g_autoptr (GFile) file = NULL;
+		g_autofree gchar *basename = NULL, *key = NULL;
+
+		file = get_snapshot_file (root->notifier, root->root);
+		basename = g_file_get_basename (file);
+
+		if (!g_hash_table_steal_extended (priv->snapshot_data, basename,
+		                                  (gpointer *) &key,
+		                                  (gpointer *) &check->bytes) &&
+		    priv->snapshots_on_disk)
+			check->file = g_steal_pointer (&file);
+	}
+
+	task = g_task_new (root->notifier, root->cancellable,
+	                   snapshot_check_cb, root);
+	g_task_set_task_data (task, check, (GDestroyNotify) snapshot_check_free);
+	g_task_run_in_thread (task, snapshot_check_thread);
+}
+
+static gboolean
+tracker_index_root_can_snapshot (TrackerIndexRoot *root)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	priv = tracker_file_notifier_get_instance_private (root->notifier);
+
+	/* Without monitors, changes to file contents after the crawl
+	 * would go unnoticed by the next one. The filesystem of the
+	 * root is checked along with the snapshot.
+	 */
+	return (priv->snapshot_dir &&
+	        !root->ignore_root &&
+	        (root->flags & TRACKER_DIRECTORY_FLAG_MONITOR) != 0 &&
+	        tracker_indexing_tree_file_is_root (priv->indexing_tree, root->root));
+}
+
 static gboolean
 tracker_index_root_query_contents (TrackerIndexRoot *root)
 {
@@ -1034,7 +1558,6 @@ tracker_index_root_query_contents (TrackerIndexRoot *root)
 	TrackerFileNotifierPrivate *priv;
 	TrackerDirectoryFlags flags;
 	GFile *directory;
-	g_autofree gchar *uri = NULL;
 
 	priv = tracker_file_notifier_get_instance_private (notifier);
 
@@ -1054,17 +1577,16 @@ tracker_index_root_query_contents (TrackerIndexRoot *root)
 	}
 
 	g_timer_reset (root->timer);
+	root->crawl_started = g_get_real_time () / G_USEC_PER_SEC;
 	g_signal_emit (notifier, signals[DIRECTORY_STARTED], 0, directory);
 
-	uri = g_file_get_uri (directory);
-	tracker_sparql_statement_bind_string (priv->content_query, "root", uri);
-
-	priv->active = TRUE;
+	if (tracker_index_root_can_snapshot (root)) {
+		tracker_index_root_check_snapshot (root);
+		return TRUE;
+	}
 
-	tracker_sparql_statement_execute_async (priv->content_query,
-	                                        root->cancellable,
-	                                        (GAsyncReadyCallback) query_execute_cb,
-	                                        root);
+	tracker_index_root_query_store (root, priv->content_query,
+	                                "root", directory);
 	return TRUE;
 }
 
@@ -1109,23 +1631,306 @@ create_shallow_file_info (GFile    *file,
 	return file_info;
 }
 
-/* Monitor signal handlers */
+typedef struct {
+	GFile *snapshot_dir;
+	/* Snapshot file names not to read ahead */
+	GHashTable *skip;
+	/* Snapshot file name -> contents */
+	GHashTable *data;
+	guint snapshot_saves;
+} SnapshotInvalidation;
+
 static void
-monitor_item_created_cb (TrackerMonitor *monitor,
-                         GFile          *file,
-                         gboolean        is_directory,
-                         gpointer        user_data)
+snapshot_invalidation_free (SnapshotInvalidation *invalidation)
+{
+	g_object_unref (invalidation->snapshot_dir);
+	g_hash_table_unref (invalidation->skip);
+	g_hash_table_unref (invalidation->data);
+	g_free (invalidation);
+}
+
+static void
+invalidate_snapshots_thread (GTask        *task,
+                             gpointer      source_object,
+                             gpointer      task_data,
+                             GCancellable *cancellable)
 {
-	TrackerFileNotifier *notifier = user_data;
 	TrackerFileNotifierPrivate *priv;
-	gboolean indexable;
+	SnapshotInvalidation *invalidation = task_data;
+	g_autoptr (GFileEnumerator) enumerator = NULL;
+	GFileInfo *info;
+	GFile *child;
 
-	priv = tracker_file_notifier_get_instance_private (notifier);
+	priv = tracker_file_notifier_get_instance_private (source_object);
 
-	indexable = tracker_indexing_tree_file_is_indexable (priv->indexing_tree,
-	                                                     file, NULL);
+	g_mutex_lock (&priv->snapshot_lock);
 
-	if (!is_directory) {
+	/* Snapshots saved in the meantime are newer than the changes
+	 * that invalidated the ones on disk.
+	 */
+	if (priv->snapshot_saves == invalidation->snapshot_saves) {
+		enumerator = g_file_enumerate_children (invalidation->snapshot_dir,
+		                                        G_FILE_ATTRIBUTE_STANDARD_NAME,
+		                                        G_FILE_QUERY_INFO_NONE,
+		                                        NULL, NULL);
+	}
+
+	while (enumerator &&
+	       g_file_enumerator_iterate (enumerator, &info, &child, NULL, NULL) &&
+	       info) {
+		const gchar *name = g_file_info_get_name (info);
+		gchar *contents;
+		gsize len;
+
+		if (!g_str_has_suffix (name, ".snapshot"))
+			continue;
+
+		if (!g_hash_table_contains (invalidation->skip, name) &&
+		    g_file_load_contents (child, NULL, &contents, &len, NULL, NULL)) {
+			g_hash_table_insert (invalidation->data,
+			                     g_strdup (name),
+			                     g_bytes_new_take (contents, len));
+		}
+
+		g_file_delete (child, NULL, NULL);
+	}
+
+	g_mutex_unlock (&priv->snapshot_lock);
+
+	g_task_return_boolean (task, TRUE);
+}
+
+static void
+invalidate_snapshots_cb (GObject      *object,
+                         GAsyncResult *res,
+                         gpointer      user_data)
+{
+	TrackerFileNotifier *notifier = TRACKER_FILE_NOTIFIER (object);
+	TrackerFileNotifierPrivate *priv;
+	SnapshotInvalidation *invalidation;
+	TrackerIndexRoot *root;
+	GHashTableIter iter;
+	gchar *name;
+	GBytes *bytes;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+	invalidation = g_task_get_task_data (G_TASK (res));
+
+	g_hash_table_iter_init (&iter, invalidation->data);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &name, (gpointer *) &bytes)) {
+		if (g_hash_table_contains (priv->snapshot_data, name))
+			continue;
+
+		g_hash_table_iter_steal (&iter);
+		g_hash_table_insert (priv->snapshot_data, name, bytes);
+	}
+
+	priv->n_snapshot_invalidations--;
+	root = priv->current_index_root;
+
+	if (priv->n_snapshot_invalidations == 0 &&
+	    root && root->waiting_snapshots) {
+		root->waiting_snapshots = FALSE;
+		tracker_index_root_check_snapshot (root);
+	}
+}
+
+static void
+tracker_file_notifier_invalidate_snapshots (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv;
+	g_autoptr (GTask) task = NULL;
+	SnapshotInvalidation *invalidation;
+	GHashTableIter iter;
+	GFile *child;
+	gchar *name;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	if (!priv->snapshots_on_disk)
+		return;
+
+	/* File contents may change without their directory noticing,
+	 * snapshots must not outlive a crash before such changes are
+	 * processed. Roots yet to be crawled keep theirs in memory.
+	 */
+	priv->snapshots_on_disk = FALSE;
+
+	invalidation = g_new0 (SnapshotInvalidation, 1);
+	invalidation->snapshot_dir = g_object_ref (priv->snapshot_dir);
+	invalidation->skip = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	invalidation->data = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                            (GDestroyNotify) g_bytes_unref);
+	invalidation->snapshot_saves = priv->snapshot_saves;
+
+	g_hash_table_iter_init (&iter, priv->snapshots);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &child, NULL)) {
+		g_autoptr (GFile) file = NULL;
+
+		file = get_snapshot_file (notifier, child);
+		g_hash_table_add (invalidation->skip, g_file_get_basename (file));
+	}
+
+	g_hash_table_iter_init (&iter, priv->snapshot_data);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &name, NULL))
+		g_hash_table_add (invalidation->skip, g_strdup (name));
+
+	/* The root being crawled already took its snapshot, if any */
+	if (priv->current_index_root &&
+	    !priv->current_index_root->waiting_snapshots) {
+		g_autoptr (GFile) file = NULL;
+
+		file = get_snapshot_file (notifier, priv->current_index_root->root);
+		g_hash_table_add (invalidation->skip, g_file_get_basename (file));
+	}
+
+	priv->n_snapshot_invalidations++;
+
+	task = g_task_new (notifier, NULL, invalidate_snapshots_cb, NULL);
+	g_task_set_task_data (task, invalidation,
+	                      (GDestroyNotify) snapshot_invalidation_free);
+	g_task_run_in_thread (task, invalidate_snapshots_thread);
+}
+
+static void
+tracker_file_notifier_forget_snapshot (TrackerFileNotifier *notifier,
+                                       GFile               *root)
+{
+	TrackerFileNotifierPrivate *priv;
+	g_autoptr (GFile) file = NULL;
+	g_autofree gchar *basename = NULL;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	if (!priv->snapshot_dir)
+		return;
+
+	file = get_snapshot_file (notifier, root);
+	basename = g_file_get_basename (file);
+
+	g_hash_table_remove (priv->snapshots, root);
+	g_hash_table_remove (priv->snapshot_data, basename);
+
+	g_mutex_lock (&priv->snapshot_lock);
+	g_file_delete (file, NULL, NULL);
+	g_mutex_unlock (&priv->snapshot_lock);
+}
+
+static void
+spill_note_root (TrackerFileNotifier *notifier,
+                 GFile               *file)
+{
+	TrackerFileNotifierPrivate *priv;
+	GFile *root;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+	root = tracker_indexing_tree_get_root (priv->indexing_tree, file, NULL);
+
+	if (root && !g_hash_table_contains (priv->spilled_roots, root))
+		g_hash_table_add (priv->spilled_roots, g_object_ref (root));
+}
+
+/* Crawls again the roots that lost spilled events. Their snapshots
+ * would let the crawl skip the directories the events were about.
+ */
+static void
+spill_recrawl_roots (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv;
+	GHashTableIter iter;
+	GFile *root;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+	g_hash_table_iter_init (&iter, priv->spilled_roots);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &root, NULL)) {
+		TrackerDirectoryFlags flags;
+
+		/* Removed from the indexing tree meanwhile */
+		if (!tracker_indexing_tree_get_root (priv->indexing_tree, root, &flags) ||
+		    (flags & TRACKER_DIRECTORY_FLAG_IGNORE) != 0)
+			continue;
+
+		TRACKER_NOTE (MINER_FS_EVENTS,
+		              g_message ("Spilled events lost, crawling '%s' again",
+		                         g_file_peek_path (root)));
+		tracker_file_notifier_forget_snapshot (notifier, root);
+		notifier_queue_root (notifier, root, flags, FALSE);
+	}
+
+	g_hash_table_remove_all (priv->spilled_roots);
+}
+
+static gboolean
+spill_monitor_event (TrackerFileNotifier *notifier,
+                     MonitorEventType     type,
+                     GFile               *file,
+                     GFile               *other_file,
+                     gboolean             is_directory,
+                     gboolean             is_source_monitored)
+{
+	TrackerFileNotifierPrivate *priv;
+	GError *error = NULL;
+	guint flags = 0;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	if (priv->replaying_spill)
+		return FALSE;
+
+	/* Once spilling, everything goes through the spill to keep order */
+	if (!priv->over_budget &&
+	    (!priv->spill || tracker_event_spill_get_length (priv->spill) == 0))
+		return FALSE;
+
+	if (!priv->spill)
+		priv->spill = tracker_event_spill_new (priv->spill_dir);
+
+	if (is_directory)
+		flags |= MONITOR_EVENT_FLAG_IS_DIRECTORY;
+	if (is_source_monitored)
+		flags |= MONITOR_EVENT_FLAG_IS_SOURCE_MONITORED;
+
+	if (!tracker_event_spill_push (priv->spill, type, flags,
+	                               file, other_file, &error)) {
+		/* Better over budget than losing the event */
+		g_warning ("Could not spill monitor event: %s", error->message);
+		g_error_free (error);
+		return FALSE;
+	}
+
+	spill_note_root (notifier, file);
+	if (other_file)
+		spill_note_root (notifier, other_file);
+
+	return TRUE;
+}
+
+/* Monitor signal handlers */
+static void
+monitor_item_created_cb (TrackerMonitor *monitor,
+                         GFile          *file,
+                         gboolean        is_directory,
+                         gpointer        user_data)
+{
+	TrackerFileNotifier *notifier = user_data;
+	TrackerFileNotifierPrivate *priv;
+	gboolean indexable;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+	tracker_file_notifier_invalidate_snapshots (notifier);
+
+	if (spill_monitor_event (notifier, MONITOR_EVENT_CREATED, file, NULL,
+	                         is_directory, FALSE))
+		return;
+
+	indexable = tracker_indexing_tree_file_is_indexable (priv->indexing_tree,
+	                                                     file, NULL);
+
+	if (!is_directory) {
 		gboolean parent_indexable;
 		GFile *parent;
 
@@ -1186,6 +1991,11 @@ monitor_item_updated_cb (TrackerMonitor *monitor,
 	TrackerFileNotifierPrivate *priv;
 
 	priv = tracker_file_notifier_get_instance_private (notifier);
+	tracker_file_notifier_invalidate_snapshots (notifier);
+
+	if (spill_monitor_event (notifier, MONITOR_EVENT_UPDATED, file, NULL,
+	                         is_directory, FALSE))
+		return;
 
 	if (!tracker_indexing_tree_file_is_indexable (priv->indexing_tree,
 	                                              file, NULL)) {
@@ -1206,6 +2016,11 @@ monitor_item_attribute_updated_cb (TrackerMonitor *monitor,
 	TrackerFileNotifierPrivate *priv;
 
 	priv = tracker_file_notifier_get_instance_private (notifier);
+	tracker_file_notifier_invalidate_snapshots (notifier);
+
+	if (spill_monitor_event (notifier, MONITOR_EVENT_ATTRIBUTE_UPDATED, file, NULL,
+	                         is_directory, FALSE))
+		return;
 
 	if (!tracker_indexing_tree_file_is_indexable (priv->indexing_tree,
 	                                              file, NULL)) {
@@ -1226,6 +2041,11 @@ monitor_item_deleted_cb (TrackerMonitor *monitor,
 	TrackerFileNotifierPrivate *priv;
 
 	priv = tracker_file_notifier_get_instance_private (notifier);
+	tracker_file_notifier_invalidate_snapshots (notifier);
+
+	if (spill_monitor_event (notifier, MONITOR_EVENT_DELETED, file, NULL,
+	                         is_directory, FALSE))
+		return;
 
 	/* Remove monitors if any */
 	if (is_directory &&
@@ -1316,6 +2136,12 @@ monitor_item_moved_cb (TrackerMonitor *monitor,
 
 	notifier = user_data;
 	priv = tracker_file_notifier_get_instance_private (notifier);
+	tracker_file_notifier_invalidate_snapshots (notifier);
+
+	if (spill_monitor_event (notifier, MONITOR_EVENT_MOVED, file, other_file,
+	                         is_directory, is_source_monitored))
+		return;
+
 	tracker_indexing_tree_get_root (priv->indexing_tree, other_file, &flags);
 
 	if (!is_source_monitored) {
@@ -1426,6 +2252,70 @@ monitor_item_moved_cb (TrackerMonitor *monitor,
 	}
 }
 
+static gboolean
+replay_spilled_events_cb (gpointer user_data)
+{
+	TrackerFileNotifier *notifier = user_data;
+	TrackerFileNotifierPrivate *priv;
+	GError *error = NULL;
+	guint i;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	for (i = 0; i < N_SPILL_REPLAY_BATCH_ITEMS && !priv->over_budget; i++) {
+		g_autoptr (GFile) file = NULL, other_file = NULL;
+		guint type, flags;
+		gboolean is_directory;
+
+		if (!tracker_event_spill_pop (priv->spill, &type, &flags,
+		                              &file, &other_file, &error))
+			break;
+
+		is_directory = (flags & MONITOR_EVENT_FLAG_IS_DIRECTORY) != 0;
+		priv->replaying_spill = TRUE;
+
+		switch (type) {
+		case MONITOR_EVENT_CREATED:
+			monitor_item_created_cb (priv->monitor, file, is_directory, notifier);
+			break;
+		case MONITOR_EVENT_UPDATED:
+			monitor_item_updated_cb (priv->monitor, file, is_directory, notifier);
+			break;
+		case MONITOR_EVENT_ATTRIBUTE_UPDATED:
+			monitor_item_attribute_updated_cb (priv->monitor, file, is_directory, notifier);
+			break;
+		case MONITOR_EVENT_DELETED:
+			monitor_item_deleted_cb (priv->monitor, file, is_directory, notifier);
+			break;
+		case MONITOR_EVENT_MOVED:
+			monitor_item_moved_cb (priv->monitor, file, other_file, is_directory,
+			                       (flags & MONITOR_EVENT_FLAG_IS_SOURCE_MONITORED) != 0,
+			                       notifier);
+			break;
+		default:
+			g_assert_not_reached ();
+		}
+
+		priv->replaying_spill = FALSE;
+	}
+
+	if (error) {
+		g_warning ("%s", error->message);
+		g_error_free (error);
+		spill_recrawl_roots (notifier);
+	} else if (tracker_event_spill_get_length (priv->spill) == 0) {
+		g_hash_table_remove_all (priv->spilled_roots);
+	}
+
+	if (priv->over_budget ||
+	    tracker_event_spill_get_length (priv->spill) == 0) {
+		priv->spill_replay_id = 0;
+		return G_SOURCE_REMOVE;
+	}
+
+	return G_SOURCE_CONTINUE;
+}
+
 /* Indexing tree signal handlers */
 static void
 indexing_tree_directory_added (TrackerIndexingTree *indexing_tree,
@@ -1498,6 +2388,8 @@ indexing_tree_directory_removed (TrackerIndexingTree *indexing_tree,
 		g_signal_emit (notifier, signals[FILE_DELETED], 0, directory, TRUE);
 	}
 
+	tracker_file_notifier_forget_snapshot (notifier, directory);
+
 	elem = g_list_find_custom (priv->pending_index_roots, directory,
 	                           (GCompareFunc) index_root_equals_file);
 
@@ -1576,6 +2468,7 @@ tracker_file_notifier_finalize (GObject *object)
 	}
 
 	g_clear_object (&priv->content_query);
+	g_clear_object (&priv->directory_query);
 	g_clear_object (&priv->deleted_query);
 
 	tracker_monitor_set_enabled (priv->monitor, FALSE);
@@ -1589,6 +2482,19 @@ tracker_file_notifier_finalize (GObject *object)
 	g_list_foreach (priv->pending_index_roots, (GFunc) tracker_index_root_free, NULL);
 	g_list_free (priv->pending_index_roots);
 
+	tracker_slab_free (priv->file_data_slab);
+
+	g_clear_handle_id (&priv->spill_replay_id, g_source_remove);
+	g_clear_pointer (&priv->spill, tracker_event_spill_free);
+	g_clear_object (&priv->spill_dir);
+	g_hash_table_unref (priv->spilled_roots);
+
+	g_hash_table_unref (priv->snapshots);
+	g_hash_table_unref (priv->snapshot_data);
+	g_clear_object (&priv->snapshot_dir);
+	g_mutex_clear (&priv->snapshot_lock);
+	g_free (priv->snapshot_checksum);
+
 	G_OBJECT_CLASS (tracker_file_notifier_parent_class)->finalize (object);
 }
 
@@ -1626,6 +2532,7 @@ check_disable_monitor (TrackerFileNotifier *notifier)
 		g_info ("Temporarily disabling monitors until crawling is "
 		        "completed. Too many folders to monitor anyway");
 		tracker_monitor_set_enabled (priv->monitor, FALSE);
+		priv->monitors_suspended = TRUE;
 	}
 }
 
@@ -1789,6 +2696,18 @@ tracker_file_notifier_init (TrackerFileNotifier *notifier)
 
 	priv = tracker_file_notifier_get_instance_private (notifier);
 	priv->stopped = TRUE;
+	priv->file_data_slab = tracker_slab_new (sizeof (TrackerFileData));
+	priv->snapshots = g_hash_table_new_full (g_file_hash,
+	                                         (GEqualFunc) g_file_equal,
+	                                         g_object_unref,
+	                                         (GDestroyNotify) tracker_crawl_snapshot_free);
+	priv->snapshot_data = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                             g_free,
+	                                             (GDestroyNotify) g_bytes_unref);
+	g_mutex_init (&priv->snapshot_lock);
+	priv->spilled_roots = g_hash_table_new_full (g_file_hash,
+	                                             (GEqualFunc) g_file_equal,
+	                                             g_object_unref, NULL);
 
 	/* Set up monitor */
 	priv->monitor = tracker_monitor_new (&error);
@@ -1842,6 +2761,20 @@ tracker_file_notifier_continue (TrackerFileNotifier *notifier)
 		notifier_check_next_root (notifier);
 }
 
+static void
+notifier_check_resume (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	if (!priv->high_water && !priv->over_budget && !priv->active &&
+	    tracker_file_notifier_is_active (notifier)) {
+		/* Maybe kick everything back into action */
+		tracker_file_notifier_continue (notifier);
+	}
+}
+
 void
 tracker_file_notifier_set_high_water (TrackerFileNotifier *notifier,
                                       gboolean             high_water)
@@ -1855,12 +2788,64 @@ tracker_file_notifier_set_high_water (TrackerFileNotifier *notifier,
 		return;
 
 	priv->high_water = high_water;
+	notifier_check_resume (notifier);
+}
 
-	if (!high_water && !priv->active &&
-	    tracker_file_notifier_is_active (notifier)) {
-		/* Maybe kick everything back into action */
-		tracker_file_notifier_continue (notifier);
+/**
+ * tracker_file_notifier_set_over_budget:
+ * @notifier: a #TrackerFileNotifier
+ * @over_budget: whether the memory budget is exhausted
+ *
+ * While over budget, crawling is paused and monitor events are
+ * spilled to a file. They are replayed in order once the budget
+ * allows again.
+ **/
+void
+tracker_file_notifier_set_over_budget (TrackerFileNotifier *notifier,
+                                       gboolean             over_budget)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	g_return_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier));
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+	if (priv->over_budget == over_budget)
+		return;
+
+	priv->over_budget = over_budget;
+
+	if (!over_budget && priv->spill &&
+	    tracker_event_spill_get_length (priv->spill) > 0 &&
+	    priv->spill_replay_id == 0) {
+		TRACKER_NOTE (MINER_FS_EVENTS,
+		              g_message ("Replaying %u spilled monitor events",
+		                         tracker_event_spill_get_length (priv->spill)));
+		priv->spill_replay_id = g_idle_add (replay_spilled_events_cb, notifier);
 	}
+
+	notifier_check_resume (notifier);
+}
+
+/**
+ * tracker_file_notifier_set_spill_directory:
+ * @notifier: a #TrackerFileNotifier
+ * @directory: (nullable): directory to spill monitor events to
+ *
+ * Sets where monitor events are spilled to while over budget, the
+ * temporary directory is used if %NULL. This only applies to
+ * spills started afterwards.
+ **/
+void
+tracker_file_notifier_set_spill_directory (TrackerFileNotifier *notifier,
+                                           GFile               *directory)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	g_return_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier));
+	g_return_if_fail (!directory || G_IS_FILE (directory));
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+	g_set_object (&priv->spill_dir, directory);
 }
 
 gboolean
@@ -1921,3 +2906,188 @@ tracker_file_notifier_is_active (TrackerFileNotifier *notifier)
 	priv = tracker_file_notifier_get_instance_private (notifier);
 	return priv->pending_index_roots || priv->current_index_root;
 }
+
+void
+tracker_file_notifier_get_timings (TrackerFileNotifier *notifier,
+                                   gdouble             *query_time,
+                                   gdouble             *crawl_time)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	g_return_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier));
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	if (query_time)
+		*query_time = priv->query_time;
+	if (crawl_time)
+		*crawl_time = priv->crawl_time;
+}
+
+/**
+ * tracker_file_notifier_get_memory_usage:
+ * @notifier: a #TrackerFileNotifier
+ *
+ * Returns an estimate of the memory held by the crawl, the file data
+ * of the index root being crawled, its pending directories and the
+ * crawl snapshots.
+ *
+ * Returns: the size in bytes
+ **/
+gsize
+tracker_file_notifier_get_memory_usage (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv;
+	TrackerIndexRoot *root;
+	GHashTableIter iter;
+	gpointer value;
+	gsize usage;
+
+	g_return_val_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier), 0);
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	usage = tracker_slab_get_size (priv->file_data_slab) +
+		tracker_slab_get_n_in_use (priv->file_data_slab) * ESTIMATED_FILE_SIZE;
+
+	root = priv->current_index_root;
+
+	if (root) {
+		usage += g_hash_table_size (root->cache) * ESTIMATED_HASH_SLOT_SIZE;
+		usage += (g_queue_get_length (root->pending_dirs) +
+		          g_queue_get_length (&root->changed_dirs) +
+		          g_queue_get_length (&root->deleted_dirs)) * ESTIMATED_FILE_SIZE;
+
+		if (root->snapshot) {
+			usage += tracker_crawl_snapshot_get_n_directories (root->snapshot) *
+				ESTIMATED_SNAPSHOT_ENTRY_SIZE;
+		}
+	}
+
+	g_hash_table_iter_init (&iter, priv->snapshots);
+
+	while (g_hash_table_iter_next (&iter, NULL, &value)) {
+		usage += tracker_crawl_snapshot_get_n_directories (value) *
+			ESTIMATED_SNAPSHOT_ENTRY_SIZE;
+	}
+
+	return usage;
+}
+
+GVariant *
+tracker_file_notifier_get_allocator_stats (TrackerFileNotifier *notifier)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	g_return_val_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier), NULL);
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	return tracker_slab_get_stats (priv->file_data_slab);
+}
+
+/**
+ * tracker_file_notifier_set_crawl_snapshots:
+ * @notifier: a #TrackerFileNotifier
+ * @directory: (nullable): directory to keep crawl snapshots in
+ * @checksum: (nullable): checksum of the indexing configuration
+ *
+ * Enables crawl snapshots. Index roots are then crawled from the
+ * snapshot left behind by the previous run if there is a usable
+ * one, so only directories that changed since are enumerated.
+ * Snapshots recorded with a different @checksum are discarded.
+ **/
+void
+tracker_file_notifier_set_crawl_snapshots (TrackerFileNotifier *notifier,
+                                           GFile               *directory,
+                                           const gchar         *checksum)
+{
+	TrackerFileNotifierPrivate *priv;
+
+	g_return_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier));
+	g_return_if_fail (!directory || G_IS_FILE (directory));
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	g_set_object (&priv->snapshot_dir, directory);
+	g_free (priv->snapshot_checksum);
+	priv->snapshot_checksum = g_strdup (checksum);
+	priv->snapshots_on_disk = directory != NULL;
+}
+
+/**
+ * tracker_file_notifier_save_crawl_snapshots:
+ * @notifier: a #TrackerFileNotifier
+ * @shutdown: whether the process is shutting down
+ *
+ * Stores the snapshots of crawled index roots. This must only be
+ * called once all notified changes were processed. Snapshots are
+ * removed from disk again as soon as monitors report changes, on
+ * @shutdown they are written back if those were processed too.
+ **/
+void
+tracker_file_notifier_save_crawl_snapshots (TrackerFileNotifier *notifier,
+                                            gboolean             shutdown)
+{
+	TrackerFileNotifierPrivate *priv;
+	g_autoptr (GError) error = NULL;
+	TrackerCrawlSnapshot *snapshot;
+	GHashTableIter iter;
+	GFile *root;
+
+	g_return_if_fail (TRACKER_IS_FILE_NOTIFIER (notifier));
+
+	priv = tracker_file_notifier_get_instance_private (notifier);
+
+	if (!priv->snapshot_dir)
+		return;
+	if (!priv->snapshots_dirty && (priv->snapshots_on_disk || !shutdown))
+		return;
+
+	if (!priv->monitor ||
+	    priv->monitors_suspended ||
+	    !tracker_monitor_get_enabled (priv->monitor) ||
+	    tracker_monitor_get_ignored (priv->monitor) > 0) {
+		/* Changes in unmonitored directories may have been missed */
+		tracker_file_notifier_invalidate_snapshots (notifier);
+		return;
+	}
+
+	g_mutex_lock (&priv->snapshot_lock);
+
+	if (!g_file_make_directory_with_parents (priv->snapshot_dir, NULL, &error) &&
+	    !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_EXISTS)) {
+		g_warning ("Could not create crawl snapshot directory: %s",
+		           error->message);
+		g_mutex_unlock (&priv->snapshot_lock);
+		return;
+	}
+
+	g_clear_error (&error);
+	g_hash_table_iter_init (&iter, priv->snapshots);
+
+	while (g_hash_table_iter_next (&iter, (gpointer *) &root, (gpointer *) &snapshot)) {
+		g_autoptr (GFile) file = NULL;
+		g_autoptr (GBytes) bytes = NULL;
+
+		file = get_snapshot_file (notifier, root);
+		bytes = tracker_crawl_snapshot_serialize (snapshot);
+
+		if (!g_file_replace_contents (file,
+		                              g_bytes_get_data (bytes, NULL),
+		                              g_bytes_get_size (bytes),
+		                              NULL, FALSE,
+		                              G_FILE_CREATE_PRIVATE,
+		                              NULL, NULL, &error)) {
+			g_warning ("Could not save crawl snapshot: %s",
+			           error->message);
+			g_clear_error (&error);
+		}
+	}
+
+	priv->snapshot_saves++;
+	g_mutex_unlock (&priv->snapshot_lock);
+
+	priv->snapshots_on_disk = TRUE;
+	priv->snapshots_dirty = FALSE;
+}
@@ -87,8 +87,25 @@ gboolean      tracker_file_notifier_start        (TrackerFileNotifier     *notif
 void          tracker_file_notifier_stop         (TrackerFileNotifier     *notifier);
 gboolean      tracker_file_notifier_is_active    (TrackerFileNotifier     *notifier);
 
-void          tracker_file_notifier_set_high_water (TrackerFileNotifier *notifier,
-                                                    gboolean             high_water);
+void          tracker_file_notifier_set_high_water  (TrackerFileNotifier *notifier,
+                                                     gboolean             high_water);
+void          tracker_file_notifier_set_over_budget (TrackerFileNotifier *notifier,
+                                                     gboolean             over_budget);
+void          tracker_file_notifier_set_spill_directory (TrackerFileNotifier *notifier,
+                                                         GFile               *directory);
+
+void          tracker_file_notifier_get_timings  (TrackerFileNotifier     *notifier,
+                                                  gdouble                 *query_time,
+                                                  gdouble                 *crawl_time);
+
+gsize         tracker_file_notifier_get_memory_usage    (TrackerFileNotifier *notifier);
+GVariant *    tracker_file_notifier_get_allocator_stats (TrackerFileNotifier *notifier);
+
+void          tracker_file_notifier_set_crawl_snapshots  (TrackerFileNotifier *notifier,
+                                                          GFile               *directory,
+                                                          const gchar         *checksum);
+void          tracker_file_notifier_save_crawl_snapshots (TrackerFileNotifier *notifier,
+                                                          gboolean             shutdown);
 
 G_END_DECLS
 
@@ -34,6 +34,9 @@ struct _TrackerFilesInterface
 	GDBusConnection *connection;
 	GSettings *settings;
 	GVariant *priority_graphs;
+	TrackerStatistics *statistics;
+	TrackerQueryCache *query_cache;
+	TrackerMinerFS *miner;
 #ifdef HAVE_POWER
 	TrackerPower *power;
 #endif
@@ -57,6 +60,15 @@ static const gchar *introspection_xml =
 	"    <method name='GetPersistenceStorage'>"
 	"      <arg type='h' direction='out' />"
 	"    </method>"
+	"    <method name='GetStatistics'>"
+	"      <arg type='a{sv}' direction='out' />"
+	"    </method>"
+	"    <method name='Query'>"
+	"      <arg type='s' name='sparql' direction='in' />"
+	"      <arg type='a{sv}' name='parameters' direction='in' />"
+	"      <arg type='as' name='variables' direction='out' />"
+	"      <arg type='aams' name='rows' direction='out' />"
+	"    </method>"
 	"  </interface>"
 	"</node>";
 
@@ -68,6 +80,68 @@ tracker_files_interface_init (TrackerFilesInterface *files_interface)
 	files_interface->fd = -1;
 }
 
+static void
+statistics_update_cb (GObject      *object,
+                      GAsyncResult *res,
+                      gpointer      user_data)
+{
+	GDBusMethodInvocation *invocation = user_data;
+	TrackerFilesInterface *files_interface;
+	g_autoptr (GVariant) statistics = NULL;
+	GVariantBuilder builder;
+	GVariantIter iter;
+	const gchar *key;
+	GVariant *value;
+	GError *error = NULL;
+
+	if (!tracker_statistics_update_finish (TRACKER_STATISTICS (object), res, &error)) {
+		g_dbus_method_invocation_take_error (invocation, error);
+		return;
+	}
+
+	files_interface = g_dbus_method_invocation_get_user_data (invocation);
+	statistics = g_variant_ref_sink (tracker_statistics_to_variant (TRACKER_STATISTICS (object)));
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+	g_variant_iter_init (&iter, statistics);
+	while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+		g_variant_builder_add (&builder, "{sv}", key, value);
+		g_variant_unref (value);
+	}
+
+	if (files_interface->query_cache) {
+		g_variant_builder_add (&builder, "{sv}", "query-cache",
+		                       tracker_query_cache_to_variant (files_interface->query_cache));
+	}
+
+	if (files_interface->miner) {
+		g_variant_builder_add (&builder, "{sv}", "devices",
+		                       tracker_miner_fs_get_device_stats (files_interface->miner));
+	}
+
+	g_dbus_method_invocation_return_value (invocation,
+	                                       g_variant_new ("(a{sv})", &builder));
+}
+
+static void
+query_cb (GObject      *object,
+          GAsyncResult *res,
+          gpointer      user_data)
+{
+	GDBusMethodInvocation *invocation = user_data;
+	GVariant *result;
+	GError *error = NULL;
+
+	result = tracker_query_cache_query_finish (TRACKER_QUERY_CACHE (object), res, &error);
+	if (!result) {
+		g_dbus_method_invocation_take_error (invocation, error);
+		return;
+	}
+
+	g_dbus_method_invocation_return_value (invocation, result);
+	g_variant_unref (result);
+}
+
 static void
 handle_method_call (GDBusConnection       *connection,
                     const gchar           *sender,
@@ -105,6 +179,38 @@ handle_method_call (GDBusConnection       *connection,
 			                                                         out_parameters,
 			                                                         fd_list);
 		}
+	} else if (g_strcmp0 (method_name, "GetStatistics") == 0) {
+		if (!files_interface->statistics) {
+			g_dbus_method_invocation_return_error (invocation,
+			                                       G_IO_ERROR,
+			                                       G_IO_ERROR_NOT_SUPPORTED,
+			                                       "Statistics are not available");
+			return;
+		}
+
+		tracker_statistics_update_async (files_interface->statistics,
+		                                 NULL,
+		                                 statistics_update_cb,
+		                                 invocation);
+	} else if (g_strcmp0 (method_name, "Query") == 0) {
+		g_autoptr (GVariant) query_parameters = NULL;
+		const gchar *sparql;
+
+		if (!files_interface->query_cache) {
+			g_dbus_method_invocation_return_error (invocation,
+			                                       G_IO_ERROR,
+			                                       G_IO_ERROR_NOT_SUPPORTED,
+			                                       "Query cache is disabled");
+			return;
+		}
+
+		g_variant_get (parameters, "(&s@a{sv})", &sparql, &query_parameters);
+		tracker_query_cache_query_async (files_interface->query_cache,
+		                                 sparql,
+		                                 query_parameters,
+		                                 NULL,
+		                                 query_cb,
+		                                 invocation);
 	} else {
 		g_dbus_method_invocation_return_error (invocation,
 		                                       G_DBUS_ERROR,
@@ -122,6 +228,8 @@ create_extractor_config_variant (TrackerFilesInterface *files_interface)
 	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
 	g_variant_builder_add (&builder, "{sv}", "max-bytes",
 	                       g_settings_get_value (files_interface->settings, "max-bytes"));
+	g_variant_builder_add (&builder, "{sv}", "readahead-budget",
+	                       g_settings_get_value (files_interface->settings, "readahead-budget"));
 
 	if (files_interface->priority_graphs)
 		g_variant_builder_add (&builder, "{sv}", "priority-graphs", files_interface->priority_graphs);
@@ -207,6 +315,8 @@ tracker_files_interface_constructed (GObject *object)
 	files_interface->settings = g_settings_new ("org.freedesktop.Tracker3.Extract");
 	g_signal_connect_swapped (files_interface->settings, "changed::max-bytes",
 	                          G_CALLBACK (tracker_files_interface_emit_changed), object);
+	g_signal_connect_swapped (files_interface->settings, "changed::readahead-budget",
+	                          G_CALLBACK (tracker_files_interface_emit_changed), object);
 
 #ifdef HAVE_POWER
 	files_interface->power = tracker_power_new ();
@@ -242,6 +352,9 @@ tracker_files_interface_finalize (GObject *object)
 	                                     files_interface->object_id);
 	g_clear_object (&files_interface->connection);
 	g_clear_object (&files_interface->settings);
+	g_clear_object (&files_interface->statistics);
+	g_clear_object (&files_interface->query_cache);
+	g_clear_object (&files_interface->miner);
 #ifdef HAVE_POWER
 	g_clear_object (&files_interface->power);
 #endif
@@ -362,3 +475,24 @@ tracker_files_interface_set_priority_graphs (TrackerFilesInterface *files_interf
 	if (changed)
 		tracker_files_interface_emit_changed (files_interface);
 }
+
+void
+tracker_files_interface_set_statistics (TrackerFilesInterface *files_interface,
+                                        TrackerStatistics     *statistics)
+{
+	g_set_object (&files_interface->statistics, statistics);
+}
+
+void
+tracker_files_interface_set_query_cache (TrackerFilesInterface *files_interface,
+                                         TrackerQueryCache     *query_cache)
+{
+	g_set_object (&files_interface->query_cache, query_cache);
+}
+
+void
+tracker_files_interface_set_miner (TrackerFilesInterface *files_interface,
+                                   TrackerMinerFS        *miner)
+{
+	g_set_object (&files_interface->miner, miner);
+}
@@ -24,6 +24,10 @@
 
 #include <gio/gio.h>
 
+#include "tracker-miner-fs.h"
+#include "tracker-query-cache.h"
+#include "tracker-statistics.h"
+
 #define TRACKER_TYPE_FILES_INTERFACE (tracker_files_interface_get_type ())
 G_DECLARE_FINAL_TYPE (TrackerFilesInterface,
                       tracker_files_interface,
@@ -40,4 +44,13 @@ int tracker_files_interface_dup_fd (TrackerFilesInterface *files_interface);
 void tracker_files_interface_set_priority_graphs (TrackerFilesInterface *files_interface,
                                                   GVariant              *graphs);
 
+void tracker_files_interface_set_statistics (TrackerFilesInterface *files_interface,
+                                             TrackerStatistics     *statistics);
+
+void tracker_files_interface_set_query_cache (TrackerFilesInterface *files_interface,
+                                              TrackerQueryCache     *query_cache);
+
+void tracker_files_interface_set_miner (TrackerFilesInterface *files_interface,
+                                        TrackerMinerFS        *miner);
+
 #endif /* __TRACKER_FILES_INTERFACE_H__ */
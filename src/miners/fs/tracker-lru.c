@@ -28,7 +28,8 @@ typedef struct _TrackerLRUElement TrackerLRUElement;
 struct _TrackerLRUElement {
 	gpointer element;
 	gpointer data;
-	GList *link;
+	/* Embedded link in the LRU queue */
+	GList link;
 };
 
 struct _TrackerLRU {
@@ -93,7 +94,6 @@ tracker_lru_unref (TrackerLRU *lru)
 		}
 
 		g_hash_table_unref (lru->items);
-		g_queue_clear (&lru->queue);
 		g_free (lru);
 	}
 }
@@ -112,10 +112,10 @@ tracker_lru_find (TrackerLRU *lru,
 	if (data)
 		*data = node->data;
 
-	if (node->link != lru->queue.head) {
+	if (&node->link != lru->queue.head) {
 		/* Push to head */
-		g_queue_unlink (&lru->queue, node->link);
-		g_queue_push_head_link (&lru->queue, node->link);
+		g_queue_unlink (&lru->queue, &node->link);
+		g_queue_push_head_link (&lru->queue, &node->link);
 	}
 
 	return TRUE;
@@ -131,16 +131,16 @@ tracker_lru_add (TrackerLRU *lru,
 	node = g_slice_new0 (TrackerLRUElement);
 	node->element = elem;
 	node->data = data;
-	node->link = g_list_alloc ();
-	node->link->data = node;
+	node->link.data = node;
 
-	g_queue_push_head_link (&lru->queue, node->link);
+	g_queue_push_head_link (&lru->queue, &node->link);
 
 	g_hash_table_insert (lru->items, elem, node);
 
 	if (g_hash_table_size (lru->items) > lru->max_size) {
 		/* Remove last element */
-		last = g_queue_pop_tail (&lru->queue);
+		last = g_queue_peek_tail (&lru->queue);
+		g_queue_unlink (&lru->queue, &last->link);
 		free_node (last, lru);
 	}
 }
@@ -155,7 +155,7 @@ tracker_lru_remove (TrackerLRU *lru,
 	if (!node)
 		return;
 
-	g_queue_remove (&lru->queue, node);
+	g_queue_unlink (&lru->queue, &node->link);
 	free_node (node, lru);
 }
 
@@ -172,7 +172,7 @@ tracker_lru_remove_foreach (TrackerLRU *lru,
 		next = link->next;
 
 		if (equal_func (node->element, elem) == TRUE) {
-			g_queue_unlink (&lru->queue, node->link);
+			g_queue_unlink (&lru->queue, &node->link);
 			free_node (node, lru);
 		}
 
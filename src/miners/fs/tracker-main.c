@@ -41,6 +41,7 @@
 #endif
 
 #include <libtracker-miners-common/tracker-common.h>
+#include <libtracker-extract/tracker-extract.h>
 
 #include "tracker-config.h"
 #include "tracker-controller.h"
@@ -66,6 +67,7 @@
 #define DBUS_PATH "/org/freedesktop/Tracker3/Miner/Files"
 
 #define LAST_CRAWL_FILENAME "last-crawl.txt"
+#define CRAWL_SNAPSHOTS_DIRNAME "crawl-snapshots"
 
 static GMainLoop *main_loop;
 static guint cleanup_id;
@@ -137,6 +139,8 @@ log_option_values (TrackerConfig *config)
 		g_message ("Indexer options:");
 		g_message ("  Throttle level  .......................  %d",
 		           tracker_config_get_throttle (config));
+		g_message ("  Memory budget  ........................  %d MiB",
+		           tracker_config_get_memory_budget (config));
 		g_message ("  Indexing while on battery  ............  %s (first time only = %s)",
 		           tracker_config_get_index_on_battery (config) ? "yes" : "no",
 		           tracker_config_get_index_on_battery_first_time (config) ? "yes" : "no");
@@ -219,6 +223,56 @@ set_last_crawl_done (TrackerMinerFiles *mf,
 	}
 }
 
+static gchar *
+get_crawl_snapshot_checksum (TrackerConfig *config)
+{
+	g_autoptr (GSettingsSchema) schema = NULL;
+	g_autoptr (GChecksum) checksum = NULL;
+	g_auto (GStrv) keys = NULL;
+	g_autofree gchar *rules = NULL;
+	guint i;
+
+	checksum = g_checksum_new (G_CHECKSUM_SHA1);
+	g_object_get (config, "settings-schema", &schema, NULL);
+	keys = g_settings_schema_list_keys (schema);
+
+	/* Any of the settings may change what gets indexed */
+	for (i = 0; keys[i]; i++) {
+		g_autoptr (GVariant) value = NULL;
+		g_autofree gchar *str = NULL;
+
+		value = g_settings_get_value (G_SETTINGS (config), keys[i]);
+		str = g_variant_print (value, FALSE);
+		g_checksum_update (checksum, (const guchar *) keys[i], -1);
+		g_checksum_update (checksum, (const guchar *) str, -1);
+	}
+
+	/* And extractor rules what gets extracted */
+	rules = tracker_extract_module_manager_get_rules_checksum ();
+	if (rules)
+		g_checksum_update (checksum, (const guchar *) rules, -1);
+
+	return g_strdup (g_checksum_get_string (checksum));
+}
+
+static void
+enable_crawl_snapshots (TrackerMinerFiles *mf,
+                        TrackerConfig     *config)
+{
+	g_autoptr (GFile) cache = NULL, directory = NULL;
+	g_autofree gchar *checksum = NULL;
+	TrackerDomainOntology *domain_ontology;
+
+	g_object_get (G_OBJECT (mf), "domain-ontology", &domain_ontology, NULL);
+	cache = get_cache_dir (domain_ontology);
+	directory = g_file_get_child (cache, CRAWL_SNAPSHOTS_DIRNAME);
+	tracker_domain_ontology_unref (domain_ontology);
+
+	checksum = get_crawl_snapshot_checksum (config);
+	tracker_miner_fs_set_crawl_snapshots (TRACKER_MINER_FS (mf),
+	                                      directory, checksum);
+}
+
 static gboolean
 signal_handler (gpointer user_data)
 {
@@ -314,7 +368,7 @@ should_crawl (TrackerMinerFiles *miner_files,
 		TRACKER_NOTE (CONFIG, g_message ("  Disabled"));
 		return FALSE;
 	} else if (crawling_interval == -1) {
-		TRACKER_NOTE (CONFIG, g_message ("  Maybe (depends on a clean last shutdown)"));
+		TRACKER_NOTE (CONFIG, g_message ("  Maybe (unchanged directories are skipped after a clean last shutdown)"));
 		return TRUE;
 	} else if (crawling_interval == 0) {
 		TRACKER_NOTE (CONFIG, g_message ("  Forced"));
@@ -959,7 +1013,30 @@ main (gint argc, gchar *argv[])
 	                                       domain_ontology,
 	                                       initial_index);
 
+	tracker_miner_fs_set_memory_budget (TRACKER_MINER_FS (miner_files),
+	                                    (gsize) tracker_config_get_memory_budget (config) * 1024 * 1024);
+
+	if (!dry_run) {
+		GFile *store = get_cache_dir (domain_ontology);
+
+		tracker_miner_fs_set_spill_directory (TRACKER_MINER_FS (miner_files), store);
+		g_object_unref (store);
+	}
+
 	controller = tracker_controller_new (indexing_tree, storage, files_interface);
+	tracker_files_interface_set_statistics (files_interface,
+	                                        tracker_miner_fs_get_statistics (TRACKER_MINER_FS (miner_files)));
+	tracker_files_interface_set_miner (files_interface, TRACKER_MINER_FS (miner_files));
+
+	if (tracker_config_get_query_cache_size (config) > 0) {
+		TrackerQueryCache *query_cache;
+
+		query_cache = tracker_query_cache_new (sparql_conn,
+		                                       tracker_miner_fs_get_statistics (TRACKER_MINER_FS (miner_files)),
+		                                       (gsize) tracker_config_get_query_cache_size (config) * 1024 * 1024);
+		tracker_files_interface_set_query_cache (files_interface, query_cache);
+		g_object_unref (query_cache);
+	}
 
 	proxy = tracker_miner_proxy_new (miner_files, connection, DBUS_PATH, NULL, &error);
 	if (error) {
@@ -998,6 +1075,13 @@ main (gint argc, gchar *argv[])
 	 */
 	do_crawling = should_crawl (TRACKER_MINER_FILES (miner_files), config);
 
+	/* After a clean shutdown, everything but changed directories
+	 * can be trusted to be up to date.
+	 */
+	if (do_crawling && !dry_run &&
+	    tracker_config_get_crawling_interval (config) == -1)
+		enable_crawl_snapshots (TRACKER_MINER_FILES (miner_files), config);
+
 	g_signal_connect (miner_files, "started",
 			  G_CALLBACK (miner_started_cb),
 			  NULL);
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_MEMORY_ESTIMATES_H__
+#define __TRACKER_MEMORY_ESTIMATES_H__
+
+#include <glib.h>
+
+/* Rough sizes of what is allocated outside our own structures, for
+ * memory budget accounting. Keep them in one place so every part of
+ * the miner counts the same object the same.
+ */
+#define ESTIMATED_FILE_SIZE 128
+#define ESTIMATED_FILE_INFO_SIZE 512
+#define ESTIMATED_HASH_SLOT_SIZE (3 * sizeof (gpointer))
+#define ESTIMATED_SNAPSHOT_ENTRY_SIZE 96
+#define ESTIMATED_SPARQL_TASK_SIZE 2048
+
+#endif /* __TRACKER_MEMORY_ESTIMATES_H__ */
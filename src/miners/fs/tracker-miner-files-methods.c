@@ -159,6 +159,17 @@ miner_files_create_empty_information_element (TrackerMinerFiles *miner,
 	return resource;
 }
 
+gboolean
+tracker_miner_files_is_sidecar (GFile *file)
+{
+	g_autofree gchar *basename = NULL;
+
+	/* Looked up by the extractor for images without embedded XMP */
+	basename = g_file_get_basename (file);
+
+	return basename && g_str_has_suffix (basename, ".xmp");
+}
+
 gchar *
 get_content_type (GFile     *file,
 		  GFileInfo *file_info)
@@ -308,6 +319,9 @@ tracker_miner_files_process_file (TrackerMinerFS      *fs,
 		                                  is_root,
 		                                  resource, folder_resource);
 	} else {
+		if (tracker_miner_files_is_sidecar (file))
+			tracker_sparql_buffer_log_sidecar_update (buffer, file);
+
 		tracker_sparql_buffer_log_file (buffer, file,
 		                                graph,
 		                                resource,
@@ -33,6 +33,8 @@ void tracker_miner_files_process_file_attributes (TrackerMinerFS      *fs,
                                                   GFileInfo           *info,
                                                   TrackerSparqlBuffer *buffer);
 
+gboolean tracker_miner_files_is_sidecar (GFile *file);
+
 gchar * tracker_miner_files_get_content_identifier (TrackerMinerFiles *files,
                                                     GFile             *file,
                                                     GFileInfo         *info);
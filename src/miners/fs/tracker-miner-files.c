@@ -47,7 +47,10 @@
 	G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
 	G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
 	G_FILE_ATTRIBUTE_TIME_CREATED "," \
-	G_FILE_ATTRIBUTE_TIME_ACCESS
+	G_FILE_ATTRIBUTE_TIME_ACCESS "," \
+	G_FILE_ATTRIBUTE_TIME_CHANGED "," \
+	G_FILE_ATTRIBUTE_UNIX_INODE "," \
+	G_FILE_ATTRIBUTE_UNIX_DEVICE
 
 #define TRACKER_MINER_FILES_GET_PRIVATE(o) (tracker_miner_files_get_instance_private (TRACKER_MINER_FILES (o)))
 
@@ -431,6 +434,15 @@ miner_files_finalize (GObject *object)
 	G_OBJECT_CLASS (tracker_miner_files_parent_class)->finalize (object);
 }
 
+static void
+invalidate_statistics (TrackerMinerFiles *miner)
+{
+	/* Index roots and their availability changed, these
+	 * affect the number of available files and folders.
+	 */
+	tracker_statistics_invalidate (tracker_miner_fs_get_statistics (TRACKER_MINER_FS (miner)));
+}
+
 static void
 set_up_mount_point_cb (GObject      *source,
                        GAsyncResult *result,
@@ -444,7 +456,11 @@ set_up_mount_point_cb (GObject      *source,
 	if (error) {
 		g_critical ("Could not set mount point in database, %s",
 		            error->message);
+	} else {
+		invalidate_statistics (user_data);
 	}
+
+	g_object_unref (user_data);
 }
 
 static void
@@ -481,7 +497,7 @@ set_up_mount_point (TrackerMinerFiles *miner,
 		tracker_sparql_statement_update_async (stmt,
 		                                       NULL,
 		                                       set_up_mount_point_cb,
-		                                       NULL);
+		                                       g_object_ref (miner));
 	}
 }
 
@@ -514,6 +530,7 @@ init_index_roots_cb (GObject      *source,
 		g_critical ("Could not initialize currently active mount points: %s",
 		            error->message);
 	} else {
+		invalidate_statistics (user_data);
 		init_stale_volume_removal (user_data);
 	}
 }
@@ -951,6 +968,8 @@ indexing_tree_directory_removed_cb (TrackerIndexingTree *indexing_tree,
 
 	if (!tracker_batch_execute (batch, NULL, &error))
 		g_warning ("Error updating indexed folder: %s", error->message);
+	else
+		invalidate_statistics (miner_files);
 }
 
 static void
@@ -999,6 +1018,8 @@ miner_files_remove_file (TrackerMinerFS      *fs,
 {
 	if (is_dir)
 		tracker_sparql_buffer_log_delete_content (buffer, file);
+	else if (tracker_miner_files_is_sidecar (file))
+		tracker_sparql_buffer_log_sidecar_update (buffer, file);
 
 	tracker_sparql_buffer_log_delete (buffer, file);
 }
@@ -1016,6 +1037,11 @@ miner_files_move_file (TrackerMinerFS      *fs,
 	tracker_sparql_buffer_log_move (buffer, source_file, file,
 	                                data_source);
 
+	if (tracker_miner_files_is_sidecar (source_file))
+		tracker_sparql_buffer_log_sidecar_update (buffer, source_file);
+	if (tracker_miner_files_is_sidecar (file))
+		tracker_sparql_buffer_log_sidecar_update (buffer, file);
+
 	if (recursive)
 		tracker_sparql_buffer_log_move_content (buffer, source_file, file);
 }
@@ -29,11 +29,17 @@
 #include "tracker-sparql-buffer.h"
 #include "tracker-file-notifier.h"
 #include "tracker-lru.h"
+#include "tracker-memory-estimates.h"
+#include "tracker-path-index.h"
+#include "tracker-slab.h"
 
 #define BUFFER_POOL_LIMIT 800
 #define DEFAULT_URN_LRU_SIZE 100
 
-#define BIG_QUEUE_THRESHOLD 1000
+/* Deletions held back waiting for a create of the same file elsewhere */
+#define MAX_PARKED_DELETIONS 1000
+#define MAX_PARKED_DELETIONS_SECONDS 60
+#define RECONCILE_BATCH_SIZE 100
 
 /* Put tasks processing at a lower priority so other events
  * (timeouts, monitor events, etc...) are guaranteed to be
@@ -63,25 +69,72 @@ typedef struct {
 	guint16 type;
 	guint attributes_update : 1;
 	guint is_dir : 1;
+	/* Only set until the event is queued, the file is
+	 * kept by the path index entry afterwards.
+	 */
 	GFile *file;
 	GFile *dest_file;
 	GFileInfo *info;
-	GList *root_node;
-	GList *queue_node;
+	/* Embedded link in the queue of events for the root, if any */
+	GList root_link;
+	TrackerPriorityQueueNode queue_node;
+	TrackerPathIndexEntry *path_entry;
 } QueueEvent;
 
 typedef struct {
+	guint n_items;
+	guint64 n_bytes;
+} DeviceStats;
+
+typedef struct {
+	/* Embedded link in the queue of parked deletions */
+	GList link;
+	GFile *file;
+	TrackerPathIndexEntry *path_entry;
+	gboolean is_dir;
+} ParkedDeletion;
+
+typedef enum {
+	RECONCILE_STAGE_QUERY_INFO,
+	RECONCILE_STAGE_LOOKUP,
+	RECONCILE_STAGE_CHECK_CANDIDATES,
+} ReconcileStage;
+
+typedef struct _ReconcileBatch ReconcileBatch;
+
+typedef struct {
+	ReconcileBatch *batch;
 	GFile *file;
-	gchar *urn;
-	gint priority;
+	GFileInfo *info;
+	gchar *content_id;
+} ReconcileItem;
+
+/* A location the store has for a content identifier */
+typedef struct {
+	ReconcileBatch *batch;
+	GFile *location;
+	/* Stored size, and mtime and birth time in seconds, -1 if unknown */
+	gint64 size;
+	gint64 mtime;
+	gint64 created;
+	gboolean exists;
+} ReconcileCandidate;
+
+struct _ReconcileBatch {
+	TrackerMinerFS *fs;
 	GCancellable *cancellable;
-	TrackerMiner *miner;
-	TrackerTask *task;
-} UpdateProcessingTaskContext;
+	GPtrArray *items;
+	/* Content identifier -> array of ReconcileCandidate */
+	GHashTable *candidates;
+	ReconcileStage stage;
+	guint n_pending;
+};
 
 struct _TrackerMinerFSPrivate {
 	TrackerPriorityQueue *items;
-	GHashTable *items_by_file;
+	TrackerSlab *event_slab;
+	/* All queued events, by their file */
+	TrackerPathIndex *items_by_path;
 
 	guint item_queues_handler_id;
 
@@ -95,10 +148,28 @@ struct _TrackerMinerFSPrivate {
 	/* Folder URN cache */
 	TrackerLRU *urn_lru;
 
+	/* Files moved while nobody was looking arrive as a deletion
+	 * and a creation. Deletions are parked until the queue drains,
+	 * or for MAX_PARKED_DELETIONS_SECONDS at most, so a creation of
+	 * the same content identifier can be turned into a move, keeping
+	 * everything attached to it. Consecutive creations are looked up
+	 * in batches.
+	 */
+	GCancellable *reconcile_cancellable;
+	TrackerPathIndex *parked_deletions; /* GFile -> ParkedDeletion */
+	GQueue parked_deletion_queue;       /* Oldest first */
+	GHashTable *reconciled_moves;       /* Dest GFile -> source GFile */
+	ReconcileBatch *reconcile_batch;
+	guint parked_deletions_timeout_id;
+	gboolean reconciling;
+
 	/* Properties */
 	gdouble throttle;
 	gchar *file_attributes;
 
+	/* Memory budget in bytes, 0 if unlimited */
+	gsize memory_budget;
+
 	/* Status */
 	GTimer *timer;
 	GTimer *extraction_timer;
@@ -106,6 +177,7 @@ struct _TrackerMinerFSPrivate {
 	guint shown_totals : 1;     /* TRUE if totals have been shown */
 	guint is_paused : 1;        /* TRUE if miner is paused */
 	guint flushing : 1;         /* TRUE if flushing SPARQL */
+	guint over_budget : 1;      /* TRUE if memory budget exhausted */
 
 	guint timer_stopped : 1;    /* TRUE if main timer is stopped */
 	guint extraction_timer_stopped : 1; /* TRUE if the extraction
@@ -128,6 +200,9 @@ struct _TrackerMinerFSPrivate {
 	/* How many we indexed and how many had errors indexing. */
 	guint changes_processed;
 	guint total_files_notified_error;
+
+	/* Processed items by the device they live in */
+	GHashTable *device_stats;           /* Filesystem ID -> DeviceStats */
 };
 
 typedef enum {
@@ -208,6 +283,11 @@ static void           file_notifier_finished              (TrackerFileNotifier *
                                                            gpointer             user_data);
 
 static void           item_queue_handlers_set_up          (TrackerMinerFS       *fs);
+static void           item_account_device                 (TrackerMinerFS       *fs,
+                                                           GFile                *file,
+                                                           GFileInfo            *info);
+static void           parked_deletion_free                (ParkedDeletion       *deletion);
+static void           reconcile_batch_free                (ReconcileBatch       *batch);
 
 static void           task_pool_limit_reached_notify_cb       (GObject        *object,
                                                                GParamSpec     *pspec,
@@ -371,9 +451,8 @@ tracker_miner_fs_init (TrackerMinerFS *object)
 	priv->extraction_timer_stopped = TRUE;
 
 	priv->items = tracker_priority_queue_new ();
-	priv->items_by_file = g_hash_table_new_full (g_file_hash,
-	                                             (GEqualFunc) g_file_equal,
-	                                             g_object_unref, NULL);
+	priv->event_slab = tracker_slab_new (sizeof (QueueEvent));
+	priv->items_by_path = tracker_path_index_new ();
 
 	priv->roots_to_notify = g_hash_table_new_full (g_file_hash,
 	                                               (GEqualFunc) g_file_equal,
@@ -384,10 +463,18 @@ tracker_miner_fs_init (TrackerMinerFS *object)
 	                                 (GEqualFunc) g_file_equal,
 	                                 g_object_unref,
 	                                 g_free);
+	priv->parked_deletions = tracker_path_index_new ();
+	priv->reconciled_moves = g_hash_table_new_full (g_file_hash,
+	                                                (GEqualFunc) g_file_equal,
+	                                                g_object_unref,
+	                                                g_object_unref);
+	priv->reconcile_cancellable = g_cancellable_new ();
+	priv->device_stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static QueueEvent *
-queue_event_new (TrackerMinerFSEventType  type,
+queue_event_new (TrackerSlab             *slab,
+                 TrackerMinerFSEventType  type,
                  GFile                   *file,
                  GFileInfo               *info)
 {
@@ -395,7 +482,7 @@ queue_event_new (TrackerMinerFSEventType  type,
 
 	g_assert (type != TRACKER_MINER_FS_EVENT_MOVED);
 
-	event = g_new0 (QueueEvent, 1);
+	event = tracker_slab_alloc (slab);
 	event->type = type;
 	g_set_object (&event->file, file);
 	g_set_object (&event->info, info);
@@ -404,13 +491,14 @@ queue_event_new (TrackerMinerFSEventType  type,
 }
 
 static QueueEvent *
-queue_event_moved_new (GFile    *source,
-                       GFile    *dest,
-                       gboolean  is_dir)
+queue_event_moved_new (TrackerSlab *slab,
+                       GFile       *source,
+                       GFile       *dest,
+                       gboolean     is_dir)
 {
 	QueueEvent *event;
 
-	event = g_new0 (QueueEvent, 1);
+	event = tracker_slab_alloc (slab);
 	event->type = TRACKER_MINER_FS_EVENT_MOVED;
 	event->is_dir = !!is_dir;
 	g_set_object (&event->dest_file, dest);
@@ -420,29 +508,29 @@ queue_event_moved_new (GFile    *source,
 }
 
 static void
-queue_event_free (QueueEvent *event)
+queue_event_free (QueueEvent  *event,
+                  TrackerSlab *slab)
 {
-	if (event->root_node) {
+	if (event->root_link.data) {
 		GQueue *root_queue;
 
-		root_queue = event->root_node->data;
-		g_queue_delete_link (root_queue, event->root_node);
+		root_queue = event->root_link.data;
+		g_queue_unlink (root_queue, &event->root_link);
 	}
 
 	g_clear_object (&event->dest_file);
 	g_clear_object (&event->file);
 	g_clear_object (&event->info);
-	g_free (event);
+	tracker_slab_release (slab, event);
 }
 
+/* @first is the last queued event on the file of @second */
 static QueueCoalesceAction
-queue_event_coalesce (const QueueEvent  *first,
+queue_event_coalesce (TrackerSlab       *slab,
+		      const QueueEvent  *first,
 		      const QueueEvent  *second,
 		      QueueEvent       **replacement)
 {
-	if (!g_file_equal (first->file, second->file))
-		return QUEUE_ACTION_NONE;
-
 	*replacement = NULL;
 
 	if (first->type == TRACKER_MINER_FS_EVENT_CREATED) {
@@ -451,7 +539,8 @@ queue_event_coalesce (const QueueEvent  *first,
 		     !second->attributes_update)) {
 			return QUEUE_ACTION_DELETE_FIRST;
 		} else if (second->type == TRACKER_MINER_FS_EVENT_MOVED) {
-			*replacement = queue_event_new (TRACKER_MINER_FS_EVENT_CREATED,
+			*replacement = queue_event_new (slab,
+			                                TRACKER_MINER_FS_EVENT_CREATED,
 			                                second->dest_file,
 			                                NULL);
 			return (QUEUE_ACTION_DELETE_FIRST |
@@ -473,8 +562,9 @@ queue_event_coalesce (const QueueEvent  *first,
 		}
 	} else if (first->type == TRACKER_MINER_FS_EVENT_MOVED) {
 		if (second->type == TRACKER_MINER_FS_EVENT_MOVED) {
-			if (first->file != second->dest_file) {
-				*replacement = queue_event_moved_new (first->file,
+			if (!g_file_equal (second->file, second->dest_file)) {
+				*replacement = queue_event_moved_new (slab,
+				                                      second->file,
 				                                      second->dest_file,
 				                                      first->is_dir);
 			}
@@ -482,8 +572,9 @@ queue_event_coalesce (const QueueEvent  *first,
 			return (QUEUE_ACTION_DELETE_FIRST |
 				QUEUE_ACTION_DELETE_SECOND);
 		} else if (second->type == TRACKER_MINER_FS_EVENT_DELETED) {
-			*replacement = queue_event_new (TRACKER_MINER_FS_EVENT_DELETED,
-			                                first->file,
+			*replacement = queue_event_new (slab,
+			                                TRACKER_MINER_FS_EVENT_DELETED,
+			                                second->file,
 			                                NULL);
 			return (QUEUE_ACTION_DELETE_FIRST |
 				QUEUE_ACTION_DELETE_SECOND);
@@ -496,14 +587,6 @@ queue_event_coalesce (const QueueEvent  *first,
 	return QUEUE_ACTION_NONE;
 }
 
-static gboolean
-queue_event_is_equal_or_descendant (QueueEvent *event,
-				    GFile      *prefix)
-{
-	return (g_file_equal (event->file, prefix) ||
-		g_file_has_prefix (event->file, prefix));
-}
-
 static void
 fs_finalize (GObject *object)
 {
@@ -522,6 +605,15 @@ fs_finalize (GObject *object)
 	}
 
 	if (priv->file_notifier) {
+		/* Crawl snapshots are only accurate if every
+		 * change made it into the store.
+		 */
+		if (!tracker_miner_fs_has_items_to_process (TRACKER_MINER_FS (object)) &&
+		    !priv->flushing &&
+		    (!priv->sparql_buffer ||
+		     tracker_task_pool_get_size (TRACKER_TASK_POOL (priv->sparql_buffer)) == 0))
+			tracker_file_notifier_save_crawl_snapshots (priv->file_notifier, TRUE);
+
 		tracker_file_notifier_stop (priv->file_notifier);
 	}
 
@@ -529,11 +621,12 @@ fs_finalize (GObject *object)
 		g_object_unref (priv->sparql_buffer);
 	}
 
-	g_hash_table_unref (priv->items_by_file);
+	tracker_path_index_free (priv->items_by_path);
 	tracker_priority_queue_foreach (priv->items,
 					(GFunc) queue_event_free,
-					NULL);
+					priv->event_slab);
 	tracker_priority_queue_unref (priv->items);
+	tracker_slab_free (priv->event_slab);
 
 	if (priv->indexing_tree) {
 		g_object_unref (priv->indexing_tree);
@@ -544,6 +637,15 @@ fs_finalize (GObject *object)
 	}
 
 	g_hash_table_unref (priv->roots_to_notify);
+	tracker_path_index_free (priv->parked_deletions);
+	g_queue_clear_full (&priv->parked_deletion_queue,
+	                    (GDestroyNotify) parked_deletion_free);
+	g_hash_table_unref (priv->reconciled_moves);
+	g_hash_table_unref (priv->device_stats);
+	g_cancellable_cancel (priv->reconcile_cancellable);
+	g_clear_object (&priv->reconcile_cancellable);
+	g_clear_pointer (&priv->reconcile_batch, reconcile_batch_free);
+	g_clear_handle_id (&priv->parked_deletions_timeout_id, g_source_remove);
 	g_free (priv->file_attributes);
 
 	G_OBJECT_CLASS (tracker_miner_fs_parent_class)->finalize (object);
@@ -809,6 +911,10 @@ process_stop (TrackerMinerFS *fs)
 	 */
 	notify_roots_finished (fs);
 
+	g_hash_table_remove_all (fs->priv->reconciled_moves);
+
+	tracker_file_notifier_save_crawl_snapshots (fs->priv->file_notifier, FALSE);
+
 	g_signal_emit (fs, signals[FINISHED], 0,
 	               g_timer_elapsed (fs->priv->timer, NULL),
 	               fs->priv->total_directories_found,
@@ -825,6 +931,64 @@ process_stop (TrackerMinerFS *fs)
 	fs->priv->total_files_notified_error = 0;
 }
 
+static gsize
+miner_fs_get_memory_usage (TrackerMinerFS *fs)
+{
+	TrackerMinerFSPrivate *priv = fs->priv;
+	gsize usage;
+
+	/* Queued events are accounted as if they all had file info,
+	 * which those coming from crawling do.
+	 */
+	usage = tracker_slab_get_size (priv->event_slab) +
+		tracker_path_index_get_memory_size (priv->items_by_path) +
+		tracker_priority_queue_get_length (priv->items) *
+		(2 * sizeof (gpointer) + ESTIMATED_FILE_INFO_SIZE);
+
+	usage += tracker_path_index_get_memory_size (priv->parked_deletions) +
+		g_queue_get_length (&priv->parked_deletion_queue) *
+		(sizeof (ParkedDeletion) + ESTIMATED_FILE_SIZE);
+	usage += tracker_task_pool_get_size (TRACKER_TASK_POOL (priv->sparql_buffer)) *
+		ESTIMATED_SPARQL_TASK_SIZE;
+	usage += tracker_file_notifier_get_memory_usage (priv->file_notifier);
+
+	return usage;
+}
+
+static void
+check_memory_budget (TrackerMinerFS *fs)
+{
+	TrackerMinerFSPrivate *priv = fs->priv;
+	gboolean draining, over_budget;
+	gsize usage, limit;
+
+	if (priv->memory_budget == 0)
+		return;
+
+	/* Holding the notifier back only helps while something
+	 * else is releasing memory.
+	 */
+	draining = (!tracker_priority_queue_is_empty (priv->items) ||
+	            priv->flushing);
+
+	/* Leave some slack before resuming, not to flip on every event */
+	limit = priv->over_budget ?
+		priv->memory_budget / 4 * 3 : priv->memory_budget;
+	usage = miner_fs_get_memory_usage (fs);
+	over_budget = draining && usage > limit;
+
+	if (over_budget == priv->over_budget)
+		return;
+
+	TRACKER_NOTE (MINER_FS_EVENTS,
+	              g_message ("Using ~%" G_GSIZE_FORMAT " KiB of a %" G_GSIZE_FORMAT " KiB budget, %s",
+	                         usage / 1024, priv->memory_budget / 1024,
+	                         over_budget ? "holding back" : "resuming"));
+
+	priv->over_budget = over_budget;
+	tracker_file_notifier_set_over_budget (priv->file_notifier, over_budget);
+}
+
 static void
 check_notifier_high_water (TrackerMinerFS *fs)
 {
@@ -836,6 +1000,8 @@ check_notifier_high_water (TrackerMinerFS *fs)
 	high_water = (tracker_priority_queue_get_length (fs->priv->items) >
 	              2 * BUFFER_POOL_LIMIT);
 	tracker_file_notifier_set_high_water (fs->priv->file_notifier, high_water);
+
+	check_memory_budget (fs);
 }
 
 static void
@@ -898,6 +1064,32 @@ sparql_buffer_flush_cb (GObject      *object,
 	g_clear_error (&error);
 }
 
+/* Flushes the SPARQL buffer if it is full. Returns %FALSE if it
+ * could not be flushed, and processing must wait for the pending
+ * operations to finish.
+ */
+static gboolean
+item_queue_flush_if_full (TrackerMinerFS *fs)
+{
+	gboolean flushed = TRUE;
+
+	if (!tracker_task_pool_limit_reached (TRACKER_TASK_POOL (fs->priv->sparql_buffer)))
+		return TRUE;
+
+	if (tracker_sparql_buffer_flush (fs->priv->sparql_buffer,
+	                                 "SPARQL buffer limit reached",
+	                                 sparql_buffer_flush_cb,
+	                                 fs))
+		fs->priv->flushing = TRUE;
+	else
+		flushed = FALSE;
+
+	/* Check if we've finished inserting for given prefixes ... */
+	notify_roots_finished (fs);
+
+	return flushed;
+}
+
 static gboolean
 item_add_or_update (TrackerMinerFS *fs,
                     GFile          *file,
@@ -1014,32 +1206,772 @@ item_move (TrackerMinerFS *fs,
 	return TRUE;
 }
 
+static void
+item_queue_remove_event (TrackerMinerFS *fs,
+                         QueueEvent     *event)
+{
+	tracker_priority_queue_remove_node (fs->priv->items,
+	                                    event->queue_node);
+
+	if (event->path_entry)
+		tracker_path_index_remove (fs->priv->items_by_path, event->path_entry);
+
+	queue_event_free (event, fs->priv->event_slab);
+}
+
+/* Removes all queued events on @prefix and the files contained in it */
+static void
+item_queue_remove_descendants (TrackerMinerFS *fs,
+                               GFile          *prefix)
+{
+	GList *events, *l;
+
+	events = tracker_path_index_remove_descendants (fs->priv->items_by_path,
+	                                                prefix);
+
+	for (l = events; l; l = l->next) {
+		QueueEvent *event = l->data;
+
+		event->path_entry = NULL;
+		item_queue_remove_event (fs, event);
+	}
+
+	g_list_free (events);
+}
+
+static void
+parked_deletion_free (ParkedDeletion *deletion)
+{
+	g_object_unref (deletion->file);
+	g_free (deletion);
+}
+
+static void
+item_unpark_deletion (TrackerMinerFS *fs,
+                      ParkedDeletion *deletion,
+                      gboolean        apply)
+{
+	g_queue_unlink (&fs->priv->parked_deletion_queue, &deletion->link);
+
+	if (deletion->path_entry)
+		tracker_path_index_remove (fs->priv->parked_deletions, deletion->path_entry);
+
+	if (apply)
+		item_remove (fs, deletion->file, deletion->is_dir, FALSE);
+
+	parked_deletion_free (deletion);
+}
+
+static void
+item_flush_parked_deletions (TrackerMinerFS *fs)
+{
+	ParkedDeletion *deletion;
+
+	g_clear_handle_id (&fs->priv->parked_deletions_timeout_id, g_source_remove);
+
+	while ((deletion = g_queue_peek_head (&fs->priv->parked_deletion_queue)) != NULL)
+		item_unpark_deletion (fs, deletion, TRUE);
+}
+
+static gboolean
+parked_deletions_timeout_cb (gpointer user_data)
+{
+	TrackerMinerFS *fs = user_data;
+
+	fs->priv->parked_deletions_timeout_id = 0;
+
+	/* Left for the queue to flush on resume */
+	if (fs->priv->is_paused)
+		return G_SOURCE_REMOVE;
+
+	TRACKER_NOTE (MINER_FS_EVENTS,
+	              g_message ("Deletions parked for too long, applying them"));
+	item_flush_parked_deletions (fs);
+	item_queue_flush_if_full (fs);
+	item_queue_handlers_set_up (fs);
+
+	return G_SOURCE_REMOVE;
+}
+
+/* Flushes the parked deletions that would otherwise be applied
+ * out of order with an event on @file.
+ */
+static void
+item_flush_parked_deletions_for_file (TrackerMinerFS *fs,
+                                      GFile          *file)
+{
+	g_autoptr (GFile) current = NULL;
+	ParkedDeletion *deletion;
+	GList *deletions, *l;
+
+	if (g_queue_is_empty (&fs->priv->parked_deletion_queue))
+		return;
+
+	/* Directories containing @file */
+	current = g_file_get_parent (file);
+
+	while (current) {
+		GFile *parent;
+
+		deletion = tracker_path_index_lookup (fs->priv->parked_deletions, current);
+		if (deletion)
+			item_unpark_deletion (fs, deletion, TRUE);
+
+		parent = g_file_get_parent (current);
+		g_object_unref (current);
+		current = parent;
+	}
+
+	/* @file and everything in it */
+	deletions = tracker_path_index_remove_descendants (fs->priv->parked_deletions, file);
+
+	for (l = deletions; l; l = l->next) {
+		deletion = l->data;
+		deletion->path_entry = NULL;
+		item_unpark_deletion (fs, deletion, TRUE);
+	}
+
+	g_list_free (deletions);
+}
+
 static gboolean
-maybe_remove_file_event_node (TrackerMinerFS *fs,
-                              QueueEvent     *event)
+item_park_deletion (TrackerMinerFS *fs,
+                    GFile          *file,
+                    gboolean        is_dir)
 {
-	QueueEvent *item_event;
+	ParkedDeletion *deletion;
 
-	item_event = g_hash_table_lookup (fs->priv->items_by_file, event->file);
+	if (!TRACKER_MINER_FS_GET_CLASS (fs)->get_content_identifier)
+		return FALSE;
 
-	if (item_event == event) {
-		g_hash_table_remove (fs->priv->items_by_file, event->file);
+	deletion = tracker_path_index_lookup (fs->priv->parked_deletions, file);
+	if (deletion) {
+		deletion->is_dir = is_dir;
 		return TRUE;
 	}
 
+	if (g_queue_get_length (&fs->priv->parked_deletion_queue) >= MAX_PARKED_DELETIONS)
+		item_flush_parked_deletions (fs);
+
+	TRACKER_NOTE (MINER_FS_EVENTS,
+	              g_message ("Holding back deletion of '%s' in case it was moved",
+	                         g_file_peek_path (file)));
+
+	deletion = g_new0 (ParkedDeletion, 1);
+	deletion->link.data = deletion;
+	deletion->file = g_object_ref (file);
+	deletion->is_dir = is_dir;
+	deletion->path_entry = tracker_path_index_add (fs->priv->parked_deletions,
+	                                               file, deletion);
+	g_queue_push_tail_link (&fs->priv->parked_deletion_queue, &deletion->link);
+
+	/* Don't keep deleted files around in the store for the
+	 * whole duration of a long crawl.
+	 */
+	if (fs->priv->parked_deletions_timeout_id == 0) {
+		fs->priv->parked_deletions_timeout_id =
+			g_timeout_add_seconds (MAX_PARKED_DELETIONS_SECONDS,
+			                       parked_deletions_timeout_cb,
+			                       fs);
+	}
+
+	return TRUE;
+}
+
+/* Returns whether @file, or a directory containing it, is known to
+ * be deleted. If a deletion of @file itself is still queued, it is
+ * returned in @queued_deletion.
+ */
+static gboolean
+item_find_deletion (TrackerMinerFS  *fs,
+                    GFile           *file,
+                    gboolean        *is_dir,
+                    QueueEvent     **queued_deletion)
+{
+	g_autoptr (GFile) current = NULL;
+
+	*queued_deletion = NULL;
+	current = g_object_ref (file);
+
+	while (current) {
+		ParkedDeletion *deletion;
+		QueueEvent *event;
+		GFile *parent;
+
+		deletion = tracker_path_index_lookup (fs->priv->parked_deletions, current);
+
+		if (deletion) {
+			if (g_file_equal (current, file))
+				*is_dir = deletion->is_dir;
+			return TRUE;
+		}
+
+		event = tracker_path_index_lookup (fs->priv->items_by_path, current);
+
+		if (event && event->type == TRACKER_MINER_FS_EVENT_DELETED) {
+			if (g_file_equal (current, file)) {
+				*is_dir = event->is_dir;
+				*queued_deletion = event;
+			}
+			return TRUE;
+		}
+
+		parent = g_file_get_parent (current);
+		g_object_unref (current);
+		current = parent;
+	}
+
 	return FALSE;
 }
 
+/* Finds the directory moved by a reconciled move that contains
+ * @file, and where @file was before the move.
+ */
+static GFile *
+item_get_reconciled_source (TrackerMinerFS *fs,
+                            GFile          *file)
+{
+	g_autoptr (GFile) current = NULL;
+
+	if (g_hash_table_size (fs->priv->reconciled_moves) == 0)
+		return NULL;
+
+	current = g_file_get_parent (file);
+
+	while (current) {
+		GFile *source, *parent;
+
+		source = g_hash_table_lookup (fs->priv->reconciled_moves, current);
+
+		if (source) {
+			g_autofree gchar *relative_path = NULL;
+
+			relative_path = g_file_get_relative_path (current, file);
+			return g_file_resolve_relative_path (source, relative_path);
+		}
+
+		parent = g_file_get_parent (current);
+		g_object_unref (current);
+		current = parent;
+	}
+
+	return NULL;
+}
+
+static const gchar *
+item_get_identifier_from_info (TrackerMinerFS *fs,
+                               GFile          *file,
+                               GFileInfo      *info)
+{
+	gchar *str;
+
+	if (tracker_lru_find (fs->priv->urn_lru, file, (gpointer*) &str))
+		return str;
+
+	if (!tracker_indexing_tree_file_is_indexable (fs->priv->indexing_tree, file, info))
+		return NULL;
+
+	str = TRACKER_MINER_FS_GET_CLASS (fs)->get_content_identifier (fs, file, info);
+	tracker_lru_add (fs->priv->urn_lru, g_object_ref (file), str);
+
+	return str;
+}
+
 static gboolean
-remove_items_by_file_foreach (gpointer key,
-                              gpointer value,
-                              gpointer user_data)
+item_matches_stored_content (GFileInfo          *info,
+                             ReconcileCandidate *candidate)
 {
-	GFile *file = key;
-	GFile *prefix = user_data;
+	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+		/* Inode numbers are reused, and the mtime of a directory
+		 * follows its contents, so only the birth time tells
+		 * a moved directory apart from one created anew.
+		 */
+		return (candidate->created >= 0 &&
+		        g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_CREATED) &&
+		        (gint64) g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_CREATED) == candidate->created);
+	}
+
+	if (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE) &&
+	    candidate->size >= 0 &&
+	    g_file_info_get_size (info) != candidate->size)
+		return FALSE;
 
-	return (g_file_equal (file, prefix) ||
-	        g_file_has_prefix (file, prefix));
+	return (candidate->mtime >= 0 &&
+	        g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) &&
+	        (gint64) g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) == candidate->mtime);
+}
+
+/* Turns the creation of @item into a move if the store has its
+ * content identifier at a location that was deleted. Returns
+ * %TRUE if the event was handled.
+ */
+static gboolean
+item_apply_reconciled_move (TrackerMinerFS *fs,
+                            ReconcileItem  *item,
+                            GPtrArray      *candidates)
+{
+	g_autoptr (GFile) previous = NULL;
+	ReconcileCandidate *candidate;
+	ParkedDeletion *deletion;
+	QueueEvent *queued_deletion;
+	gboolean is_dir;
+	guint i;
+
+	previous = item_get_reconciled_source (fs, item->file);
+
+	for (i = 0; previous && i < candidates->len; i++) {
+		candidate = g_ptr_array_index (candidates, i);
+
+		if (!g_file_equal (candidate->location, previous) &&
+		    !g_file_equal (candidate->location, item->file))
+			continue;
+
+		/* Carried along with the directory it is in */
+		if (item_matches_stored_content (item->info, candidate)) {
+			TRACKER_NOTE (MINER_FS_EVENTS,
+			              g_message ("'%s' was moved along with its parent, skipping",
+			                         g_file_peek_path (item->file)));
+			return TRUE;
+		}
+
+		return item_add_or_update (fs, item->file, item->info, FALSE, FALSE);
+	}
+
+	for (i = 0; i < candidates->len; i++) {
+		candidate = g_ptr_array_index (candidates, i);
+
+		if (g_file_equal (candidate->location, item->file))
+			return FALSE;
+	}
+
+	for (i = 0; i < candidates->len; i++) {
+		candidate = g_ptr_array_index (candidates, i);
+		is_dir = g_file_info_get_file_type (item->info) == G_FILE_TYPE_DIRECTORY;
+
+		/* Only a location that went away counts, anything
+		 * else is a hardlink or a stale deletion.
+		 */
+		if (candidate->exists ||
+		    !item_find_deletion (fs, candidate->location, &is_dir, &queued_deletion) ||
+		    !item_matches_stored_content (item->info, candidate))
+			continue;
+
+		deletion = tracker_path_index_lookup (fs->priv->parked_deletions,
+		                                      candidate->location);
+		if (deletion)
+			item_unpark_deletion (fs, deletion, FALSE);
+		if (queued_deletion)
+			item_queue_remove_event (fs, queued_deletion);
+
+		if (is_dir) {
+			g_hash_table_insert (fs->priv->reconciled_moves,
+			                     g_object_ref (item->file),
+			                     g_object_ref (candidate->location));
+		}
+
+		TRACKER_NOTE (MINER_FS_EVENTS,
+		              g_message ("'%s' has the same content identifier as deleted '%s', treating as a move",
+		                         g_file_peek_path (item->file),
+		                         g_file_peek_path (candidate->location)));
+
+		return item_move (fs, item->file, candidate->location, is_dir);
+	}
+
+	return FALSE;
+}
+
+static void
+reconcile_item_free (ReconcileItem *item)
+{
+	g_object_unref (item->file);
+	g_clear_object (&item->info);
+	g_free (item->content_id);
+	g_free (item);
+}
+
+static void
+reconcile_candidate_free (ReconcileCandidate *candidate)
+{
+	g_object_unref (candidate->location);
+	g_free (candidate);
+}
+
+static void
+reconcile_batch_free (ReconcileBatch *batch)
+{
+	g_ptr_array_unref (batch->items);
+	g_hash_table_unref (batch->candidates);
+	g_object_unref (batch->cancellable);
+	g_free (batch);
+}
+
+static void reconcile_batch_op_done (ReconcileBatch *batch);
+
+static void
+item_reconcile_batch_apply (ReconcileBatch *batch)
+{
+	TrackerMinerFS *fs = batch->fs;
+	guint i;
+
+	fs->priv->reconciling = FALSE;
+
+	for (i = 0; i < batch->items->len; i++) {
+		ReconcileItem *item = g_ptr_array_index (batch->items, i);
+		GPtrArray *candidates = NULL;
+
+		/* Deferred while the creations before it were pending */
+		item_flush_parked_deletions_for_file (fs, item->file);
+
+		if (item->content_id)
+			candidates = g_hash_table_lookup (batch->candidates, item->content_id);
+
+		if (!candidates || !item->info ||
+		    !item_apply_reconciled_move (fs, item, candidates))
+			item_add_or_update (fs, item->file, item->info, FALSE, TRUE);
+
+		item_account_device (fs, item->file, item->info);
+	}
+
+	reconcile_batch_free (batch);
+
+	item_queue_flush_if_full (fs);
+	item_queue_handlers_set_up (fs);
+}
+
+static void
+candidate_query_info_cb (GObject      *object,
+                         GAsyncResult *result,
+                         gpointer      user_data)
+{
+	ReconcileCandidate *candidate = user_data;
+	g_autoptr (GFileInfo) info = NULL;
+
+	info = g_file_query_info_finish (G_FILE (object), result, NULL);
+	candidate->exists = info != NULL;
+
+	reconcile_batch_op_done (candidate->batch);
+}
+
+static void
+item_reconcile_batch_check_candidates (ReconcileBatch *batch)
+{
+	GHashTableIter iter;
+	GPtrArray *candidates;
+	guint i;
+
+	batch->stage = RECONCILE_STAGE_CHECK_CANDIDATES;
+	batch->n_pending = 1;
+
+	g_hash_table_iter_init (&iter, batch->candidates);
+
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &candidates)) {
+		for (i = 0; i < candidates->len; i++) {
+			ReconcileCandidate *candidate = g_ptr_array_index (candidates, i);
+
+			batch->n_pending++;
+			g_file_query_info_async (candidate->location,
+			                         G_FILE_ATTRIBUTE_STANDARD_TYPE,
+			                         G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+			                         G_PRIORITY_DEFAULT,
+			                         batch->cancellable,
+			                         candidate_query_info_cb,
+			                         candidate);
+		}
+	}
+
+	reconcile_batch_op_done (batch);
+}
+
+static gint64
+cursor_get_unix_time (TrackerSparqlCursor *cursor,
+                      gint                 column)
+{
+	g_autoptr (GDateTime) datetime = NULL;
+
+	if (!tracker_sparql_cursor_is_bound (cursor, column))
+		return -1;
+
+	datetime = tracker_sparql_cursor_get_datetime (cursor, column);
+
+	return datetime ? g_date_time_to_unix (datetime) : -1;
+}
+
+static void
+content_id_cursor_next_cb (GObject      *object,
+                           GAsyncResult *result,
+                           gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor = TRACKER_SPARQL_CURSOR (object);
+	ReconcileBatch *batch = user_data;
+	ReconcileCandidate *candidate;
+	GPtrArray *candidates;
+	GError *error = NULL;
+
+	if (!tracker_sparql_cursor_next_finish (cursor, result, &error)) {
+		if (error && !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("Could not query content identifiers: %s", error->message);
+
+		g_clear_error (&error);
+		tracker_sparql_cursor_close (cursor);
+		g_object_unref (cursor);
+		reconcile_batch_op_done (batch);
+		return;
+	}
+
+	candidates = g_hash_table_lookup (batch->candidates,
+	                                  tracker_sparql_cursor_get_string (cursor, 0, NULL));
+
+	if (candidates) {
+		candidate = g_new0 (ReconcileCandidate, 1);
+		candidate->batch = batch;
+		candidate->location =
+			g_file_new_for_uri (tracker_sparql_cursor_get_string (cursor, 1, NULL));
+		candidate->size = tracker_sparql_cursor_is_bound (cursor, 2) ?
+			tracker_sparql_cursor_get_integer (cursor, 2) : -1;
+		candidate->mtime = cursor_get_unix_time (cursor, 3);
+		candidate->created = cursor_get_unix_time (cursor, 4);
+		g_ptr_array_add (candidates, candidate);
+	}
+
+	tracker_sparql_cursor_next_async (cursor, batch->cancellable,
+	                                  content_id_cursor_next_cb, batch);
+}
+
+static void
+content_id_query_cb (GObject      *object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+	ReconcileBatch *batch = user_data;
+	TrackerSparqlCursor *cursor;
+	GError *error = NULL;
+
+	cursor = tracker_sparql_connection_query_finish (TRACKER_SPARQL_CONNECTION (object),
+	                                                 result, &error);
+
+	if (error) {
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("Could not query content identifiers: %s", error->message);
+
+		g_error_free (error);
+		reconcile_batch_op_done (batch);
+		return;
+	}
+
+	tracker_sparql_cursor_next_async (cursor, batch->cancellable,
+	                                  content_id_cursor_next_cb, batch);
+}
+
+static void
+item_reconcile_batch_lookup (ReconcileBatch *batch)
+{
+	TrackerMinerFS *fs = batch->fs;
+	GString *query;
+	guint i;
+
+	batch->stage = RECONCILE_STAGE_LOOKUP;
+	batch->n_pending = 1;
+
+	query = g_string_new ("SELECT ?id ?url ?fileSize ?lastModified ?created {"
+	                      "  VALUES ?id {");
+
+	for (i = 0; i < batch->items->len; i++) {
+		ReconcileItem *item = g_ptr_array_index (batch->items, i);
+		g_autofree gchar *escaped = NULL;
+		const gchar *content_id;
+
+		/* The content identifier of a link is that of its target */
+		if (!item->info ||
+		    g_file_info_get_file_type (item->info) == G_FILE_TYPE_SYMBOLIC_LINK)
+			continue;
+
+		content_id = item_get_identifier_from_info (fs, item->file, item->info);
+		if (!content_id)
+			continue;
+
+		item->content_id = g_strdup (content_id);
+
+		if (g_hash_table_contains (batch->candidates, content_id))
+			continue;
+
+		g_hash_table_insert (batch->candidates,
+		                     g_strdup (content_id),
+		                     g_ptr_array_new_with_free_func ((GDestroyNotify) reconcile_candidate_free));
+
+		escaped = tracker_sparql_escape_uri_printf ("%s", content_id);
+		g_string_append_printf (query, " <%s>", escaped);
+	}
+
+	g_string_append (query,
+	                 "  }"
+	                 "  GRAPH tracker:FileSystem {"
+	                 "    ?f a nfo:FileDataObject ;"
+	                 "       nie:interpretedAs ?id ;"
+	                 "       nie:url ?url ;"
+	                 "       nfo:fileLastModified ?lastModified ."
+	                 "    OPTIONAL { ?f nfo:fileSize ?fileSize }"
+	                 "    OPTIONAL { ?f nfo:fileCreated ?created }"
+	                 "  }"
+	                 "}");
+
+	if (g_hash_table_size (batch->candidates) > 0) {
+		batch->n_pending++;
+		tracker_sparql_connection_query_async (tracker_miner_get_connection (TRACKER_MINER (fs)),
+		                                       query->str,
+		                                       batch->cancellable,
+		                                       content_id_query_cb,
+		                                       batch);
+	}
+
+	g_string_free (query, TRUE);
+	reconcile_batch_op_done (batch);
+}
+
+static void
+item_query_info_cb (GObject      *object,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+	ReconcileItem *item = user_data;
+	g_autoptr (GFileInfo) info = NULL;
+
+	info = g_file_query_info_finish (G_FILE (object), result, NULL);
+	if (info)
+		g_set_object (&item->info, info);
+
+	reconcile_batch_op_done (item->batch);
+}
+
+static void
+reconcile_batch_op_done (ReconcileBatch *batch)
+{
+	if (--batch->n_pending > 0)
+		return;
+
+	/* The miner is gone */
+	if (g_cancellable_is_cancelled (batch->cancellable)) {
+		reconcile_batch_free (batch);
+		return;
+	}
+
+	switch (batch->stage) {
+	case RECONCILE_STAGE_QUERY_INFO:
+		item_reconcile_batch_lookup (batch);
+		break;
+	case RECONCILE_STAGE_LOOKUP:
+		item_reconcile_batch_check_candidates (batch);
+		break;
+	case RECONCILE_STAGE_CHECK_CANDIDATES:
+		item_reconcile_batch_apply (batch);
+		break;
+	}
+}
+
+/* Looks up whether the store has the content identifiers of the
+ * files created in the current batch at locations that were deleted,
+ * so their creation can be turned into a move. The queue waits
+ * until the batch is handled.
+ */
+static void
+item_reconcile_batch_start (TrackerMinerFS *fs)
+{
+	g_autofree gchar *attributes = NULL;
+	ReconcileBatch *batch;
+	guint i;
+
+	batch = g_steal_pointer (&fs->priv->reconcile_batch);
+	batch->stage = RECONCILE_STAGE_QUERY_INFO;
+	batch->n_pending = 1;
+	fs->priv->reconciling = TRUE;
+
+	attributes = g_strconcat (fs->priv->file_attributes, ",",
+	                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+	                          G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN ","
+	                          G_FILE_ATTRIBUTE_ID_FILESYSTEM ","
+	                          G_FILE_ATTRIBUTE_UNIX_INODE,
+	                          NULL);
+
+	for (i = 0; i < batch->items->len; i++) {
+		ReconcileItem *item = g_ptr_array_index (batch->items, i);
+
+		/* The content identifier needs the filesystem ID */
+		if (item->info &&
+		    tracker_lru_find (fs->priv->urn_lru, item->file, NULL))
+			continue;
+
+		batch->n_pending++;
+		g_file_query_info_async (item->file,
+		                         attributes,
+		                         G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+		                         G_PRIORITY_DEFAULT,
+		                         batch->cancellable,
+		                         item_query_info_cb,
+		                         item);
+	}
+
+	reconcile_batch_op_done (batch);
+}
+
+/* Adds the creation of @file to the batch of creations that may
+ * turn out to be moves. Returns %FALSE if @file needs no lookup.
+ */
+static gboolean
+item_reconcile_move (TrackerMinerFS *fs,
+                     GFile          *file,
+                     GFileInfo      *info)
+{
+	g_autoptr (GFile) previous = NULL;
+	ReconcileBatch *batch = fs->priv->reconcile_batch;
+	ReconcileItem *item;
+
+	if (!TRACKER_MINER_FS_GET_CLASS (fs)->get_content_identifier)
+		return FALSE;
+
+	/* Creations queued after others in the batch wait for
+	 * them, so they are applied in order.
+	 */
+	if (!batch) {
+		item_flush_parked_deletions_for_file (fs, file);
+		previous = item_get_reconciled_source (fs, file);
+
+		if (!previous && g_queue_is_empty (&fs->priv->parked_deletion_queue))
+			return FALSE;
+
+		batch = g_new0 (ReconcileBatch, 1);
+		batch->fs = fs;
+		batch->cancellable = g_object_ref (fs->priv->reconcile_cancellable);
+		batch->items = g_ptr_array_new_with_free_func ((GDestroyNotify) reconcile_item_free);
+		batch->candidates = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+		                                           (GDestroyNotify) g_ptr_array_unref);
+		fs->priv->reconcile_batch = batch;
+	}
+
+	item = g_new0 (ReconcileItem, 1);
+	item->batch = batch;
+	item->file = g_object_ref (file);
+	item->info = info ? g_object_ref (info) : NULL;
+	g_ptr_array_add (batch->items, item);
+
+	return TRUE;
+}
+
+/* Whether the batch of creations must be looked up before going
+ * on with the next event.
+ */
+static gboolean
+item_reconcile_batch_is_due (TrackerMinerFS *fs)
+{
+	QueueEvent *event;
+
+	if (!fs->priv->reconcile_batch)
+		return FALSE;
+
+	if (fs->priv->reconcile_batch->items->len >= RECONCILE_BATCH_SIZE)
+		return TRUE;
+
+	event = tracker_priority_queue_peek (fs->priv->items, NULL);
+
+	return !event || event->type != TRACKER_MINER_FS_EVENT_CREATED;
 }
 
 static void
@@ -1061,9 +1993,9 @@ item_queue_get_next_file (TrackerMinerFS           *fs,
 	if (event) {
 		if (event->type == TRACKER_MINER_FS_EVENT_MOVED) {
 			g_set_object (file, event->dest_file);
-			g_set_object (source_file, event->file);
+			*source_file = tracker_path_index_entry_get_file (event->path_entry);
 		} else {
-			g_set_object (file, event->file);
+			*file = tracker_path_index_entry_get_file (event->path_entry);
 		}
 
 		*type = event->type;
@@ -1071,8 +2003,8 @@ item_queue_get_next_file (TrackerMinerFS           *fs,
 		*is_dir = event->is_dir;
 		g_set_object (info, event->info);
 
-		maybe_remove_file_event_node (fs, event);
-		queue_event_free (event);
+		tracker_path_index_remove (fs->priv->items_by_path, event->path_entry);
+		queue_event_free (event, fs->priv->event_slab);
 	}
 }
 
@@ -1107,6 +2039,36 @@ item_queue_get_progress (TrackerMinerFS *fs,
 	return (gdouble) (items_total - items_to_process) / items_total;
 }
 
+static void
+item_account_device (TrackerMinerFS *fs,
+                     GFile          *file,
+                     GFileInfo      *info)
+{
+	DeviceStats *stats;
+	const gchar *content_id;
+	g_autofree gchar *device = NULL;
+
+	if (!info || !TRACKER_MINER_FS_GET_CLASS (fs)->get_content_identifier)
+		return;
+
+	/* Just handled, so this is a cache hit */
+	content_id = tracker_miner_fs_get_identifier (fs, file);
+	device = tracker_content_identifier_get_filesystem_id (content_id);
+	if (!device)
+		return;
+
+	stats = g_hash_table_lookup (fs->priv->device_stats, device);
+
+	if (!stats) {
+		stats = g_new0 (DeviceStats, 1);
+		g_hash_table_insert (fs->priv->device_stats,
+		                     g_steal_pointer (&device), stats);
+	}
+
+	stats->n_items++;
+	stats->n_bytes += g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_SIZE);
+}
+
 static gboolean
 miner_handle_next_item (TrackerMinerFS *fs)
 {
@@ -1120,6 +2082,11 @@ miner_handle_next_item (TrackerMinerFS *fs)
 	TrackerMinerFSEventType type;
 	GFileInfo *info = NULL;
 
+	if (item_reconcile_batch_is_due (fs)) {
+		item_reconcile_batch_start (fs);
+		return FALSE;
+	}
+
 	item_queue_get_next_file (fs, &file, &source_file, &info, &type,
 	                          &attributes_update, &is_dir);
 
@@ -1212,7 +2179,13 @@ miner_handle_next_item (TrackerMinerFS *fs)
 	}
 
 	if (file == NULL) {
+		/* The queue drained, let the notifier go on */
+		check_notifier_high_water (fs);
+
 		if (!tracker_file_notifier_is_active (fs->priv->file_notifier)) {
+			/* Nothing left that could claim the parked deletions */
+			item_flush_parked_deletions (fs);
+
 			if (!fs->priv->flushing &&
 			    tracker_task_pool_get_size (TRACKER_TASK_POOL (fs->priv->sparql_buffer)) == 0) {
 				/* Print stats and signal finished */
@@ -1239,37 +2212,36 @@ miner_handle_next_item (TrackerMinerFS *fs)
 	/* Handle queues */
 	switch (type) {
 	case TRACKER_MINER_FS_EVENT_MOVED:
+		item_flush_parked_deletions_for_file (fs, source_file);
+		item_flush_parked_deletions_for_file (fs, file);
 		keep_processing = item_move (fs, file, source_file, is_dir);
 		break;
 	case TRACKER_MINER_FS_EVENT_DELETED:
-		keep_processing = item_remove (fs, file, is_dir, FALSE);
+		if (!item_park_deletion (fs, file, is_dir))
+			keep_processing = item_remove (fs, file, is_dir, FALSE);
 		break;
 	case TRACKER_MINER_FS_EVENT_CREATED:
+		if (item_reconcile_move (fs, file, info)) {
+			/* Handled along with its batch */
+			g_clear_object (&file);
+			g_clear_object (&info);
+			return TRUE;
+		}
+
 		keep_processing = item_add_or_update (fs, file, info, FALSE, TRUE);
 		break;
 	case TRACKER_MINER_FS_EVENT_UPDATED:
+		item_flush_parked_deletions_for_file (fs, file);
 		keep_processing = item_add_or_update (fs, file, info, attributes_update, FALSE);
 		break;
 	default:
 		g_assert_not_reached ();
 	}
 
-	if (tracker_task_pool_limit_reached (TRACKER_TASK_POOL (fs->priv->sparql_buffer))) {
-		if (tracker_sparql_buffer_flush (fs->priv->sparql_buffer,
-						 "SPARQL buffer limit reached",
-						 sparql_buffer_flush_cb,
-						 fs)) {
-			fs->priv->flushing = TRUE;
-		} else {
-			/* If we cannot flush, wait for the pending operations
-			 * to finish.
-			 */
-			keep_processing = FALSE;
-		}
+	item_account_device (fs, file, info);
 
-		/* Check if we've finished inserting for given prefixes ... */
-		notify_roots_finished (fs);
-	}
+	if (!item_queue_flush_if_full (fs))
+		keep_processing = FALSE;
 
 	item_queue_handlers_set_up (fs);
 
@@ -1330,6 +2302,11 @@ item_queue_handlers_set_up (TrackerMinerFS *fs)
 		return;
 	}
 
+	if (fs->priv->reconciling) {
+		trace_eq ("   cancelled: waiting for content identifier lookup");
+		return;
+	}
+
 	/* Already processing max number of sparql updates */
 	if (tracker_task_pool_limit_reached (TRACKER_TASK_POOL (fs->priv->sparql_buffer))) {
 		trace_eq ("   cancelled: pool limit reached (sparql buffer: %u)",
@@ -1395,9 +2372,8 @@ assign_root_node (TrackerMinerFS *fs,
 		                     g_object_ref (root), queue);
 	}
 
-	event->root_node = g_list_alloc ();
-	event->root_node->data = queue;
-	g_queue_push_head_link (queue, event->root_node);
+	event->root_link.data = queue;
+	g_queue_push_head_link (queue, &event->root_link);
 }
 
 static void
@@ -1409,32 +2385,23 @@ miner_fs_queue_event (TrackerMinerFS *fs,
 
 	if (event->type == TRACKER_MINER_FS_EVENT_MOVED) {
 		/* Remove all children of the dest location from being processed. */
-		g_hash_table_foreach_remove (fs->priv->items_by_file,
-		                             remove_items_by_file_foreach,
-		                             event->dest_file);
-		tracker_priority_queue_foreach_remove (fs->priv->items,
-						       (GEqualFunc) queue_event_is_equal_or_descendant,
-						       event->dest_file,
-						       (GDestroyNotify) queue_event_free);
+		item_queue_remove_descendants (fs, event->dest_file);
 	}
 
-	old = g_hash_table_lookup (fs->priv->items_by_file, event->file);
+	old = tracker_path_index_lookup (fs->priv->items_by_path, event->file);
 
 	if (old) {
 		QueueCoalesceAction action;
 		QueueEvent *replacement = NULL;
 
-		action = queue_event_coalesce (old, event, &replacement);
+		action = queue_event_coalesce (fs->priv->event_slab,
+		                               old, event, &replacement);
 
-		if (action & QUEUE_ACTION_DELETE_FIRST) {
-			g_hash_table_remove (fs->priv->items_by_file, old->file);
-			tracker_priority_queue_remove_node (fs->priv->items,
-							    old->queue_node);
-			queue_event_free (old);
-		}
+		if (action & QUEUE_ACTION_DELETE_FIRST)
+			item_queue_remove_event (fs, old);
 
 		if (action & QUEUE_ACTION_DELETE_SECOND) {
-			queue_event_free (event);
+			queue_event_free (event, fs->priv->event_slab);
 			event = NULL;
 		}
 
@@ -1444,18 +2411,11 @@ miner_fs_queue_event (TrackerMinerFS *fs,
 
 	if (event) {
 		if (event->is_dir &&
-		    event->type == TRACKER_MINER_FS_EVENT_DELETED &&
-		    g_hash_table_size (fs->priv->items_by_file) < BIG_QUEUE_THRESHOLD) {
+		    event->type == TRACKER_MINER_FS_EVENT_DELETED) {
 			/* Attempt to optimize by removing any children
 			 * of this directory from being processed.
 			 */
-			g_hash_table_foreach_remove (fs->priv->items_by_file,
-			                             remove_items_by_file_foreach,
-			                             event->file);
-			tracker_priority_queue_foreach_remove (fs->priv->items,
-							       (GEqualFunc) queue_event_is_equal_or_descendant,
-							       event->file,
-							       (GDestroyNotify) queue_event_free);
+			item_queue_remove_descendants (fs, event->file);
 		}
 
 		trace_eq_event (event);
@@ -1463,8 +2423,9 @@ miner_fs_queue_event (TrackerMinerFS *fs,
 		assign_root_node (fs, event);
 		event->queue_node =
 			tracker_priority_queue_add (fs->priv->items, event, priority);
-		g_hash_table_replace (fs->priv->items_by_file,
-		                      g_object_ref (event->file), event);
+		event->path_entry =
+			tracker_path_index_add (fs->priv->items_by_path, event->file, event);
+		g_clear_object (&event->file);
 		item_queue_handlers_set_up (fs);
 		check_notifier_high_water (fs);
 	}
@@ -1479,7 +2440,8 @@ file_notifier_file_created (TrackerFileNotifier  *notifier,
 	TrackerMinerFS *fs = user_data;
 	QueueEvent *event;
 
-	event = queue_event_new (TRACKER_MINER_FS_EVENT_CREATED, file, info);
+	event = queue_event_new (fs->priv->event_slab,
+	                         TRACKER_MINER_FS_EVENT_CREATED, file, info);
 	miner_fs_queue_event (fs, event, miner_fs_get_queue_priority (fs, file));
 }
 
@@ -1492,7 +2454,8 @@ file_notifier_file_deleted (TrackerFileNotifier  *notifier,
 	TrackerMinerFS *fs = user_data;
 	QueueEvent *event;
 
-	event = queue_event_new (TRACKER_MINER_FS_EVENT_DELETED, file, NULL);
+	event = queue_event_new (fs->priv->event_slab,
+	                         TRACKER_MINER_FS_EVENT_DELETED, file, NULL);
 	event->is_dir = !!is_dir;
 	miner_fs_queue_event (fs, event, miner_fs_get_queue_priority (fs, file));
 }
@@ -1507,7 +2470,8 @@ file_notifier_file_updated (TrackerFileNotifier  *notifier,
 	TrackerMinerFS *fs = user_data;
 	QueueEvent *event;
 
-	event = queue_event_new (TRACKER_MINER_FS_EVENT_UPDATED, file, info);
+	event = queue_event_new (fs->priv->event_slab,
+	                         TRACKER_MINER_FS_EVENT_UPDATED, file, info);
 	event->attributes_update = attributes_only;
 	miner_fs_queue_event (fs, event, miner_fs_get_queue_priority (fs, file));
 }
@@ -1522,7 +2486,8 @@ file_notifier_file_moved (TrackerFileNotifier *notifier,
 	TrackerMinerFS *fs = user_data;
 	QueueEvent *event;
 
-	event = queue_event_moved_new (source, dest, is_dir);
+	event = queue_event_moved_new (fs->priv->event_slab,
+	                               source, dest, is_dir);
 	miner_fs_queue_event (fs, event, miner_fs_get_queue_priority (fs, source));
 }
 
@@ -1609,7 +2574,6 @@ indexing_tree_directory_removed (TrackerIndexingTree *indexing_tree,
                                  gpointer             user_data)
 {
 	TrackerMinerFS *fs = user_data;
-	TrackerMinerFSPrivate *priv = fs->priv;
 	GTimer *timer = g_timer_new ();
 
 	TRACKER_NOTE (MINER_FS_EVENTS, g_message ("  Cancelled processing pool tasks at %f\n", g_timer_elapsed (timer, NULL)));
@@ -1617,13 +2581,7 @@ indexing_tree_directory_removed (TrackerIndexingTree *indexing_tree,
 	/* Remove anything contained in the removed directory
 	 * from all relevant processing queues.
 	 */
-	g_hash_table_foreach_remove (fs->priv->items_by_file,
-	                             remove_items_by_file_foreach,
-	                             directory);
-	tracker_priority_queue_foreach_remove (priv->items,
-					       (GEqualFunc) queue_event_is_equal_or_descendant,
-					       directory,
-					       (GDestroyNotify) queue_event_free);
+	item_queue_remove_descendants (fs, directory);
 
 	TRACKER_NOTE (MINER_FS_EVENTS, g_message ("  Removed files at %f\n", g_timer_elapsed (timer, NULL)));
 	g_timer_destroy (timer);
@@ -1686,6 +2644,217 @@ tracker_miner_fs_get_throttle (TrackerMinerFS *fs)
 	return fs->priv->throttle;
 }
 
+/**
+ * tracker_miner_fs_get_statistics:
+ * @fs: a #TrackerMinerFS
+ *
+ * Gets the resource statistics kept up to date as batches of
+ * updates are committed by @fs.
+ *
+ * Returns: (transfer none): a #TrackerStatistics
+ **/
+TrackerStatistics *
+tracker_miner_fs_get_statistics (TrackerMinerFS *fs)
+{
+	g_return_val_if_fail (TRACKER_IS_MINER_FS (fs), NULL);
+
+	return tracker_sparql_buffer_get_statistics (fs->priv->sparql_buffer);
+}
+
+/**
+ * tracker_miner_fs_get_timings:
+ * @fs: a #TrackerMinerFS
+ *
+ * Returns the time spent so far in the different indexing phases, as
+ * a floating a{sv} variant with the following keys:
+ *   - "elapsed" (d): Seconds since processing last started
+ *   - "processing" (d): Seconds spent handling queued items
+ *   - "store-query" (d): Seconds spent querying the store contents of indexed folders
+ *   - "crawl" (d): Seconds spent crawling indexed folders
+ *   - "flush" (d): Seconds spent waiting on SPARQL updates
+ *   - "flushes" (u): Number of SPARQL updates
+ *   - "flushed-items" (u): Number of items in those updates
+ *
+ * Crawling and processing happen concurrently, so these don't add up
+ * to the elapsed time.
+ *
+ * Returns: (transfer floating): The timings
+ **/
+GVariant *
+tracker_miner_fs_get_timings (TrackerMinerFS *fs)
+{
+	GVariantBuilder builder;
+	gdouble query_time, crawl_time, flush_time;
+	guint n_flushes, n_flushed_tasks;
+
+	g_return_val_if_fail (TRACKER_IS_MINER_FS (fs), NULL);
+
+	tracker_file_notifier_get_timings (fs->priv->file_notifier,
+	                                   &query_time, &crawl_time);
+	tracker_sparql_buffer_get_timings (fs->priv->sparql_buffer,
+	                                   &flush_time, &n_flushes, &n_flushed_tasks);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "elapsed",
+	                       g_variant_new_double (g_timer_elapsed (fs->priv->timer, NULL)));
+	g_variant_builder_add (&builder, "{sv}", "processing",
+	                       g_variant_new_double (g_timer_elapsed (fs->priv->extraction_timer, NULL)));
+	g_variant_builder_add (&builder, "{sv}", "store-query",
+	                       g_variant_new_double (query_time));
+	g_variant_builder_add (&builder, "{sv}", "crawl",
+	                       g_variant_new_double (crawl_time));
+	g_variant_builder_add (&builder, "{sv}", "flush",
+	                       g_variant_new_double (flush_time));
+	g_variant_builder_add (&builder, "{sv}", "flushes",
+	                       g_variant_new_uint32 (n_flushes));
+	g_variant_builder_add (&builder, "{sv}", "flushed-items",
+	                       g_variant_new_uint32 (n_flushed_tasks));
+
+	return g_variant_builder_end (&builder);
+}
+
+/**
+ * tracker_miner_fs_get_allocator_stats:
+ * @fs: a #TrackerMinerFS
+ *
+ * Returns the allocation statistics of the slabs holding the queued
+ * events and the crawled file data, and those of the event queue, as
+ * a floating a{sv} variant with the "queue-events", "queue" and
+ * "file-data" keys. See tracker_slab_get_stats() and
+ * tracker_priority_queue_get_allocator_stats() for their contents.
+ *
+ * Returns: (transfer floating): The statistics
+ **/
+GVariant *
+tracker_miner_fs_get_allocator_stats (TrackerMinerFS *fs)
+{
+	GVariantBuilder builder;
+
+	g_return_val_if_fail (TRACKER_IS_MINER_FS (fs), NULL);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "queue-events",
+	                       tracker_slab_get_stats (fs->priv->event_slab));
+	g_variant_builder_add (&builder, "{sv}", "queue",
+	                       tracker_priority_queue_get_allocator_stats (fs->priv->items));
+	g_variant_builder_add (&builder, "{sv}", "file-data",
+	                       tracker_file_notifier_get_allocator_stats (fs->priv->file_notifier));
+
+	return g_variant_builder_end (&builder);
+}
+
+/**
+ * tracker_miner_fs_get_device_stats:
+ * @fs: a #TrackerMinerFS
+ *
+ * Returns counters of the created and updated items processed so
+ * far, per device, as a floating a{sv} variant keyed by the filesystem
+ * ID of their content identifiers, the same keys the extractor uses
+ * for its own device statistics. Each value is an a{sv} variant with
+ * the following keys:
+ *   - "items" (u): Number of processed items
+ *   - "bytes" (t): Total size of those items
+ *
+ * Nothing is accounted if the miner does not implement
+ * #TrackerMinerFSClass.get_content_identifier().
+ *
+ * Returns: (transfer floating): The statistics
+ **/
+GVariant *
+tracker_miner_fs_get_device_stats (TrackerMinerFS *fs)
+{
+	GVariantBuilder builder;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_return_val_if_fail (TRACKER_IS_MINER_FS (fs), NULL);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_hash_table_iter_init (&iter, fs->priv->device_stats);
+
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		DeviceStats *stats = value;
+		GVariantBuilder device_builder;
+
+		g_variant_builder_init (&device_builder, G_VARIANT_TYPE_VARDICT);
+		g_variant_builder_add (&device_builder, "{sv}", "items",
+		                       g_variant_new_uint32 (stats->n_items));
+		g_variant_builder_add (&device_builder, "{sv}", "bytes",
+		                       g_variant_new_uint64 (stats->n_bytes));
+		g_variant_builder_add (&builder, "{sv}", (const gchar *) key,
+		                       g_variant_builder_end (&device_builder));
+	}
+
+	return g_variant_builder_end (&builder);
+}
+
+/**
+ * tracker_miner_fs_set_memory_budget:
+ * @fs: a #TrackerMinerFS
+ * @budget: memory budget in bytes, or 0 for no limit
+ *
+ * Sets how much memory the queued events, crawl data and pending
+ * SPARQL updates of @fs should take. When exceeded, crawling is
+ * paused and monitor events are spilled to a file until enough of
+ * the queued work was processed, see
+ * tracker_miner_fs_set_spill_directory().
+ *
+ * The memory taken is estimated, the budget is not a hard limit.
+ **/
+void
+tracker_miner_fs_set_memory_budget (TrackerMinerFS *fs,
+                                    gsize           budget)
+{
+	g_return_if_fail (TRACKER_IS_MINER_FS (fs));
+
+	fs->priv->memory_budget = budget;
+
+	if (budget == 0 && fs->priv->over_budget) {
+		fs->priv->over_budget = FALSE;
+		tracker_file_notifier_set_over_budget (fs->priv->file_notifier, FALSE);
+	}
+}
+
+/**
+ * tracker_miner_fs_set_spill_directory:
+ * @fs: a #TrackerMinerFS
+ * @directory: (nullable): directory to spill monitor events to
+ *
+ * Sets the directory monitor events are spilled to while over the
+ * memory budget. The temporary directory is used if unset, which
+ * may well be backed by memory.
+ **/
+void
+tracker_miner_fs_set_spill_directory (TrackerMinerFS *fs,
+                                      GFile          *directory)
+{
+	g_return_if_fail (TRACKER_IS_MINER_FS (fs));
+
+	tracker_file_notifier_set_spill_directory (fs->priv->file_notifier,
+	                                           directory);
+}
+
+/**
+ * tracker_miner_fs_set_crawl_snapshots:
+ * @fs: a #TrackerMinerFS
+ * @directory: (nullable): directory to keep crawl snapshots in
+ * @checksum: (nullable): checksum of the indexing configuration
+ *
+ * Makes @fs record the state of every crawled directory, so the
+ * next run only needs to crawl the directories that changed in
+ * the meantime. See tracker_file_notifier_set_crawl_snapshots().
+ **/
+void
+tracker_miner_fs_set_crawl_snapshots (TrackerMinerFS *fs,
+                                      GFile          *directory,
+                                      const gchar    *checksum)
+{
+	g_return_if_fail (TRACKER_IS_MINER_FS (fs));
+
+	tracker_file_notifier_set_crawl_snapshots (fs->priv->file_notifier,
+	                                           directory, checksum);
+}
+
 const gchar *
 tracker_miner_fs_get_identifier (TrackerMinerFS *fs,
 				 GFile          *file)
@@ -1742,7 +2911,10 @@ tracker_miner_fs_has_items_to_process (TrackerMinerFS *fs)
 	g_return_val_if_fail (TRACKER_IS_MINER_FS (fs), FALSE);
 
 	if (tracker_file_notifier_is_active (fs->priv->file_notifier) ||
-	    !tracker_priority_queue_is_empty (fs->priv->items)) {
+	    !tracker_priority_queue_is_empty (fs->priv->items) ||
+	    !g_queue_is_empty (&fs->priv->parked_deletion_queue) ||
+	    fs->priv->reconcile_batch ||
+	    fs->priv->reconciling) {
 		return TRUE;
 	}
 
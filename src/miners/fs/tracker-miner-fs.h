@@ -122,6 +122,23 @@ gdouble               tracker_miner_fs_get_throttle          (TrackerMinerFS  *f
 void                  tracker_miner_fs_set_throttle          (TrackerMinerFS  *fs,
                                                               gdouble          throttle);
 
+/* Statistics */
+TrackerStatistics *   tracker_miner_fs_get_statistics        (TrackerMinerFS  *fs);
+GVariant *            tracker_miner_fs_get_timings           (TrackerMinerFS  *fs);
+GVariant *            tracker_miner_fs_get_allocator_stats   (TrackerMinerFS  *fs);
+GVariant *            tracker_miner_fs_get_device_stats      (TrackerMinerFS  *fs);
+
+/* Resources */
+void                  tracker_miner_fs_set_memory_budget     (TrackerMinerFS  *fs,
+                                                              gsize            budget);
+void                  tracker_miner_fs_set_spill_directory   (TrackerMinerFS  *fs,
+                                                              GFile           *directory);
+
+/* Crawling */
+void                  tracker_miner_fs_set_crawl_snapshots   (TrackerMinerFS  *fs,
+                                                              GFile           *directory,
+                                                              const gchar     *checksum);
+
 /* URNs */
 const gchar * tracker_miner_fs_get_identifier (TrackerMinerFS *miner,
                                                GFile          *file);
@@ -0,0 +1,401 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config-miners.h"
+
+#include <string.h>
+
+#include "tracker-memory-estimates.h"
+#include "tracker-path-index.h"
+
+typedef struct _TrackerPathNode TrackerPathNode;
+
+/* Nodes are compact file references, a parent node plus a basename.
+ * Only directories and toplevel nodes keep a GFile, the files of
+ * other nodes are created as needed from their parent's.
+ */
+struct _TrackerPathNode {
+	TrackerPathNode *parent;
+	const gchar *basename;
+	GFile *file;
+	/* Embedded link in the parent's children */
+	GList link;
+	GQueue children;
+	GQueue entries;
+};
+
+struct _TrackerPathIndexEntry {
+	/* Embedded link in the node's entries */
+	GList link;
+	TrackerPathNode *node;
+	gpointer data;
+};
+
+struct _TrackerPathIndex {
+	/* All nodes, by parent node and basename */
+	GHashTable *nodes;
+	/* Nodes that keep a GFile, by file */
+	GHashTable *dirs;
+	guint n_entries;
+	/* Memory taken by nodes and their basenames */
+	gsize node_size;
+};
+
+static guint
+node_hash (gconstpointer key)
+{
+	const TrackerPathNode *node = key;
+
+	return g_direct_hash (node->parent) ^ g_str_hash (node->basename);
+}
+
+static gboolean
+node_equal (gconstpointer a,
+            gconstpointer b)
+{
+	const TrackerPathNode *node_a = a, *node_b = b;
+
+	return (node_a->parent == node_b->parent &&
+	        strcmp (node_a->basename, node_b->basename) == 0);
+}
+
+TrackerPathIndex *
+tracker_path_index_new (void)
+{
+	TrackerPathIndex *index;
+
+	index = g_new0 (TrackerPathIndex, 1);
+	index->nodes = g_hash_table_new (node_hash, node_equal);
+	index->dirs = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+
+	return index;
+}
+
+static void
+node_free (TrackerPathNode *node)
+{
+	GList *l;
+
+	l = node->entries.head;
+	while (l) {
+		TrackerPathIndexEntry *entry = l->data;
+
+		l = l->next;
+		g_slice_free (TrackerPathIndexEntry, entry);
+	}
+
+	g_clear_object (&node->file);
+	g_free (node);
+}
+
+static void
+node_destroy (TrackerPathIndex *index,
+              TrackerPathNode  *node)
+{
+	g_hash_table_remove (index->nodes, node);
+	if (node->file)
+		g_hash_table_remove (index->dirs, node->file);
+
+	index->node_size -= sizeof (TrackerPathNode) + strlen (node->basename) + 1;
+	node_free (node);
+}
+
+void
+tracker_path_index_free (TrackerPathIndex *index)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	g_hash_table_unref (index->dirs);
+
+	g_hash_table_iter_init (&iter, index->nodes);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		node_free (value);
+
+	g_hash_table_unref (index->nodes);
+	g_free (index);
+}
+
+static TrackerPathNode *
+lookup_child (TrackerPathIndex *index,
+              TrackerPathNode  *parent,
+              const gchar      *basename)
+{
+	TrackerPathNode key = { 0, };
+
+	key.parent = parent;
+	key.basename = basename;
+
+	return g_hash_table_lookup (index->nodes, &key);
+}
+
+static TrackerPathNode *
+ensure_node (TrackerPathIndex *index,
+             GFile            *file,
+             gboolean          keep_file)
+{
+	TrackerPathNode *node, *parent_node = NULL;
+	GFile *parent;
+	gchar *basename;
+	gsize len;
+
+	node = g_hash_table_lookup (index->dirs, file);
+	if (node)
+		return node;
+
+	/* Ancestors are created up to the first one already indexed */
+	parent = g_file_get_parent (file);
+	if (parent) {
+		parent_node = ensure_node (index, parent, TRUE);
+		basename = g_file_get_basename (file);
+		g_object_unref (parent);
+	} else {
+		/* Toplevel nodes need their file to build the others' */
+		basename = g_file_get_uri (file);
+		keep_file = TRUE;
+	}
+
+	node = lookup_child (index, parent_node, basename);
+
+	if (!node) {
+		/* The basename is allocated along with the node */
+		len = strlen (basename);
+		node = g_malloc0 (sizeof (TrackerPathNode) + len + 1);
+		node->basename = memcpy (node + 1, basename, len + 1);
+		node->link.data = node;
+		node->parent = parent_node;
+		g_hash_table_add (index->nodes, node);
+		index->node_size += sizeof (TrackerPathNode) + len + 1;
+
+		if (parent_node)
+			g_queue_push_tail_link (&parent_node->children, &node->link);
+	}
+
+	if (keep_file && !node->file) {
+		node->file = g_object_ref (file);
+		g_hash_table_insert (index->dirs, node->file, node);
+	}
+
+	g_free (basename);
+
+	return node;
+}
+
+static TrackerPathNode *
+lookup_node (TrackerPathIndex *index,
+             GFile            *file)
+{
+	TrackerPathNode *node, *parent_node;
+	GFile *parent;
+	gchar *basename;
+
+	node = g_hash_table_lookup (index->dirs, file);
+	if (node)
+		return node;
+
+	/* Nodes with children keep their file, so a node not
+	 * found by file can only be a child of one that is.
+	 */
+	parent = g_file_get_parent (file);
+	if (!parent)
+		return NULL;
+
+	parent_node = g_hash_table_lookup (index->dirs, parent);
+	g_object_unref (parent);
+
+	if (!parent_node)
+		return NULL;
+
+	basename = g_file_get_basename (file);
+	node = lookup_child (index, parent_node, basename);
+	g_free (basename);
+
+	return node;
+}
+
+static void
+prune_node (TrackerPathIndex *index,
+            TrackerPathNode  *node)
+{
+	while (node &&
+	       g_queue_is_empty (&node->entries) &&
+	       g_queue_is_empty (&node->children)) {
+		TrackerPathNode *parent = node->parent;
+
+		if (parent)
+			g_queue_unlink (&parent->children, &node->link);
+
+		node_destroy (index, node);
+		node = parent;
+	}
+}
+
+TrackerPathIndexEntry *
+tracker_path_index_add (TrackerPathIndex *index,
+                        GFile            *file,
+                        gpointer          data)
+{
+	TrackerPathIndexEntry *entry;
+
+	entry = g_slice_new0 (TrackerPathIndexEntry);
+	entry->link.data = entry;
+	entry->data = data;
+	entry->node = ensure_node (index, file, FALSE);
+	g_queue_push_tail_link (&entry->node->entries, &entry->link);
+	index->n_entries++;
+
+	return entry;
+}
+
+void
+tracker_path_index_remove (TrackerPathIndex      *index,
+                           TrackerPathIndexEntry *entry)
+{
+	TrackerPathNode *node = entry->node;
+
+	g_queue_unlink (&node->entries, &entry->link);
+	g_slice_free (TrackerPathIndexEntry, entry);
+	index->n_entries--;
+
+	prune_node (index, node);
+}
+
+/**
+ * tracker_path_index_lookup:
+ * @index: a #TrackerPathIndex
+ * @file: a #GFile
+ *
+ * Returns the data of the last entry added for @file.
+ *
+ * Returns: (transfer none) (nullable): The entry data, or %NULL
+ **/
+gpointer
+tracker_path_index_lookup (TrackerPathIndex *index,
+                           GFile            *file)
+{
+	TrackerPathNode *node;
+	TrackerPathIndexEntry *entry;
+
+	node = lookup_node (index, file);
+	if (!node || g_queue_is_empty (&node->entries))
+		return NULL;
+
+	entry = node->entries.tail->data;
+
+	return entry->data;
+}
+
+/**
+ * tracker_path_index_entry_get_file:
+ * @entry: a #TrackerPathIndexEntry
+ *
+ * Returns the file @entry was added for.
+ *
+ * Returns: (transfer full): a #GFile
+ **/
+GFile *
+tracker_path_index_entry_get_file (TrackerPathIndexEntry *entry)
+{
+	TrackerPathNode *node = entry->node;
+
+	if (node->file)
+		return g_object_ref (node->file);
+
+	return g_file_get_child (node->parent->file, node->basename);
+}
+
+static void
+collect_subtree (TrackerPathIndex  *index,
+                 TrackerPathNode   *node,
+                 GList            **data)
+{
+	GList *l;
+
+	l = node->children.head;
+	while (l) {
+		TrackerPathNode *child = l->data;
+
+		l = l->next;
+		collect_subtree (index, child, data);
+	}
+
+	for (l = node->entries.tail; l; l = l->prev) {
+		TrackerPathIndexEntry *entry = l->data;
+
+		*data = g_list_prepend (*data, entry->data);
+		index->n_entries--;
+	}
+
+	node_destroy (index, node);
+}
+
+/**
+ * tracker_path_index_remove_descendants:
+ * @index: a #TrackerPathIndex
+ * @prefix: a #GFile
+ *
+ * Removes all entries for @prefix and the files contained in it.
+ *
+ * Returns: (transfer container): The data of the removed entries
+ **/
+GList *
+tracker_path_index_remove_descendants (TrackerPathIndex *index,
+                                       GFile            *prefix)
+{
+	TrackerPathNode *node, *parent;
+	GList *data = NULL;
+
+	node = lookup_node (index, prefix);
+	if (!node)
+		return NULL;
+
+	parent = node->parent;
+	if (parent)
+		g_queue_unlink (&parent->children, &node->link);
+
+	collect_subtree (index, node, &data);
+	prune_node (index, parent);
+
+	return data;
+}
+
+guint
+tracker_path_index_get_size (TrackerPathIndex *index)
+{
+	return index->n_entries;
+}
+
+/**
+ * tracker_path_index_get_memory_size:
+ * @index: a #TrackerPathIndex
+ *
+ * Returns an estimate of the memory used by @index, including
+ * the files kept for directory nodes.
+ *
+ * Returns: the size in bytes
+ **/
+gsize
+tracker_path_index_get_memory_size (TrackerPathIndex *index)
+{
+	return (index->node_size +
+	        index->n_entries * sizeof (TrackerPathIndexEntry) +
+	        g_hash_table_size (index->nodes) * ESTIMATED_HASH_SLOT_SIZE +
+	        g_hash_table_size (index->dirs) * (ESTIMATED_HASH_SLOT_SIZE +
+	                                          ESTIMATED_FILE_SIZE));
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+#ifndef __TRACKER_PATH_INDEX_H__
+#define __TRACKER_PATH_INDEX_H__
+
+#include <gio/gio.h>
+
+/* Indexes data by file, laid out as a tree following the filesystem
+ * hierarchy, so all data for a file and its descendants can be found
+ * at a cost proportional to the number of items found. Files are kept
+ * as basenames below their parent directory node, so entries do not
+ * need to hold a GFile of their own.
+ */
+typedef struct _TrackerPathIndex TrackerPathIndex;
+typedef struct _TrackerPathIndexEntry TrackerPathIndexEntry;
+
+TrackerPathIndex * tracker_path_index_new  (void);
+void               tracker_path_index_free (TrackerPathIndex *index);
+
+TrackerPathIndexEntry * tracker_path_index_add (TrackerPathIndex *index,
+                                                GFile            *file,
+                                                gpointer          data);
+void tracker_path_index_remove (TrackerPathIndex      *index,
+                                TrackerPathIndexEntry *entry);
+
+gpointer tracker_path_index_lookup (TrackerPathIndex *index,
+                                    GFile            *file);
+
+GFile * tracker_path_index_entry_get_file (TrackerPathIndexEntry *entry);
+
+GList * tracker_path_index_remove_descendants (TrackerPathIndex *index,
+                                               GFile            *prefix);
+
+guint tracker_path_index_get_size        (TrackerPathIndex *index);
+gsize tracker_path_index_get_memory_size (TrackerPathIndex *index);
+
+#endif /* __TRACKER_PATH_INDEX_H__ */
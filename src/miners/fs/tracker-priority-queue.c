@@ -23,30 +23,61 @@
 
 #include "tracker-priority-queue.h"
 
+#define MIN_SEGMENT_CAPACITY 16
+
 typedef struct PrioritySegment PrioritySegment;
+typedef struct PriorityEntry PriorityEntry;
+
+/* Elements of a same priority are kept in a ring buffer, each with a
+ * sequence number that keeps increasing as elements are added, and
+ * serves as a handle. Elements removed from the middle are left as
+ * %NULL tombstones, the ring is compacted when these take most of
+ * it. Sequence numbers stay sorted along the ring, so the element
+ * of a handle is found through binary search.
+ */
+struct PriorityEntry
+{
+	guint32 seq;
+	gpointer data;
+};
 
 struct PrioritySegment
 {
 	gint priority;
-	GList *first_elem;
-	GList *last_elem;
+	guint32 next_seq;
+	/* Ring positions of the first and past the last element */
+	guint32 head;
+	guint32 tail;
+	guint n_elements;
+	guint capacity;
+	PriorityEntry *entries;
 };
 
 struct _TrackerPriorityQueue
 {
-	GQueue queue;
+	/* Segments, sorted by priority */
 	GArray *segments;
+	guint length;
 
 	gint ref_count;
 };
 
+#define SEGMENT_ENTRY(s,i) ((s)->entries[(i) & ((s)->capacity - 1)])
+#define SEGMENT_SPAN(s) ((guint32) ((s)->tail - (s)->head))
+
+/* Handles keep the priority in the upper half, so the
+ * segment of an element can be looked up.
+ */
+#define NODE_PRIORITY(n) ((gint) (guint32) ((n) >> 32))
+#define NODE_SEQUENCE(n) ((guint32) ((n) & G_MAXUINT32))
+#define NODE(priority,seq) ((((guint64) (guint32) (priority)) << 32) | (seq))
+
 TrackerPriorityQueue *
 tracker_priority_queue_new (void)
 {
 	TrackerPriorityQueue *queue;
 
-	queue = g_slice_new (TrackerPriorityQueue);
-	g_queue_init (&queue->queue);
+	queue = g_slice_new0 (TrackerPriorityQueue);
 	queue->segments = g_array_new (FALSE, FALSE,
 	                               sizeof (PrioritySegment));
 
@@ -66,114 +97,157 @@ void
 tracker_priority_queue_unref (TrackerPriorityQueue *queue)
 {
 	if (g_atomic_int_dec_and_test (&queue->ref_count)) {
-		g_queue_clear (&queue->queue);
+		guint i;
+
+		for (i = 0; i < queue->segments->len; i++) {
+			PrioritySegment *segment;
+
+			segment = &g_array_index (queue->segments, PrioritySegment, i);
+			g_free (segment->entries);
+		}
+
 		g_array_free (queue->segments, TRUE);
 		g_slice_free (TrackerPriorityQueue, queue);
 	}
 }
 
-static void
-queue_insert_before_link (GQueue *queue,
-                          GList  *sibling,
-                          GList  *link_)
-{
-	if (sibling == queue->head)
-		g_queue_push_head_link (queue, link_);
-	else {
-		link_->next = sibling;
-		link_->prev = sibling->prev;
-		sibling->prev->next = link_;
-		sibling->prev = link_;
-		queue->length++;
-	}
-}
-
-static void
-queue_insert_after_link (GQueue *queue,
-                         GList  *sibling,
-                         GList  *link_)
-{
-	if (sibling == queue->tail)
-		g_queue_push_tail_link (queue, link_);
-	else
-		queue_insert_before_link (queue, sibling->next, link_);
-}
-
-static void
-insert_node (TrackerPriorityQueue *queue,
-             gint                  priority,
-             GList                *node)
+/* Performs binary search to find out the segment for the given
+ * priority, returns %FALSE and the position to insert it at if
+ * it isn't found.
+ */
+static gboolean
+find_segment (TrackerPriorityQueue *queue,
+              gint                  priority,
+              guint                *pos)
 {
-	PrioritySegment *segment = NULL;
-	gboolean found = FALSE;
 	gint l, r, c;
 
-	/* Perform binary search to find out the segment for
-	 * the given priority, create one if it isn't found.
-	 */
 	l = 0;
-	r = queue->segments->len - 1;
+	r = (gint) queue->segments->len - 1;
+
+	while (l <= r) {
+		PrioritySegment *segment;
 
-	while (queue->segments->len > 0 && !found) {
 		c = (r + l) / 2;
 		segment = &g_array_index (queue->segments, PrioritySegment, c);
 
 		if (segment->priority == priority) {
-			found = TRUE;
-			break;
+			*pos = c;
+			return TRUE;
 		} else if (segment->priority > priority) {
 			r = c - 1;
-		} else if (segment->priority < priority) {
+		} else {
 			l = c + 1;
 		}
+	}
 
-		if (l > r) {
-			break;
-		}
+	*pos = l;
+	return FALSE;
+}
+
+/* Moves the elements to a ring of the given capacity, dropping
+ * tombstones. Elements keep their sequence number.
+ */
+static void
+segment_resize (PrioritySegment *segment,
+                guint            capacity)
+{
+	PriorityEntry *entries;
+	guint32 i, n = 0;
+
+	entries = g_new (PriorityEntry, capacity);
+
+	for (i = segment->head; i != segment->tail; i++) {
+		if (SEGMENT_ENTRY (segment, i).data)
+			entries[n++] = SEGMENT_ENTRY (segment, i);
 	}
 
-	if (found) {
-		/* Element found, append at the end of segment */
-		g_assert (segment != NULL);
-		g_assert (segment->priority == priority);
+	g_free (segment->entries);
+	segment->entries = entries;
+	segment->capacity = capacity;
+	segment->head = 0;
+	segment->tail = n;
+}
 
-		queue_insert_after_link (&queue->queue, segment->last_elem, node);
-		segment->last_elem = node;
-	} else {
-		PrioritySegment new_segment = { 0 };
+/* Returns the smallest capacity fitting twice the elements */
+static guint
+segment_get_fitting_capacity (PrioritySegment *segment)
+{
+	guint capacity = MIN_SEGMENT_CAPACITY;
 
-		new_segment.priority = priority;
+	while (capacity < segment->n_elements * 2)
+		capacity *= 2;
 
-		if (segment) {
-			g_assert (segment->priority != priority);
-
-			/* Binary search got to one of the closest results,
-			 * but we may have come from either of both sides,
-			 * so check whether we have to insert after the
-			 * segment we got.
-			 */
-			if (segment->priority > priority) {
-				/* We have to insert to the left of this element */
-				queue_insert_before_link (&queue->queue, segment->first_elem, node);
-			} else {
-				/* We have to insert to the right of this element */
-				queue_insert_after_link (&queue->queue, segment->last_elem, node);
-				c++;
-			}
+	return capacity;
+}
 
-			new_segment.first_elem = new_segment.last_elem = node;
-			g_array_insert_val (queue->segments, c, new_segment);
-		} else {
-			/* Segments list has 0 elements */
-			g_assert (queue->segments->len == 0);
-			g_assert (g_queue_get_length (&queue->queue) == 0);
+/* Skips over tombstones at both ends, and drops the segment if it
+ * has no elements left. If tombstones in the middle take most of the
+ * ring, the segment is compacted. Returns %TRUE if the segment was
+ * dropped.
+ */
+static gboolean
+segment_trim (TrackerPriorityQueue *queue,
+              guint                 pos)
+{
+	PrioritySegment *segment;
+
+	segment = &g_array_index (queue->segments, PrioritySegment, pos);
+
+	if (segment->n_elements == 0) {
+		g_free (segment->entries);
+		g_array_remove_index (queue->segments, pos);
+		return TRUE;
+	}
+
+	while (SEGMENT_ENTRY (segment, segment->head).data == NULL)
+		segment->head++;
+	while (SEGMENT_ENTRY (segment, segment->tail - 1).data == NULL)
+		segment->tail--;
+
+	if (SEGMENT_SPAN (segment) > MIN_SEGMENT_CAPACITY &&
+	    segment->n_elements < SEGMENT_SPAN (segment) / 4)
+		segment_resize (segment, segment_get_fitting_capacity (segment));
+
+	return FALSE;
+}
+
+/* Finds the ring position of the element with the given sequence
+ * number, returns %FALSE if it is not in the segment.
+ */
+static gboolean
+segment_find_entry (PrioritySegment *segment,
+                    guint32          seq,
+                    guint32         *pos)
+{
+	guint32 first_seq, offset, l, r;
+
+	/* Segments never start with a tombstone, offsets from the first
+	 * sequence number are increasing along the ring, even if sequence
+	 * numbers wrapped around.
+	 */
+	first_seq = SEGMENT_ENTRY (segment, segment->head).seq;
+	offset = seq - first_seq;
+	l = 0;
+	r = SEGMENT_SPAN (segment);
+
+	while (l < r) {
+		guint32 c, entry_offset;
 
-			g_queue_push_head_link (&queue->queue, node);
-			new_segment.first_elem = new_segment.last_elem = node;
+		c = l + (r - l) / 2;
+		entry_offset = SEGMENT_ENTRY (segment, segment->head + c).seq - first_seq;
 
-			g_array_append_val (queue->segments, new_segment);
+		if (entry_offset == offset) {
+			*pos = segment->head + c;
+			return TRUE;
+		} else if (entry_offset > offset) {
+			r = c;
+		} else {
+			l = c + 1;
 		}
 	}
+
+	return FALSE;
 }
 
 void
@@ -181,10 +255,24 @@ tracker_priority_queue_foreach (TrackerPriorityQueue *queue,
                                 GFunc                 func,
                                 gpointer              user_data)
 {
+	guint i;
+
 	g_return_if_fail (queue != NULL);
 	g_return_if_fail (func != NULL);
 
-	g_queue_foreach (&queue->queue, func, user_data);
+	for (i = 0; i < queue->segments->len; i++) {
+		PrioritySegment *segment;
+		guint32 idx;
+
+		segment = &g_array_index (queue->segments, PrioritySegment, i);
+
+		for (idx = segment->head; idx != segment->tail; idx++) {
+			gpointer data = SEGMENT_ENTRY (segment, idx).data;
+
+			if (data)
+				func (data, user_data);
+		}
+	}
 }
 
 gboolean
@@ -193,68 +281,35 @@ tracker_priority_queue_foreach_remove (TrackerPriorityQueue *queue,
                                        gpointer              compare_user_data,
                                        GDestroyNotify        destroy_notify)
 {
-	PrioritySegment *segment;
-	gint n_segment = 0;
 	gboolean updated = FALSE;
-	GList *list;
+	guint i = 0;
 
 	g_return_val_if_fail (queue != NULL, FALSE);
 	g_return_val_if_fail (compare_func != NULL, FALSE);
 
-	list = queue->queue.head;
+	while (i < queue->segments->len) {
+		PrioritySegment *segment;
+		guint32 idx;
 
-	if (!list) {
-		return FALSE;
-	}
+		segment = &g_array_index (queue->segments, PrioritySegment, i);
 
-	segment = &g_array_index (queue->segments, PrioritySegment, n_segment);
-
-	while (list) {
-		gboolean fetch_segment = FALSE;
-		GList *elem;
-
-		elem = list;
-		list = list->next;
-
-		if ((compare_func) (elem->data, compare_user_data)) {
-			/* Update segment limits */
-			if (elem == segment->first_elem &&
-			    elem == segment->last_elem) {
-				/* Last element of segment, remove it */
-				g_array_remove_index (queue->segments,
-				                      n_segment);
-				fetch_segment = TRUE;
-			} else if (elem == segment->first_elem) {
-				/* First elemen in segment */
-				segment->first_elem = elem->next;
-			} else if (elem == segment->last_elem) {
-				segment->last_elem = elem->prev;
-				n_segment++;
-				fetch_segment = TRUE;
-			}
+		for (idx = segment->head; idx != segment->tail; idx++) {
+			gpointer data = SEGMENT_ENTRY (segment, idx).data;
 
-			if (destroy_notify) {
-				(destroy_notify) (elem->data);
-			}
+			if (!data || !(compare_func) (data, compare_user_data))
+				continue;
 
-			g_queue_delete_link (&queue->queue, elem);
+			SEGMENT_ENTRY (segment, idx).data = NULL;
+			segment->n_elements--;
+			queue->length--;
 			updated = TRUE;
-		} else {
-			if (list != NULL &&
-			    elem == segment->last_elem) {
-				/* Move on to the next segment */
-				n_segment++;
-				fetch_segment = TRUE;
-			}
-		}
 
-		if (list && fetch_segment) {
-			/* Fetch the next segment */
-			g_assert (n_segment < queue->segments->len);
-			segment = &g_array_index (queue->segments,
-			                          PrioritySegment,
-			                          n_segment);
+			if (destroy_notify)
+				(destroy_notify) (data);
 		}
+
+		if (!segment_trim (queue, i))
+			i++;
 	}
 
 	return updated;
@@ -265,7 +320,7 @@ tracker_priority_queue_is_empty (TrackerPriorityQueue *queue)
 {
 	g_return_val_if_fail (queue != NULL, FALSE);
 
-	return g_queue_is_empty (&queue->queue);
+	return queue->length == 0;
 }
 
 guint
@@ -273,66 +328,72 @@ tracker_priority_queue_get_length (TrackerPriorityQueue *queue)
 {
 	g_return_val_if_fail (queue != NULL, 0);
 
-	return g_queue_get_length (&queue->queue);
+	return queue->length;
 }
 
-GList *
+TrackerPriorityQueueNode
 tracker_priority_queue_add (TrackerPriorityQueue *queue,
                             gpointer              data,
                             gint                  priority)
 {
-	GList *node;
+	PrioritySegment *segment;
+	guint32 seq;
+	guint pos;
 
-	g_return_val_if_fail (queue != NULL, NULL);
-	g_return_val_if_fail (data != NULL, NULL);
+	g_return_val_if_fail (queue != NULL, 0);
+	g_return_val_if_fail (data != NULL, 0);
 
-	node = g_list_alloc ();
-	node->data = data;
-	insert_node (queue, priority, node);
+	if (!find_segment (queue, priority, &pos)) {
+		PrioritySegment new_segment = { 0 };
 
-	return node;
-}
+		new_segment.priority = priority;
+		g_array_insert_val (queue->segments, pos, new_segment);
+	}
 
-void
-tracker_priority_queue_add_node (TrackerPriorityQueue *queue,
-                                 GList                *node,
-                                 gint                  priority)
-{
-	g_return_if_fail (queue != NULL);
-	g_return_if_fail (node != NULL);
+	segment = &g_array_index (queue->segments, PrioritySegment, pos);
+
+	if (SEGMENT_SPAN (segment) == segment->capacity) {
+		/* Grow the ring, unless dropping tombstones is enough */
+		segment_resize (segment,
+		                MAX (segment_get_fitting_capacity (segment),
+		                     segment->capacity));
+	}
 
-	insert_node (queue, priority, node);
+	seq = segment->next_seq++;
+	SEGMENT_ENTRY (segment, segment->tail).seq = seq;
+	SEGMENT_ENTRY (segment, segment->tail).data = data;
+	segment->tail++;
+	segment->n_elements++;
+	queue->length++;
+
+	return NODE (priority, seq);
 }
 
 void
-tracker_priority_queue_remove_node (TrackerPriorityQueue *queue,
-                                    GList                *node)
+tracker_priority_queue_remove_node (TrackerPriorityQueue     *queue,
+                                    TrackerPriorityQueueNode  node)
 {
-	guint i;
+	PrioritySegment *segment;
+	guint32 idx;
+	guint pos;
 
 	g_return_if_fail (queue != NULL);
 
-	/* Check if it is the first or last of a segment */
-	for (i = 0; i < queue->segments->len; i++) {
-		PrioritySegment *segment;
+	if (!find_segment (queue, NODE_PRIORITY (node), &pos))
+		g_return_if_reached ();
 
-		segment = &g_array_index (queue->segments, PrioritySegment, i);
+	segment = &g_array_index (queue->segments, PrioritySegment, pos);
 
-		if (segment->first_elem == node) {
-			if (segment->last_elem == node)
-				g_array_remove_index (queue->segments, i);
-			else
-				segment->first_elem = node->next;
-			break;
-		}
+	if (!segment_find_entry (segment, NODE_SEQUENCE (node), &idx))
+		g_return_if_reached ();
 
-		if (segment->last_elem == node) {
-			segment->last_elem = node->prev;
-			break;
-		}
-	}
+	g_return_if_fail (SEGMENT_ENTRY (segment, idx).data != NULL);
 
-	g_queue_delete_link (&queue->queue, node);
+	SEGMENT_ENTRY (segment, idx).data = NULL;
+	segment->n_elements--;
+	queue->length--;
+
+	segment_trim (queue, pos);
 }
 
 gpointer
@@ -341,36 +402,27 @@ tracker_priority_queue_find (TrackerPriorityQueue *queue,
                              GEqualFunc            compare_func,
                              gpointer              user_data)
 {
-	PrioritySegment *segment;
-	gint n_segment = 0;
-	GList *list;
+	guint i;
 
 	g_return_val_if_fail (queue != NULL, NULL);
 	g_return_val_if_fail (compare_func != NULL, NULL);
 
-	list = queue->queue.head;
-	segment = &g_array_index (queue->segments, PrioritySegment, n_segment);
+	for (i = 0; i < queue->segments->len; i++) {
+		PrioritySegment *segment;
+		guint32 idx;
 
-	while (list) {
-		if ((compare_func) (list->data, user_data)) {
-			if (priority_out) {
-				*priority_out = segment->priority;
-			}
+		segment = &g_array_index (queue->segments, PrioritySegment, i);
 
-			return list->data;
-		}
+		for (idx = segment->head; idx != segment->tail; idx++) {
+			gpointer data = SEGMENT_ENTRY (segment, idx).data;
 
-		if (list->next != NULL &&
-		    list == segment->last_elem) {
-			/* Move on to the next segment */
-			n_segment++;
-			g_assert (n_segment < queue->segments->len);
-			segment = &g_array_index (queue->segments,
-			                          PrioritySegment,
-			                          n_segment);
-		}
+			if (data && (compare_func) (data, user_data)) {
+				if (priority_out)
+					*priority_out = segment->priority;
 
-		list = list->next;
+				return data;
+			}
+		}
 	}
 
 	return NULL;
@@ -380,76 +432,92 @@ gpointer
 tracker_priority_queue_peek (TrackerPriorityQueue *queue,
                              gint                 *priority_out)
 {
+	PrioritySegment *segment;
+
 	g_return_val_if_fail (queue != NULL, NULL);
 
-	if (priority_out && queue->segments->len > 0) {
-		PrioritySegment *segment;
+	if (queue->segments->len == 0)
+		return NULL;
 
-		segment = &g_array_index (queue->segments, PrioritySegment, 0);
+	/* Segments are never empty, nor start with a tombstone */
+	segment = &g_array_index (queue->segments, PrioritySegment, 0);
+
+	if (priority_out)
 		*priority_out = segment->priority;
-	}
 
-	return g_queue_peek_head (&queue->queue);
+	return SEGMENT_ENTRY (segment, segment->head).data;
 }
 
 gpointer
 tracker_priority_queue_pop (TrackerPriorityQueue *queue,
                             gint                 *priority_out)
-{
-	GList *node;
-	gpointer data;
-
-	node = tracker_priority_queue_pop_node (queue, priority_out);
-	if (node == NULL)
-		return NULL;
-
-	data = node->data;
-	g_list_free_1 (node);
-
-	return data;
-}
-
-GList *
-tracker_priority_queue_pop_node (TrackerPriorityQueue *queue,
-                                 gint                 *priority_out)
 {
 	PrioritySegment *segment;
-	GList *node;
+	gpointer data;
 
 	g_return_val_if_fail (queue != NULL, NULL);
 
-	node = g_queue_peek_head_link (&queue->queue);
-
-	if (!node) {
-		/* No elements in queue */
+	if (queue->segments->len == 0)
 		return NULL;
-	}
 
 	segment = &g_array_index (queue->segments, PrioritySegment, 0);
-	g_assert (segment->first_elem == node);
 
-	if (priority_out) {
+	if (priority_out)
 		*priority_out = segment->priority;
-	}
 
-	if (segment->last_elem == node) {
-		/* It is the last element of the first
-		 * segment, remove segment as well.
-		 */
-		g_array_remove_index (queue->segments, 0);
-	} else {
+	data = SEGMENT_ENTRY (segment, segment->head).data;
+	SEGMENT_ENTRY (segment, segment->head).data = NULL;
+	segment->n_elements--;
+	queue->length--;
 
-		/* Move segments first element forward */
-		segment->first_elem = segment->first_elem->next;
-	}
+	segment_trim (queue, 0);
 
-	return g_queue_pop_head_link (&queue->queue);
+	return data;
 }
 
-GList *
-tracker_priority_queue_get_head (TrackerPriorityQueue *queue)
+/**
+ * tracker_priority_queue_get_allocator_stats:
+ * @queue: a #TrackerPriorityQueue
+ *
+ * Returns the memory usage of @queue, as a floating a{sv} variant
+ * with the following keys:
+ *   - "segments" (u): Number of priorities with queued elements
+ *   - "capacity" (u): Number of slots allocated
+ *   - "in-use" (u): Number of queued elements
+ *   - "tombstones" (u): Number of removed elements still taking a slot
+ *   - "fragmentation" (d): Ratio of allocated slots not in use
+ *
+ * Returns: (transfer floating): The statistics
+ **/
+GVariant *
+tracker_priority_queue_get_allocator_stats (TrackerPriorityQueue *queue)
 {
+	GVariantBuilder builder;
+	guint i, capacity = 0, tombstones = 0;
+
 	g_return_val_if_fail (queue != NULL, NULL);
 
-	return queue->queue.head;
+	for (i = 0; i < queue->segments->len; i++) {
+		PrioritySegment *segment;
+
+		segment = &g_array_index (queue->segments, PrioritySegment, i);
+		capacity += segment->capacity;
+		tombstones += SEGMENT_SPAN (segment) - segment->n_elements;
+	}
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "segments",
+	                       g_variant_new_uint32 (queue->segments->len));
+	g_variant_builder_add (&builder, "{sv}", "capacity",
+	                       g_variant_new_uint32 (capacity));
+	g_variant_builder_add (&builder, "{sv}", "in-use",
+	                       g_variant_new_uint32 (queue->length));
+	g_variant_builder_add (&builder, "{sv}", "tombstones",
+	                       g_variant_new_uint32 (tombstones));
+	g_variant_builder_add (&builder, "{sv}", "fragmentation",
+	                       g_variant_new_double (capacity > 0 ?
+	                                             1.0 - (gdouble) queue->length / capacity :
+	                                             0.0));
+
+	return g_variant_builder_end (&builder);
 }
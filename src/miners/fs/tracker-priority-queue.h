@@ -28,6 +28,9 @@ G_BEGIN_DECLS
 
 typedef struct _TrackerPriorityQueue TrackerPriorityQueue;
 
+/* Stable handle to a queued element, valid until it is popped or removed */
+typedef guint64 TrackerPriorityQueueNode;
+
 TrackerPriorityQueue *tracker_priority_queue_new   (void);
 
 TrackerPriorityQueue *tracker_priority_queue_ref   (TrackerPriorityQueue *queue);
@@ -37,9 +40,9 @@ gboolean tracker_priority_queue_is_empty           (TrackerPriorityQueue *queue)
 
 guint    tracker_priority_queue_get_length         (TrackerPriorityQueue *queue);
 
-GList *  tracker_priority_queue_add     (TrackerPriorityQueue *queue,
-                                         gpointer              data,
-                                         gint                  priority);
+TrackerPriorityQueueNode tracker_priority_queue_add (TrackerPriorityQueue *queue,
+                                                     gpointer              data,
+                                                     gint                  priority);
 void     tracker_priority_queue_foreach (TrackerPriorityQueue *queue,
                                          GFunc                 func,
                                          gpointer              user_data);
@@ -59,14 +62,10 @@ gpointer tracker_priority_queue_peek    (TrackerPriorityQueue *queue,
 gpointer tracker_priority_queue_pop     (TrackerPriorityQueue *queue,
                                          gint                 *priority_out);
 
-GList *  tracker_priority_queue_get_head    (TrackerPriorityQueue *queue);
-void     tracker_priority_queue_add_node    (TrackerPriorityQueue *queue,
-                                             GList                *node,
-                                             gint                  priority);
-void     tracker_priority_queue_remove_node (TrackerPriorityQueue  *queue,
-                                             GList                 *node);
-GList *  tracker_priority_queue_pop_node    (TrackerPriorityQueue *queue,
-                                             gint                 *priority_out);
+void     tracker_priority_queue_remove_node (TrackerPriorityQueue     *queue,
+                                             TrackerPriorityQueueNode  node);
+
+GVariant * tracker_priority_queue_get_allocator_stats (TrackerPriorityQueue *queue);
 
 
 G_END_DECLS
@@ -0,0 +1,789 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include "config-miners.h"
+
+#include <string.h>
+
+#include "tracker-query-cache.h"
+
+#include "libtracker-miners-common/tracker-debug.h"
+
+/* Results bigger than this fraction of the cache are handed
+ * out, but not kept.
+ */
+#define MAX_ENTRY_FRACTION 8
+
+/* Results are returned over D-Bus in a single message, queries
+ * producing more than this are failed, they should use LIMIT.
+ */
+#define MAX_ROWS 10000
+#define MAX_RESULT_SIZE (16 * 1024 * 1024)
+
+/* Changes to classes without tracker:notify made by other clients
+ * of the endpoint (e.g. tags set with "localsearch tag") are not
+ * noticed, results older than this are not reused.
+ */
+#define MAX_ENTRY_AGE_USEC (30 * G_USEC_PER_SEC)
+
+typedef struct _CacheEntry CacheEntry;
+typedef struct _QueryJob QueryJob;
+
+struct _CacheEntry
+{
+	gchar *key;
+	GVariant *result;
+	gsize size;
+	gint64 created;
+	GList *link;
+};
+
+struct _TrackerQueryCache
+{
+	GObject parent_instance;
+	TrackerSparqlConnection *connection;
+	TrackerStatistics *statistics;
+	TrackerNotifier *notifier;
+
+	/* Normalized query -> CacheEntry */
+	GHashTable *entries;
+	/* Most recently used entries first */
+	GQueue lru;
+
+	gsize max_size;
+	gsize size;
+
+	/* Commit sequence the cached results reflect */
+	guint64 sequence;
+	/* Bumped on every invalidation, so results of queries
+	 * running across a change are not stored.
+	 */
+	guint64 generation;
+
+	guint64 hits;
+	guint64 misses;
+	guint64 evictions;
+};
+
+struct _QueryJob
+{
+	TrackerQueryCache *cache;
+	TrackerSparqlStatement *statement;
+	gchar *key;
+	GTask *task;
+	GPtrArray *columns;
+	GVariantBuilder rows;
+	guint64 generation;
+	gsize size;
+	guint n_rows;
+	gint n_columns;
+};
+
+enum {
+	PROP_0,
+	PROP_CONNECTION,
+	PROP_STATISTICS,
+	PROP_MAX_SIZE,
+	N_PROPS,
+};
+
+static GParamSpec *props[N_PROPS] = { 0, };
+
+G_DEFINE_TYPE (TrackerQueryCache, tracker_query_cache, G_TYPE_OBJECT)
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+	g_free (entry->key);
+	g_variant_unref (entry->result);
+	g_slice_free (CacheEntry, entry);
+}
+
+static void
+notifier_events_cb (TrackerQueryCache *cache)
+{
+	/* Updates done through the endpoint (e.g. by the extractor)
+	 * do not go through the miner SPARQL buffer.
+	 */
+	tracker_query_cache_invalidate (cache);
+}
+
+static void
+tracker_query_cache_init (TrackerQueryCache *cache)
+{
+	cache->entries =
+		g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+		                       (GDestroyNotify) cache_entry_free);
+	g_queue_init (&cache->lru);
+}
+
+static void
+tracker_query_cache_constructed (GObject *object)
+{
+	TrackerQueryCache *cache = TRACKER_QUERY_CACHE (object);
+
+	G_OBJECT_CLASS (tracker_query_cache_parent_class)->constructed (object);
+
+	if (cache->statistics)
+		cache->sequence = tracker_statistics_get_sequence (cache->statistics);
+
+	cache->notifier = tracker_sparql_connection_create_notifier (cache->connection);
+	g_signal_connect_swapped (cache->notifier, "events",
+	                          G_CALLBACK (notifier_events_cb), cache);
+}
+
+static void
+tracker_query_cache_finalize (GObject *object)
+{
+	TrackerQueryCache *cache = TRACKER_QUERY_CACHE (object);
+
+	g_queue_clear (&cache->lru);
+	g_hash_table_unref (cache->entries);
+	g_clear_object (&cache->notifier);
+	g_clear_object (&cache->statistics);
+	g_clear_object (&cache->connection);
+
+	G_OBJECT_CLASS (tracker_query_cache_parent_class)->finalize (object);
+}
+
+static void
+tracker_query_cache_set_property (GObject      *object,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+	TrackerQueryCache *cache = TRACKER_QUERY_CACHE (object);
+
+	switch (prop_id) {
+	case PROP_CONNECTION:
+		cache->connection = g_value_dup_object (value);
+		break;
+	case PROP_STATISTICS:
+		cache->statistics = g_value_dup_object (value);
+		break;
+	case PROP_MAX_SIZE:
+		cache->max_size = g_value_get_uint64 (value);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+tracker_query_cache_get_property (GObject    *object,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+	TrackerQueryCache *cache = TRACKER_QUERY_CACHE (object);
+
+	switch (prop_id) {
+	case PROP_CONNECTION:
+		g_value_set_object (value, cache->connection);
+		break;
+	case PROP_STATISTICS:
+		g_value_set_object (value, cache->statistics);
+		break;
+	case PROP_MAX_SIZE:
+		g_value_set_uint64 (value, cache->max_size);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+tracker_query_cache_class_init (TrackerQueryCacheClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->constructed = tracker_query_cache_constructed;
+	object_class->finalize = tracker_query_cache_finalize;
+	object_class->set_property = tracker_query_cache_set_property;
+	object_class->get_property = tracker_query_cache_get_property;
+
+	props[PROP_CONNECTION] =
+		g_param_spec_object ("connection",
+		                     NULL, NULL,
+		                     TRACKER_SPARQL_TYPE_CONNECTION,
+		                     G_PARAM_READWRITE |
+		                     G_PARAM_CONSTRUCT_ONLY |
+		                     G_PARAM_STATIC_STRINGS);
+	props[PROP_STATISTICS] =
+		g_param_spec_object ("statistics",
+		                     NULL, NULL,
+		                     TRACKER_TYPE_STATISTICS,
+		                     G_PARAM_READWRITE |
+		                     G_PARAM_CONSTRUCT_ONLY |
+		                     G_PARAM_STATIC_STRINGS);
+	props[PROP_MAX_SIZE] =
+		g_param_spec_uint64 ("max-size",
+		                     NULL, NULL,
+		                     0, G_MAXUINT64, 0,
+		                     G_PARAM_READWRITE |
+		                     G_PARAM_CONSTRUCT_ONLY |
+		                     G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties (object_class, N_PROPS, props);
+}
+
+/**
+ * tracker_query_cache_new:
+ * @connection: the connection queries are run on
+ * @statistics: (nullable): the #TrackerStatistics of the miner SPARQL buffer
+ * @max_size: memory in bytes used for cached results
+ *
+ * Creates a cache of SELECT query results. Cached results are dropped
+ * whenever the change sequence of @statistics moves forward, which
+ * happens on every batch committed by the miner and on changes notified
+ * by the connection. Results are reused for 30 seconds at most, as
+ * changes made elsewhere to classes that are not notified go unnoticed.
+ *
+ * Returns: (transfer full): a new #TrackerQueryCache
+ **/
+TrackerQueryCache *
+tracker_query_cache_new (TrackerSparqlConnection *connection,
+                         TrackerStatistics       *statistics,
+                         gsize                    max_size)
+{
+	return g_object_new (TRACKER_TYPE_QUERY_CACHE,
+	                     "connection", connection,
+	                     "statistics", statistics,
+	                     "max-size", (guint64) max_size,
+	                     NULL);
+}
+
+/**
+ * tracker_query_cache_invalidate:
+ * @cache: a #TrackerQueryCache
+ *
+ * Drops all cached results.
+ **/
+void
+tracker_query_cache_invalidate (TrackerQueryCache *cache)
+{
+	g_return_if_fail (TRACKER_IS_QUERY_CACHE (cache));
+
+	cache->generation++;
+
+	if (cache->size == 0)
+		return;
+
+	TRACKER_NOTE (MINER_FS_EVENTS,
+	              g_message ("(Query cache) Dropping %u results",
+	                         g_hash_table_size (cache->entries)));
+
+	g_queue_clear (&cache->lru);
+	g_hash_table_remove_all (cache->entries);
+	cache->size = 0;
+}
+
+static void
+check_sequence (TrackerQueryCache *cache)
+{
+	guint64 sequence;
+
+	if (!cache->statistics)
+		return;
+
+	sequence = tracker_statistics_get_sequence (cache->statistics);
+	if (sequence == cache->sequence)
+		return;
+
+	cache->sequence = sequence;
+	tracker_query_cache_invalidate (cache);
+}
+
+static gsize
+skip_string_literal (const gchar *str)
+{
+	const gchar *p = str;
+	gchar quote = *p;
+	gboolean triple;
+
+	triple = (p[1] == quote && p[2] == quote);
+	p += triple ? 3 : 1;
+
+	while (*p) {
+		if (*p == '\\' && p[1] != '\0') {
+			p += 2;
+		} else if (*p == quote) {
+			if (!triple)
+				return p - str + 1;
+			if (p[1] == quote && p[2] == quote)
+				return p - str + 3;
+			p++;
+		} else {
+			p++;
+		}
+	}
+
+	return p - str;
+}
+
+static gchar *
+normalize_query (const gchar *sparql)
+{
+	GString *str;
+	const gchar *p = sparql;
+
+	str = g_string_sized_new (strlen (sparql));
+
+	while (*p) {
+		if (g_ascii_isspace (*p)) {
+			while (g_ascii_isspace (*p))
+				p++;
+
+			/* Whitespace runs collapse into one, except
+			 * at the start and end of the query.
+			 */
+			if (str->len > 0 && *p != '\0')
+				g_string_append_c (str, ' ');
+		} else if (*p == '"' || *p == '\'') {
+			gsize len;
+
+			/* String literals are kept verbatim */
+			len = skip_string_literal (p);
+			g_string_append_len (str, p, len);
+			p += len;
+		} else {
+			g_string_append_c (str, *p);
+			p++;
+		}
+	}
+
+	return g_string_free (str, FALSE);
+}
+
+static gint
+compare_parameters (gconstpointer a,
+                    gconstpointer b)
+{
+	return g_strcmp0 (*(const gchar **) a, *(const gchar **) b);
+}
+
+static gchar *
+create_key (const gchar *sparql,
+            GVariant    *parameters)
+{
+	g_autoptr (GPtrArray) names = NULL;
+	g_autofree gchar *query = NULL;
+	GVariantIter iter;
+	GString *key;
+	const gchar *name;
+	guint i;
+
+	query = normalize_query (sparql);
+
+	if (!parameters || g_variant_n_children (parameters) == 0)
+		return g_steal_pointer (&query);
+
+	key = g_string_new (query);
+	names = g_ptr_array_new ();
+
+	g_variant_iter_init (&iter, parameters);
+	while (g_variant_iter_next (&iter, "{&sv}", &name, NULL))
+		g_ptr_array_add (names, (gpointer) name);
+
+	/* Parameters may come in any order */
+	g_ptr_array_sort (names, compare_parameters);
+
+	for (i = 0; i < names->len; i++) {
+		g_autoptr (GVariant) value = NULL;
+		g_autofree gchar *printed = NULL;
+
+		name = g_ptr_array_index (names, i);
+		value = g_variant_lookup_value (parameters, name, NULL);
+		printed = g_variant_print (value, TRUE);
+		g_string_append_printf (key, "\n~%s=%s", name, printed);
+	}
+
+	return g_string_free (key, FALSE);
+}
+
+static gboolean
+bind_parameters (TrackerSparqlStatement  *stmt,
+                 GVariant                *parameters,
+                 GError                 **error)
+{
+	GVariantIter iter;
+	const gchar *name;
+	GVariant *value;
+
+	if (!parameters)
+		return TRUE;
+
+	g_variant_iter_init (&iter, parameters);
+	while (g_variant_iter_next (&iter, "{&sv}", &name, &value)) {
+		if (g_variant_is_of_type (value, G_VARIANT_TYPE_STRING)) {
+			tracker_sparql_statement_bind_string (stmt, name,
+			                                      g_variant_get_string (value, NULL));
+		} else if (g_variant_is_of_type (value, G_VARIANT_TYPE_INT64)) {
+			tracker_sparql_statement_bind_int (stmt, name,
+			                                   g_variant_get_int64 (value));
+		} else if (g_variant_is_of_type (value, G_VARIANT_TYPE_INT32)) {
+			tracker_sparql_statement_bind_int (stmt, name,
+			                                   g_variant_get_int32 (value));
+		} else if (g_variant_is_of_type (value, G_VARIANT_TYPE_BOOLEAN)) {
+			tracker_sparql_statement_bind_boolean (stmt, name,
+			                                       g_variant_get_boolean (value));
+		} else if (g_variant_is_of_type (value, G_VARIANT_TYPE_DOUBLE)) {
+			tracker_sparql_statement_bind_double (stmt, name,
+			                                      g_variant_get_double (value));
+		} else {
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+			             "Unhandled type '%s' for parameter '%s'",
+			             g_variant_get_type_string (value), name);
+			g_variant_unref (value);
+			return FALSE;
+		}
+
+		g_variant_unref (value);
+	}
+
+	return TRUE;
+}
+
+static void
+evict_entries (TrackerQueryCache *cache)
+{
+	while (cache->size > cache->max_size) {
+		CacheEntry *entry;
+
+		entry = g_queue_pop_tail (&cache->lru);
+		if (!entry)
+			break;
+
+		cache->size -= entry->size;
+		cache->evictions++;
+		g_hash_table_remove (cache->entries, entry->key);
+	}
+}
+
+static void
+insert_entry (TrackerQueryCache *cache,
+              gchar             *key,
+              GVariant          *result,
+              gsize              size)
+{
+	CacheEntry *entry;
+
+	/* The same query may have been run twice concurrently */
+	entry = g_hash_table_lookup (cache->entries, key);
+	if (entry) {
+		g_queue_delete_link (&cache->lru, entry->link);
+		cache->size -= entry->size;
+		g_hash_table_remove (cache->entries, key);
+	}
+
+	entry = g_slice_new0 (CacheEntry);
+	entry->key = key;
+	entry->result = g_variant_ref (result);
+	entry->size = size;
+	entry->created = g_get_monotonic_time ();
+
+	g_queue_push_head (&cache->lru, entry);
+	entry->link = cache->lru.head;
+	g_hash_table_replace (cache->entries, entry->key, entry);
+	cache->size += entry->size;
+
+	evict_entries (cache);
+}
+
+static void
+query_job_free (QueryJob *job)
+{
+	g_clear_object (&job->statement);
+	g_clear_pointer (&job->columns, g_ptr_array_unref);
+	g_variant_builder_clear (&job->rows);
+	g_free (job->key);
+	g_object_unref (job->task);
+	g_object_unref (job->cache);
+	g_slice_free (QueryJob, job);
+}
+
+static void
+query_job_complete (QueryJob *job,
+                    GError   *error)
+{
+	TrackerQueryCache *cache = job->cache;
+	const gchar *no_columns[] = { NULL };
+	GVariant *result;
+	gsize size;
+
+	if (error) {
+		g_task_return_error (job->task, error);
+		query_job_free (job);
+		return;
+	}
+
+	result = g_variant_new ("(^as@aams)",
+	                        job->columns ?
+	                        (const gchar * const *) job->columns->pdata :
+	                        no_columns,
+	                        g_variant_builder_end (&job->rows));
+	g_variant_ref_sink (result);
+
+	/* The serialized variant holds the strings too */
+	size = g_variant_get_size (result) + strlen (job->key) + sizeof (CacheEntry);
+
+	/* Do not store results that might predate a change */
+	if (job->generation == cache->generation &&
+	    size <= cache->max_size / MAX_ENTRY_FRACTION)
+		insert_entry (cache, g_steal_pointer (&job->key), result, size);
+
+	g_task_return_pointer (job->task, result, (GDestroyNotify) g_variant_unref);
+	query_job_free (job);
+}
+
+static void
+query_next_cb (GObject      *object,
+               GAsyncResult *res,
+               gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor = TRACKER_SPARQL_CURSOR (object);
+	QueryJob *job = user_data;
+	GError *error = NULL;
+	gint i;
+
+	if (!tracker_sparql_cursor_next_finish (cursor, res, &error)) {
+		tracker_sparql_cursor_close (cursor);
+		g_object_unref (cursor);
+		query_job_complete (job, error);
+		return;
+	}
+
+	if (job->n_rows >= MAX_ROWS || job->size >= MAX_RESULT_SIZE) {
+		tracker_sparql_cursor_close (cursor);
+		g_object_unref (cursor);
+		query_job_complete (job,
+		                    g_error_new (G_IO_ERROR,
+		                                 G_IO_ERROR_MESSAGE_TOO_LARGE,
+		                                 "Query results exceed %d rows or %d bytes, use LIMIT",
+		                                 MAX_ROWS, MAX_RESULT_SIZE));
+		return;
+	}
+
+	if (!job->columns) {
+		job->n_columns = tracker_sparql_cursor_get_n_columns (cursor);
+		job->columns = g_ptr_array_new_with_free_func (g_free);
+
+		for (i = 0; i < job->n_columns; i++) {
+			g_ptr_array_add (job->columns,
+			                 g_strdup (tracker_sparql_cursor_get_variable_name (cursor, i)));
+		}
+
+		g_ptr_array_add (job->columns, NULL);
+	}
+
+	g_variant_builder_open (&job->rows, G_VARIANT_TYPE ("ams"));
+
+	for (i = 0; i < job->n_columns; i++) {
+		const gchar *str = NULL;
+		glong len = 0;
+
+		if (tracker_sparql_cursor_get_value_type (cursor, i) != TRACKER_SPARQL_VALUE_TYPE_UNBOUND)
+			str = tracker_sparql_cursor_get_string (cursor, i, &len);
+
+		g_variant_builder_add (&job->rows, "ms", str);
+		job->size += len;
+	}
+
+	g_variant_builder_close (&job->rows);
+	job->n_rows++;
+
+	tracker_sparql_cursor_next_async (cursor,
+	                                  g_task_get_cancellable (job->task),
+	                                  query_next_cb, job);
+}
+
+static void
+query_execute_cb (GObject      *object,
+                  GAsyncResult *res,
+                  gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor;
+	QueryJob *job = user_data;
+	GError *error = NULL;
+
+	cursor = tracker_sparql_statement_execute_finish (TRACKER_SPARQL_STATEMENT (object),
+	                                                  res, &error);
+	if (!cursor) {
+		query_job_complete (job, error);
+		return;
+	}
+
+	tracker_sparql_cursor_next_async (cursor,
+	                                  g_task_get_cancellable (job->task),
+	                                  query_next_cb, job);
+}
+
+/**
+ * tracker_query_cache_query_async:
+ * @cache: a #TrackerQueryCache
+ * @sparql: a SPARQL SELECT query
+ * @parameters: (nullable): a{sv} dictionary of values to bind
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when the results are available
+ * @user_data: user data for @callback
+ *
+ * Runs @sparql with the given @parameters, or reuses the results of
+ * a previous identical query if the database did not change since,
+ * and they are at most 30 seconds old.
+ * Queries are considered identical if they only differ in whitespace
+ * outside string literals, and bind the same values.
+ *
+ * Queries returning more than 10000 rows, or 16MB of data, fail
+ * with %G_IO_ERROR_MESSAGE_TOO_LARGE.
+ **/
+void
+tracker_query_cache_query_async (TrackerQueryCache   *cache,
+                                 const gchar         *sparql,
+                                 GVariant            *parameters,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+	TrackerSparqlStatement *stmt;
+	CacheEntry *entry;
+	QueryJob *job;
+	GTask *task;
+	GError *error = NULL;
+	gchar *key;
+
+	g_return_if_fail (TRACKER_IS_QUERY_CACHE (cache));
+	g_return_if_fail (sparql != NULL);
+	g_return_if_fail (!parameters ||
+	                  g_variant_is_of_type (parameters, G_VARIANT_TYPE_VARDICT));
+
+	task = g_task_new (cache, cancellable, callback, user_data);
+	check_sequence (cache);
+
+	key = create_key (sparql, parameters);
+	entry = g_hash_table_lookup (cache->entries, key);
+
+	if (entry &&
+	    g_get_monotonic_time () - entry->created > MAX_ENTRY_AGE_USEC) {
+		g_queue_delete_link (&cache->lru, entry->link);
+		cache->size -= entry->size;
+		g_hash_table_remove (cache->entries, key);
+		entry = NULL;
+	}
+
+	if (entry) {
+		cache->hits++;
+		g_queue_unlink (&cache->lru, entry->link);
+		g_queue_push_head_link (&cache->lru, entry->link);
+
+		g_task_return_pointer (task, g_variant_ref (entry->result),
+		                       (GDestroyNotify) g_variant_unref);
+		g_object_unref (task);
+		g_free (key);
+		return;
+	}
+
+	cache->misses++;
+
+	stmt = tracker_sparql_connection_query_statement (cache->connection,
+	                                                  sparql,
+	                                                  cancellable,
+	                                                  &error);
+	if (stmt && !bind_parameters (stmt, parameters, &error))
+		g_clear_object (&stmt);
+
+	if (!stmt) {
+		g_task_return_error (task, error);
+		g_object_unref (task);
+		g_free (key);
+		return;
+	}
+
+	job = g_slice_new0 (QueryJob);
+	job->cache = g_object_ref (cache);
+	job->statement = stmt;
+	job->key = key;
+	job->task = task;
+	job->generation = cache->generation;
+	g_variant_builder_init (&job->rows, G_VARIANT_TYPE ("aams"));
+
+	tracker_sparql_statement_execute_async (stmt, cancellable,
+	                                        query_execute_cb, job);
+}
+
+/**
+ * tracker_query_cache_query_finish:
+ * @cache: a #TrackerQueryCache
+ * @res: a #GAsyncResult
+ * @error: location for a #GError
+ *
+ * Finishes the operation started with tracker_query_cache_query_async().
+ *
+ * Returns: (transfer full): a (asaams) variant with the variable names
+ *   and the result rows, unbound values are nothing.
+ **/
+GVariant *
+tracker_query_cache_query_finish (TrackerQueryCache  *cache,
+                                  GAsyncResult       *res,
+                                  GError            **error)
+{
+	g_return_val_if_fail (TRACKER_IS_QUERY_CACHE (cache), NULL);
+
+	return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+/**
+ * tracker_query_cache_to_variant:
+ * @cache: a #TrackerQueryCache
+ *
+ * Returns the cache counters as an a{sv} dictionary, with keys:
+ *   - "hits" (t): Queries answered from the cache
+ *   - "misses" (t): Queries that had to be run
+ *   - "evictions" (t): Results dropped to stay within the size limit
+ *   - "entries" (u): Number of cached results
+ *   - "size" (t): Memory used by cached results, in bytes
+ *   - "max-size" (t): Maximum memory used by cached results
+ *
+ * Returns: (transfer floating): the cache counters
+ **/
+GVariant *
+tracker_query_cache_to_variant (TrackerQueryCache *cache)
+{
+	GVariantBuilder builder;
+
+	g_return_val_if_fail (TRACKER_IS_QUERY_CACHE (cache), NULL);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "hits",
+	                       g_variant_new_uint64 (cache->hits));
+	g_variant_builder_add (&builder, "{sv}", "misses",
+	                       g_variant_new_uint64 (cache->misses));
+	g_variant_builder_add (&builder, "{sv}", "evictions",
+	                       g_variant_new_uint64 (cache->evictions));
+	g_variant_builder_add (&builder, "{sv}", "entries",
+	                       g_variant_new_uint32 (g_hash_table_size (cache->entries)));
+	g_variant_builder_add (&builder, "{sv}", "size",
+	                       g_variant_new_uint64 (cache->size));
+	g_variant_builder_add (&builder, "{sv}", "max-size",
+	                       g_variant_new_uint64 (cache->max_size));
+
+	return g_variant_builder_end (&builder);
+}
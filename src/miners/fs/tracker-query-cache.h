@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __TRACKER_QUERY_CACHE_H__
+#define __TRACKER_QUERY_CACHE_H__
+
+#include <gio/gio.h>
+#include <tinysparql.h>
+
+#include "tracker-statistics.h"
+
+#define TRACKER_TYPE_QUERY_CACHE (tracker_query_cache_get_type ())
+G_DECLARE_FINAL_TYPE (TrackerQueryCache,
+                      tracker_query_cache,
+                      TRACKER, QUERY_CACHE,
+                      GObject)
+
+TrackerQueryCache * tracker_query_cache_new (TrackerSparqlConnection *connection,
+                                             TrackerStatistics       *statistics,
+                                             gsize                    max_size);
+
+void tracker_query_cache_invalidate (TrackerQueryCache *cache);
+
+void tracker_query_cache_query_async (TrackerQueryCache   *cache,
+                                      const gchar         *sparql,
+                                      GVariant            *parameters,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data);
+
+GVariant * tracker_query_cache_query_finish (TrackerQueryCache  *cache,
+                                             GAsyncResult       *res,
+                                             GError            **error);
+
+GVariant * tracker_query_cache_to_variant (TrackerQueryCache *cache);
+
+#endif /* __TRACKER_QUERY_CACHE_H__ */
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config-miners.h"
+
+#include <string.h>
+
+#include "tracker-slab.h"
+
+#define CHUNK_SIZE (16 * 1024)
+#define MIN_ELEMENTS_PER_CHUNK 16
+
+typedef struct _TrackerSlabChunk TrackerSlabChunk;
+
+struct _TrackerSlabChunk {
+	TrackerSlabChunk *next;
+	/* Keeps elements after the header 16-byte aligned */
+	gpointer padding;
+};
+
+struct _TrackerSlab {
+	gsize element_size;
+	guint elements_per_chunk;
+
+	/* Elements are taken from the free list first, then
+	 * from the unused tail of the first chunk.
+	 */
+	TrackerSlabChunk *chunks;
+	gpointer free_list;
+	guint next_element;
+
+	guint n_chunks;
+	guint n_in_use;
+	guint peak_in_use;
+	guint n_released_chunks;
+};
+
+/**
+ * tracker_slab_new:
+ * @element_size: size of the allocated elements
+ *
+ * Creates a slab handing out zeroed elements of @element_size bytes.
+ *
+ * Returns: (transfer full): a #TrackerSlab
+ **/
+TrackerSlab *
+tracker_slab_new (gsize element_size)
+{
+	TrackerSlab *slab;
+
+	g_return_val_if_fail (element_size > 0, NULL);
+
+	slab = g_new0 (TrackerSlab, 1);
+	/* Freed elements hold the free list link */
+	slab->element_size = MAX (element_size, sizeof (gpointer));
+	slab->element_size = (slab->element_size + sizeof (gpointer) - 1) &
+		~(sizeof (gpointer) - 1);
+	slab->elements_per_chunk = MAX (CHUNK_SIZE / slab->element_size,
+	                                MIN_ELEMENTS_PER_CHUNK);
+
+	return slab;
+}
+
+/* Releases all chunks but the first, only if no element is in use */
+static void
+slab_trim (TrackerSlab *slab)
+{
+	TrackerSlabChunk *chunk, *next;
+
+	g_assert (slab->n_in_use == 0);
+
+	if (!slab->chunks)
+		return;
+
+	chunk = slab->chunks->next;
+	slab->chunks->next = NULL;
+
+	while (chunk) {
+		next = chunk->next;
+		g_free (chunk);
+		slab->n_chunks--;
+		slab->n_released_chunks++;
+		chunk = next;
+	}
+
+	slab->free_list = NULL;
+	slab->next_element = 0;
+}
+
+void
+tracker_slab_free (TrackerSlab *slab)
+{
+	TrackerSlabChunk *chunk, *next;
+
+	g_return_if_fail (slab != NULL);
+
+	/* Elements still in use are freed along */
+	for (chunk = slab->chunks; chunk; chunk = next) {
+		next = chunk->next;
+		g_free (chunk);
+	}
+
+	g_free (slab);
+}
+
+gpointer
+tracker_slab_alloc (TrackerSlab *slab)
+{
+	gpointer element;
+
+	if (slab->free_list) {
+		element = slab->free_list;
+		slab->free_list = *((gpointer *) element);
+	} else {
+		if (!slab->chunks ||
+		    slab->next_element == slab->elements_per_chunk) {
+			TrackerSlabChunk *chunk;
+
+			chunk = g_malloc (sizeof (TrackerSlabChunk) +
+			                  slab->elements_per_chunk * slab->element_size);
+			chunk->next = slab->chunks;
+			slab->chunks = chunk;
+			slab->next_element = 0;
+			slab->n_chunks++;
+		}
+
+		element = ((guint8 *) (slab->chunks + 1) +
+		           slab->next_element * slab->element_size);
+		slab->next_element++;
+	}
+
+	slab->n_in_use++;
+	slab->peak_in_use = MAX (slab->peak_in_use, slab->n_in_use);
+
+	return memset (element, 0, slab->element_size);
+}
+
+void
+tracker_slab_release (TrackerSlab *slab,
+                      gpointer     element)
+{
+	if (!element)
+		return;
+
+	g_assert (slab->n_in_use > 0);
+
+	*((gpointer *) element) = slab->free_list;
+	slab->free_list = element;
+	slab->n_in_use--;
+
+	/* Everything went back to the slab, e.g. a queue was drained or
+	 * an indexing root finished, return the memory in bulk. One chunk
+	 * is kept so slabs emptying often do not keep reallocating.
+	 */
+	if (slab->n_in_use == 0)
+		slab_trim (slab);
+}
+
+/**
+ * tracker_slab_get_size:
+ * @slab: a #TrackerSlab
+ *
+ * Returns the memory currently allocated by @slab, whether the
+ * elements are in use or not.
+ *
+ * Returns: the size in bytes
+ **/
+gsize
+tracker_slab_get_size (TrackerSlab *slab)
+{
+	g_return_val_if_fail (slab != NULL, 0);
+
+	return slab->n_chunks * (sizeof (TrackerSlabChunk) +
+	                         slab->elements_per_chunk * slab->element_size);
+}
+
+guint
+tracker_slab_get_n_in_use (TrackerSlab *slab)
+{
+	g_return_val_if_fail (slab != NULL, 0);
+
+	return slab->n_in_use;
+}
+
+/**
+ * tracker_slab_get_stats:
+ * @slab: a #TrackerSlab
+ *
+ * Returns the allocation statistics of @slab, as a floating a{sv}
+ * variant with the following keys:
+ *   - "element-size" (u): Size of the elements, in bytes
+ *   - "chunks" (u): Number of chunks currently allocated
+ *   - "capacity" (u): Number of elements fitting in those chunks
+ *   - "in-use" (u): Number of elements in use
+ *   - "peak-in-use" (u): Highest number of elements in use at once
+ *   - "released-chunks" (u): Number of chunks returned so far
+ *   - "fragmentation" (d): Ratio of allocated element space not in use
+ *
+ * Returns: (transfer floating): The statistics
+ **/
+GVariant *
+tracker_slab_get_stats (TrackerSlab *slab)
+{
+	GVariantBuilder builder;
+	guint capacity;
+
+	g_return_val_if_fail (slab != NULL, NULL);
+
+	capacity = slab->n_chunks * slab->elements_per_chunk;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "element-size",
+	                       g_variant_new_uint32 (slab->element_size));
+	g_variant_builder_add (&builder, "{sv}", "chunks",
+	                       g_variant_new_uint32 (slab->n_chunks));
+	g_variant_builder_add (&builder, "{sv}", "capacity",
+	                       g_variant_new_uint32 (capacity));
+	g_variant_builder_add (&builder, "{sv}", "in-use",
+	                       g_variant_new_uint32 (slab->n_in_use));
+	g_variant_builder_add (&builder, "{sv}", "peak-in-use",
+	                       g_variant_new_uint32 (slab->peak_in_use));
+	g_variant_builder_add (&builder, "{sv}", "released-chunks",
+	                       g_variant_new_uint32 (slab->n_released_chunks));
+	g_variant_builder_add (&builder, "{sv}", "fragmentation",
+	                       g_variant_new_double (capacity > 0 ?
+	                                             1.0 - (gdouble) slab->n_in_use / capacity :
+	                                             0.0));
+
+	return g_variant_builder_end (&builder);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_SLAB_H__
+#define __TRACKER_SLAB_H__
+
+#include <glib.h>
+
+/* Allocates fixed size elements out of bigger chunks. Chunks are
+ * released in bulk once no element is in use, so short lived
+ * structures allocated at crawl rate do not fragment the heap.
+ *
+ * Slabs are not thread safe.
+ */
+typedef struct _TrackerSlab TrackerSlab;
+
+TrackerSlab * tracker_slab_new  (gsize        element_size);
+void          tracker_slab_free (TrackerSlab *slab);
+
+gpointer tracker_slab_alloc   (TrackerSlab *slab);
+void     tracker_slab_release (TrackerSlab *slab,
+                               gpointer     element);
+
+gsize      tracker_slab_get_size      (TrackerSlab *slab);
+guint      tracker_slab_get_n_in_use  (TrackerSlab *slab);
+GVariant * tracker_slab_get_stats     (TrackerSlab *slab);
+
+#endif /* __TRACKER_SLAB_H__ */
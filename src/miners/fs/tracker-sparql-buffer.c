@@ -21,6 +21,8 @@
 
 #include "config-miners.h"
 
+#include <string.h>
+
 #include "tracker-sparql-buffer.h"
 
 #include "libtracker-miners-common/tracker-debug.h"
@@ -29,6 +31,14 @@
 
 #define DEFAULT_GRAPH "tracker:FileSystem"
 
+static const gchar *special_graphs[] = {
+	"tracker:Audio",
+	"tracker:Documents",
+	"tracker:Pictures",
+	"tracker:Software",
+	"tracker:Video"
+};
+
 typedef struct _TrackerSparqlBufferPrivate TrackerSparqlBufferPrivate;
 typedef struct _SparqlTaskData SparqlTaskData;
 typedef struct _UpdateBatchData UpdateBatchData;
@@ -45,11 +55,19 @@ struct _TrackerSparqlBufferPrivate
 	gint n_updates;
 	TrackerBatch *batch;
 
+	TrackerStatistics *statistics;
+
+	/* Accumulated flush timings */
+	gint64 flush_time;
+	guint n_flushes;
+	guint n_flushed_tasks;
+
 	TrackerSparqlStatement *delete_file;
 	TrackerSparqlStatement *delete_file_content;
 	TrackerSparqlStatement *delete_content;
 	TrackerSparqlStatement *move_file;
 	TrackerSparqlStatement *move_content;
+	TrackerSparqlStatement *update_sidecar_owners;
 };
 
 enum {
@@ -80,6 +98,7 @@ struct _UpdateBatchData {
 	GPtrArray *tasks;
 	TrackerBatch *batch;
 	GTask *async_task;
+	gint64 start_time;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (TrackerSparqlBuffer, tracker_sparql_buffer, TRACKER_TYPE_TASK_POOL)
@@ -96,6 +115,8 @@ tracker_sparql_buffer_finalize (GObject *object)
 	g_object_unref (priv->delete_content);
 	g_object_unref (priv->move_file);
 	g_object_unref (priv->move_content);
+	g_object_unref (priv->update_sidecar_owners);
+	g_object_unref (priv->statistics);
 	g_object_unref (priv->connection);
 
 	G_OBJECT_CLASS (tracker_sparql_buffer_parent_class)->finalize (object);
@@ -159,6 +180,10 @@ tracker_sparql_buffer_constructed (GObject *object)
 		tracker_load_statement (priv->connection, "move-file.rq", NULL);
 	priv->move_content =
 		tracker_load_statement (priv->connection, "move-folder-contents.rq", NULL);
+	priv->update_sidecar_owners =
+		tracker_load_statement (priv->connection, "update-sidecar-owners.rq", NULL);
+
+	priv->statistics = tracker_statistics_new (priv->connection);
 
 	G_OBJECT_CLASS (tracker_sparql_buffer_parent_class)->constructed (object);
 }
@@ -232,6 +257,9 @@ batch_execute_cb (GObject      *object,
 	buffer = TRACKER_SPARQL_BUFFER (update_data->buffer);
 	priv = tracker_sparql_buffer_get_instance_private (buffer);
 	priv->n_updates--;
+	priv->flush_time += g_get_monotonic_time () - update_data->start_time;
+	priv->n_flushes++;
+	priv->n_flushed_tasks += update_data->tasks->len;
 
 	TRACKER_NOTE (MINER_FS_EVENTS,
 	              g_message ("(Sparql buffer) Finished array-update with %u tasks",
@@ -245,6 +273,7 @@ batch_execute_cb (GObject      *object,
 		                      (GDestroyNotify) g_ptr_array_unref);
 		g_task_return_error (update_data->async_task, error);
 	} else {
+		tracker_statistics_note_changes (priv->statistics);
 		g_task_return_pointer (update_data->async_task,
 		                       g_ptr_array_ref (update_data->tasks),
 		                       (GDestroyNotify) g_ptr_array_unref);
@@ -280,6 +309,7 @@ tracker_sparql_buffer_flush (TrackerSparqlBuffer *buffer,
 	update_data->tasks = g_ptr_array_ref (priv->tasks);
 	update_data->batch = g_object_ref (priv->batch);
 	update_data->async_task = g_task_new (buffer, NULL, cb, user_data);
+	update_data->start_time = g_get_monotonic_time ();
 
 	/* Empty pool, update_data will keep
 	 * references to the tasks to keep
@@ -587,6 +617,47 @@ tracker_sparql_buffer_log_file (TrackerSparqlBuffer *buffer,
 		tracker_sparql_buffer_push (buffer, file, content_graph, graph_resource);
 }
 
+void
+tracker_sparql_buffer_log_sidecar_update (TrackerSparqlBuffer *buffer,
+                                          GFile               *sidecar)
+{
+	TrackerSparqlBufferPrivate *priv;
+	TrackerBatch *batch;
+	g_autoptr (GFile) parent = NULL;
+	g_autofree gchar *uri = NULL, *parent_uri = NULL;
+	g_autofree gchar *path = NULL, *basename = NULL, *prefix = NULL;
+	const gchar *dot;
+
+	g_return_if_fail (TRACKER_IS_SPARQL_BUFFER (buffer));
+	g_return_if_fail (G_IS_FILE (sidecar));
+
+	priv = tracker_sparql_buffer_get_instance_private (TRACKER_SPARQL_BUFFER (buffer));
+
+	parent = g_file_get_parent (sidecar);
+	path = g_file_get_path (sidecar);
+	if (!parent || !path)
+		return;
+
+	/* Matched against nfo:fileName, which holds the display name */
+	basename = g_filename_display_basename (path);
+	dot = strrchr (basename, '.');
+	if (!dot)
+		return;
+
+	/* Sidecars replace the extension of the file they belong to */
+	prefix = g_strndup (basename, dot - basename + 1);
+	uri = g_file_get_uri (sidecar);
+	parent_uri = g_file_get_uri (parent);
+
+	batch = tracker_sparql_buffer_get_current_batch (buffer);
+	tracker_batch_add_statement (batch, priv->update_sidecar_owners,
+	                             "uri", G_TYPE_STRING, uri,
+	                             "parent", G_TYPE_STRING, parent_uri,
+	                             "prefix", G_TYPE_STRING, prefix,
+	                             NULL);
+	/* The statement is flushed along with the task logged for the sidecar itself */
+}
+
 void
 tracker_sparql_buffer_log_folder (TrackerSparqlBuffer *buffer,
                                   GFile               *file,
@@ -601,13 +672,6 @@ tracker_sparql_buffer_log_folder (TrackerSparqlBuffer *buffer,
 
 	/* Add indexing roots also to content specific graphs to provide the availability information */
 	if (is_root) {
-		const gchar *special_graphs[] = {
-			"tracker:Audio",
-			"tracker:Documents",
-			"tracker:Pictures",
-			"tracker:Software",
-			"tracker:Video"
-		};
 		gint i;
 
 		for (i = 0; i < G_N_ELEMENTS (special_graphs); i++) {
@@ -636,3 +700,33 @@ tracker_sparql_buffer_log_attributes_update (TrackerSparqlBuffer *buffer,
 
 	tracker_sparql_buffer_push (buffer, file, DEFAULT_GRAPH, file_resource);
 }
+
+TrackerStatistics *
+tracker_sparql_buffer_get_statistics (TrackerSparqlBuffer *buffer)
+{
+	TrackerSparqlBufferPrivate *priv;
+
+	g_return_val_if_fail (TRACKER_IS_SPARQL_BUFFER (buffer), NULL);
+
+	priv = tracker_sparql_buffer_get_instance_private (buffer);
+
+	return priv->statistics;
+}
+
+void
+tracker_sparql_buffer_get_timings (TrackerSparqlBuffer *buffer,
+                                   gdouble             *flush_time,
+                                   guint               *n_flushes,
+                                   guint               *n_flushed_tasks)
+{
+	TrackerSparqlBufferPrivate *priv;
+
+	priv = tracker_sparql_buffer_get_instance_private (buffer);
+
+	if (flush_time)
+		*flush_time = (gdouble) priv->flush_time / G_USEC_PER_SEC;
+	if (n_flushes)
+		*n_flushes = priv->n_flushes;
+	if (n_flushed_tasks)
+		*n_flushed_tasks = priv->n_flushed_tasks;
+}
@@ -26,6 +26,7 @@
 #include <gio/gio.h>
 #include <tinysparql.h>
 
+#include "tracker-statistics.h"
 #include "tracker-task-pool.h"
 
 G_BEGIN_DECLS
@@ -88,6 +89,9 @@ void tracker_sparql_buffer_log_file (TrackerSparqlBuffer *buffer,
                                      TrackerResource     *file_resource,
                                      TrackerResource     *graph_resource);
 
+void tracker_sparql_buffer_log_sidecar_update (TrackerSparqlBuffer *buffer,
+                                               GFile               *sidecar);
+
 void tracker_sparql_buffer_log_folder (TrackerSparqlBuffer *buffer,
                                        GFile               *file,
                                        gboolean             is_root,
@@ -100,6 +104,13 @@ void tracker_sparql_buffer_log_attributes_update (TrackerSparqlBuffer *buffer,
                                                   TrackerResource     *file_resource,
                                                   TrackerResource     *graph_resource);
 
+TrackerStatistics * tracker_sparql_buffer_get_statistics (TrackerSparqlBuffer *buffer);
+
+void tracker_sparql_buffer_get_timings (TrackerSparqlBuffer *buffer,
+                                        gdouble             *flush_time,
+                                        guint               *n_flushes,
+                                        guint               *n_flushed_tasks);
+
 G_END_DECLS
 
 #endif /* __LIBTRACKER_MINER_SPARQL_BUFFER_H__ */
@@ -0,0 +1,798 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config-miners.h"
+
+#include <string.h>
+
+#include "tracker-statistics.h"
+
+#include "libtracker-miners-common/tracker-debug.h"
+
+#include "tracker-utils.h"
+
+/* Resource counts are queried once, on startup, and then kept up to
+ * date from the events of a TrackerNotifier, so changes done by the
+ * extractor or other clients of the endpoint are followed too.
+ *
+ * The classes of created resources are looked up in batches, deleted
+ * resources can not be looked up anymore, so these are assumed to be
+ * of the classes of their graph in the proportions counted so far.
+ * Only changes to classes with tracker:notify are notified, and
+ * resources gaining or losing classes are not followed, so the numbers
+ * are approximate until the next start. The anonymous default graph is
+ * not counted.
+ */
+#define LOOKUP_BATCH_SIZE 100
+
+#define FILESYSTEM_GRAPH "http://tracker.api.gnome.org/ontology/v3/tracker#FileSystem"
+#define RDFS_RESOURCE "http://www.w3.org/2000/01/rdf-schema#Resource"
+#define NFO_FILE_DATA_OBJECT "http://tracker.api.gnome.org/ontology/v3/nfo#FileDataObject"
+#define NFO_FOLDER "http://tracker.api.gnome.org/ontology/v3/nfo#Folder"
+
+struct _TrackerStatistics
+{
+	GObject parent_instance;
+	TrackerSparqlConnection *connection;
+	TrackerNotifier *notifier;
+	GCancellable *cancellable;
+
+	/* Graph name -> (class name -> gdouble count) */
+	GHashTable *graphs;
+
+	TrackerSparqlStatement *summary;
+	gdouble files;
+	gdouble folders;
+	gboolean summary_dirty;
+
+	guint64 sequence;
+	guint64 updated_sequence;
+	guint n_pending_lookups;
+
+	/* Tasks waiting for counts or the summary */
+	GList *tasks;
+
+	guint seeded     : 1;
+	guint refreshing : 1;
+};
+
+typedef struct
+{
+	TrackerStatistics *statistics;
+	gchar *graph;
+} LookupData;
+
+enum {
+	PROP_0,
+	PROP_CONNECTION,
+	N_PROPS,
+};
+
+static GParamSpec *props[N_PROPS] = { 0, };
+
+G_DEFINE_TYPE (TrackerStatistics, tracker_statistics, G_TYPE_OBJECT)
+
+static void statistics_refresh (TrackerStatistics *statistics);
+
+static void
+tracker_statistics_init (TrackerStatistics *statistics)
+{
+	statistics->graphs =
+		g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+		                       (GDestroyNotify) g_hash_table_unref);
+	statistics->cancellable = g_cancellable_new ();
+	statistics->summary_dirty = TRUE;
+}
+
+static gdouble *
+lookup_count (TrackerStatistics *statistics,
+              const gchar       *graph,
+              const gchar       *class_name)
+{
+	GHashTable *classes;
+	gdouble *count;
+
+	classes = g_hash_table_lookup (statistics->graphs, graph);
+	if (!classes) {
+		classes = g_hash_table_new_full (g_str_hash, g_str_equal,
+		                                 g_free, g_free);
+		g_hash_table_insert (statistics->graphs, g_strdup (graph), classes);
+	}
+
+	count = g_hash_table_lookup (classes, class_name);
+	if (!count) {
+		count = g_new0 (gdouble, 1);
+		g_hash_table_insert (classes, g_strdup (class_name), count);
+	}
+
+	return count;
+}
+
+static void
+add_count (TrackerStatistics *statistics,
+           const gchar       *graph,
+           const gchar       *class_name,
+           gdouble            delta)
+{
+	gdouble *count;
+
+	count = lookup_count (statistics, graph, class_name);
+	*count = MAX (*count + delta, 0);
+
+	/* Folders are also file data objects, see get-file-statistics.rq */
+	if (!statistics->seeded || strcmp (graph, FILESYSTEM_GRAPH) != 0)
+		return;
+
+	if (strcmp (class_name, NFO_FILE_DATA_OBJECT) == 0) {
+		statistics->files = MAX (statistics->files + delta, 0);
+	} else if (strcmp (class_name, NFO_FOLDER) == 0) {
+		statistics->folders = MAX (statistics->folders + delta, 0);
+		statistics->files = MAX (statistics->files - delta, 0);
+	}
+}
+
+static void
+remove_resources (TrackerStatistics *statistics,
+                  const gchar       *graph,
+                  guint              n_resources)
+{
+	GHashTable *classes;
+	GHashTableIter iter;
+	gdouble *total, ratio;
+	GPtrArray *class_names;
+	gpointer key;
+	guint i;
+
+	classes = g_hash_table_lookup (statistics->graphs, graph);
+	if (!classes)
+		return;
+
+	total = g_hash_table_lookup (classes, RDFS_RESOURCE);
+	if (!total || *total <= 0)
+		return;
+
+	ratio = MIN (n_resources / *total, 1.0);
+
+	/* Collect names first, add_count() may touch the table */
+	class_names = g_ptr_array_new ();
+	g_hash_table_iter_init (&iter, classes);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+		g_ptr_array_add (class_names, key);
+
+	for (i = 0; i < class_names->len; i++) {
+		const gchar *class_name = g_ptr_array_index (class_names, i);
+		gdouble *count = g_hash_table_lookup (classes, class_name);
+
+		add_count (statistics, graph, class_name, - (*count * ratio));
+	}
+
+	g_ptr_array_unref (class_names);
+}
+
+static void
+update_sequence (TrackerStatistics *statistics)
+{
+	if (statistics->seeded && statistics->n_pending_lookups == 0)
+		statistics->updated_sequence = statistics->sequence;
+}
+
+static void
+lookup_data_free (LookupData *data)
+{
+	g_free (data->graph);
+	g_slice_free (LookupData, data);
+}
+
+static void
+lookup_finish (LookupData *data)
+{
+	TrackerStatistics *statistics = data->statistics;
+
+	statistics->n_pending_lookups--;
+	update_sequence (statistics);
+	lookup_data_free (data);
+}
+
+static void
+lookup_next_cb (GObject      *object,
+                GAsyncResult *res,
+                gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor = TRACKER_SPARQL_CURSOR (object);
+	LookupData *data = user_data;
+	GError *error = NULL;
+
+	if (tracker_sparql_cursor_next_finish (cursor, res, &error)) {
+		add_count (data->statistics, data->graph,
+		           tracker_sparql_cursor_get_string (cursor, 0, NULL),
+		           tracker_sparql_cursor_get_integer (cursor, 1));
+		tracker_sparql_cursor_next_async (cursor, data->statistics->cancellable,
+		                                  lookup_next_cb, data);
+		return;
+	}
+
+	tracker_sparql_cursor_close (cursor);
+	g_object_unref (cursor);
+
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		lookup_data_free (data);
+		g_error_free (error);
+		return;
+	}
+
+	if (error) {
+		g_warning ("Could not count created resources: %s", error->message);
+		g_error_free (error);
+	}
+
+	lookup_finish (data);
+}
+
+static void
+lookup_query_cb (GObject      *object,
+                 GAsyncResult *res,
+                 gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor;
+	LookupData *data = user_data;
+	GError *error = NULL;
+
+	cursor = tracker_sparql_connection_query_finish (TRACKER_SPARQL_CONNECTION (object),
+	                                                 res, &error);
+
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		lookup_data_free (data);
+		g_error_free (error);
+		return;
+	}
+
+	if (!cursor) {
+		g_warning ("Could not count created resources: %s", error->message);
+		g_error_free (error);
+		lookup_finish (data);
+		return;
+	}
+
+	tracker_sparql_cursor_next_async (cursor, data->statistics->cancellable,
+	                                  lookup_next_cb, data);
+}
+
+static void
+lookup_created_resources (TrackerStatistics  *statistics,
+                          const gchar        *graph,
+                          const gchar       **urns,
+                          guint               n_urns)
+{
+	g_autofree gchar *escaped_graph = NULL;
+	LookupData *data;
+	GString *query;
+	guint i;
+
+	escaped_graph = tracker_sparql_escape_uri_printf ("%s", graph);
+	query = g_string_new ("SELECT ?class (COUNT(?r) AS ?count) { VALUES ?r {");
+
+	for (i = 0; i < n_urns; i++) {
+		g_autofree gchar *escaped = NULL;
+
+		escaped = tracker_sparql_escape_uri_printf ("%s", urns[i]);
+		g_string_append_printf (query, " <%s>", escaped);
+	}
+
+	g_string_append_printf (query,
+	                        " } GRAPH <%s> { ?r a ?class } } "
+	                        "GROUP BY ?class",
+	                        escaped_graph);
+
+	data = g_slice_new0 (LookupData);
+	data->statistics = statistics;
+	data->graph = g_strdup (graph);
+	statistics->n_pending_lookups++;
+
+	tracker_sparql_connection_query_async (statistics->connection,
+	                                       query->str,
+	                                       statistics->cancellable,
+	                                       lookup_query_cb,
+	                                       data);
+	g_string_free (query, TRUE);
+}
+
+static void
+notifier_events_cb (TrackerStatistics *statistics,
+                    const gchar       *service,
+                    const gchar       *graph,
+                    GPtrArray         *events,
+                    TrackerNotifier   *notifier)
+{
+	g_autoptr (GPtrArray) created = NULL;
+	guint n_deleted = 0, i;
+
+	statistics->sequence++;
+
+	/* Changes before the initial counts are part of these */
+	if (!statistics->seeded || !graph) {
+		update_sequence (statistics);
+		return;
+	}
+
+	created = g_ptr_array_new ();
+
+	for (i = 0; i < events->len; i++) {
+		TrackerNotifierEvent *event = g_ptr_array_index (events, i);
+		const gchar *urn;
+
+		switch (tracker_notifier_event_get_event_type (event)) {
+		case TRACKER_NOTIFIER_EVENT_CREATE:
+			urn = tracker_notifier_event_get_urn (event);
+			if (urn)
+				g_ptr_array_add (created, (gpointer) urn);
+			break;
+		case TRACKER_NOTIFIER_EVENT_DELETE:
+			n_deleted++;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (n_deleted > 0)
+		remove_resources (statistics, graph, n_deleted);
+
+	for (i = 0; i < created->len; i += LOOKUP_BATCH_SIZE) {
+		lookup_created_resources (statistics, graph,
+		                          (const gchar **) &created->pdata[i],
+		                          MIN (LOOKUP_BATCH_SIZE, created->len - i));
+	}
+
+	update_sequence (statistics);
+}
+
+static void
+tracker_statistics_constructed (GObject *object)
+{
+	TrackerStatistics *statistics = TRACKER_STATISTICS (object);
+
+	G_OBJECT_CLASS (tracker_statistics_parent_class)->constructed (object);
+
+	statistics->summary =
+		tracker_load_statement (statistics->connection, "get-file-statistics.rq", NULL);
+
+	statistics->notifier =
+		tracker_sparql_connection_create_notifier (statistics->connection);
+	g_signal_connect_swapped (statistics->notifier, "events",
+	                          G_CALLBACK (notifier_events_cb), statistics);
+
+	statistics_refresh (statistics);
+}
+
+static void
+tracker_statistics_finalize (GObject *object)
+{
+	TrackerStatistics *statistics = TRACKER_STATISTICS (object);
+
+	g_cancellable_cancel (statistics->cancellable);
+	g_clear_object (&statistics->cancellable);
+	g_hash_table_unref (statistics->graphs);
+	g_clear_object (&statistics->summary);
+	g_clear_object (&statistics->notifier);
+	g_clear_object (&statistics->connection);
+
+	G_OBJECT_CLASS (tracker_statistics_parent_class)->finalize (object);
+}
+
+static void
+tracker_statistics_set_property (GObject      *object,
+                                 guint         prop_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+	TrackerStatistics *statistics = TRACKER_STATISTICS (object);
+
+	switch (prop_id) {
+	case PROP_CONNECTION:
+		statistics->connection = g_value_dup_object (value);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+tracker_statistics_get_property (GObject    *object,
+                                 guint       prop_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+	TrackerStatistics *statistics = TRACKER_STATISTICS (object);
+
+	switch (prop_id) {
+	case PROP_CONNECTION:
+		g_value_set_object (value, statistics->connection);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+tracker_statistics_class_init (TrackerStatisticsClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->constructed = tracker_statistics_constructed;
+	object_class->finalize = tracker_statistics_finalize;
+	object_class->set_property = tracker_statistics_set_property;
+	object_class->get_property = tracker_statistics_get_property;
+
+	props[PROP_CONNECTION] =
+		g_param_spec_object ("connection",
+		                     NULL, NULL,
+		                     TRACKER_SPARQL_TYPE_CONNECTION,
+		                     G_PARAM_READWRITE |
+		                     G_PARAM_CONSTRUCT_ONLY |
+		                     G_PARAM_STATIC_STRINGS);
+
+	g_object_class_install_properties (object_class, N_PROPS, props);
+}
+
+TrackerStatistics *
+tracker_statistics_new (TrackerSparqlConnection *connection)
+{
+	return g_object_new (TRACKER_TYPE_STATISTICS,
+	                     "connection", connection,
+	                     NULL);
+}
+
+/**
+ * tracker_statistics_invalidate:
+ * @statistics: a #TrackerStatistics
+ *
+ * Marks the number of available files and folders to be queried again
+ * on the next update, e.g. after changes in the availability of index
+ * roots. Modifications of the store are followed without calling this.
+ **/
+void
+tracker_statistics_invalidate (TrackerStatistics *statistics)
+{
+	g_return_if_fail (TRACKER_IS_STATISTICS (statistics));
+
+	statistics->sequence++;
+	statistics->summary_dirty = TRUE;
+}
+
+/**
+ * tracker_statistics_note_changes:
+ * @statistics: a #TrackerStatistics
+ *
+ * Moves the change sequence forward for changes that may not be
+ * notified, e.g. batches committed by the miner that modify classes
+ * without tracker:notify. Counts are not affected.
+ **/
+void
+tracker_statistics_note_changes (TrackerStatistics *statistics)
+{
+	g_return_if_fail (TRACKER_IS_STATISTICS (statistics));
+
+	statistics->sequence++;
+	update_sequence (statistics);
+}
+
+guint64
+tracker_statistics_get_sequence (TrackerStatistics *statistics)
+{
+	g_return_val_if_fail (TRACKER_IS_STATISTICS (statistics), 0);
+
+	return statistics->sequence;
+}
+
+static void
+statistics_complete_tasks (TrackerStatistics *statistics,
+                           GError            *error)
+{
+	GList *tasks, *l;
+
+	tasks = g_steal_pointer (&statistics->tasks);
+
+	for (l = tasks; l; l = l->next) {
+		GTask *task = l->data;
+
+		if (error)
+			g_task_return_error (task, g_error_copy (error));
+		else
+			g_task_return_boolean (task, TRUE);
+	}
+
+	g_list_free_full (tasks, g_object_unref);
+}
+
+static void
+statistics_refresh_failed (TrackerStatistics *statistics,
+                           GError            *error)
+{
+	statistics->refreshing = FALSE;
+	statistics_complete_tasks (statistics, error);
+	g_error_free (error);
+}
+
+static void
+summary_next_cb (GObject      *object,
+                 GAsyncResult *res,
+                 gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor = TRACKER_SPARQL_CURSOR (object);
+	TrackerStatistics *statistics = user_data;
+	GError *error = NULL;
+	gboolean has_row;
+
+	has_row = tracker_sparql_cursor_next_finish (cursor, res, &error);
+
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_object_unref (cursor);
+		g_error_free (error);
+		return;
+	}
+
+	if (has_row) {
+		statistics->files = tracker_sparql_cursor_get_integer (cursor, 0);
+		statistics->folders = tracker_sparql_cursor_get_integer (cursor, 1);
+	}
+
+	tracker_sparql_cursor_close (cursor);
+	g_object_unref (cursor);
+
+	if (error) {
+		statistics->summary_dirty = TRUE;
+		statistics_refresh_failed (statistics, error);
+		return;
+	}
+
+	statistics->refreshing = FALSE;
+	statistics_refresh (statistics);
+}
+
+static void
+summary_execute_cb (GObject      *object,
+                    GAsyncResult *res,
+                    gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor;
+	TrackerStatistics *statistics = user_data;
+	GError *error = NULL;
+
+	cursor = tracker_sparql_statement_execute_finish (TRACKER_SPARQL_STATEMENT (object),
+	                                                  res, &error);
+
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free (error);
+		return;
+	}
+
+	if (!cursor) {
+		statistics->summary_dirty = TRUE;
+		statistics_refresh_failed (statistics, error);
+		return;
+	}
+
+	tracker_sparql_cursor_next_async (cursor, statistics->cancellable,
+	                                  summary_next_cb, statistics);
+}
+
+static void
+seed_next_cb (GObject      *object,
+              GAsyncResult *res,
+              gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor = TRACKER_SPARQL_CURSOR (object);
+	TrackerStatistics *statistics = user_data;
+	GError *error = NULL;
+
+	if (tracker_sparql_cursor_next_finish (cursor, res, &error)) {
+		add_count (statistics,
+		           tracker_sparql_cursor_get_string (cursor, 0, NULL),
+		           tracker_sparql_cursor_get_string (cursor, 1, NULL),
+		           tracker_sparql_cursor_get_integer (cursor, 2));
+		tracker_sparql_cursor_next_async (cursor, statistics->cancellable,
+		                                  seed_next_cb, statistics);
+		return;
+	}
+
+	tracker_sparql_cursor_close (cursor);
+	g_object_unref (cursor);
+
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free (error);
+		return;
+	}
+
+	if (error) {
+		g_hash_table_remove_all (statistics->graphs);
+		statistics_refresh_failed (statistics, error);
+		return;
+	}
+
+	statistics->seeded = TRUE;
+	statistics->refreshing = FALSE;
+	update_sequence (statistics);
+
+	TRACKER_NOTE (MINER_FS_EVENTS,
+	              g_message ("(Statistics) Counted %u graphs at sequence %" G_GUINT64_FORMAT,
+	                         g_hash_table_size (statistics->graphs),
+	                         statistics->sequence));
+
+	statistics_refresh (statistics);
+}
+
+static void
+seed_query_cb (GObject      *object,
+               GAsyncResult *res,
+               gpointer      user_data)
+{
+	TrackerSparqlCursor *cursor;
+	TrackerStatistics *statistics = user_data;
+	GError *error = NULL;
+
+	cursor = tracker_sparql_connection_query_finish (TRACKER_SPARQL_CONNECTION (object),
+	                                                 res, &error);
+
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_error_free (error);
+		return;
+	}
+
+	if (!cursor) {
+		statistics_refresh_failed (statistics, error);
+		return;
+	}
+
+	tracker_sparql_cursor_next_async (cursor, statistics->cancellable,
+	                                  seed_next_cb, statistics);
+}
+
+static void
+statistics_refresh (TrackerStatistics *statistics)
+{
+	if (statistics->refreshing)
+		return;
+
+	if (!statistics->seeded) {
+		statistics->refreshing = TRUE;
+		tracker_sparql_connection_query_async (statistics->connection,
+		                                       "SELECT ?g ?class (COUNT(?r) AS ?count) "
+		                                       "{ GRAPH ?g { ?r a ?class } } "
+		                                       "GROUP BY ?g ?class",
+		                                       statistics->cancellable,
+		                                       seed_query_cb,
+		                                       statistics);
+	} else if (statistics->summary_dirty && statistics->summary) {
+		statistics->refreshing = TRUE;
+		statistics->summary_dirty = FALSE;
+		tracker_sparql_statement_execute_async (statistics->summary,
+		                                        statistics->cancellable,
+		                                        summary_execute_cb,
+		                                        statistics);
+	} else {
+		statistics->summary_dirty = FALSE;
+		update_sequence (statistics);
+		statistics_complete_tasks (statistics, NULL);
+	}
+}
+
+/**
+ * tracker_statistics_update_async:
+ * @statistics: a #TrackerStatistics
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when statistics are available
+ * @user_data: user data for @callback
+ *
+ * Waits for the initial counts, and queries the number of available
+ * files and folders again if it was invalidated. Counts are otherwise
+ * kept up to date as changes are notified. Use
+ * tracker_statistics_to_variant() after @callback is called.
+ **/
+void
+tracker_statistics_update_async (TrackerStatistics   *statistics,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+	GTask *task;
+
+	g_return_if_fail (TRACKER_IS_STATISTICS (statistics));
+
+	task = g_task_new (statistics, cancellable, callback, user_data);
+	statistics->tasks = g_list_prepend (statistics->tasks, task);
+	statistics_refresh (statistics);
+}
+
+gboolean
+tracker_statistics_update_finish (TrackerStatistics  *statistics,
+                                  GAsyncResult       *res,
+                                  GError            **error)
+{
+	g_return_val_if_fail (TRACKER_IS_STATISTICS (statistics), FALSE);
+	g_return_val_if_fail (G_IS_TASK (res), FALSE);
+
+	return g_task_propagate_boolean (G_TASK (res), error);
+}
+
+/**
+ * tracker_statistics_to_variant:
+ * @statistics: a #TrackerStatistics
+ *
+ * Returns the last known statistics as a floating a{sv} variant with
+ * the following keys:
+ *   - "graphs" (a{sa{sx}}): Per graph and class resource counts
+ *   - "files" (x): Number of available files, excluding folders
+ *   - "folders" (x): Number of available folders
+ *   - "sequence" (t): Number of changes these counts reflect
+ *   - "up-to-date" (b): Whether later changes are not reflected yet
+ *
+ * Graphs and classes are given as full IRIs. Counts are estimated
+ * from notified changes since the miner started.
+ *
+ * Returns: (transfer floating): The statistics
+ **/
+GVariant *
+tracker_statistics_to_variant (TrackerStatistics *statistics)
+{
+	GVariantBuilder builder, graphs;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_return_val_if_fail (TRACKER_IS_STATISTICS (statistics), NULL);
+
+	g_variant_builder_init (&graphs, G_VARIANT_TYPE ("a{sa{sx}}"));
+
+	g_hash_table_iter_init (&iter, statistics->graphs);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		GVariantBuilder classes;
+		GHashTableIter class_iter;
+		gpointer class_name, count;
+
+		g_variant_builder_init (&classes, G_VARIANT_TYPE ("a{sx}"));
+
+		g_hash_table_iter_init (&class_iter, value);
+		while (g_hash_table_iter_next (&class_iter, &class_name, &count)) {
+			gint64 rounded = (gint64) (*(gdouble *) count + 0.5);
+
+			if (rounded <= 0)
+				continue;
+
+			g_variant_builder_add (&classes, "{sx}", class_name, rounded);
+		}
+
+		g_variant_builder_add (&graphs, "{sa{sx}}", key, &classes);
+	}
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+	g_variant_builder_add (&builder, "{sv}", "graphs",
+	                       g_variant_builder_end (&graphs));
+	g_variant_builder_add (&builder, "{sv}", "files",
+	                       g_variant_new_int64 ((gint64) (statistics->files + 0.5)));
+	g_variant_builder_add (&builder, "{sv}", "folders",
+	                       g_variant_new_int64 ((gint64) (statistics->folders + 0.5)));
+	g_variant_builder_add (&builder, "{sv}", "sequence",
+	                       g_variant_new_uint64 (statistics->updated_sequence));
+	g_variant_builder_add (&builder, "{sv}", "up-to-date",
+	                       g_variant_new_boolean (statistics->seeded &&
+	                                              statistics->updated_sequence == statistics->sequence));
+
+	return g_variant_builder_end (&builder);
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_STATISTICS_H__
+#define __TRACKER_STATISTICS_H__
+
+#include <gio/gio.h>
+#include <tinysparql.h>
+
+#define TRACKER_TYPE_STATISTICS (tracker_statistics_get_type ())
+G_DECLARE_FINAL_TYPE (TrackerStatistics,
+                      tracker_statistics,
+                      TRACKER, STATISTICS,
+                      GObject)
+
+TrackerStatistics * tracker_statistics_new (TrackerSparqlConnection *connection);
+
+void tracker_statistics_invalidate (TrackerStatistics *statistics);
+
+void tracker_statistics_note_changes (TrackerStatistics *statistics);
+
+guint64 tracker_statistics_get_sequence (TrackerStatistics *statistics);
+
+void tracker_statistics_update_async (TrackerStatistics   *statistics,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data);
+
+gboolean tracker_statistics_update_finish (TrackerStatistics  *statistics,
+                                           GAsyncResult       *res,
+                                           GError            **error);
+
+GVariant * tracker_statistics_to_variant (TrackerStatistics *statistics);
+
+#endif /* __TRACKER_STATISTICS_H__ */
@@ -200,6 +200,131 @@ process_toc_tags (TrackerToc *toc)
 	}
 }
 
+/* Album directories are extracted one track at a time, so the cue
+ * sheets found in the directory of the last extracted file are kept
+ * around, parsed. Each is reparsed only if its mtime changes, and the
+ * list of cue sheets in the directory is looked up again only if the
+ * directory mtime changes.
+ */
+typedef struct {
+	Cd *cd;
+	guint64 mtime;
+} CueSheet;
+
+typedef struct {
+	GMutex mutex;
+	TrackerSparqlConnection *conn;
+	TrackerSparqlStatement *stmt;
+	GFile *directory;
+	guint64 directory_mtime;
+	GList *local_cue_sheets;
+	gboolean local_cue_sheets_valid;
+	/* URI -> CueSheet */
+	GHashTable *cue_sheets;
+} CueSheetCache;
+
+static CueSheetCache cache;
+
+static void
+cue_sheet_free (CueSheet *cue_sheet)
+{
+	if (cue_sheet->cd)
+		cd_delete (cue_sheet->cd);
+	g_slice_free (CueSheet, cue_sheet);
+}
+
+static guint64
+get_mtime (GFile *file)
+{
+	g_autoptr (GFileInfo) info = NULL;
+
+	info = g_file_query_info (file,
+	                          G_FILE_ATTRIBUTE_TIME_MODIFIED,
+	                          G_FILE_QUERY_INFO_NONE,
+	                          NULL, NULL);
+	if (!info)
+		return 0;
+
+	return g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+}
+
+static void
+cache_set_directory (GFile *directory)
+{
+	if (cache.directory && g_file_equal (cache.directory, directory))
+		return;
+
+	g_set_object (&cache.directory, directory);
+	g_list_free_full (cache.local_cue_sheets, g_object_unref);
+	cache.local_cue_sheets = NULL;
+	cache.local_cue_sheets_valid = FALSE;
+
+	if (cache.cue_sheets) {
+		g_hash_table_remove_all (cache.cue_sheets);
+	} else {
+		cache.cue_sheets =
+			g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+			                       (GDestroyNotify) cue_sheet_free);
+	}
+}
+
+/* Drops the cached cue sheets, and the connection and statement
+ * used to look them up, on extractor module shutdown.
+ */
+void
+tracker_cue_sheet_clear_cache (void)
+{
+	g_mutex_lock (&cache.mutex);
+
+	g_clear_object (&cache.stmt);
+	g_clear_object (&cache.conn);
+	g_clear_object (&cache.directory);
+	g_list_free_full (cache.local_cue_sheets, g_object_unref);
+	cache.local_cue_sheets = NULL;
+	cache.local_cue_sheets_valid = FALSE;
+	g_clear_pointer (&cache.cue_sheets, g_hash_table_unref);
+
+	g_mutex_unlock (&cache.mutex);
+}
+
+static Cd *
+cache_lookup_cue_sheet (GFile *file)
+{
+	CueSheet *cue_sheet;
+	gchar *uri, *buffer;
+	GError *error = NULL;
+	guint64 mtime;
+
+	uri = g_file_get_uri (file);
+	mtime = get_mtime (file);
+	cue_sheet = g_hash_table_lookup (cache.cue_sheets, uri);
+
+	if (cue_sheet && cue_sheet->mtime == mtime) {
+		g_free (uri);
+		return cue_sheet->cd;
+	}
+
+	if (!g_file_load_contents (file, NULL, &buffer, NULL, NULL, &error)) {
+		g_debug ("Unable to read cue sheet: %s", error->message);
+		g_error_free (error);
+		g_free (uri);
+		return NULL;
+	}
+
+	/* Unparseable cue sheets are also kept, to avoid trying again */
+	cue_sheet = g_slice_new0 (CueSheet);
+	cue_sheet->mtime = mtime;
+	cue_sheet->cd = cue_parse_string (buffer);
+	g_free (buffer);
+
+	if (cue_sheet->cd == NULL)
+		g_debug ("Unable to parse CUE sheet %s.", uri);
+
+	g_hash_table_replace (cache.cue_sheets, uri, cue_sheet);
+
+	return cue_sheet->cd;
+}
+
 /* This function runs in two modes: for external CUE sheets, it will check
  * the FILE field for each track and build a TrackerToc for all the tracks
  * contained in @file_name. If @file_name does not appear in the CUE sheet,
@@ -207,25 +332,16 @@ process_toc_tags (TrackerToc *toc)
  * the whole TOC will be returned regardless of any FILE information.
  */
 static TrackerToc *
-parse_cue_sheet_for_file (const gchar *cue_sheet,
-                          const gchar *file_name)
+create_toc_for_file (Cd          *cd,
+                     const gchar *file_name)
 {
 	TrackerToc *toc;
 	TrackerTocEntry *toc_entry;
-	Cd *cd;
 	Track *track;
 	gint i;
 
 	toc = NULL;
 
-	cd = cue_parse_string (cue_sheet);
-
-	if (cd == NULL) {
-		g_debug ("Unable to parse CUE sheet for %s.",
-		         file_name ? file_name : "(embedded in FLAC)");
-		return NULL;
-	}
-
 	for (i = 1; i <= cd_get_ntrack (cd); i++) {
 		track = cd_get_track (cd, i);
 
@@ -269,8 +385,6 @@ parse_cue_sheet_for_file (const gchar *cue_sheet,
 		toc->entry_list = g_list_prepend (toc->entry_list, toc_entry);
 	}
 
-	cd_delete (cd);
-
 	if (toc != NULL)
 		toc->entry_list = g_list_reverse (toc->entry_list);
 
@@ -281,8 +395,17 @@ TrackerToc *
 tracker_cue_sheet_parse (const gchar *cue_sheet)
 {
 	TrackerToc *result;
+	Cd *cd;
+
+	cd = cue_parse_string (cue_sheet);
+
+	if (cd == NULL) {
+		g_debug ("Unable to parse embedded CUE sheet.");
+		return NULL;
+	}
 
-	result = parse_cue_sheet_for_file (cue_sheet, NULL);
+	result = create_toc_for_file (cd, NULL);
+	cd_delete (cd);
 
 	if (result)
 		process_toc_tags (result);
@@ -292,35 +415,55 @@ tracker_cue_sheet_parse (const gchar *cue_sheet)
 
 static GList *
 find_local_cue_sheets (TrackerSparqlConnection *conn,
-                       GFile                   *audio_file)
+                       GFile                   *directory)
 {
-	g_autoptr (TrackerSparqlStatement) stmt = NULL;
 	g_autoptr (TrackerSparqlCursor) cursor = NULL;
-	g_autoptr (GFile) parent = NULL;
 	g_autofree gchar *parent_uri = NULL;
-	GList *result = NULL;
+	GList *result = NULL, *l;
+	guint64 mtime;
+
+	mtime = get_mtime (directory);
+
+	if (cache.local_cue_sheets_valid && cache.directory_mtime == mtime)
+		goto out;
 
-	stmt = tracker_sparql_connection_load_statement_from_gresource (conn,
-	                                                                "/org/freedesktop/Tracker3/Extract/queries/get-cue-sheets.rq",
-	                                                                NULL, NULL);
-	if (!stmt)
+	if (!cache.stmt || cache.conn != conn) {
+		g_clear_object (&cache.stmt);
+		g_set_object (&cache.conn, conn);
+		cache.stmt =
+			tracker_sparql_connection_load_statement_from_gresource (conn,
+			                                                         "/org/freedesktop/Tracker3/Extract/queries/get-cue-sheets.rq",
+			                                                         NULL, NULL);
+	}
+
+	if (!cache.stmt)
 		return NULL;
 
-	parent = g_file_get_parent (audio_file);
-	parent_uri = g_file_get_uri (parent);
-	tracker_sparql_statement_bind_string (stmt, "parent", parent_uri);
-	cursor = tracker_sparql_statement_execute (stmt, NULL, NULL);
+	parent_uri = g_file_get_uri (directory);
+	tracker_sparql_statement_bind_string (cache.stmt, "parent", parent_uri);
+	cursor = tracker_sparql_statement_execute (cache.stmt, NULL, NULL);
 
 	if (!cursor)
 		return NULL;
 
+	g_list_free_full (cache.local_cue_sheets, g_object_unref);
+	cache.local_cue_sheets = NULL;
+
 	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
 		const gchar *str;
 
 		str = tracker_sparql_cursor_get_string (cursor, 0, NULL);
-		result = g_list_prepend (result, g_file_new_for_uri (str));
+		cache.local_cue_sheets = g_list_prepend (cache.local_cue_sheets,
+		                                         g_file_new_for_uri (str));
 	}
 
+	cache.directory_mtime = mtime;
+	cache.local_cue_sheets_valid = TRUE;
+
+ out:
+	for (l = cache.local_cue_sheets; l; l = l->next)
+		result = g_list_prepend (result, g_object_ref (l->data));
+
 	return result;
 }
 
@@ -351,38 +494,44 @@ tracker_cue_sheet_guess_from_uri (TrackerSparqlConnection *conn,
 {
 	GFile *audio_file;
 	GFile *cue_sheet_file;
+	GFile *directory;
 	gchar *audio_file_name;
 	GList *cue_sheet_list = NULL;
 	TrackerToc *toc;
-	GError *error = NULL;
 	GList *n;
 
 	audio_file = g_file_new_for_uri (uri);
 	audio_file_name = g_file_get_basename (audio_file);
+	directory = g_file_get_parent (audio_file);
+
+	if (!directory) {
+		g_object_unref (audio_file);
+		g_free (audio_file_name);
+		return NULL;
+	}
+
+	g_mutex_lock (&cache.mutex);
+
+	cache_set_directory (directory);
 
 	cue_sheet_file = find_matching_cue_file (audio_file);
 
 	if (cue_sheet_file)
 		cue_sheet_list = g_list_prepend (cue_sheet_list, cue_sheet_file);
 	else if (conn)
-		cue_sheet_list = find_local_cue_sheets (conn, audio_file);
+		cue_sheet_list = find_local_cue_sheets (conn, directory);
 
 	toc = NULL;
 
 	for (n = cue_sheet_list; n != NULL; n = n->next) {
-		gchar *buffer;
+		Cd *cd;
 
 		cue_sheet_file = n->data;
-
-		if (!g_file_load_contents (cue_sheet_file, NULL, &buffer, NULL, NULL, &error)) {
-			g_debug ("Unable to read cue sheet: %s", error->message);
-			g_error_free (error);
+		cd = cache_lookup_cue_sheet (cue_sheet_file);
+		if (!cd)
 			continue;
-		}
 
-		toc = parse_cue_sheet_for_file (buffer, audio_file_name);
-
-		g_free (buffer);
+		toc = create_toc_for_file (cd, audio_file_name);
 
 		if (toc != NULL) {
 			char *path = g_file_get_path (cue_sheet_file);
@@ -392,9 +541,12 @@ tracker_cue_sheet_guess_from_uri (TrackerSparqlConnection *conn,
 		}
 	}
 
+	g_mutex_unlock (&cache.mutex);
+
 	g_list_foreach (cue_sheet_list, (GFunc) g_object_unref, NULL);
 	g_list_free (cue_sheet_list);
 
+	g_object_unref (directory);
 	g_object_unref (audio_file);
 	g_free (audio_file_name);
 
@@ -419,4 +571,9 @@ tracker_cue_sheet_guess_from_uri (TrackerSparqlConnection *conn,
 	return NULL;
 }
 
+void
+tracker_cue_sheet_clear_cache (void)
+{
+}
+
 #endif /* ! HAVE_LIBCUE */
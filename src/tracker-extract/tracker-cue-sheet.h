@@ -52,6 +52,7 @@ void        tracker_toc_add_entry       (TrackerToc *toc,
 TrackerToc *tracker_cue_sheet_parse     (const gchar *cue_sheet);
 TrackerToc *tracker_cue_sheet_guess_from_uri (TrackerSparqlConnection *conn,
                                               const gchar             *uri);
+void        tracker_cue_sheet_clear_cache (void);
 
 G_END_DECLS
 
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config-miners.h"
+
+#include <libtracker-miners-common/tracker-common.h>
+
+#include "tracker-decorator-device.h"
+
+static void
+tracker_decorator_device_free (TrackerDecoratorDevice *device)
+{
+	g_free (device->id);
+	g_slice_free (TrackerDecoratorDevice, device);
+}
+
+/* Returns a table of devices by their ID, owning them */
+GHashTable *
+tracker_decorator_device_table_new (void)
+{
+	return g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+	                              (GDestroyNotify) tracker_decorator_device_free);
+}
+
+/* Returns the device @content_id lives in, items whose content
+ * identifier has no filesystem ID are all put in the same one.
+ */
+TrackerDecoratorDevice *
+tracker_decorator_device_lookup (GHashTable  *devices,
+                                 const gchar *content_id)
+{
+	TrackerDecoratorDevice *device;
+	g_autofree gchar *id = NULL;
+
+	id = tracker_content_identifier_get_filesystem_id (content_id);
+	if (!id)
+		id = g_strdup ("unknown");
+
+	device = g_hash_table_lookup (devices, id);
+
+	if (!device) {
+		device = g_slice_new0 (TrackerDecoratorDevice);
+		device->id = g_steal_pointer (&id);
+		g_hash_table_insert (devices, device->id, device);
+	}
+
+	return device;
+}
+
+/* Returns the first of @items whose device was served the longest
+ * time ago.
+ */
+GList *
+tracker_decorator_device_find_next (GList                      *items,
+                                    TrackerDecoratorDeviceFunc  get_device)
+{
+	TrackerDecoratorDevice *next_device = NULL;
+	GList *l, *next = NULL;
+
+	for (l = items; l; l = l->next) {
+		TrackerDecoratorDevice *device = get_device (l->data);
+
+		if (!next_device ||
+		    device->last_served < next_device->last_served) {
+			next = l;
+			next_device = device;
+		}
+	}
+
+	return next;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#ifndef __TRACKER_DECORATOR_DEVICE_H__
+#define __TRACKER_DECORATOR_DEVICE_H__
+
+#include <glib.h>
+
+typedef struct _TrackerDecoratorDevice TrackerDecoratorDevice;
+
+/* Items are grouped by the filesystem their content identifier
+ * points to, the devices with items in the cache take turns. The
+ * cache is filled without regard to devices though, so a cache
+ * full of items from a slow device still has to be drained before
+ * the others get a turn.
+ */
+struct _TrackerDecoratorDevice {
+	gchar *id;
+	/* Serial of the last item handed out, 0 if none was */
+	guint64 last_served;
+	guint n_processed;
+	guint64 n_bytes;
+	guint64 n_readahead_bytes;
+	gdouble elapsed;
+};
+
+typedef TrackerDecoratorDevice * (* TrackerDecoratorDeviceFunc) (gconstpointer item);
+
+GHashTable *             tracker_decorator_device_table_new (void);
+TrackerDecoratorDevice * tracker_decorator_device_lookup    (GHashTable                 *devices,
+                                                             const gchar                *content_id);
+GList *                  tracker_decorator_device_find_next (GList                      *items,
+                                                             TrackerDecoratorDeviceFunc  get_device);
+
+#endif /* __TRACKER_DECORATOR_DEVICE_H__ */
@@ -23,12 +23,23 @@
 
 #include <libtracker-miners-common/tracker-common.h>
 
+#include <libtracker-extract/tracker-extract.h>
+
 #include "tracker-decorator.h"
+#include "tracker-decorator-device.h"
+
+#include <sys/stat.h>
 
 #ifdef HAVE_POSIX_FADVISE
 #include <fcntl.h>
 #endif
 
+#ifdef HAVE_FIEMAP
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <linux/fiemap.h>
+#endif
+
 #define QUERY_BATCH_SIZE 200
 #define DEFAULT_BATCH_SIZE 200
 
@@ -54,6 +65,14 @@ struct _TrackerDecoratorInfo {
 	GTask *task;
 	gchar *url;
 	gchar *content_id;
+	TrackerDecoratorDevice *device;
+	gint64 start_time;
+	/* Disk location and size, only known with a readahead budget */
+	guint64 location;
+	gboolean has_location;
+	guint64 inode;
+	goffset size;
+	goffset readahead_len;
 	gint id;
 	gint ref_count;
 };
@@ -65,6 +84,18 @@ struct _TrackerDecoratorPrivate {
 	gssize n_processed_items;
 
 	GQueue item_cache; /* Queue of TrackerDecoratorInfo */
+	/* IDs of the items deleted while the layout of the cached
+	 * items is queried, NULL otherwise.
+	 */
+	GHashTable *deleted_ids;
+	GHashTable *devices; /* Device ID -> TrackerDecoratorDevice */
+	guint64 n_served;
+
+	/* Bytes of upcoming items to read ahead, 0 to only hint the
+	 * next item.
+	 */
+	gsize readahead_budget;
+	gsize readahead_pending;
 
 	GStrv priority_graphs;
 
@@ -131,6 +162,7 @@ tracker_decorator_info_new (TrackerDecorator    *decorator,
 	info->url = g_strdup (tracker_sparql_cursor_get_string (cursor, 0, NULL));
 	info->id = tracker_sparql_cursor_get_integer (cursor, 1);
 	info->content_id = g_strdup (tracker_sparql_cursor_get_string (cursor, 2, NULL));
+	info->device = tracker_decorator_device_lookup (priv->devices, info->content_id);
 	info->ref_count = 1;
 
 	info->task = g_task_new (decorator,
@@ -187,6 +219,7 @@ G_DEFINE_BOXED_TYPE (TrackerDecoratorInfo,
 
 static void
 hint_file_needed (GFile    *file,
+                  goffset   len,
                   gboolean  needed)
 {
 #ifdef HAVE_POSIX_FADVISE
@@ -198,7 +231,7 @@ hint_file_needed (GFile    *file,
 		return;
 
 	fd = tracker_file_open_fd (path);
-	posix_fadvise (fd, 0, 0,
+	posix_fadvise (fd, 0, len,
 	               needed ? POSIX_FADV_WILLNEED : POSIX_FADV_DONTNEED);
 	close (fd);
 #endif /* HAVE_POSIX_FADVISE */
@@ -211,7 +244,87 @@ tracker_decorator_info_hint_needed (TrackerDecoratorInfo *info,
 	g_autoptr (GFile) file = NULL;
 
 	file = g_file_new_for_uri (info->url);
-	hint_file_needed (file, needed);
+	/* Whatever was read, drop all of it */
+	hint_file_needed (file, needed ? info->readahead_len : 0, needed);
+}
+
+/* Finds out where the file starts on disk, its inode number and
+ * its size. This opens the file, so it runs in a thread.
+ */
+static void
+tracker_decorator_info_query_layout (TrackerDecoratorInfo *info)
+{
+	g_autoptr (GFile) file = NULL;
+	g_autofree gchar *path = NULL;
+	const gchar *inode;
+	struct stat st;
+	int fd;
+
+	if (info->content_id) {
+		inode = strrchr (info->content_id, ':');
+		if (inode)
+			info->inode = g_ascii_strtoull (inode + 1, NULL, 10);
+	}
+
+	if (!info->url)
+		return;
+
+	file = g_file_new_for_uri (info->url);
+	path = g_file_get_path (file);
+	if (!path)
+		return;
+
+	fd = tracker_file_open_fd (path);
+	if (fd < 0)
+		return;
+
+	if (fstat (fd, &st) == 0) {
+		info->size = st.st_size;
+		if (info->inode == 0)
+			info->inode = st.st_ino;
+	}
+
+#ifdef HAVE_FIEMAP
+	{
+		struct {
+			struct fiemap fiemap;
+			struct fiemap_extent extent;
+		} request = { 0, };
+
+		request.fiemap.fm_length = FIEMAP_MAX_OFFSET;
+		request.fiemap.fm_extent_count = 1;
+
+		if (ioctl (fd, FS_IOC_FIEMAP, &request) == 0 &&
+		    request.fiemap.fm_mapped_extents > 0 &&
+		    (request.extent.fe_flags & FIEMAP_EXTENT_UNKNOWN) == 0) {
+			info->location = request.extent.fe_physical;
+			info->has_location = TRUE;
+		}
+	}
+#endif /* HAVE_FIEMAP */
+
+	close (fd);
+}
+
+static TrackerDecoratorDevice *
+decorator_info_get_device (gconstpointer item)
+{
+	const TrackerDecoratorInfo *info = item;
+
+	return info->device;
+}
+
+/* Returns the first cached item of the device that was
+ * served the longest time ago.
+ */
+static GList *
+decorator_find_next_item (TrackerDecorator *decorator)
+{
+	TrackerDecoratorPrivate *priv =
+		tracker_decorator_get_instance_private (decorator);
+
+	return tracker_decorator_device_find_next (g_queue_peek_head_link (&priv->item_cache),
+	                                           decorator_info_get_device);
 }
 
 static void
@@ -219,12 +332,135 @@ decorator_hint_next_file_needed (TrackerDecorator *decorator)
 {
 	TrackerDecoratorPrivate *priv =
 		tracker_decorator_get_instance_private (decorator);
-	TrackerDecoratorInfo *next_info;
-	g_autoptr (GFile) file = NULL;
+	GList *l;
+
+	if (priv->readahead_budget == 0) {
+		l = decorator_find_next_item (decorator);
+		if (l)
+			tracker_decorator_info_hint_needed (l->data, TRUE);
+		return;
+	}
+
+	/* The cache is in the order items will be handed out, read
+	 * ahead as much of it as the budget allows.
+	 */
+	for (l = g_queue_peek_head_link (&priv->item_cache);
+	     l && priv->readahead_pending < priv->readahead_budget;
+	     l = l->next) {
+		TrackerDecoratorInfo *info = l->data;
 
-	next_info = g_queue_peek_head (&priv->item_cache);
-	if (next_info)
-		tracker_decorator_info_hint_needed (next_info, TRUE);
+		if (info->readahead_len > 0 || info->size == 0)
+			continue;
+
+		info->readahead_len = MIN ((gsize) info->size,
+		                           priv->readahead_budget - priv->readahead_pending);
+		priv->readahead_pending += info->readahead_len;
+		info->device->n_readahead_bytes += info->readahead_len;
+		tracker_decorator_info_hint_needed (info, TRUE);
+	}
+}
+
+static void
+decorator_release_readahead (TrackerDecorator     *decorator,
+                             TrackerDecoratorInfo *info)
+{
+	TrackerDecoratorPrivate *priv =
+		tracker_decorator_get_instance_private (decorator);
+
+	priv->readahead_pending -= info->readahead_len;
+	info->readahead_len = 0;
+}
+
+/* Items whose location on disk is known go first, by location.
+ * The others follow by inode number, files created together tend
+ * to get close ones.
+ */
+static gint
+compare_info_location (gconstpointer a,
+                       gconstpointer b,
+                       gpointer      user_data)
+{
+	const TrackerDecoratorInfo *info_a = a, *info_b = b;
+
+	if (info_a->has_location != info_b->has_location)
+		return info_a->has_location ? -1 : 1;
+
+	if (info_a->has_location) {
+		return (info_a->location > info_b->location) -
+			(info_a->location < info_b->location);
+	}
+
+	return (info_a->inode > info_b->inode) -
+		(info_a->inode < info_b->inode);
+}
+
+static gint
+compare_device_last_served (gconstpointer a,
+                            gconstpointer b)
+{
+	const TrackerDecoratorDevice *device_a = *(TrackerDecoratorDevice **) a;
+	const TrackerDecoratorDevice *device_b = *(TrackerDecoratorDevice **) b;
+
+	return (device_a->last_served > device_b->last_served) -
+		(device_a->last_served < device_b->last_served);
+}
+
+/* Sorts the items of each device by their location on disk, so
+ * they are read with as little seeking as possible. Devices are
+ * interleaved in the order they take turns, so the cache is in
+ * the order items are handed out. This only reorders the cached
+ * items, it does not change which items get in the cache.
+ */
+static void
+decorator_sort_item_cache (TrackerDecorator *decorator)
+{
+	TrackerDecoratorPrivate *priv =
+		tracker_decorator_get_instance_private (decorator);
+	g_autoptr (GHashTable) queues = NULL;
+	g_autoptr (GPtrArray) devices = NULL;
+	TrackerDecoratorInfo *info;
+	gboolean added;
+	guint i;
+
+	queues = g_hash_table_new_full (NULL, NULL, NULL,
+	                                (GDestroyNotify) g_queue_free);
+	devices = g_ptr_array_new ();
+
+	while ((info = g_queue_pop_head (&priv->item_cache)) != NULL) {
+		GQueue *queue;
+
+		queue = g_hash_table_lookup (queues, info->device);
+		if (!queue) {
+			queue = g_queue_new ();
+			g_hash_table_insert (queues, info->device, queue);
+			g_ptr_array_add (devices, info->device);
+		}
+
+		g_queue_push_tail (queue, info);
+	}
+
+	g_ptr_array_sort (devices, compare_device_last_served);
+
+	for (i = 0; i < devices->len; i++) {
+		g_queue_sort (g_hash_table_lookup (queues, g_ptr_array_index (devices, i)),
+		              compare_info_location, NULL);
+	}
+
+	do {
+		added = FALSE;
+
+		for (i = 0; i < devices->len; i++) {
+			GQueue *queue;
+
+			queue = g_hash_table_lookup (queues, g_ptr_array_index (devices, i));
+			info = g_queue_pop_head (queue);
+
+			if (info) {
+				g_queue_push_tail (&priv->item_cache, info);
+				added = TRUE;
+			}
+		}
+	} while (added);
 }
 
 static void
@@ -401,6 +637,25 @@ decorator_finish (TrackerDecorator *decorator)
 
 	priv = tracker_decorator_get_instance_private (decorator);
 
+#ifdef G_ENABLE_DEBUG
+	if (TRACKER_DEBUG_CHECK (DECORATOR)) {
+		GHashTableIter iter;
+		TrackerDecoratorDevice *device;
+
+		g_hash_table_iter_init (&iter, priv->devices);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &device)) {
+			g_message ("[Decorator] Device '%s': %u items extracted in %.2fs, "
+			           "%" G_GUINT64_FORMAT " bytes (%.2f MB/s), "
+			           "%" G_GUINT64_FORMAT " bytes read ahead",
+			           device->id, device->n_processed, device->elapsed,
+			           device->n_bytes,
+			           device->elapsed > 0 ?
+			           device->n_bytes / device->elapsed / 1000000 : 0,
+			           device->n_readahead_bytes);
+		}
+	}
+#endif
+
 	priv->processing = FALSE;
 	priv->n_remaining_items = priv->n_processed_items = 0;
 	g_signal_emit (decorator, signals[FINISHED], 0);
@@ -412,13 +667,16 @@ static void
 decorator_rebuild_cache (TrackerDecorator *decorator)
 {
 	TrackerDecoratorPrivate *priv;
+	TrackerDecoratorInfo *info;
 
 	priv = tracker_decorator_get_instance_private (decorator);
 
 	priv->n_remaining_items = 0;
-	g_queue_foreach (&priv->item_cache,
-	                 (GFunc) tracker_decorator_info_unref, NULL);
-	g_queue_clear (&priv->item_cache);
+
+	while ((info = g_queue_pop_head (&priv->item_cache)) != NULL) {
+		decorator_release_readahead (decorator, info);
+		tracker_decorator_info_unref (info);
+	}
 
 	decorator_cache_next_items (decorator);
 }
@@ -442,6 +700,14 @@ decorator_task_done (GObject      *object,
 	extract_info = g_task_propagate_pointer (G_TASK (result), &error);
 
 	tracker_decorator_info_hint_needed (info, FALSE);
+	decorator_release_readahead (decorator, info);
+
+	if (info->start_time > 0) {
+		info->device->n_processed++;
+		info->device->n_bytes += info->size;
+		info->device->elapsed +=
+			(gdouble) (g_get_monotonic_time () - info->start_time) / G_USEC_PER_SEC;
+	}
 
 	if (!extract_info) {
 		if (error) {
@@ -550,6 +816,9 @@ decorator_item_cache_remove (TrackerDecorator *decorator,
 
 	priv = tracker_decorator_get_instance_private (decorator);
 
+	if (priv->deleted_ids)
+		g_hash_table_add (priv->deleted_ids, GINT_TO_POINTER (id));
+
 	for (item = g_queue_peek_head_link (&priv->item_cache);
 	     item; item = item->next) {
 		TrackerDecoratorInfo *info = item->data;
@@ -558,11 +827,98 @@ decorator_item_cache_remove (TrackerDecorator *decorator,
 			continue;
 
 		g_queue_remove (&priv->item_cache, info);
+		decorator_release_readahead (decorator, info);
 		tracker_decorator_info_unref (info);
 		break;
 	}
 }
 
+static void
+decorator_items_cached (TrackerDecorator *decorator,
+                        gboolean          queue_was_empty);
+
+static void
+query_item_layouts_thread (GTask        *task,
+                           gpointer      source_object,
+                           gpointer      task_data,
+                           GCancellable *cancellable)
+{
+	GPtrArray *items = task_data;
+	guint i;
+
+	for (i = 0; i < items->len; i++) {
+		if (g_task_return_error_if_cancelled (task))
+			return;
+
+		tracker_decorator_info_query_layout (g_ptr_array_index (items, i));
+	}
+
+	g_task_return_boolean (task, TRUE);
+}
+
+static void
+query_item_layouts_cb (GObject      *object,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+	TrackerDecorator *decorator = TRACKER_DECORATOR (object);
+	TrackerDecoratorPrivate *priv;
+	g_autoptr (GHashTable) deleted_ids = NULL;
+	GPtrArray *items;
+	guint i;
+
+	priv = tracker_decorator_get_instance_private (decorator);
+	priv->querying = FALSE;
+	deleted_ids = g_steal_pointer (&priv->deleted_ids);
+
+	if (!g_task_propagate_boolean (G_TASK (result), NULL))
+		return;
+
+	items = g_task_get_task_data (G_TASK (result));
+
+	for (i = 0; i < items->len; i++) {
+		TrackerDecoratorInfo *info = g_ptr_array_index (items, i);
+
+		if (g_hash_table_contains (deleted_ids, GINT_TO_POINTER (info->id)))
+			continue;
+
+		g_queue_push_tail (&priv->item_cache,
+		                   tracker_decorator_info_ref (info));
+	}
+
+	decorator_sort_item_cache (decorator);
+	TRACKER_NOTE (DECORATOR, g_message ("[Decorator] Sorted %u items by disk location",
+	                                    g_queue_get_length (&priv->item_cache)));
+
+	decorator_items_cached (decorator, TRUE);
+}
+
+/* Takes the cached items out while their layout on disk is
+ * queried in a thread, the next batch is not queried meanwhile.
+ */
+static void
+decorator_query_item_layouts (TrackerDecorator *decorator)
+{
+	TrackerDecoratorPrivate *priv;
+	g_autoptr (GTask) task = NULL;
+	TrackerDecoratorInfo *info;
+	GPtrArray *items;
+
+	priv = tracker_decorator_get_instance_private (decorator);
+	priv->querying = TRUE;
+	priv->deleted_ids = g_hash_table_new (NULL, NULL);
+
+	items = g_ptr_array_new_with_free_func ((GDestroyNotify) tracker_decorator_info_unref);
+
+	while ((info = g_queue_pop_head (&priv->item_cache)) != NULL)
+		g_ptr_array_add (items, info);
+
+	task = g_task_new (decorator, priv->cancellable,
+	                   query_item_layouts_cb, NULL);
+	g_task_set_task_data (task, items, (GDestroyNotify) g_ptr_array_unref);
+	g_task_run_in_thread (task, query_item_layouts_thread);
+}
+
 static void
 decorator_cache_items_cb (GObject      *object,
                           GAsyncResult *result,
@@ -594,6 +950,28 @@ decorator_cache_items_cb (GObject      *object,
 		}
 	}
 
+	/* Sidecars changed since the last batch make their images
+	 * show up again as items to extract, have the sidecar listings
+	 * checked again against their directory.
+	 */
+	tracker_xmp_reset_sidecar_cache ();
+
+	if (priv->readahead_budget > 0 && !g_queue_is_empty (&priv->item_cache)) {
+		decorator_query_item_layouts (decorator);
+		return;
+	}
+
+	decorator_items_cached (decorator, queue_was_empty);
+}
+
+static void
+decorator_items_cached (TrackerDecorator *decorator,
+                        gboolean          queue_was_empty)
+{
+	TrackerDecoratorPrivate *priv;
+
+	priv = tracker_decorator_get_instance_private (decorator);
+
 	if (!g_queue_is_empty (&priv->item_cache) && !priv->processing) {
 		decorator_start (decorator);
 	} else if (g_queue_is_empty (&priv->item_cache) && priv->processing) {
@@ -814,6 +1192,7 @@ tracker_decorator_finalize (GObject *object)
 	                 (GFunc) tracker_decorator_info_unref,
 	                 NULL);
 	g_queue_clear (&priv->item_cache);
+	g_hash_table_unref (priv->devices);
 
 	g_clear_pointer (&priv->sparql_buffer, g_ptr_array_unref);
 	g_clear_pointer (&priv->commit_buffer, g_ptr_array_unref);
@@ -955,6 +1334,7 @@ tracker_decorator_init (TrackerDecorator *decorator)
 	priv->task_cancellable = g_cancellable_new ();
 
 	g_queue_init (&priv->item_cache);
+	priv->devices = tracker_decorator_device_table_new ();
 }
 
 /**
@@ -988,6 +1368,7 @@ tracker_decorator_next (TrackerDecorator  *decorator,
 {
 	TrackerDecoratorPrivate *priv;
 	TrackerDecoratorInfo *info;
+	GList *next;
 
 	g_return_val_if_fail (TRACKER_IS_DECORATOR (decorator), NULL);
 
@@ -1001,16 +1382,116 @@ tracker_decorator_next (TrackerDecorator  *decorator,
 		return NULL;
 	}
 
-	info = g_queue_pop_head (&priv->item_cache);
-	if (!info)
+	next = decorator_find_next_item (decorator);
+	if (!next)
 		return NULL;
 
+	info = next->data;
+	g_queue_delete_link (&priv->item_cache, next);
+	info->device->last_served = ++priv->n_served;
+	info->start_time = g_get_monotonic_time ();
+
 	TRACKER_NOTE (DECORATOR, g_message ("[Decorator] Next item %s", info->url));
 	decorator_hint_next_file_needed (decorator);
 
 	return info;
 }
 
+/**
+ * tracker_decorator_get_device_stats:
+ * @decorator: a #TrackerDecorator
+ *
+ * Returns per device extraction statistics as a floating a{sv}
+ * variant, keyed by the filesystem ID found in the content
+ * identifier of the items. Each value is an a{sv} variant with
+ * the following keys:
+ *   - "queued" (u): Number of items waiting in the cache
+ *   - "processed" (u): Number of items processed
+ *   - "bytes" (t): Total size of those items, only known with a
+ *     readahead budget
+ *   - "readahead" (t): Bytes read ahead
+ *   - "elapsed" (d): Seconds spent processing those items
+ *
+ * Returns: (transfer floating): The statistics
+ **/
+GVariant *
+tracker_decorator_get_device_stats (TrackerDecorator *decorator)
+{
+	TrackerDecoratorPrivate *priv;
+	g_autoptr (GHashTable) queued = NULL;
+	GVariantBuilder builder;
+	GHashTableIter iter;
+	TrackerDecoratorDevice *device;
+	GList *l;
+
+	g_return_val_if_fail (TRACKER_IS_DECORATOR (decorator), NULL);
+
+	priv = tracker_decorator_get_instance_private (decorator);
+	queued = g_hash_table_new (NULL, NULL);
+
+	for (l = g_queue_peek_head_link (&priv->item_cache); l; l = l->next) {
+		TrackerDecoratorInfo *info = l->data;
+		guint n_queued;
+
+		n_queued = GPOINTER_TO_UINT (g_hash_table_lookup (queued, info->device));
+		g_hash_table_insert (queued, info->device, GUINT_TO_POINTER (n_queued + 1));
+	}
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_hash_table_iter_init (&iter, priv->devices);
+
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &device)) {
+		GVariantBuilder device_builder;
+
+		g_variant_builder_init (&device_builder, G_VARIANT_TYPE_VARDICT);
+		g_variant_builder_add (&device_builder, "{sv}", "queued",
+		                       g_variant_new_uint32 (GPOINTER_TO_UINT (g_hash_table_lookup (queued, device))));
+		g_variant_builder_add (&device_builder, "{sv}", "processed",
+		                       g_variant_new_uint32 (device->n_processed));
+		g_variant_builder_add (&device_builder, "{sv}", "bytes",
+		                       g_variant_new_uint64 (device->n_bytes));
+		g_variant_builder_add (&device_builder, "{sv}", "readahead",
+		                       g_variant_new_uint64 (device->n_readahead_bytes));
+		g_variant_builder_add (&device_builder, "{sv}", "elapsed",
+		                       g_variant_new_double (device->elapsed));
+		g_variant_builder_add (&builder, "{sv}", device->id,
+		                       g_variant_builder_end (&device_builder));
+	}
+
+	return g_variant_builder_end (&builder);
+}
+
+/**
+ * tracker_decorator_set_readahead_budget:
+ * @decorator: a #TrackerDecorator
+ * @budget: bytes to read ahead, or 0
+ *
+ * Sets how many bytes of the upcoming items may be read ahead at
+ * once. With a budget, each batch of items is sorted by location
+ * on disk and read ahead in that order, meant to reduce seeking on
+ * rotational disks. Items that did not fit are read ahead as
+ * others are processed. The budget applies from the next batch of
+ * items on.
+ *
+ * With a budget of 0, the default, only the next item is read
+ * ahead, in the order the store returned the items.
+ **/
+void
+tracker_decorator_set_readahead_budget (TrackerDecorator *decorator,
+                                        gsize             budget)
+{
+	TrackerDecoratorPrivate *priv;
+
+	g_return_if_fail (TRACKER_IS_DECORATOR (decorator));
+
+	priv = tracker_decorator_get_instance_private (decorator);
+
+	if (priv->readahead_budget == budget)
+		return;
+
+	priv->readahead_budget = budget;
+}
+
 void
 tracker_decorator_set_priority_graphs (TrackerDecorator    *decorator,
                                        const gchar * const *graphs)
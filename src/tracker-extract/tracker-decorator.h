@@ -93,9 +93,14 @@ guint         tracker_decorator_get_n_items       (TrackerDecorator     *decorat
 TrackerDecoratorInfo * tracker_decorator_next (TrackerDecorator  *decorator,
                                                GError           **error);
 
+GVariant *    tracker_decorator_get_device_stats  (TrackerDecorator     *decorator);
+
 void          tracker_decorator_set_priority_graphs (TrackerDecorator    *decorator,
                                                      const gchar * const *graphs);
 
+void          tracker_decorator_set_readahead_budget (TrackerDecorator *decorator,
+                                                      gsize             budget);
+
 void tracker_decorator_invalidate_cache (TrackerDecorator *decorator);
 
 GType         tracker_decorator_info_get_type     (void) G_GNUC_CONST;
@@ -52,6 +52,9 @@ static const gchar *introspection_xml =
 	"    <signal name='Error'>"
 	"      <arg type='a{sv}' name='data' direction='out' />"
 	"    </signal>"
+	"    <method name='GetStatistics'>"
+	"      <arg type='a{sv}' direction='out' />"
+	"    </method>"
 	"  </interface>"
 	"</node>";
 
@@ -112,6 +115,13 @@ update_extract_config (TrackerExtractController *controller,
 				tracker_extract_set_max_text (extract, max_bytes);
 				g_object_unref (extract);
 			}
+		} else if (g_strcmp0 (key, "readahead-budget") == 0 &&
+		           g_variant_is_of_type (value, G_VARIANT_TYPE_INT32)) {
+			gint budget;
+
+			budget = g_variant_get_int32 (value);
+			tracker_decorator_set_readahead_budget (priv->decorator,
+			                                        (gsize) MAX (budget, 0) * 1024 * 1024);
 		} else if (g_strcmp0 (key, "on-battery") == 0 &&
 		           g_variant_is_of_type (value, G_VARIANT_TYPE_BOOLEAN)) {
 			tracker_extract_decorator_set_throttled (TRACKER_EXTRACT_DECORATOR (priv->decorator),
@@ -174,6 +184,37 @@ set_up_persistence (TrackerExtractController  *controller,
 	return TRUE;
 }
 
+static void
+handle_method_call (GDBusConnection       *connection,
+                    const gchar           *sender,
+                    const gchar           *object_path,
+                    const gchar           *interface_name,
+                    const gchar           *method_name,
+                    GVariant              *parameters,
+                    GDBusMethodInvocation *invocation,
+                    gpointer               user_data)
+{
+	TrackerExtractController *controller = user_data;
+	TrackerExtractControllerPrivate *priv =
+		tracker_extract_controller_get_instance_private (controller);
+
+	if (g_strcmp0 (method_name, "GetStatistics") == 0) {
+		GVariantBuilder builder;
+
+		g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+		g_variant_builder_add (&builder, "{sv}", "devices",
+		                       tracker_decorator_get_device_stats (priv->decorator));
+		g_dbus_method_invocation_return_value (invocation,
+		                                       g_variant_new ("(a{sv})", &builder));
+	} else {
+		g_dbus_method_invocation_return_error (invocation,
+		                                       G_DBUS_ERROR,
+		                                       G_DBUS_ERROR_UNKNOWN_METHOD,
+		                                       "Unknown method %s",
+		                                       method_name);
+	}
+}
+
 static gboolean
 tracker_extract_controller_initable_init (GInitable     *initable,
                                           GCancellable  *cancellable,
@@ -183,7 +224,7 @@ tracker_extract_controller_initable_init (GInitable     *initable,
 	TrackerExtractControllerPrivate *priv;
 	g_autoptr (GDBusNodeInfo) introspection_data = NULL;
 	GDBusInterfaceVTable interface_vtable = {
-		NULL, NULL, NULL
+		handle_method_call, NULL, NULL
 	};
 
 	controller = TRACKER_EXTRACT_CONTROLLER (initable);
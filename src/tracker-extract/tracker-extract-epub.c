@@ -519,6 +519,13 @@ content_xml_text_handler (GMarkupParseContext   *context,
 		return;
 	}
 
+	if (content_data->limit == 0) {
+		/* Stop parsing, so the rest of the file is not inflated */
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+		                     "Maximum text limit reached");
+		return;
+	}
+
 	if (tracker_text_validate_utf8 (text,
 	                                MIN (text_len, content_data->limit),
 	                                &content_data->contents,
@@ -532,7 +539,7 @@ content_xml_text_handler (GMarkupParseContext   *context,
 }
 
 static gchar *
-extract_opf_path (const gchar *uri)
+extract_opf_path (TrackerZip *zip)
 {
 	GMarkupParseContext *context;
 	gchar *path = NULL;
@@ -548,7 +555,7 @@ extract_opf_path (const gchar *uri)
 	/* Load the internal container file from the Zip archive,
 	 * and parse it to extract the .opf file to get metadata from
 	 */
-	tracker_gsf_parse_xml_in_zip (uri, "META-INF/container.xml", context, &error);
+	tracker_zip_parse_xml (zip, "META-INF/container.xml", context, &error);
 	g_markup_parse_context_free (context);
 
 	if (error || !path) {
@@ -563,7 +570,7 @@ extract_opf_path (const gchar *uri)
 
 static gchar *
 extract_opf_contents (TrackerExtractInfo *info,
-                      const gchar        *uri,
+                      TrackerZip         *zip,
                       const gchar        *content_prefix,
                       GList              *content_files)
 {
@@ -589,9 +596,11 @@ extract_opf_contents (TrackerExtractInfo *info,
 
 		/* Page file is relative to OPF file location */
 		path = g_build_filename (content_prefix, l->data, NULL);
-		tracker_gsf_parse_xml_in_zip (uri, path, context, &error);
+		tracker_zip_parse_xml (zip, path, context, &error);
 
-		if (error) {
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+			g_clear_error (&error);
+		} else if (error) {
 			g_warning ("Error extracting EPUB contents (%s): %s",
 				   path, error->message);
 			g_clear_error (&error);
@@ -612,6 +621,7 @@ extract_opf_contents (TrackerExtractInfo *info,
 static TrackerResource *
 extract_opf (TrackerExtractInfo *info,
              const gchar        *uri,
+             TrackerZip         *zip,
              const gchar        *opf_path)
 {
 	TrackerResource *ebook;
@@ -644,7 +654,7 @@ extract_opf (TrackerExtractInfo *info,
 	/* Load the internal container file from the Zip archive,
 	 * and parse it to extract the .opf file to get metadata from
 	 */
-	tracker_gsf_parse_xml_in_zip (uri, opf_path, context, &error);
+	tracker_zip_parse_xml (zip, opf_path, context, &error);
 	g_markup_parse_context_free (context);
 
 	if (error) {
@@ -657,7 +667,7 @@ extract_opf (TrackerExtractInfo *info,
 	}
 
 	dirname = g_path_get_dirname (opf_path);
-	contents = extract_opf_contents (info, uri, dirname, data->pages);
+	contents = extract_opf_contents (info, zip, dirname, data->pages);
 	g_free (dirname);
 
 	if (contents && *contents) {
@@ -675,20 +685,28 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
                               GError             **error)
 {
 	TrackerResource *ebook;
+	g_autoptr (TrackerZip) zip = NULL;
 	gchar *opf_path, *uri;
 	GFile *file;
 
 	file = tracker_extract_info_get_file (info);
 	uri = g_file_get_uri (file);
 
-	opf_path = extract_opf_path (uri);
+	/* The archive is opened once for all the files inside */
+	zip = tracker_zip_open (uri, error);
+	if (!zip) {
+		g_free (uri);
+		return FALSE;
+	}
+
+	opf_path = extract_opf_path (zip);
 
 	if (!opf_path) {
 		g_free (uri);
 		return FALSE;
 	}
 
-	ebook = extract_opf (info, uri, opf_path);
+	ebook = extract_opf (info, uri, zip, opf_path);
 	g_free (opf_path);
 	g_free (uri);
 
@@ -112,10 +112,10 @@ read_metadata (GifFileType        *gifFile,
 	GifRecordType RecordType;
 	int frameheight;
 	int framewidth;
-	unsigned char *framedata = NULL;
+	int codesize;
+	GifByteType *codeblock;
 	GPtrArray *keywords;
 	guint i;
-	gint h;
 	int status;
 	MergeData md = { 0 };
 	GifData   gd = { 0 };
@@ -150,26 +150,34 @@ read_metadata (GifFileType        *gifFile,
 			framewidth  = gifFile->Image.Width;
 			frameheight = gifFile->Image.Height;
 
-			framedata = g_malloc_n (framewidth, sizeof(GifPixelType));
-			for (h = 0; h < frameheight; h++)
-			{
-				if (DGifGetLine(gifFile, framedata, framewidth)==GIF_ERROR) {
-					g_free (framedata);
+			/* Only the image descriptor is needed, skip over the
+			 * LZW compressed raster sub-blocks without decoding them.
+			 */
+			if (DGifGetCode (gifFile, &codesize, &codeblock) == GIF_ERROR) {
+#if GIFLIB_MAJOR < 5
+				print_gif_error();
+#else  /* GIFLIB_MAJOR < 5 */
+				gif_error ("Could not skip GIF image data", gifFile->Error);
+#endif /* GIFLIB_MAJOR < 5 */
+				return NULL;
+			}
+
+			while (codeblock != NULL) {
+				if (DGifGetCodeNext (gifFile, &codeblock) == GIF_ERROR) {
 #if GIFLIB_MAJOR < 5
 					print_gif_error();
 #else  /* GIFLIB_MAJOR < 5 */
-					gif_error ("Could not load a block of GIF pixes", gifFile->Error);
+					gif_error ("Could not skip GIF image data", gifFile->Error);
 #endif /* GIFLIB_MAJOR < 5 */
 					return NULL;
 				}
 			}
 
+			/* Animations report the last frame size */
+			g_free (gd.width);
+			g_free (gd.height);
 			gd.width  = g_strdup_printf ("%d", framewidth);
 			gd.height = g_strdup_printf ("%d", frameheight);
-
-
-			g_free (framedata);
-
 		break;
 		case EXTENSION_RECORD_TYPE:
 			extBlock.bytes = NULL;
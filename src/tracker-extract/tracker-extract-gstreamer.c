@@ -1494,6 +1494,7 @@ tracker_extract_module_init (GError **error)
 G_MODULE_EXPORT gboolean
 tracker_extract_module_shutdown (void)
 {
+	tracker_cue_sheet_clear_cache ();
 	g_clear_object (&local_conn);
 	return TRUE;
 }
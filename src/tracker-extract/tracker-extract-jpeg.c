@@ -54,34 +54,6 @@ enum {
 	JPEG_RESOLUTION_UNIT_PER_CENTIMETER = 2,
 };
 
-typedef struct {
-	const gchar *make;
-	const gchar *model;
-	const gchar *title;
-	const gchar *orientation;
-	const gchar *copyright;
-	const gchar *white_balance;
-	const gchar *fnumber;
-	const gchar *flash;
-	const gchar *focal_length;
-	const gchar *artist;
-	const gchar *exposure_time;
-	const gchar *iso_speed_ratings;
-	const gchar *date;
-	const gchar *description;
-	const gchar *metering_mode;
-	const gchar *creator;
-	const gchar *comment;
-	const gchar *city;
-	const gchar *state;
-	const gchar *address;
-	const gchar *country;
-	const gchar *gps_altitude;
-	const gchar *gps_latitude;
-	const gchar *gps_longitude;
-	const gchar *gps_direction;
-} MergeData;
-
 struct tej_error_mgr {
 	struct jpeg_error_mgr jpeg;
 	jmp_buf setjmp_buffer;
@@ -142,19 +114,14 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	struct tej_error_mgr tejerr;
 	struct jpeg_marker_struct *marker;
 	TrackerResource *metadata = NULL;
-	TrackerXmpData *xd = NULL;
-	TrackerExifData *ed = NULL;
-	TrackerIptcData *id = NULL;
-	MergeData md = { 0 };
+	TrackerImageMetadata *image_metadata = NULL;
 	GFile *file;
 	FILE *f;
 	goffset size;
-	gchar *filename, *uri, *resource_uri;
+	gchar *filename, *resource_uri;
 	gchar *comment = NULL;
 	const gchar *dlna_profile, *dlna_mimetype;
-	GPtrArray *keywords;
 	gboolean success = TRUE;
-	guint i;
 
 	file = tracker_extract_info_get_file (info);
 	filename = g_file_get_path (file);
@@ -173,8 +140,6 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 		return FALSE;
 	}
 
-	uri = g_file_get_uri (file);
-
 	cinfo.err = jpeg_std_error (&tejerr.jpeg);
 	tejerr.jpeg.error_exit = extract_jpeg_error_exit;
 	if (setjmp (tejerr.setjmp_buffer)) {
@@ -188,6 +153,8 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	tracker_resource_add_uri (metadata, "rdf:type", "nmm:Photo");
 	g_free (resource_uri);
 
+	image_metadata = tracker_image_metadata_new (file);
+
 	jpeg_create_decompress (&cinfo);
 
 	jpeg_save_markers (&cinfo, JPEG_COM, 0xFFFF);
@@ -228,16 +195,18 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 			len = marker->data_length;
 
 #ifdef HAVE_LIBEXIF
-			if (!ed && strncmp (EXIF_NAMESPACE, str, EXIF_NAMESPACE_LENGTH) == 0) {
-				ed = tracker_exif_new ((guchar *) marker->data, len, uri);
+			if (strncmp (EXIF_NAMESPACE, str, EXIF_NAMESPACE_LENGTH) == 0) {
+				tracker_image_metadata_add_exif (image_metadata,
+				                                 (guchar *) marker->data,
+				                                 len);
 			}
 #endif /* HAVE_LIBEXIF */
 
 #ifdef HAVE_EXEMPI
-			if (!xd && strncmp (XMP_NAMESPACE, str, XMP_NAMESPACE_LENGTH) == 0) {
-				xd = tracker_xmp_new (str + XMP_NAMESPACE_LENGTH,
-				                      len - XMP_NAMESPACE_LENGTH,
-				                      uri);
+			if (strncmp (XMP_NAMESPACE, str, XMP_NAMESPACE_LENGTH) == 0) {
+				tracker_image_metadata_add_xmp (image_metadata,
+				                                str + XMP_NAMESPACE_LENGTH,
+				                                len - XMP_NAMESPACE_LENGTH);
 			}
 #endif /* HAVE_EXEMPI */
 
@@ -250,7 +219,9 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 			if (len > 0 && strncmp (PS3_NAMESPACE, str, PS3_NAMESPACE_LENGTH) == 0) {
 				offset = iptc_jpeg_ps3_find_iptc (str, len, &sublen);
 				if (offset > 0 && sublen > 0) {
-					id = tracker_iptc_new (str + offset, sublen, uri);
+					tracker_image_metadata_add_iptc (image_metadata,
+					                                 (guchar *) str + offset,
+					                                 sublen);
 				}
 			}
 #endif /* HAVE_LIBIPTCDATA */
@@ -265,61 +236,7 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 		marker = marker->next;
 	}
 
-	if (!ed) {
-		ed = g_new0 (TrackerExifData, 1);
-	}
-
-	if (!xd) {
-		gchar *sidecar = NULL;
-
-		xd = tracker_xmp_new_from_sidecar (file, &sidecar);
-
-		if (sidecar) {
-			TrackerResource *sidecar_resource;
-
-			sidecar_resource = tracker_resource_new (sidecar);
-			tracker_resource_add_uri (sidecar_resource, "rdf:type", "nfo:FileDataObject");
-			tracker_resource_add_relation (sidecar_resource, "nie:interpretedAs", metadata);
-
-			tracker_resource_add_take_relation (metadata, "nie:isStoredAs", sidecar_resource);
-		}
-	}
-
-	if (!xd) {
-		xd = g_new0 (TrackerXmpData, 1);
-	}
-
-	if (!id) {
-		id = g_new0 (TrackerIptcData, 1);
-	}
-
-	md.title = tracker_coalesce_strip (4, xd->title, ed->document_name, xd->title2, xd->pdf_title);
-	md.orientation = tracker_coalesce_strip (3, xd->orientation, ed->orientation, id->image_orientation);
-	md.copyright = tracker_coalesce_strip (4, xd->copyright, xd->rights, ed->copyright, id->copyright_notice);
-	md.white_balance = tracker_coalesce_strip (2, xd->white_balance, ed->white_balance);
-	md.fnumber = tracker_coalesce_strip (2, xd->fnumber, ed->fnumber);
-	md.flash = tracker_coalesce_strip (2, xd->flash, ed->flash);
-	md.focal_length =  tracker_coalesce_strip (2, xd->focal_length, ed->focal_length);
-	md.artist = tracker_coalesce_strip (3, xd->artist, ed->artist, xd->contributor);
-	md.exposure_time = tracker_coalesce_strip (2, xd->exposure_time, ed->exposure_time);
-	md.iso_speed_ratings = tracker_coalesce_strip (2, xd->iso_speed_ratings, ed->iso_speed_ratings);
-	md.date = tracker_coalesce_strip (5, xd->date, xd->time_original, ed->time, id->date_created, ed->time_original);
-	md.description = tracker_coalesce_strip (2, xd->description, ed->description);
-	md.metering_mode = tracker_coalesce_strip (2, xd->metering_mode, ed->metering_mode);
-	md.city = tracker_coalesce_strip (2, xd->city, id->city);
-	md.state = tracker_coalesce_strip (2, xd->state, id->state);
-	md.address = tracker_coalesce_strip (2, xd->address, id->sublocation);
-	md.country = tracker_coalesce_strip (2, xd->country, id->country_name);
-
-	/* FIXME We are not handling the altitude ref here for xmp */
-	md.gps_altitude = tracker_coalesce_strip (2, xd->gps_altitude, ed->gps_altitude);
-	md.gps_latitude = tracker_coalesce_strip (2, xd->gps_latitude, ed->gps_latitude);
-	md.gps_longitude = tracker_coalesce_strip (2, xd->gps_longitude, ed->gps_longitude);
-	md.gps_direction = tracker_coalesce_strip (2, xd->gps_direction, ed->gps_direction);
-	md.creator = tracker_coalesce_strip (3, xd->creator, id->byline, id->credit);
-	md.comment = tracker_coalesce_strip (2, comment, ed->user_comment);
-	md.make = tracker_coalesce_strip (2, xd->make, ed->make);
-	md.model = tracker_coalesce_strip (2, xd->model, ed->model);
+	tracker_image_metadata_apply_to_resource (image_metadata, metadata);
 
 	/* Prioritize on native dimention in all cases */
 	tracker_resource_set_int64 (metadata, "nfo:width", cinfo.image_width);
@@ -330,263 +247,24 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 		tracker_resource_set_string (metadata, "nmm:dlnaMime", dlna_mimetype);
 	}
 
-	if (id->contact) {
-		TrackerResource *contact = tracker_extract_new_contact (id->contact);
-		tracker_resource_add_relation (metadata, "nco:contributor", contact);
-		g_object_unref (contact);
-	}
-
-	keywords = g_ptr_array_new_with_free_func ((GDestroyNotify) g_free);
-
-	if (xd->keywords) {
-		tracker_keywords_parse (keywords, xd->keywords);
-	}
-
-	if (xd->pdf_keywords) {
-		tracker_keywords_parse (keywords, xd->pdf_keywords);
-	}
-
-	if (xd->subject) {
-		tracker_keywords_parse (keywords, xd->subject);
-	}
-
-	if (xd->publisher) {
-		TrackerResource *publisher = tracker_extract_new_contact (xd->publisher);
-		tracker_resource_set_relation (metadata, "nco:publisher", publisher);
-		g_object_unref (publisher);
-	}
-
-	if (xd->type) {
-		tracker_resource_set_string (metadata, "dc:type", xd->type);
-	}
-
-	if (xd->rating) {
-		tracker_resource_set_string (metadata, "nao:numericRating", xd->rating);
-	}
-
-	if (xd->format) {
-		tracker_resource_set_string (metadata, "dc:format", xd->format);
-	}
-
-	if (xd->identifier) {
-		tracker_resource_set_string (metadata, "dc:identifier", xd->identifier);
-	}
-
-	if (xd->source) {
-		tracker_resource_set_string (metadata, "dc:source", xd->source);
-	}
-
-	if (xd->language) {
-		tracker_resource_set_string (metadata, "dc:language", xd->language);
-	}
-
-	if (xd->relation) {
-		tracker_resource_set_string (metadata, "dc:relation", xd->relation);
-	}
-
-	if (xd->coverage) {
-		tracker_resource_set_string (metadata, "dc:coverage", xd->coverage);
-	}
-
-	if (xd->license) {
-		tracker_resource_set_string (metadata, "nie:license", xd->license);
-	}
-
-	if (xd->regions) {
-		tracker_xmp_apply_regions_to_resource (metadata, xd);
-	}
-
-	if (id->keywords) {
-		tracker_keywords_parse (keywords, id->keywords);
-	}
-
-	for (i = 0; i < keywords->len; i++) {
-		TrackerResource *tag;
-		const gchar *p;
-
-		p = g_ptr_array_index (keywords, i);
-		tag = tracker_extract_new_tag (p);
-
-		tracker_resource_add_relation (metadata, "nao:hasTag", tag);
-
-		g_object_unref (tag);
-	}
-	g_ptr_array_free (keywords, TRUE);
-
-	if (md.make || md.model) {
-		TrackerResource *equipment = tracker_extract_new_equipment (md.make, md.model);
-		tracker_resource_set_relation (metadata, "nfo:equipment", equipment);
-		g_object_unref (equipment);
-	}
-
-	tracker_guarantee_resource_title_from_file (metadata,
-	                                            "nie:title",
-	                                            md.title,
-	                                            uri,
-	                                            NULL);
-
-	if (md.orientation) {
-		TrackerResource *orientation;
-
-		orientation = tracker_resource_new (md.orientation);
-		tracker_resource_set_relation (metadata, "nfo:orientation", orientation);
-		g_object_unref (orientation);
-	}
-
-	if (md.copyright) {
-		tracker_guarantee_resource_utf8_string (metadata, "nie:copyright", md.copyright);
-	}
-
-	if (md.white_balance) {
-		TrackerResource *white_balance;
-
-		white_balance = tracker_resource_new (md.white_balance);
-		tracker_resource_set_relation (metadata, "nmm:whiteBalance", white_balance);
-		g_object_unref (white_balance);
-	}
-
-	if (md.fnumber) {
-		gdouble value;
-
-		value = g_strtod (md.fnumber, NULL);
-		tracker_resource_set_double (metadata, "nmm:fnumber", value);
-	}
-
-	if (md.flash) {
-		TrackerResource *flash;
-
-		flash = tracker_resource_new (md.flash);
-		tracker_resource_set_relation (metadata, "nmm:flash", flash);
-		g_object_unref (flash);
-	}
-
-	if (md.focal_length) {
-		gdouble value;
-
-		value = g_strtod (md.focal_length, NULL);
-		tracker_resource_set_double (metadata, "nmm:focalLength", value);
-	}
-
-	if (md.artist) {
-		TrackerResource *artist = tracker_extract_new_contact (md.artist);
-		tracker_resource_add_relation (metadata, "nco:contributor", artist);
-		g_object_unref (artist);
-	}
-
-	if (md.exposure_time) {
-		gdouble value;
-
-		value = g_strtod (md.exposure_time, NULL);
-		tracker_resource_set_double (metadata, "nmm:exposureTime", value);
-	}
-
-	if (md.iso_speed_ratings) {
-		gdouble value;
-
-		value = g_strtod (md.iso_speed_ratings, NULL);
-		tracker_resource_set_double (metadata, "nmm:isoSpeed", value);
-	}
-
-	tracker_guarantee_resource_date_from_file_mtime (metadata,
-	                                                 "nie:contentCreated",
-	                                                 md.date,
-	                                                 uri);
-
-	if (md.description) {
-		tracker_guarantee_resource_utf8_string (metadata, "nie:description", md.description);
-	}
-
-	if (md.metering_mode) {
-		TrackerResource *metering;
-
-		metering = tracker_resource_new (md.metering_mode);
-		tracker_resource_set_relation (metadata, "nmm:meteringMode", metering);
-		g_object_unref (metering);
-	}
-
-	if (md.creator) {
-		TrackerResource *creator = tracker_extract_new_contact (md.creator);
-		tracker_resource_add_relation (metadata, "nco:creator", creator);
-		g_object_unref (creator);
-
-		/* NOTE: We only have affiliation with
-		 * nco:PersonContact and we are using
-		 * nco:Contact here.
-		 */
-
-		/* if (id->byline_title) { */
-		/* 	tracker_sparql_builder_insert_open (preupdate, NULL); */
-
-		/* 	tracker_sparql_builder_subject (preupdate, "_:affiliation_by_line"); */
-		/* 	tracker_sparql_builder_predicate (preupdate, "a"); */
-		/* 	tracker_sparql_builder_object (preupdate, "nco:Affiliation"); */
-
-		/* 	tracker_sparql_builder_predicate (preupdate, "nco:title"); */
-		/* 	tracker_sparql_builder_object_unvalidated (preupdate, id->byline_title); */
-
-		/* 	tracker_sparql_builder_insert_close (preupdate); */
-
-		/*      tracker_sparql_builder_predicate (preupdate, "a"); */
-		/*      tracker_sparql_builder_object (preupdate, "nco:Contact"); */
-		/*      tracker_sparql_builder_predicate (preupdate, "nco:hasAffiliation"); */
-		/*      tracker_sparql_builder_object (preupdate, "_:affiliation_by_line"); */
-		/* } */
-	}
-
-	if (md.comment) {
-		tracker_guarantee_resource_utf8_string (metadata, "nie:comment", md.comment);
-	}
-
-	if (md.address || md.state || md.country || md.city ||
-	    md.gps_altitude || md.gps_latitude || md.gps_longitude) {
-
-		TrackerResource *location = tracker_extract_new_location (md.address,
-		        md.state, md.city, md.country, md.gps_altitude,
-		        md.gps_latitude, md.gps_longitude);
-
-		tracker_resource_set_relation (metadata, "slo:location", location);
-
-		g_object_unref (location);
-	}
-
-	if (md.gps_direction) {
-		tracker_resource_set_string (metadata, "nfo:heading", md.gps_direction);
-	}
-
-	if (cinfo.density_unit != 0 || ed->x_resolution) {
-		gdouble value;
-
-		if (cinfo.density_unit == JPEG_RESOLUTION_UNIT_UNKNOWN) {
-			if (ed->resolution_unit == EXIF_RESOLUTION_UNIT_PER_CENTIMETER)
-				value = g_strtod (ed->x_resolution, NULL) * CMS_PER_INCH;
-			else
-				value = g_strtod (ed->x_resolution, NULL);
-		} else {
-			if (cinfo.density_unit == JPEG_RESOLUTION_UNIT_PER_INCH)
-				value = cinfo.X_density;
-			else
-				value = cinfo.X_density * CMS_PER_INCH;
-		}
-
-		tracker_resource_set_double (metadata, "nfo:horizontalResolution", value);
+	if (comment) {
+		tracker_guarantee_resource_utf8_string (metadata, "nie:comment", comment);
 	}
 
-	if (cinfo.density_unit != 0 || ed->y_resolution) {
-		gdouble value;
+	/* The JFIF density has priority over the EXIF resolution */
+	if (cinfo.density_unit != JPEG_RESOLUTION_UNIT_UNKNOWN) {
+		gdouble x_value, y_value;
 
-		if (cinfo.density_unit == JPEG_RESOLUTION_UNIT_UNKNOWN) {
-			if (ed->resolution_unit == EXIF_RESOLUTION_UNIT_PER_CENTIMETER)
-				value = g_strtod (ed->y_resolution, NULL) * CMS_PER_INCH;
-			else
-				value = g_strtod (ed->y_resolution, NULL);
+		if (cinfo.density_unit == JPEG_RESOLUTION_UNIT_PER_INCH) {
+			x_value = cinfo.X_density;
+			y_value = cinfo.Y_density;
 		} else {
-			if (cinfo.density_unit == JPEG_RESOLUTION_UNIT_PER_INCH)
-				value = cinfo.Y_density;
-			else
-				value = cinfo.Y_density * CMS_PER_INCH;
+			x_value = cinfo.X_density * CMS_PER_INCH;
+			y_value = cinfo.Y_density * CMS_PER_INCH;
 		}
 
-		tracker_resource_set_double (metadata, "nfo:verticalResolution", value);
+		tracker_resource_set_double (metadata, "nfo:horizontalResolution", x_value);
+		tracker_resource_set_double (metadata, "nfo:verticalResolution", y_value);
 	}
 
 	tracker_extract_info_set_resource (info, metadata);
@@ -594,14 +272,11 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 fail:
 	jpeg_destroy_decompress (&cinfo);
 
-	g_clear_pointer (&ed, tracker_exif_free);
-	g_clear_pointer (&xd, tracker_xmp_free);
-	g_clear_pointer (&id, tracker_iptc_free);
+	g_clear_pointer (&image_metadata, tracker_image_metadata_free);
 	g_clear_pointer (&comment, g_free);
 	g_clear_object (&metadata);
 
 	tracker_file_close (f, FALSE);
-	g_free (uri);
 
 	return success;
 }
@@ -44,24 +44,24 @@
 #warning Frame traces enabled
 #endif /* FRAME_ENABLE_TRACE */
 
-/* We mmap the beginning of the file and read separately the last 128
- * bytes for id3v1 tags. While these are probably cornercases the
- * rationale is that we don't want to fault a whole page for the last
- * 128 bytes and on the other we don't want to mmap the whole file
- * with unlimited size (might need to create private copy in some
- * special cases, finding continuous space etc). We now take 5 first
- * MB of the file and assume that this is enough. In theory there is
- * no maximum size as someone could embed 50 gigabytes of album art
- * there.
+/* We mmap the ID3v2 tags at the beginning of the file, plus enough of
+ * the following audio data to find the first frames, and read
+ * separately the last 128 bytes for id3v1 tags. The tag sizes are read
+ * from their headers first, so only the pages holding metadata are
+ * touched. Tags are still capped to the first 5 MB of the file, in
+ * theory there is no maximum size as someone could embed 50 gigabytes
+ * of album art there.
  */
 
 #define MAX_FILE_READ     1024 * 1024 * 5
+#define MAX_AUDIO_READ    1024 * 256
 #define MAX_MP3_SCAN_DEEP 16768
 
 #define MAX_FRAMES_SCAN   512
 #define VBR_THRESHOLD     16
 
 #define ID3V1_SIZE        128
+#define ID3V2_HEADER_SIZE 10
 
 typedef struct {
 	gchar *title;
@@ -170,6 +170,8 @@ typedef enum {
 typedef struct {
 	size_t size;
 	size_t id3v2_size;
+	/* Whether the parsed data stops before the end of the file */
+	gboolean partial;
 
 	const gchar *title;
 	const gchar *artist_name;
@@ -1024,6 +1026,7 @@ mp3_parse_header (const gchar          *data,
 	size_t pos = 0;
 	gint n_channels;
 	guint32 xing_nr_frames = 0;
+	gboolean eof = FALSE;
 
 	pos = seek_pos;
 
@@ -1106,6 +1109,7 @@ mp3_parse_header (const gchar          *data,
 
 		if (pos + sizeof (header) > size) {
 			/* EOF */
+			eof = TRUE;
 			break;
 		}
 
@@ -1141,7 +1145,8 @@ mp3_parse_header (const gchar          *data,
 		/* If the file is encoded with variable bitrate mode (VBR)
 		   and the number of frame is known */
 		length = spfp8 * 8 * xing_nr_frames / sample_rate;
-	} else if ((!vbr_flag && frames > VBR_THRESHOLD) || (frames > MAX_FRAMES_SCAN)) {
+	} else if ((!vbr_flag && frames > VBR_THRESHOLD) || (frames > MAX_FRAMES_SCAN) ||
+	           (eof && filedata->partial)) {
 		/* If not all frames scanned
 		 * Note that bitrate is always > 0, checked before */
 		length = (filedata->size - filedata->id3v2_size) / (avg_bps ? avg_bps : (bitrate / 1000)) / 125;
@@ -2632,6 +2637,44 @@ parse_id3v2 (const gchar          *data,
 	return offset;
 }
 
+/* Adds up the sizes of the ID3v2 tags at the start of the file, as
+ * given by their headers.
+ */
+static goffset
+read_id3v2_size (int     fd,
+                 goffset size)
+{
+	guchar header[ID3V2_HEADER_SIZE];
+	goffset offset = 0;
+
+	while (offset + ID3V2_HEADER_SIZE <= size) {
+		guint32 tag_size;
+
+		if (pread (fd, header, ID3V2_HEADER_SIZE, offset) != ID3V2_HEADER_SIZE)
+			break;
+
+		if (memcmp (header, "ID3", 3) != 0)
+			break;
+
+		/* Sizes are synchsafe integers */
+		if ((header[6] | header[7] | header[8] | header[9]) & 0x80)
+			break;
+
+		tag_size = ((header[6] & 0x7F) << 21) |
+			((header[7] & 0x7F) << 14) |
+			((header[8] & 0x7F) << 7) |
+			(header[9] & 0x7F);
+
+		offset += ID3V2_HEADER_SIZE + tag_size;
+
+		/* ID3v2.4 footer */
+		if (header[3] == 4 && (header[5] & 0x10) != 0)
+			offset += ID3V2_HEADER_SIZE;
+	}
+
+	return offset;
+}
+
 G_MODULE_EXPORT gboolean
 tracker_extract_get_metadata (TrackerExtractInfo  *info,
                               GError             **error)
@@ -2660,7 +2703,6 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	}
 
 	md.size = size;
-	buffer_size = MIN (size, MAX_FILE_READ);
 
 	fd = tracker_file_open_fd (filename);
 
@@ -2668,6 +2710,10 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 		return FALSE;
 	}
 
+	buffer_size = MIN (read_id3v2_size (fd, size), MAX_FILE_READ) + MAX_AUDIO_READ;
+	buffer_size = MIN (size, buffer_size);
+	md.partial = buffer_size < size;
+
 #ifndef G_OS_WIN32
 	/* We don't use GLib's mmap because size can not be specified */
 	buffer = mmap (NULL,
@@ -62,6 +62,7 @@ typedef enum {
 typedef struct {
 	/* Common constant stuff */
 	const gchar *uri;
+	TrackerZip *zip;
 	MsOfficeXMLFileType file_type;
 
 	/* Tag type, reused by Content and Metadata parsers */
@@ -618,10 +619,10 @@ xml_read (MsOfficeXMLParserInfo *parser_info,
 
 		/* Load the internal XML file from the Zip archive, and parse it
 		 * using the given context */
-		tracker_gsf_parse_xml_in_zip (parser_info->uri,
-		                              xml_filename,
-		                              context,
-		                              &error);
+		tracker_zip_parse_xml (parser_info->zip,
+		                       xml_filename,
+		                       context,
+		                       &error);
 		g_markup_parse_context_free (context);
 
 		if (error) {
@@ -805,6 +806,7 @@ tracker_extract_get_metadata (TrackerExtractInfo  *extract_info,
                               GError             **error)
 {
 	MsOfficeXMLParserInfo info = { 0 };
+	g_autoptr (TrackerZip) zip = NULL;
 	MsOfficeXMLFileType file_type;
 	TrackerResource *metadata;
 	GMarkupParseContext *context = NULL;
@@ -819,6 +821,14 @@ tracker_extract_get_metadata (TrackerExtractInfo  *extract_info,
 	file = tracker_extract_info_get_file (extract_info);
 	uri = g_file_get_uri (file);
 
+	/* The archive is opened once for all parts */
+	zip = tracker_zip_open (uri, &inner_error);
+	if (!zip) {
+		g_propagate_prefixed_error (error, inner_error, "Could not open:");
+		g_free (uri);
+		return FALSE;
+	}
+
 	/* Get current Content Type */
 	file_type = msoffice_xml_get_file_type (uri);
 
@@ -836,6 +846,7 @@ tracker_extract_get_metadata (TrackerExtractInfo  *extract_info,
 	info.style_element_present = FALSE;
 	info.preserve_attribute_present = FALSE;
 	info.uri = uri;
+	info.zip = zip;
 	info.content = NULL;
 	info.title_already_set = FALSE;
 	info.generator_already_set = FALSE;
@@ -850,12 +861,16 @@ tracker_extract_get_metadata (TrackerExtractInfo  *extract_info,
 	info.timer = g_timer_new ();
 	/* Load the internal XML file from the Zip archive, and parse it
 	 * using the given context */
-	tracker_gsf_parse_xml_in_zip (uri,
-	                              "[Content_Types].xml",
-	                              context,
-	                              &inner_error);
+	tracker_zip_parse_xml (zip,
+	                       "[Content_Types].xml",
+	                       context,
+	                       &inner_error);
 	if (inner_error) {
 		g_propagate_prefixed_error (error, inner_error, "Could not open:");
+		g_timer_destroy (info.timer);
+		g_markup_parse_context_free (context);
+		g_object_unref (metadata);
+		g_free (uri);
 		return FALSE;
 	}
 
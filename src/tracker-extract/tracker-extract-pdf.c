@@ -240,6 +240,11 @@ extract_content_text (PopplerDocument *document,
 		g_debug ("Extraction timed out, %d seconds reached", EXTRACTION_PROCESS_TIMEOUT);
 	}
 
+	if (i < n_pages) {
+		g_debug ("Content truncated, %d pages left unread",
+		         n_pages - i);
+	}
+
 	g_debug ("Content extraction finished: %d/%d pages indexed in %2.2f seconds, "
 	         "%" G_GSIZE_FORMAT " bytes extracted",
 	         i,
@@ -290,7 +295,6 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	TrackerXmpData *xd = NULL;
 	PDFData pd = { 0 }; /* actual data */
 	PDFData md = { 0 }; /* for merging */
-	G_GNUC_UNUSED GBytes *bytes;
 	PopplerDocument *document;
 	gchar *xml = NULL;
 	gchar *content, *uri;
@@ -300,9 +304,12 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	GFile *file;
 	gchar *filename, *resource_uri;
 	int fd;
+#if !POPPLER_CHECK_VERSION (21, 12, 0)
+	G_GNUC_UNUSED GBytes *bytes;
 	gchar *contents = NULL;
 	gsize len;
 	struct stat st;
+#endif
 
 	file = tracker_extract_info_get_file (info);
 	filename = g_file_get_path (file);
@@ -317,6 +324,15 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 		return FALSE;
 	}
 
+#if POPPLER_CHECK_VERSION (21, 12, 0)
+	g_free (filename);
+	uri = g_file_get_uri (file);
+
+	/* Let poppler read the document on demand instead of mapping
+	 * all of it, the file descriptor is owned by the document.
+	 */
+	document = poppler_document_new_from_fd (dup (fd), NULL, &inner_error);
+#else
 	if (fstat (fd, &st) == -1) {
 		g_warning ("Could not fstat pdf file '%s': %s\n",
 		           filename,
@@ -345,12 +361,13 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	g_free (filename);
 	uri = g_file_get_uri (file);
 
-#if POPPLER_CHECK_VERSION (0, 82, 0)
-	bytes = g_bytes_new (contents, len);
+#  if POPPLER_CHECK_VERSION (0, 82, 0)
+	bytes = g_bytes_new_static (contents, len);
 	document = poppler_document_new_from_bytes (bytes, NULL, &inner_error);
 	g_bytes_unref (bytes);
-#else
+#  else
 	document = poppler_document_new_from_data (contents, len, NULL, &inner_error);
+#  endif
 #endif
 
 	if (inner_error) {
@@ -574,9 +591,11 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 
 	g_object_unref (document);
 
+#if !POPPLER_CHECK_VERSION (21, 12, 0)
 	if (contents) {
 		munmap (contents, len);
 	}
+#endif
 
 	close (fd);
 
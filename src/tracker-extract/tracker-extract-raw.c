@@ -28,7 +28,6 @@
 
 #include "tracker-main.h"
 
-#define CMS_PER_INCH            2.54
 #define EXIF_DATE_FORMAT        "%Y:%m:%d %H:%M:%S"
 
 enum {
@@ -51,71 +50,12 @@ enum {
 	EXIF_METERING_MODE_OTHER = 255,
 };
 
-typedef struct {
-	gchar *artist;
-	gchar *copyright;
-	gchar *description;
-	gchar *document_name;
-	gchar *flash;
-	gchar *gps_altitude;
-	gchar *gps_direction;
-	gchar *gps_latitude;
-	gchar *gps_longitude;
-	gchar *make;
-	gchar *metering_mode;
-	gchar *model;
-	gchar *time;
-	gchar *time_original;
-	gchar *user_comment;
-	gchar *white_balance;
-	gchar *x_resolution;
-	gchar *y_resolution;
-	gdouble exposure_time;
-	gdouble fnumber;
-	gdouble focal_length;
-	gdouble iso_speed_ratings;
-	gint resolution_unit;
-} RawExifData;
-
-static void
-raw_exif_data_free (RawExifData *ed)
+static gchar *
+double_to_string (gdouble value)
 {
-	g_return_if_fail (ed != NULL);
-
-	g_free (ed->artist);
-	g_free (ed->copyright);
-	g_free (ed->description);
-	g_free (ed->document_name);
-	g_free (ed->flash);
-	g_free (ed->gps_altitude);
-	g_free (ed->gps_direction);
-	g_free (ed->gps_latitude);
-	g_free (ed->gps_longitude);
-	g_free (ed->make);
-	g_free (ed->metering_mode);
-	g_free (ed->model);
-	g_free (ed->time);
-	g_free (ed->time_original);
-	g_free (ed->user_comment);
-	g_free (ed->white_balance);
-	g_free (ed->x_resolution);
-	g_free (ed->y_resolution);
-
-	g_free (ed);
-}
+	gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
 
-static RawExifData *
-raw_exif_data_new (void)
-{
-	RawExifData *ed;
-
-	ed = g_new0 (RawExifData, 1);
-	ed->exposure_time = -1.0;
-	ed->fnumber = -1.0;
-	ed->focal_length = -1.0;
-	ed->iso_speed_ratings = -1.0;
-	ed->resolution_unit = -1;
-	return ed;
+	return g_strdup (g_ascii_dtostr (buf, sizeof (buf), value));
 }
 
 static gchar *
@@ -225,22 +165,25 @@ parse_white_balance (gushort white_balance_value)
 	return white_balance;
 }
 
-static RawExifData *
+static TrackerExifData *
 parse_exif_data (GExiv2Metadata *metadata)
 {
-	RawExifData *ed = NULL;
+	TrackerExifData *ed = NULL;
 	gchar *time = NULL;
 	gchar *time_original = NULL;
 	gdouble gps_altitude;
 	gdouble gps_latitude;
 	gdouble gps_longitude;
+	gdouble fnumber;
+	gdouble focal_length;
 	gint exposure_time_den;
 	gint exposure_time_nom;
 	glong flash = G_MAXLONG;
 	glong metering_mode = G_MAXLONG;
 	glong white_balance = G_MAXLONG;
 
-	ed = raw_exif_data_new ();
+	ed = g_new0 (TrackerExifData, 1);
+	ed->orientation = convert_exiv2_orientation_to_nfo (gexiv2_metadata_get_orientation (metadata));
 
 	if (!gexiv2_metadata_has_exif (metadata))
 		goto out;
@@ -264,9 +207,11 @@ parse_exif_data (GExiv2Metadata *metadata)
 	ed->model = gexiv2_metadata_get_tag_string (metadata, "Exif.Image.Model");
 
 	if (gexiv2_metadata_get_exposure_time (metadata, &exposure_time_nom, &exposure_time_den))
-		ed->exposure_time = (gdouble) exposure_time_nom / (double) exposure_time_den;
+		ed->exposure_time = double_to_string ((gdouble) exposure_time_nom / (double) exposure_time_den);
 
-	ed->fnumber = gexiv2_metadata_get_fnumber (metadata);
+	fnumber = gexiv2_metadata_get_fnumber (metadata);
+	if (fnumber != -1.0)
+		ed->fnumber = double_to_string (fnumber);
 
 	if (gexiv2_metadata_has_tag (metadata, "Exif.Image.Flash"))
 		flash = gexiv2_metadata_get_tag_long (metadata, "Exif.Image.Flash");
@@ -275,10 +220,12 @@ parse_exif_data (GExiv2Metadata *metadata)
 	if (flash != G_MAXLONG)
 		ed->flash = parse_flash ((gushort) flash);
 
-	ed->focal_length = gexiv2_metadata_get_focal_length (metadata);
+	focal_length = gexiv2_metadata_get_focal_length (metadata);
+	if (focal_length != -1.0)
+		ed->focal_length = double_to_string (focal_length);
 
 	if (gexiv2_metadata_has_tag (metadata, "Exif.Photo.ISOSpeedRatings"))
-		ed->iso_speed_ratings = (gdouble) gexiv2_metadata_get_iso_speed (metadata);
+		ed->iso_speed_ratings = g_strdup_printf ("%d", gexiv2_metadata_get_iso_speed (metadata));
 
 	if (gexiv2_metadata_has_tag (metadata, "Exif.Image.MeteringMode"))
 		metering_mode = gexiv2_metadata_get_tag_long (metadata, "Exif.Image.MeteringMode");
@@ -301,13 +248,13 @@ parse_exif_data (GExiv2Metadata *metadata)
 	ed->y_resolution = gexiv2_metadata_get_tag_string (metadata, "Exif.Image.YResolution");
 
 	if (gexiv2_metadata_get_gps_altitude (metadata, &gps_altitude))
-		ed->gps_altitude = g_strdup_printf ("%f", gps_altitude);
+		ed->gps_altitude = double_to_string (gps_altitude);
 
 	if (gexiv2_metadata_get_gps_latitude (metadata, &gps_latitude))
-		ed->gps_latitude = g_strdup_printf ("%f", gps_latitude);
+		ed->gps_latitude = double_to_string (gps_latitude);
 
 	if (gexiv2_metadata_get_gps_longitude (metadata, &gps_longitude))
-		ed->gps_longitude = g_strdup_printf ("%f", gps_longitude);
+		ed->gps_longitude = double_to_string (gps_longitude);
 
 	ed->gps_direction = gexiv2_metadata_get_tag_string (metadata, "Exif.GPSInfo.GPSImgDirection");
 
@@ -324,14 +271,11 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	GError *inner_error = NULL;
 	GFile *file;
 	GExiv2Metadata *metadata = NULL;
-	GExiv2Orientation orientation;
-	RawExifData *ed = NULL;
+	TrackerImageMetadata *image_metadata = NULL;
 	TrackerResource *resource = NULL;
 	gboolean retval = FALSE;
-	const gchar *time_content_created;
 	gchar *filename = NULL;
-	gchar *nfo_orientation = NULL;
-	gchar *uri = NULL, *resource_uri;
+	gchar *resource_uri;
 	gint height;
 	gint width;
 
@@ -355,103 +299,21 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	height = gexiv2_metadata_get_pixel_height (metadata);
 	tracker_resource_set_int (resource, "nfo:height", height);
 
-	orientation = gexiv2_metadata_get_orientation (metadata);
-	nfo_orientation = convert_exiv2_orientation_to_nfo (orientation);
-	tracker_resource_set_uri (resource, "nfo:orientation", nfo_orientation);
-
-	ed = parse_exif_data (metadata);
-
-	if (ed->make != NULL || ed->model != NULL) {
-		TrackerResource *equipment;
-
-		equipment = tracker_extract_new_equipment (ed->make, ed->model);
-		tracker_resource_set_relation (resource, "nfo:equipment", equipment);
-		g_object_unref (equipment);
-	}
-
-	uri = g_file_get_uri (file);
-	tracker_guarantee_resource_title_from_file (resource, "nie:title", ed->document_name, uri, NULL);
-
-	if (ed->copyright != NULL)
-		tracker_resource_set_string (resource, "nie:copyright", ed->copyright);
-
-	if (ed->white_balance != NULL)
-		tracker_resource_set_uri (resource, "nmm:whiteBalance", ed->white_balance);
-
-	if (ed->fnumber != -1.0)
-		tracker_resource_set_double (resource, "nmm:fnumber", ed->fnumber);
-
-	if (ed->flash != NULL)
-		tracker_resource_set_uri (resource, "nmm:flash", ed->flash);
-
-	if (ed->focal_length != -1.0)
-		tracker_resource_set_double (resource, "nmm:focalLength", ed->focal_length);
+	image_metadata = tracker_image_metadata_new (file);
+	tracker_image_metadata_take_exif (image_metadata, parse_exif_data (metadata));
 
-	if (ed->artist != NULL) {
-		TrackerResource *artist;
+#ifdef HAVE_EXEMPI
+	if (gexiv2_metadata_has_xmp (metadata)) {
+		gchar *packet;
 
-		artist = tracker_extract_new_contact (ed->artist);
-		tracker_resource_add_relation (resource, "nco:contributor", artist);
-		g_object_unref (artist);
+		packet = gexiv2_metadata_get_xmp_packet (metadata);
+		if (packet)
+			tracker_image_metadata_add_xmp (image_metadata, packet, strlen (packet));
+		g_free (packet);
 	}
+#endif /* HAVE_EXEMPI */
 
-	if (ed->exposure_time != -1.0)
-		tracker_resource_set_double (resource, "nmm:exposureTime", ed->exposure_time);
-
-	if (ed->iso_speed_ratings != -1.0)
-		tracker_resource_set_double (resource, "nmm:isoSpeed", ed->iso_speed_ratings);
-
-	time_content_created = tracker_coalesce_strip (2, ed->time, ed->time_original);
-	tracker_guarantee_resource_date_from_file_mtime (resource, "nie:contentCreated", time_content_created, uri);
-
-	if (ed->description != NULL)
-		tracker_resource_set_string (resource, "nie:description", ed->description);
-
-	if (ed->metering_mode != NULL)
-		tracker_resource_set_uri (resource, "nmm:meteringMode", ed->metering_mode);
-
-	if (ed->user_comment != NULL)
-		tracker_guarantee_resource_utf8_string (resource, "nie:comment", ed->user_comment);
-
-	if (ed->gps_altitude != NULL || ed->gps_latitude != NULL || ed->gps_longitude != NULL) {
-		TrackerResource *location;
-
-		location = tracker_extract_new_location (NULL,
-		                                         NULL,
-		                                         NULL,
-		                                         NULL,
-		                                         ed->gps_altitude,
-		                                         ed->gps_latitude,
-		                                         ed->gps_longitude);
-
-		tracker_resource_set_relation (resource, "slo:location", location);
-		g_object_unref (location);
-	}
-
-	if (ed->gps_direction != NULL)
-		tracker_resource_set_string (resource, "nfo:heading", ed->gps_direction);
-
-	if (ed->x_resolution != NULL) {
-		gdouble value;
-
-		if (ed->resolution_unit == EXIF_RESOLUTION_UNIT_PER_CENTIMETER)
-			value = g_strtod (ed->x_resolution, NULL) * CMS_PER_INCH;
-		else
-			value = g_strtod (ed->x_resolution, NULL);
-
-		tracker_resource_set_double (resource, "nfo:horizontalResolution", value);
-	}
-
-	if (ed->y_resolution != NULL) {
-		gdouble value;
-
-		if (ed->resolution_unit == EXIF_RESOLUTION_UNIT_PER_CENTIMETER)
-			value = g_strtod (ed->y_resolution, NULL) * CMS_PER_INCH;
-		else
-			value = g_strtod (ed->y_resolution, NULL);
-
-		tracker_resource_set_double (resource, "nfo:verticalResolution", value);
-	}
+	tracker_image_metadata_apply_to_resource (image_metadata, resource);
 
 	tracker_extract_info_set_resource (info, resource);
 	retval = TRUE;
@@ -459,9 +321,7 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 out:
 	g_clear_object (&metadata);
 	g_clear_object (&resource);
-	g_clear_pointer (&ed, raw_exif_data_free);
+	g_clear_pointer (&image_metadata, tracker_image_metadata_free);
 	g_free (filename);
-	g_free (nfo_orientation);
-	g_free (uri);
 	return retval;
 }
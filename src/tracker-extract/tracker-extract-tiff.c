@@ -34,8 +34,6 @@
 #include <libtracker-miners-common/tracker-common.h>
 #include <libtracker-extract/tracker-extract.h>
 
-#define CMS_PER_INCH        2.54
-
 typedef enum {
 	TAG_TYPE_UNDEFINED = 0,
 	TAG_TYPE_STRING,
@@ -45,63 +43,6 @@ typedef enum {
 	TAG_TYPE_C16_UINT16
 } TagType;
 
-typedef struct {
-	const gchar *make;
-	const gchar *model;
-	const gchar *title;
-	const gchar *orientation;
-	const gchar *copyright;
-	const gchar *white_balance;
-	const gchar *fnumber;
-	const gchar *flash;
-	const gchar *focal_length;
-	const gchar *artist;
-	const gchar *exposure_time;
-	const gchar *iso_speed_ratings;
-	const gchar *date;
-	const gchar *description;
-	const gchar *metering_mode;
-	const gchar *creator;
-	const gchar *x_dimension;
-	const gchar *y_dimension;
-	const gchar *city;
-	const gchar *state;
-	const gchar *address;
-	const gchar *country;
-	const gchar *gps_altitude;
-	const gchar *gps_latitude;
-	const gchar *gps_longitude;
-	const gchar *gps_direction;
-} MergeData;
-
-typedef struct {
-	gchar *artist;
-	gchar *copyright;
-	gchar *date;
-	gchar *title;
-	gchar *description;
-	gchar *width;
-	gchar *length;
-	gchar *make;
-	gchar *model;
-	gchar *orientation;
-} TiffData;
-
-static void
-tiff_data_free (TiffData *tags)
-{
-	g_free (tags->artist);
-	g_free (tags->copyright);
-	g_free (tags->date);
-	g_free (tags->title);
-	g_free (tags->description);
-	g_free (tags->width);
-	g_free (tags->length);
-	g_free (tags->make);
-	g_free (tags->model);
-	g_free (tags->orientation);
-}
-
 static gchar *
 get_flash (TIFF *image)
 {
@@ -256,17 +197,12 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
                               GError             **error)
 {
 	TrackerResource *metadata;
+	TrackerImageMetadata *image_metadata;
+	TrackerExifData *ed;
 	TIFF *image;
-	TrackerXmpData *xd = NULL;
-	TrackerIptcData *id = NULL;
-	TrackerExifData *ed = NULL;
-	MergeData md = { 0 };
-	TiffData td = { 0 };
-	gchar *filename, *uri, *resource_uri;
+	gchar *filename, *resource_uri;
 	gchar *date;
 	glong exif_offset;
-	GPtrArray *keywords;
-	guint i;
 	GFile *file;
 	int fd;
 
@@ -311,7 +247,7 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	tracker_resource_add_uri (metadata, "rdf:type", "nmm:Photo");
 	g_free (resource_uri);
 
-	uri = g_file_get_uri (file);
+	image_metadata = tracker_image_metadata_new (file);
 
 #ifdef HAVE_LIBIPTCDATA
 	if (TIFFGetField (image,
@@ -334,58 +270,49 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 				iptc_size = 4 * iptc_size;
 			}
 
-			id = tracker_iptc_new (iptc_offset, iptc_size, uri);
+			tracker_image_metadata_add_iptc (image_metadata,
+			                                 (guchar *) iptc_offset,
+			                                 iptc_size);
 		}
 	}
 #endif /* HAVE_LIBIPTCDATA */
 
-	if (!id) {
-		id = g_new0 (TrackerIptcData, 1);
-	}
-
 	/* FIXME There are problems between XMP data embedded with different tools
 	   due to bugs in the original spec (type) */
 #ifdef HAVE_EXEMPI
 	if (TIFFGetField (image, TIFFTAG_XMLPACKET, &size, &xmp_offset)) {
-		xd = tracker_xmp_new (xmp_offset, size, uri);
-	} else {
-		gchar *sidecar = NULL;
-
-		xd = tracker_xmp_new_from_sidecar (file, &sidecar);
-
-		if (sidecar) {
-			TrackerResource *sidecar_resource;
-
-			sidecar_resource = tracker_resource_new (sidecar);
-			tracker_resource_add_uri (sidecar_resource, "rdf:type", "nfo:FileDataObject");
-			tracker_resource_add_relation (sidecar_resource, "nie:interpretedAs", metadata);
-
-			tracker_resource_add_take_relation (metadata, "nie:isStoredAs", sidecar_resource);
-		}
+		tracker_image_metadata_add_xmp (image_metadata, xmp_offset, size);
 	}
 #endif /* HAVE_EXEMPI */
 
-	if (!xd) {
-		xd = g_new0 (TrackerXmpData, 1);
-	}
-
+	/* The TIFF image file directory holds the same tags as
+	 * the EXIF IFD0, read both through libtiff.
+	 */
 	ed = g_new0 (TrackerExifData, 1);
 
-	/* Get Tiff specifics */
-	td.width = tag_to_string (image, TIFFTAG_IMAGEWIDTH, TAG_TYPE_UINT32);
-	td.length = tag_to_string (image, TIFFTAG_IMAGELENGTH, TAG_TYPE_UINT32);
-	td.artist = tag_to_string (image, TIFFTAG_ARTIST, TAG_TYPE_STRING);
-	td.copyright = tag_to_string (image, TIFFTAG_COPYRIGHT, TAG_TYPE_STRING);
+	ed->x_dimension = tag_to_string (image, TIFFTAG_IMAGEWIDTH, TAG_TYPE_UINT32);
+	ed->y_dimension = tag_to_string (image, TIFFTAG_IMAGELENGTH, TAG_TYPE_UINT32);
+	ed->artist = tag_to_string (image, TIFFTAG_ARTIST, TAG_TYPE_STRING);
+	ed->copyright = tag_to_string (image, TIFFTAG_COPYRIGHT, TAG_TYPE_STRING);
 
 	date = tag_to_string (image, TIFFTAG_DATETIME, TAG_TYPE_STRING);
-	td.date = tracker_date_guess (date);
+	ed->time = tracker_date_guess (date);
 	g_free (date);
 
-	td.title = tag_to_string (image, TIFFTAG_DOCUMENTNAME, TAG_TYPE_STRING);
-	td.description = tag_to_string (image, TIFFTAG_IMAGEDESCRIPTION, TAG_TYPE_STRING);
-	td.make = tag_to_string (image, TIFFTAG_MAKE, TAG_TYPE_STRING);
-	td.model = tag_to_string (image, TIFFTAG_MODEL, TAG_TYPE_STRING);
-	td.orientation = get_orientation (image);
+	ed->document_name = tag_to_string (image, TIFFTAG_DOCUMENTNAME, TAG_TYPE_STRING);
+	ed->description = tag_to_string (image, TIFFTAG_IMAGEDESCRIPTION, TAG_TYPE_STRING);
+	ed->make = tag_to_string (image, TIFFTAG_MAKE, TAG_TYPE_STRING);
+	ed->model = tag_to_string (image, TIFFTAG_MODEL, TAG_TYPE_STRING);
+	ed->orientation = get_orientation (image);
+	ed->x_resolution = tag_to_string (image, TIFFTAG_XRESOLUTION, TAG_TYPE_DOUBLE);
+	ed->y_resolution = tag_to_string (image, TIFFTAG_YRESOLUTION, TAG_TYPE_DOUBLE);
+
+	if (ed->x_resolution || ed->y_resolution) {
+		guint16 unit = 0;
+
+		if (TIFFGetField (image, TIFFTAG_RESOLUTIONUNIT, &unit))
+			ed->resolution_unit = unit;
+	}
 
 	/* Get Exif specifics */
 	if (TIFFGetField (image, TIFFTAG_EXIFIFD, &exif_offset)) {
@@ -408,290 +335,18 @@ tracker_extract_get_metadata (TrackerExtractInfo  *info,
 	TIFFClose (image);
 	g_free (filename);
 
-	md.title = tracker_coalesce_strip (5, xd->title, xd->pdf_title, td.title, ed->document_name, xd->title2);
-	md.orientation = tracker_coalesce_strip (4, xd->orientation, td.orientation, ed->orientation, id->image_orientation);
-	md.copyright = tracker_coalesce_strip (4, xd->rights, td.copyright, ed->copyright, id->copyright_notice);
-	md.white_balance = tracker_coalesce_strip (2, xd->white_balance, ed->white_balance);
-	md.fnumber = tracker_coalesce_strip (2, xd->fnumber, ed->fnumber);
-	md.flash = tracker_coalesce_strip (2, xd->flash, ed->flash);
-	md.focal_length = tracker_coalesce_strip (2, xd->focal_length, ed->focal_length);
-	md.artist = tracker_coalesce_strip (4, xd->artist, td.artist, ed->artist, xd->contributor);
-	md.exposure_time = tracker_coalesce_strip (2, xd->exposure_time, ed->exposure_time);
-	md.iso_speed_ratings = tracker_coalesce_strip (2, xd->iso_speed_ratings, ed->iso_speed_ratings);
-	md.date = tracker_coalesce_strip (6, xd->date, xd->time_original, td.date, ed->time, id->date_created, ed->time_original);
-	md.description = tracker_coalesce_strip (3, xd->description, td.description, ed->description);
-	md.metering_mode = tracker_coalesce_strip (2, xd->metering_mode, ed->metering_mode);
-	md.city = tracker_coalesce_strip (2, xd->city, id->city);
-	md.state = tracker_coalesce_strip (2, xd->state, id->state);
-	md.address = tracker_coalesce_strip (2, xd->address, id->sublocation);
-	md.country = tracker_coalesce_strip (2, xd->country, id->country_name);
-
-	/* FIXME We are not handling the altitude ref here for xmp */
-	md.gps_altitude = tracker_coalesce_strip (2, xd->gps_altitude, ed->gps_altitude);
-	md.gps_latitude = tracker_coalesce_strip (2, xd->gps_latitude, ed->gps_latitude);
-	md.gps_longitude = tracker_coalesce_strip (2, xd->gps_longitude, ed->gps_longitude);
-	md.gps_direction = tracker_coalesce_strip (2, xd->gps_direction, ed->gps_direction);
-	md.creator = tracker_coalesce_strip (3, xd->creator, id->byline, id->credit);
-	md.x_dimension = tracker_coalesce_strip (2, td.width, ed->x_dimension);
-	md.y_dimension = tracker_coalesce_strip (2, td.length, ed->y_dimension);
-	md.make = tracker_coalesce_strip (3, xd->make, td.make, ed->make);
-	md.model = tracker_coalesce_strip (3, xd->model, td.model, ed->model);
-
-	keywords = g_ptr_array_new_with_free_func ((GDestroyNotify) g_free);
-
-	if (ed->user_comment) {
-		tracker_guarantee_resource_utf8_string (metadata, "nie:comment", ed->user_comment);
-	}
-
-	if (md.x_dimension) {
-		tracker_resource_set_string (metadata, "nfo:width", md.x_dimension);
-	}
-
-	if (md.y_dimension) {
-		tracker_resource_set_string (metadata, "nfo:height", md.y_dimension);
-	}
-
-	if (xd->keywords) {
-		tracker_keywords_parse (keywords, xd->keywords);
-	}
-
-	if (xd->pdf_keywords) {
-		tracker_keywords_parse (keywords, xd->pdf_keywords);
-	}
-
-	if (xd->subject) {
-		tracker_keywords_parse (keywords, xd->subject);
-	}
-
-	if (xd->publisher) {
-		TrackerResource *publisher = tracker_extract_new_contact (xd->publisher);
-		tracker_resource_set_relation (metadata, "nco:publisher", publisher);
-		g_object_unref (publisher);
-	}
-
-	if (xd->type) {
-		tracker_resource_set_string (metadata, "dc:type", xd->type);
-	}
-
-	if (xd->format) {
-		tracker_resource_set_string (metadata, "dc:format", xd->format);
-	}
-
-	if (xd->identifier) {
-		tracker_resource_set_string (metadata, "dc:identifier", xd->identifier);
-	}
-
-	if (xd->source) {
-		tracker_resource_set_string (metadata, "dc:source", xd->source);
-	}
-
-	if (xd->language) {
-		tracker_resource_set_string (metadata, "dc:language", xd->language);
-	}
-
-	if (xd->relation) {
-		tracker_resource_set_string (metadata, "dc:relation", xd->relation);
-	}
-
-	if (xd->coverage) {
-		tracker_resource_set_string (metadata, "dc:coverage", xd->coverage);
-	}
-
-	if (xd->rating) {
-		tracker_resource_set_string (metadata, "nao:numericRating", xd->rating);
-	}
-
-	if (xd->license) {
-		tracker_resource_set_string (metadata, "nie:license", xd->license);
-	}
-
-	if (xd->regions) {
-		tracker_xmp_apply_regions_to_resource (metadata, xd);
-	}
-
-	if (md.address || md.state || md.country || md.city ||
-	    md.gps_altitude || md.gps_latitude || md.gps_longitude) {
-		TrackerResource *location;
-
-		location = tracker_extract_new_location (md.address, md.state,
-				md.city, md.country, md.gps_altitude, md.gps_latitude,
-				md.gps_longitude);
-
-		tracker_resource_set_relation (metadata, "slo:location", location);
-
-		g_object_unref (location);
-	}
-
-	if (md.gps_direction) {
-		tracker_resource_set_string (metadata, "nfo:heading", md.gps_direction);
-	}
-
-	if (id->contact) {
-		TrackerResource *contact = tracker_extract_new_contact (id->contact);
-
-		tracker_resource_set_relation (metadata, "nco:contributor", contact);
-
-		g_object_unref (contact);
-	}
-
-	if (id->keywords) {
-		tracker_keywords_parse (keywords, id->keywords);
-	}
-
-	for (i = 0; i < keywords->len; i++) {
-		TrackerResource *tag;
-		const gchar *p;
-
-		p = g_ptr_array_index (keywords, i);
-		tag = tracker_extract_new_tag (p);
-
-		tracker_resource_set_relation (metadata, "nao:hasTag", tag);
-
-		g_object_unref (tag);
-	}
-	g_ptr_array_free (keywords, TRUE);
-
-	if (md.make || md.model) {
-		TrackerResource *equipment = tracker_extract_new_equipment (md.make, md.model);
-
-		tracker_resource_set_relation (metadata, "nfo:equipment", equipment);
-
-		g_object_unref (equipment);
-	}
-
-	tracker_guarantee_resource_title_from_file (metadata,
-	                                            "nie:title",
-	                                            md.title,
-	                                            uri,
-	                                            NULL);
-
-	if (md.orientation) {
-		TrackerResource *orientation;
-
-		orientation = tracker_resource_new (md.orientation);
-		tracker_resource_set_relation (metadata, "nfo:orientation", orientation);
-		g_object_unref (orientation);
-	}
-
-	if (md.copyright) {
-		tracker_guarantee_resource_utf8_string (metadata, "nie:copyright", md.copyright);
-	}
-
-	if (md.white_balance) {
-		TrackerResource *white_balance;
-
-		white_balance = tracker_resource_new (md.white_balance);
-		tracker_resource_set_relation (metadata, "nmm:whiteBalance", white_balance);
-		g_object_unref (white_balance);
-	}
-
-	if (md.fnumber) {
-		tracker_resource_set_string (metadata, "nmm:fnumber", md.fnumber);
-	}
-
-	if (md.flash) {
-		TrackerResource *flash;
-
-		flash = tracker_resource_new (md.flash);
-		tracker_resource_set_relation (metadata, "nmm:flash", flash);
-		g_object_unref (flash);
-	}
-
-	if (md.focal_length) {
-		tracker_resource_set_string (metadata, "nmm:focalLength", md.focal_length);
+	if (ed->x_dimension) {
+		tracker_resource_set_string (metadata, "nfo:width", ed->x_dimension);
 	}
 
-	if (md.artist) {
-		TrackerResource *artist = tracker_extract_new_contact (md.artist);
-
-		tracker_resource_set_relation (metadata, "nco:contributor", artist);
-
-		g_object_unref (artist);
-	}
-
-	if (md.exposure_time) {
-		tracker_resource_set_string (metadata, "nmm:exposureTime", md.exposure_time);
+	if (ed->y_dimension) {
+		tracker_resource_set_string (metadata, "nfo:height", ed->y_dimension);
 	}
 
-	if (md.iso_speed_ratings) {
-		tracker_resource_set_string (metadata, "nmm:isoSpeed", md.iso_speed_ratings);
-	}
-
-	tracker_guarantee_resource_date_from_file_mtime (metadata,
-	                                                 "nie:contentCreated",
-	                                                 md.date,
-	                                                 uri);
-
-	if (md.description) {
-		tracker_guarantee_resource_utf8_string (metadata, "nie:description", md.description);
-	}
-
-	if (md.metering_mode) {
-		TrackerResource *metering;
-
-		metering = tracker_resource_new (md.metering_mode);
-		tracker_resource_set_relation (metadata, "nmm:meteringMode", metering);
-		g_object_unref (metering);
-	}
-
-	if (md.creator) {
-		TrackerResource *creator = tracker_extract_new_contact (md.creator);
-
-		/* NOTE: We only have affiliation with
-		 * nco:PersonContact and we are using
-		 * nco:Contact here.
-		 */
-
-		/* if (id->byline_title) { */
-		/* 	tracker_sparql_builder_insert_open (preupdate, NULL); */
-
-		/* 	tracker_sparql_builder_subject (preupdate, "_:affiliation_by_line"); */
-		/* 	tracker_sparql_builder_predicate (preupdate, "a"); */
-		/* 	tracker_sparql_builder_object (preupdate, "nco:Affiliation"); */
-
-		/* 	tracker_sparql_builder_predicate (preupdate, "nco:title"); */
-		/* 	tracker_sparql_builder_object_unvalidated (preupdate, id->byline_title); */
-
-		/* 	tracker_sparql_builder_insert_close (preupdate); */
-
-		/* 	tracker_sparql_builder_predicate (metadata, "a"); */
-		/* 	tracker_sparql_builder_object (metadata, "nco:PersonContact"); */
-		/* 	tracker_sparql_builder_predicate (metadata, "nco:hasAffiliation"); */
-		/* 	tracker_sparql_builder_object (metadata, "_:affiliation_by_line"); */
-		/* } */
-
-		tracker_resource_set_relation (metadata, "nco:creator", creator);
-
-		g_object_unref (creator);
-	}
-
-	if (ed->x_resolution) {
-		gdouble value;
-
-		if (ed->resolution_unit == EXIF_RESOLUTION_UNIT_PER_CENTIMETER)
-			value = g_strtod (ed->x_resolution, NULL) * CMS_PER_INCH;
-		else
-			value = g_strtod (ed->x_resolution, NULL);
-
-		tracker_resource_set_double (metadata, "nfo:horizontalResolution", value);
-	}
-
-	if (ed->y_resolution) {
-		gdouble value;
-
-		if (ed->resolution_unit == EXIF_RESOLUTION_UNIT_PER_CENTIMETER)
-			value = g_strtod (ed->y_resolution, NULL) * CMS_PER_INCH;
-		else
-			value = g_strtod (ed->y_resolution, NULL);
-
-		tracker_resource_set_double (metadata, "nfo:verticalResolution", value);
-	}
+	tracker_image_metadata_take_exif (image_metadata, ed);
+	tracker_image_metadata_apply_to_resource (image_metadata, metadata);
 
-	tiff_data_free (&td);
-	tracker_exif_free (ed);
-	tracker_xmp_free (xd);
-	tracker_iptc_free (id);
-	g_free (uri);
+	tracker_image_metadata_free (image_metadata);
 	close (fd);
 
 	tracker_extract_info_set_resource (info, metadata);
@@ -23,6 +23,7 @@
 /* Avoid warnings about deprecated GParameter from gsf headers */
 #define GLIB_VERSION_MIN_REQUIRED GLIB_VERSION_2_40
 #include <glib.h>
+#include <gio/gio.h>
 
 #include <libtracker-miners-common/tracker-file-utils.h>
 
@@ -30,6 +31,7 @@
 #include <gsf/gsf-infile.h>
 #include <gsf/gsf-input-stdio.h>
 #include <gsf/gsf-infile-zip.h>
+#include <gsf/gsf-input-memory.h>
 
 #include "tracker-gsf.h"
 
@@ -37,6 +39,18 @@
 #define XML_BUFFER_SIZE            8192         /* bytes */
 /* Note: 20 MBytes of max size is really assumed to be a safe limit. */
 #define XML_MAX_BYTES_READ         (20u << 20)  /* bytes */
+/* Limits to the data inflated from all members of an archive */
+#define ZIP_MAX_EXPANSION_RATIO    100
+#define ZIP_MAX_TOTAL_BYTES_READ   (200u << 20) /* bytes */
+
+struct _TrackerZip {
+	gchar *name;
+	FILE *file;
+	GsfInput *src;
+	GsfInfile *infile;
+	gsize total_bytes;
+	gsize max_total_bytes;
+};
 
 /**
  * based on find_member() from vsd_utils.c:
@@ -78,101 +92,210 @@ find_member (GsfInfile *arch,
 	}
 }
 
+static TrackerZip *
+tracker_zip_new_for_input (GsfInput     *src,
+                           const gchar  *name,
+                           GError      **error)
+{
+	TrackerZip *zip;
+	GsfInfile *infile;
+	GError *inner_error = NULL;
+	gsf_off_t size;
+
+	/* The central directory is read once, here */
+	infile = gsf_infile_zip_new (src, &inner_error);
+
+	if (!infile) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+		             "'%s' Not a zip file: %s",
+		             name, inner_error ? inner_error->message : "no error given");
+		g_clear_error (&inner_error);
+		g_object_unref (src);
+		return NULL;
+	}
+
+	zip = g_new0 (TrackerZip, 1);
+	zip->name = g_strdup (name);
+	zip->src = src;
+	zip->infile = infile;
+
+	size = gsf_input_size (src);
+	zip->max_total_bytes = CLAMP (size * ZIP_MAX_EXPANSION_RATIO,
+	                              XML_MAX_BYTES_READ,
+	                              ZIP_MAX_TOTAL_BYTES_READ);
+
+	return zip;
+}
+
 /**
- * tracker_gsf_parse_xml_in_zip:
+ * tracker_zip_open:
  * @zip_file_uri: URI of the ZIP archive
+ * @error: return location for a #GError
+ *
+ * Opens a ZIP archive, so the XML files stored inside can be parsed
+ * with tracker_zip_parse_xml().
+ *
+ * Returns: (transfer full): the opened archive, or %NULL on error
+ */
+TrackerZip *
+tracker_zip_open (const gchar  *zip_file_uri,
+                  GError      **error)
+{
+	g_autofree gchar *filename = NULL;
+	TrackerZip *zip;
+	GsfInput *src;
+	FILE *file;
+
+	/* Get filename from the given URI */
+	filename = g_filename_from_uri (zip_file_uri, NULL, error);
+	if (!filename)
+		return NULL;
+
+	file = tracker_file_open (filename);
+	if (!file) {
+		g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+		             "Can't open file from uri '%s': %s",
+		             zip_file_uri, g_strerror (errno));
+		return NULL;
+	}
+
+	/* Create a new Input GSF object for the given file */
+	src = gsf_input_stdio_new_FILE (filename, file, TRUE);
+	if (!src) {
+		tracker_file_close (file, FALSE);
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+		             "Failed creating a GSF Input object for '%s'",
+		             zip_file_uri);
+		return NULL;
+	}
+
+	zip = tracker_zip_new_for_input (src, zip_file_uri, error);
+	if (!zip) {
+		tracker_file_close (file, FALSE);
+		return NULL;
+	}
+
+	zip->file = file;
+
+	return zip;
+}
+
+/**
+ * tracker_zip_open_from_data:
+ * @data: contents of a ZIP archive
+ * @size: size of @data
+ * @error: return location for a #GError
+ *
+ * Opens a ZIP archive held in memory. @data must stay alive
+ * until the archive is closed.
+ *
+ * Returns: (transfer full): the opened archive, or %NULL on error
+ */
+TrackerZip *
+tracker_zip_open_from_data (const guint8  *data,
+                            gsize          size,
+                            GError       **error)
+{
+	GsfInput *src;
+
+	src = gsf_input_memory_new (data, size, FALSE);
+
+	return tracker_zip_new_for_input (src, "(memory)", error);
+}
+
+void
+tracker_zip_close (TrackerZip *zip)
+{
+	g_object_unref (zip->infile);
+	g_object_unref (zip->src);
+
+	if (zip->file)
+		tracker_file_close (zip->file, FALSE);
+
+	g_free (zip->name);
+	g_free (zip);
+}
+
+/**
+ * tracker_zip_parse_xml:
+ * @zip: a #TrackerZip
  * @xml_filename: Name of the XML file stored inside the ZIP archive
  * @context: Markup context to be used when parsing the XML
+ * @error: return location for a #GError
  *
  * This function reads and parses the contents of an XML file stored
- *  inside a ZIP compressed archive. Reading and parsing is done buffered, and
- *  maximum size of the uncompressed XML file is limited to be to 20MBytes.
+ *  inside a ZIP compressed archive. The member is inflated and parsed
+ *  in chunks, so parsing stops inflating as soon as @context reports an
+ *  error, e.g. once the text limit is reached. Each member is limited to
+ *  20MBytes uncompressed, and all members parsed from @zip together are
+ *  limited to a multiple of the archive size, to stop zip bombs.
+ *
+ * Returns: %TRUE if the XML file was found and parsed without errors
  */
-void
-tracker_gsf_parse_xml_in_zip (const gchar          *zip_file_uri,
-                              const gchar          *xml_filename,
-                              GMarkupParseContext  *context,
-                              GError              **err)
+gboolean
+tracker_zip_parse_xml (TrackerZip           *zip,
+                       const gchar          *xml_filename,
+                       GMarkupParseContext  *context,
+                       GError              **error)
 {
-	gchar *filename;
-	GError *error = NULL;
-	GsfInfile *infile = NULL;
-	GsfInput *src = NULL;
-	GsfInput *member = NULL;
-	FILE *file;
+	GError *inner_error = NULL;
+	GsfInput *member;
+	guint8 buf[XML_BUFFER_SIZE];
+	size_t remaining_size, chunk_size, accum;
 
 	g_debug ("Parsing '%s' XML file contained inside zip archive...",
 	         xml_filename);
 
-	/* Get filename from the given URI */
-	if ((filename = g_filename_from_uri (zip_file_uri,
-	                                     NULL, &error)) == NULL) {
-		g_warning ("Can't get filename from uri '%s': %s",
-		           zip_file_uri, error ? error->message : "no error given");
-	} else { /* Create a new Input GSF object for the given file */
-
-		file = tracker_file_open (filename);
-		if (!file) {
-			g_warning ("Can't open file from uri '%s': %s",
-			           zip_file_uri, g_strerror (errno));
-		} else if ((src = gsf_input_stdio_new_FILE (filename, file, TRUE)) == NULL) {
-			g_warning ("Failed creating a GSF Input object for '%s': %s",
-			           zip_file_uri, error ? error->message : "no error given");
-		}
-		/* Input object is a Zip file */
-		else if ((infile = gsf_infile_zip_new (src, &error)) == NULL) {
-			g_warning ("'%s' Not a zip file: %s",
-			           zip_file_uri, error ? error->message : "no error given");
-		}
-		/* Look for requested filename inside the ZIP file */
-		else if ((member = find_member (infile, xml_filename)) == NULL) {
-			g_warning ("No member '%s' in zip file '%s'",
-			           xml_filename, zip_file_uri);
-		}
-		/* Load whole contents of the internal file in the xml buffer */
-		else {
-			guint8 buf[XML_BUFFER_SIZE];
-			size_t remaining_size, chunk_size, accum;
-
-			/* Get whole size of the contents to read */
-			remaining_size = (size_t) gsf_input_size (GSF_INPUT (member));
-
-			/* Note that gsf_input_read() needs to be able to read ALL specified
-			 *  number of bytes, or it will fail */
-			chunk_size = MIN (remaining_size, XML_BUFFER_SIZE);
-
-			accum = 0;
-			while (!error &&
-			       accum  <= XML_MAX_BYTES_READ &&
-			       chunk_size > 0 &&
-			       gsf_input_read (GSF_INPUT (member), chunk_size, buf) != NULL) {
-
-				/* update accumulated count */
-				accum += chunk_size;
-
-				/* Pass the read stream to the context parser... */
-				g_markup_parse_context_parse (context, buf, chunk_size, &error);
-
-				/* update bytes to be read */
-				remaining_size -= chunk_size;
-				chunk_size = MIN (remaining_size, XML_BUFFER_SIZE);
-			}
-		}
+	/* Look for requested filename inside the ZIP file */
+	member = find_member (zip->infile, xml_filename);
+	if (!member) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+		             "No member '%s' in zip file '%s'",
+		             xml_filename, zip->name);
+		return FALSE;
+	}
+
+	/* Get whole size of the contents to read */
+	remaining_size = (size_t) gsf_input_size (member);
+
+	/* Note that gsf_input_read() needs to be able to read ALL specified
+	 *  number of bytes, or it will fail */
+	chunk_size = MIN (remaining_size, XML_BUFFER_SIZE);
 
-		if (file) {
-			tracker_file_close (file, FALSE);
+	accum = 0;
+	while (!inner_error &&
+	       accum <= XML_MAX_BYTES_READ &&
+	       chunk_size > 0) {
+		if (zip->total_bytes + chunk_size > zip->max_total_bytes) {
+			g_set_error (&inner_error,
+			             G_IO_ERROR, G_IO_ERROR_MESSAGE_TOO_LARGE,
+			             "Maximum expanded size of zip file '%s' reached",
+			             zip->name);
+			break;
 		}
+
+		if (gsf_input_read (member, chunk_size, buf) == NULL)
+			break;
+
+		/* update accumulated count */
+		accum += chunk_size;
+		zip->total_bytes += chunk_size;
+
+		/* Pass the read stream to the context parser... */
+		g_markup_parse_context_parse (context, (const gchar *) buf,
+		                              chunk_size, &inner_error);
+
+		/* update bytes to be read */
+		remaining_size -= chunk_size;
+		chunk_size = MIN (remaining_size, XML_BUFFER_SIZE);
 	}
 
-	g_free (filename);
+	g_object_unref (member);
 
-	if (error)
-		g_propagate_error (err, error);
-	if (infile)
-		g_object_unref (infile);
-	if (src)
-		g_object_unref (src);
-	if (member)
-		g_object_unref (member);
-}
+	if (inner_error) {
+		g_propagate_error (error, inner_error);
+		return FALSE;
+	}
 
+	return TRUE;
+}
@@ -24,10 +24,21 @@
 
 G_BEGIN_DECLS
 
-void tracker_gsf_parse_xml_in_zip (const gchar          *zip_file_uri,
-                                   const gchar          *xml_filename,
-                                   GMarkupParseContext  *context,
-                                   GError              **error);
+typedef struct _TrackerZip TrackerZip;
+
+TrackerZip * tracker_zip_open           (const gchar   *zip_file_uri,
+                                         GError       **error);
+TrackerZip * tracker_zip_open_from_data (const guint8  *data,
+                                         gsize          size,
+                                         GError       **error);
+void         tracker_zip_close          (TrackerZip    *zip);
+
+gboolean tracker_zip_parse_xml (TrackerZip           *zip,
+                                const gchar          *xml_filename,
+                                GMarkupParseContext  *context,
+                                GError              **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (TrackerZip, tracker_zip_close)
 
 G_END_DECLS
 
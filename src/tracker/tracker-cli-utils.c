@@ -20,12 +20,27 @@
  */
 
 
+#include <math.h>
+#include <stdio.h>
+
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <gio/gio.h>
 
 #include "tracker-cli-utils.h"
 
+#define QUERY_RESOURCE "/org/freedesktop/Tracker3/CLI/queries/"
+
+/* Machine readable output is written one record at a time, JSON Lines
+ * writes an object per line, NUL mode writes each field as a
+ * "field=value" string terminated by a NUL byte, with an extra NUL
+ * byte terminating the record.
+ */
+struct _TrackerCliWriter {
+	TrackerCliOutputFormat format;
+	GString *record;
+	guint n_fields;
+};
 
 static gint
 sort_by_date (gconstpointer a,
@@ -118,3 +133,228 @@ tracker_cli_check_inside_build_tree (const gchar* argv0)
 
 	return g_file_has_prefix (path, build_root);
 }
+
+TrackerSparqlStatement *
+tracker_cli_load_statement (TrackerSparqlConnection  *connection,
+                            const gchar              *query_filename,
+                            GError                  **error)
+{
+	g_autofree gchar *resource_path = NULL;
+
+	resource_path = g_strconcat (QUERY_RESOURCE, query_filename, NULL);
+
+	return tracker_sparql_connection_load_statement_from_gresource (connection,
+	                                                                resource_path,
+	                                                                NULL,
+	                                                                error);
+}
+
+gboolean
+tracker_cli_parse_output_format (const gchar            *str,
+                                 TrackerCliOutputFormat *format)
+{
+	if (!str || g_strcmp0 (str, "text") == 0)
+		*format = TRACKER_CLI_OUTPUT_FORMAT_TEXT;
+	else if (g_strcmp0 (str, "json") == 0)
+		*format = TRACKER_CLI_OUTPUT_FORMAT_JSON;
+	else if (g_strcmp0 (str, "nul") == 0)
+		*format = TRACKER_CLI_OUTPUT_FORMAT_NUL;
+	else
+		return FALSE;
+
+	return TRUE;
+}
+
+TrackerCliWriter *
+tracker_cli_writer_new (TrackerCliOutputFormat format)
+{
+	TrackerCliWriter *writer;
+
+	g_return_val_if_fail (format != TRACKER_CLI_OUTPUT_FORMAT_TEXT, NULL);
+
+	writer = g_new0 (TrackerCliWriter, 1);
+	writer->format = format;
+	writer->record = g_string_new (NULL);
+
+	return writer;
+}
+
+void
+tracker_cli_writer_free (TrackerCliWriter *writer)
+{
+	fflush (stdout);
+	g_string_free (writer->record, TRUE);
+	g_free (writer);
+}
+
+void
+tracker_cli_writer_begin_record (TrackerCliWriter *writer)
+{
+	g_string_truncate (writer->record, 0);
+	writer->n_fields = 0;
+
+	if (writer->format == TRACKER_CLI_OUTPUT_FORMAT_JSON)
+		g_string_append_c (writer->record, '{');
+}
+
+void
+tracker_cli_writer_end_record (TrackerCliWriter *writer)
+{
+	if (writer->format == TRACKER_CLI_OUTPUT_FORMAT_JSON)
+		g_string_append (writer->record, "}\n");
+	else
+		g_string_append_c (writer->record, '\0');
+
+	fwrite (writer->record->str, 1, writer->record->len, stdout);
+}
+
+static void
+append_json_string (GString     *str,
+                    const gchar *value)
+{
+	const gchar *p;
+
+	g_string_append_c (str, '"');
+
+	for (p = value; *p; p++) {
+		switch (*p) {
+		case '"':
+			g_string_append (str, "\\\"");
+			break;
+		case '\\':
+			g_string_append (str, "\\\\");
+			break;
+		case '\n':
+			g_string_append (str, "\\n");
+			break;
+		case '\r':
+			g_string_append (str, "\\r");
+			break;
+		case '\t':
+			g_string_append (str, "\\t");
+			break;
+		default:
+			if ((guchar) *p < 0x20)
+				g_string_append_printf (str, "\\u%04x", (guint) *p);
+			else
+				g_string_append_c (str, *p);
+			break;
+		}
+	}
+
+	g_string_append_c (str, '"');
+}
+
+static void
+append_field (TrackerCliWriter *writer,
+              const gchar      *field,
+              const gchar      *value,
+              gboolean          quote)
+{
+	if (writer->format == TRACKER_CLI_OUTPUT_FORMAT_JSON) {
+		if (writer->n_fields > 0)
+			g_string_append_c (writer->record, ',');
+
+		append_json_string (writer->record, field);
+		g_string_append_c (writer->record, ':');
+
+		if (!value)
+			g_string_append (writer->record, "null");
+		else if (quote)
+			append_json_string (writer->record, value);
+		else
+			g_string_append (writer->record, value);
+	} else {
+		/* Unbound values are left out of NUL separated records */
+		if (!value)
+			return;
+
+		g_string_append_printf (writer->record, "%s=%s", field, value);
+		g_string_append_c (writer->record, '\0');
+	}
+
+	writer->n_fields++;
+}
+
+void
+tracker_cli_writer_add_string (TrackerCliWriter *writer,
+                               const gchar      *field,
+                               const gchar      *value)
+{
+	append_field (writer, field, value, TRUE);
+}
+
+void
+tracker_cli_writer_add_integer (TrackerCliWriter *writer,
+                                const gchar      *field,
+                                gint64            value)
+{
+	gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+	g_snprintf (buf, sizeof (buf), "%" G_GINT64_FORMAT, value);
+	append_field (writer, field, buf, FALSE);
+}
+
+void
+tracker_cli_writer_add_double (TrackerCliWriter *writer,
+                               const gchar      *field,
+                               gdouble           value)
+{
+	gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+	/* JSON has no representation for infinities and NaN,
+	 * these are written like unbound values.
+	 */
+	if (!isfinite (value)) {
+		append_field (writer, field, NULL, FALSE);
+		return;
+	}
+
+	g_ascii_dtostr (buf, sizeof (buf), value);
+	append_field (writer, field, buf, FALSE);
+}
+
+void
+tracker_cli_writer_add_boolean (TrackerCliWriter *writer,
+                                const gchar      *field,
+                                gboolean          value)
+{
+	append_field (writer, field, value ? "true" : "false", FALSE);
+}
+
+void
+tracker_cli_writer_add_cursor_row (TrackerCliWriter    *writer,
+                                   TrackerSparqlCursor *cursor)
+{
+	gint i, n_columns;
+
+	n_columns = tracker_sparql_cursor_get_n_columns (cursor);
+
+	for (i = 0; i < n_columns; i++) {
+		const gchar *field;
+
+		field = tracker_sparql_cursor_get_variable_name (cursor, i);
+
+		switch (tracker_sparql_cursor_get_value_type (cursor, i)) {
+		case TRACKER_SPARQL_VALUE_TYPE_UNBOUND:
+			append_field (writer, field, NULL, FALSE);
+			break;
+		case TRACKER_SPARQL_VALUE_TYPE_INTEGER:
+			tracker_cli_writer_add_integer (writer, field,
+			                                tracker_sparql_cursor_get_integer (cursor, i));
+			break;
+		case TRACKER_SPARQL_VALUE_TYPE_DOUBLE:
+			tracker_cli_writer_add_double (writer, field,
+			                               tracker_sparql_cursor_get_double (cursor, i));
+			break;
+		case TRACKER_SPARQL_VALUE_TYPE_BOOLEAN:
+			tracker_cli_writer_add_boolean (writer, field,
+			                                tracker_sparql_cursor_get_boolean (cursor, i));
+			break;
+		default:
+			tracker_cli_writer_add_string (writer, field,
+			                               tracker_sparql_cursor_get_string (cursor, i, NULL));
+			break;
+		}
+	}
+}
@@ -24,10 +24,50 @@
 
 #include <glib.h>
 #include <gio/gio.h>
+#include <tinysparql.h>
 
 
+typedef enum {
+	TRACKER_CLI_OUTPUT_FORMAT_TEXT,
+	TRACKER_CLI_OUTPUT_FORMAT_JSON,
+	TRACKER_CLI_OUTPUT_FORMAT_NUL,
+} TrackerCliOutputFormat;
+
+typedef struct _TrackerCliWriter TrackerCliWriter;
+
 GList* tracker_cli_get_error_keyfiles (void);
 
 gboolean tracker_cli_check_inside_build_tree (const gchar* argv0);
 
+TrackerSparqlStatement * tracker_cli_load_statement (TrackerSparqlConnection  *connection,
+                                                     const gchar              *query_filename,
+                                                     GError                  **error);
+
+gboolean tracker_cli_parse_output_format (const gchar            *str,
+                                          TrackerCliOutputFormat *format);
+
+TrackerCliWriter * tracker_cli_writer_new  (TrackerCliOutputFormat  format);
+void               tracker_cli_writer_free (TrackerCliWriter       *writer);
+
+void tracker_cli_writer_begin_record (TrackerCliWriter *writer);
+void tracker_cli_writer_end_record   (TrackerCliWriter *writer);
+
+void tracker_cli_writer_add_string  (TrackerCliWriter *writer,
+                                     const gchar      *field,
+                                     const gchar      *value);
+void tracker_cli_writer_add_integer (TrackerCliWriter *writer,
+                                     const gchar      *field,
+                                     gint64            value);
+void tracker_cli_writer_add_double  (TrackerCliWriter *writer,
+                                     const gchar      *field,
+                                     gdouble           value);
+void tracker_cli_writer_add_boolean (TrackerCliWriter *writer,
+                                     const gchar      *field,
+                                     gboolean          value);
+
+void tracker_cli_writer_add_cursor_row (TrackerCliWriter    *writer,
+                                        TrackerSparqlCursor *cursor);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (TrackerCliWriter, tracker_cli_writer_free)
+
 #endif /* __TRACKER_CLI_UTILS_H__ */
@@ -48,6 +48,16 @@
 
 #define LINK_STR "[🡕]" /* NORTH EAST SANS-SERIF ARROW, in consistence with systemd */
 
+/* Number of arguments resolved, and resources described, per query */
+#define BATCH_SIZE 256
+
+typedef struct {
+	const gchar *arg;
+	gchar *uri;
+	GPtrArray *urns;
+	gboolean failed;
+} InfoTarget;
+
 static gboolean inside_build_tree = FALSE;
 
 static gchar **filenames;
@@ -57,8 +67,10 @@ static gboolean resource_is_iri;
 static gboolean turtle;
 static gboolean eligible;
 static gchar *url_property;
+static gchar *output_format;
 
 static gboolean output_is_tty;
+static TrackerCliWriter *writer;
 
 static GOptionEntry entries[] = {
 	{ "full-namespaces", 'f', 0, G_OPTION_ARG_NONE, &full_namespaces,
@@ -90,6 +102,9 @@ static GOptionEntry entries[] = {
 	{ "eligible", 'e', 0, G_OPTION_ARG_NONE, &eligible,
 	  N_("Checks if FILE is eligible for being mined based on configuration"),
 	  NULL },
+	{ "output-format", 0, 0, G_OPTION_ARG_STRING, &output_format,
+	  N_("Output format, “text” (the default), “json” for JSON Lines or “nul” for NUL separated fields"),
+	  N_("FORMAT") },
 	{ G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames,
 	  N_("FILE"),
 	  N_("FILE")},
@@ -114,18 +129,49 @@ has_valid_uri_scheme (const gchar *uri)
 	return (*s == ':');
 }
 
+static InfoTarget *
+info_target_new (const gchar *arg)
+{
+	InfoTarget *target;
+
+	target = g_new0 (InfoTarget, 1);
+	target->arg = arg;
+	target->urns = g_ptr_array_new_with_free_func (g_free);
+
+	/* support both, URIs and local file paths */
+	if (has_valid_uri_scheme (arg) || resource_is_iri) {
+		target->uri = g_strdup (arg);
+	} else {
+		g_autoptr (GFile) file = NULL;
+
+		file = g_file_new_for_commandline_arg (arg);
+		target->uri = g_file_get_uri (file);
+	}
+
+	return target;
+}
+
+static void
+info_target_free (InfoTarget *target)
+{
+	g_ptr_array_unref (target->urns);
+	g_free (target->uri);
+	g_free (target);
+}
+
 static TrackerSparqlStatement *
 describe_statement_for_urns (TrackerSparqlConnection *conn,
-                             GList                   *urns)
+                             gchar                  **urns,
+                             guint                    n_urns)
 {
 	TrackerSparqlStatement *stmt;
 	g_autoptr (GString) str = NULL;
-	GList *l;
+	guint i;
 
 	str = g_string_new ("DESCRIBE");
 
-	for (l = urns; l; l = l->next)
-		g_string_append_printf (str, " <%s>", (gchar*) l->data);
+	for (i = 0; i < n_urns; i++)
+		g_string_append_printf (str, " <%s>", urns[i]);
 
 	stmt = tracker_sparql_connection_query_statement (conn,
 	                                                  str->str,
@@ -252,28 +298,34 @@ print_plain_values (const gchar             *subject,
 	g_print ("\n");
 }
 
-static void
-print_plain_objects (GHashTable              *objects,
-                     TrackerNamespaceManager *namespaces,
-                     int                      axis_column)
+static gint
+get_longest_predicate (GHashTable *values)
 {
 	GHashTableIter iter;
-	gpointer subject, values;
+	const gchar *pred;
+	gint longest_pred = 0;
+
+	g_hash_table_iter_init (&iter, values);
 
-	g_hash_table_iter_init (&iter, objects);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &pred, NULL))
+		longest_pred = MAX (longest_pred, g_utf8_strlen (pred, -1));
 
-	while (g_hash_table_iter_next (&iter, &subject, &values))
-		print_plain_values (subject, values, namespaces, axis_column);
+	return longest_pred;
 }
 
+/* Prints the described resources in the given order, as cursors
+ * are not guaranteed to be sorted by subject.
+ */
 static void
 print_plain (TrackerSparqlCursor     *cursor,
-             TrackerNamespaceManager *namespaces)
+             TrackerNamespaceManager *namespaces,
+             gchar                  **urns,
+             guint                    n_urns)
 {
 	g_autoptr (GHashTable) objects = NULL;
 	GHashTable *values = NULL;
 	gchar *last_subject = NULL;
-	int longest_pred = 0;
+	guint i;
 
 	objects = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
 	                                 (GDestroyNotify) g_hash_table_unref);
@@ -284,9 +336,15 @@ print_plain (TrackerSparqlCursor     *cursor,
 		const gchar *object = tracker_sparql_cursor_get_string (cursor, 2, NULL);
 
 		if (g_strcmp0 (subject, last_subject) != 0) {
+			values = g_hash_table_lookup (objects, subject);
+
+			if (!values) {
+				values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, free_object_list);
+				g_hash_table_insert (objects, g_strdup (subject), values);
+			}
+
+			g_free (last_subject);
 			last_subject = g_strdup (subject);
-			values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, free_object_list);
-			g_hash_table_insert (objects, last_subject, values);
 		}
 
 		/* Don't display nie:plainTextContent */
@@ -296,16 +354,48 @@ print_plain (TrackerSparqlCursor     *cursor,
 
 		if (full_namespaces) {
 			accumulate_value (values, pred, object);
-			longest_pred = MAX (longest_pred, g_utf8_strlen (pred, -1));
 		} else {
 			g_autofree gchar *compressed = NULL;
 			compressed = tracker_namespace_manager_compress_uri (namespaces, pred);
 			accumulate_value (values, compressed, object);
-			longest_pred = MAX (longest_pred, g_utf8_strlen (compressed, -1));
 		}
 	}
 
-	print_plain_objects (objects, namespaces, longest_pred + 1);
+	g_free (last_subject);
+
+	for (i = 0; i < n_urns; i++) {
+		values = g_hash_table_lookup (objects, urns[i]);
+		if (!values)
+			continue;
+
+		print_plain_values (urns[i], values, namespaces,
+		                    get_longest_predicate (values) + 1);
+	}
+}
+
+static void
+write_triples (TrackerSparqlCursor     *cursor,
+               TrackerNamespaceManager *namespaces)
+{
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+		const gchar *subject = tracker_sparql_cursor_get_string (cursor, 0, NULL);
+		const gchar *pred = tracker_sparql_cursor_get_string (cursor, 1, NULL);
+		const gchar *object = tracker_sparql_cursor_get_string (cursor, 2, NULL);
+		g_autofree gchar *compressed = NULL;
+
+		if (!plain_text_content &&
+		    strcmp (pred, TRACKER_PREFIX_NIE "plainTextContent") == 0)
+			continue;
+
+		if (!full_namespaces)
+			compressed = tracker_namespace_manager_compress_uri (namespaces, pred);
+
+		tracker_cli_writer_begin_record (writer);
+		tracker_cli_writer_add_string (writer, "subject", subject);
+		tracker_cli_writer_add_string (writer, "predicate", compressed ? compressed : pred);
+		tracker_cli_writer_add_string (writer, "object", object);
+		tracker_cli_writer_end_record (writer);
+	}
 }
 
 static void
@@ -404,99 +494,207 @@ print_errors (GList       *keyfiles,
 }
 
 
-static int
-info_run (void)
+static gchar *
+create_values_clause (void)
 {
-	TrackerSparqlConnection *connection;
-	GError *error = NULL;
-	GList *urns = NULL;
-	gchar **p;
+	GString *values;
+	guint i;
 
-	tracker_term_pipe_to_pager ();
+	values = g_string_new ("VALUES ?arg {");
 
-	connection = create_connection (&error);
+	for (i = 0; i < BATCH_SIZE; i++)
+		g_string_append_printf (values, " ~arg%u", i);
 
-	if (!connection) {
-		g_printerr ("%s: %s\n",
-		            _("Could not establish a connection to Tracker"),
-		            error ? error->message : _("No error given"));
-		g_clear_error (&error);
-		return EXIT_FAILURE;
+	g_string_append (values, " }");
+
+	return g_string_free (values, FALSE);
+}
+
+/* Binds the BATCH_SIZE targets starting at @offset to the ~argN
+ * parameters, and groups them by their URI in @batch.
+ */
+static void
+bind_batch (TrackerSparqlStatement *stmt,
+            GPtrArray              *targets,
+            guint                   offset,
+            GHashTable             *batch)
+{
+	guint i;
+
+	g_hash_table_remove_all (batch);
+
+	for (i = 0; i < BATCH_SIZE; i++) {
+		InfoTarget *target;
+		GPtrArray *same_uri;
+		gchar name[16];
+
+		/* Pad the last batch by repeating its last target */
+		target = g_ptr_array_index (targets, MIN (offset + i, targets->len - 1));
+		g_snprintf (name, sizeof (name), "arg%u", i);
+		tracker_sparql_statement_bind_string (stmt, name, target->uri);
+
+		if (offset + i >= targets->len)
+			continue;
+
+		same_uri = g_hash_table_lookup (batch, target->uri);
+		if (!same_uri) {
+			same_uri = g_ptr_array_new ();
+			g_hash_table_insert (batch, target->uri, same_uri);
+		}
+
+		g_ptr_array_add (same_uri, target);
 	}
+}
 
-	for (p = filenames; *p; p++) {
-		g_autoptr (TrackerSparqlStatement) stmt = NULL;
-		g_autoptr (TrackerSparqlCursor) cursor = NULL;
-		gchar *uri = NULL;
-		gchar *query;
-		GList *keyfiles;
-		gboolean found = FALSE;
-
-		/* support both, URIs and local file paths */
-		if (has_valid_uri_scheme (*p)) {
-			uri = g_strdup (*p);
-		} else if (resource_is_iri) {
-			uri = g_strdup (*p);
-		} else {
-			GFile *file;
+/* Replaces the URI of the targets with the resource having it as
+ * the value of --url-property, BATCH_SIZE targets at a time.
+ */
+static void
+resolve_targets_by_property (TrackerSparqlConnection *connection,
+                             GPtrArray               *targets)
+{
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
+	g_autoptr (GHashTable) batch = NULL;
+	g_autofree gchar *values = NULL, *query = NULL;
+	GError *error = NULL;
+	guint i, j;
+
+	values = create_values_clause ();
+	query = g_strdup_printf ("SELECT ?arg ?urn { %s ?urn %s ?arg }",
+	                         values, url_property);
+	stmt = tracker_sparql_connection_query_statement (connection, query,
+	                                                  NULL, &error);
+	if (!stmt) {
+		g_printerr ("  %s, %s\n",
+		            _("Unable to retrieve URN for URI"),
+		            error->message);
+		g_clear_error (&error);
 
-			file = g_file_new_for_commandline_arg (*p);
-			uri = g_file_get_uri (file);
-			g_object_unref (file);
+		for (i = 0; i < targets->len; i++) {
+			InfoTarget *target = g_ptr_array_index (targets, i);
+
+			target->failed = TRUE;
 		}
 
-		if (url_property) {
-			g_autoptr (TrackerSparqlStatement) stmt = NULL;
-			g_autoptr (TrackerSparqlCursor) cursor = NULL;
+		return;
+	}
 
-			/* First check whether there's some entity with nie:url like this */
-			query = g_strdup_printf ("SELECT ?urn { ?urn %s ~value }", url_property);
-			stmt = tracker_sparql_connection_query_statement (connection, query,
-			                                                  NULL, &error);
-			g_free (query);
+	batch = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+	                               (GDestroyNotify) g_ptr_array_unref);
 
-			if (stmt) {
-				tracker_sparql_statement_bind_string (stmt, "prop", url_property);
-				tracker_sparql_statement_bind_string (stmt, "value", uri);
-				cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
-			}
+	for (i = 0; i < targets->len; i += BATCH_SIZE) {
+		g_autoptr (TrackerSparqlCursor) cursor = NULL;
 
-			if (cursor && tracker_sparql_cursor_next (cursor, NULL, &error)) {
-				g_clear_pointer (&uri, g_free);
-				uri = g_strdup (tracker_sparql_cursor_get_string (cursor, 0, NULL));
-			}
+		bind_batch (stmt, targets, i, batch);
+		cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
+
+		while (cursor && tracker_sparql_cursor_next (cursor, NULL, &error)) {
+			const gchar *arg, *urn;
+			gpointer key, value;
+			GPtrArray *same_uri;
 
-			if (error) {
-				g_printerr ("  %s, %s\n",
-				            _("Unable to retrieve URN for URI"),
-				            error->message);
-				g_clear_error (&error);
+			arg = tracker_sparql_cursor_get_string (cursor, 0, NULL);
+			urn = tracker_sparql_cursor_get_string (cursor, 1, NULL);
+
+			/* The first match is used, targets are taken out of
+			 * the batch before their URI (its key) is replaced.
+			 */
+			if (!g_hash_table_steal_extended (batch, arg, &key, &value))
 				continue;
+
+			same_uri = value;
+
+			for (j = 0; j < same_uri->len; j++) {
+				InfoTarget *target = g_ptr_array_index (same_uri, j);
+
+				g_free (target->uri);
+				target->uri = g_strdup (urn);
 			}
+
+			g_ptr_array_unref (same_uri);
 		}
 
-		stmt = tracker_sparql_connection_query_statement (connection,
-		                                                  "SELECT DISTINCT ?urn {"
-		                                                  "  {"
-		                                                  "    BIND (~uri AS ?urn) . "
-		                                                  "    ?urn a rdfs:Resource . "
-		                                                  "  } UNION {"
-		                                                  "    ~uri nie:interpretedAs ?urn ."
-		                                                  "  }"
-		                                                  "}",
-		                                                  NULL, &error);
-		if (stmt) {
-			tracker_sparql_statement_bind_string (stmt, "uri", uri);
-			cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
+		if (error) {
+			g_printerr ("  %s, %s\n",
+			            _("Unable to retrieve URN for URI"),
+			            error->message);
+			g_clear_error (&error);
+
+			for (j = i; j < MIN (i + BATCH_SIZE, targets->len); j++) {
+				InfoTarget *target = g_ptr_array_index (targets, j);
+
+				target->failed = TRUE;
+			}
 		}
+	}
+}
 
-		if (cursor) {
-			while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
-				const gchar *str;
+static TrackerSparqlStatement *
+create_resolve_statement (TrackerSparqlConnection  *connection,
+                          GError                  **error)
+{
+	g_autofree gchar *values = NULL;
+	g_autofree gchar *query = NULL;
+
+	values = create_values_clause ();
+	query = g_strdup_printf ("SELECT DISTINCT ?arg ?urn {"
+	                         "  {"
+	                         "    %s"
+	                         "    BIND (?arg AS ?urn) . "
+	                         "    ?urn a rdfs:Resource . "
+	                         "  } UNION {"
+	                         "    %s"
+	                         "    ?arg nie:interpretedAs ?urn ."
+	                         "  }"
+	                         "}",
+	                         values, values);
+
+	return tracker_sparql_connection_query_statement (connection, query,
+	                                                  NULL, error);
+}
+
+/* Resolves the targets to the resources they refer to, BATCH_SIZE
+ * targets at a time.
+ */
+static void
+resolve_targets (TrackerSparqlConnection *connection,
+                 GPtrArray               *targets)
+{
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
+	g_autoptr (GHashTable) batch = NULL;
+	GError *error = NULL;
+	guint i, j;
+
+	stmt = create_resolve_statement (connection, &error);
+	if (!stmt) {
+		g_printerr ("  %s, %s\n",
+		            _("Unable to retrieve data for URI"),
+		            error->message);
+		g_clear_error (&error);
+		return;
+	}
 
-				str = tracker_sparql_cursor_get_string (cursor, 0, NULL);
-				urns = g_list_prepend (urns, g_strdup (str));
-				found = TRUE;
+	batch = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+	                               (GDestroyNotify) g_ptr_array_unref);
+
+	for (i = 0; i < targets->len; i += BATCH_SIZE) {
+		g_autoptr (TrackerSparqlCursor) cursor = NULL;
+
+		bind_batch (stmt, targets, i, batch);
+		cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
+
+		while (cursor && tracker_sparql_cursor_next (cursor, NULL, &error)) {
+			const gchar *arg, *urn;
+			GPtrArray *same_uri;
+
+			arg = tracker_sparql_cursor_get_string (cursor, 0, NULL);
+			urn = tracker_sparql_cursor_get_string (cursor, 1, NULL);
+			same_uri = g_hash_table_lookup (batch, arg);
+
+			for (j = 0; same_uri && j < same_uri->len; j++) {
+				InfoTarget *target = g_ptr_array_index (same_uri, j);
+
+				g_ptr_array_add (target->urns, g_strdup (urn));
 			}
 		}
 
@@ -506,37 +704,137 @@ info_run (void)
 			            error->message);
 			g_clear_error (&error);
 		}
+	}
+}
 
-		if (!found) {
-			if (turtle) {
-				g_print ("# No metadata available for <%s>\n", uri);
-			} else {
-				g_print ("  %s\n",
-				         _("No metadata available for that URI"));
-				output_eligible_status_for_file (*p, &error);
-
-				if (error) {
-					g_printerr ("%s: %s\n",
-					            _("Could not get eligible status: "),
-					            error->message);
-					g_clear_error (&error);
-				}
-
-				keyfiles = tracker_cli_get_error_keyfiles ();
-				if (keyfiles)
-					print_errors (keyfiles, uri);
-			}
+static void
+print_missing_target (InfoTarget *target)
+{
+	GError *error = NULL;
+	GList *keyfiles;
+
+	if (writer) {
+		g_printerr ("%s: %s\n",
+		            _("No metadata available for that URI"),
+		            target->uri);
+	} else if (turtle) {
+		g_print ("# No metadata available for <%s>\n", target->uri);
+	} else {
+		g_print ("  %s\n",
+		         _("No metadata available for that URI"));
+		output_eligible_status_for_file ((gchar *) target->arg, &error);
+
+		if (error) {
+			g_printerr ("%s: %s\n",
+			            _("Could not get eligible status: "),
+			            error->message);
+			g_clear_error (&error);
+		}
+
+		keyfiles = tracker_cli_get_error_keyfiles ();
+		if (keyfiles)
+			print_errors (keyfiles, target->uri);
+	}
+}
+
+static void
+describe_urns (TrackerSparqlConnection *connection,
+               GPtrArray               *urns)
+{
+	TrackerNamespaceManager *namespaces;
+	guint i;
+
+	namespaces = tracker_sparql_connection_get_namespace_manager (connection);
+
+	for (i = 0; i < urns->len; i += BATCH_SIZE) {
+		g_autoptr (TrackerSparqlStatement) stmt = NULL;
+		g_autoptr (TrackerSparqlCursor) cursor = NULL;
+		gchar **batch;
+		guint n_urns;
+
+		batch = (gchar **) &urns->pdata[i];
+		n_urns = MIN (BATCH_SIZE, urns->len - i);
+
+		stmt = describe_statement_for_urns (connection, batch, n_urns);
+		if (stmt)
+			cursor = tracker_sparql_statement_execute (stmt, NULL, NULL);
+		if (!cursor)
+			continue;
+
+		if (writer)
+			write_triples (cursor, namespaces);
+		else
+			print_plain (cursor, namespaces, batch, n_urns);
+	}
+}
+
+static int
+info_run (void)
+{
+	TrackerSparqlConnection *connection;
+	GError *error = NULL;
+	g_autoptr (GPtrArray) targets = NULL;
+	g_autoptr (GPtrArray) urns = NULL;
+	g_autoptr (GHashTable) seen = NULL;
+	gchar **p;
+	guint i, j;
+
+	if (!writer)
+		tracker_term_pipe_to_pager ();
+
+	connection = create_connection (&error);
+
+	if (!connection) {
+		g_printerr ("%s: %s\n",
+		            _("Could not establish a connection to Tracker"),
+		            error ? error->message : _("No error given"));
+		g_clear_error (&error);
+		return EXIT_FAILURE;
+	}
+
+	targets = g_ptr_array_new_with_free_func ((GDestroyNotify) info_target_free);
+
+	for (p = filenames; *p; p++)
+		g_ptr_array_add (targets, info_target_new (*p));
+
+	if (url_property)
+		resolve_targets_by_property (connection, targets);
+
+	resolve_targets (connection, targets);
+
+	/* Resources are described once, in command line order */
+	urns = g_ptr_array_new ();
+	seen = g_hash_table_new (g_str_hash, g_str_equal);
+
+	for (i = 0; i < targets->len; i++) {
+		InfoTarget *target = g_ptr_array_index (targets, i);
+
+		if (target->failed)
+			continue;
+
+		if (target->urns->len == 0) {
+			print_missing_target (target);
+			continue;
+		}
+
+		for (j = 0; j < target->urns->len; j++) {
+			gchar *urn = g_ptr_array_index (target->urns, j);
+
+			if (g_hash_table_add (seen, urn))
+				g_ptr_array_add (urns, urn);
 		}
 	}
 
-	if (!urns)
+	if (urns->len == 0)
 		goto out;
 
 	if (turtle) {
 		g_autoptr (TrackerSparqlStatement) stmt = NULL;
 		g_autoptr (GMainLoop) main_loop = NULL;
 
-		stmt = describe_statement_for_urns (connection, urns);
+		stmt = describe_statement_for_urns (connection,
+		                                    (gchar **) urns->pdata,
+		                                    urns->len);
 		main_loop = g_main_loop_new (NULL, FALSE);
 		tracker_sparql_statement_serialize_async (stmt,
 		                                          TRACKER_SERIALIZE_FLAGS_NONE,
@@ -546,20 +844,10 @@ info_run (void)
 		                                          main_loop);
 		g_main_loop_run (main_loop);
 	} else {
-		g_autoptr (TrackerSparqlStatement) stmt = NULL;
-		g_autoptr (TrackerSparqlCursor) cursor = NULL;
-		g_autoptr (GMainLoop) main_loop = NULL;
-		TrackerNamespaceManager *namespaces;
-
-		namespaces = tracker_sparql_connection_get_namespace_manager (connection);
-		stmt = describe_statement_for_urns (connection, urns);
-		cursor = tracker_sparql_statement_execute (stmt, NULL, NULL);
-
-		print_plain (cursor, namespaces);
+		describe_urns (connection, urns);
 	}
 
  out:
-	g_list_free_full (urns, g_free);
 	g_object_unref (connection);
 
 	tracker_term_pager_close ();
@@ -614,6 +902,7 @@ int
 tracker_info (int          argc,
               const char **argv)
 {
+	TrackerCliOutputFormat format;
 	GOptionContext *context;
 	GError *error = NULL;
 
@@ -641,11 +930,29 @@ tracker_info (int          argc,
 
 	g_option_context_free (context);
 
+	if (!tracker_cli_parse_output_format (output_format, &format)) {
+		g_printerr ("%s: %s\n", _("Unknown output format"), output_format);
+		return EXIT_FAILURE;
+	}
+
+	if (turtle && format != TRACKER_CLI_OUTPUT_FORMAT_TEXT) {
+		g_printerr ("%s\n", _("The --turtle and --output-format options can not be used together"));
+		return EXIT_FAILURE;
+	}
+
 	if (info_options_enabled ()) {
+		gint retval;
+
 		if (eligible)
 			return info_run_eligible ();
 
-		return info_run ();
+		if (format != TRACKER_CLI_OUTPUT_FORMAT_TEXT)
+			writer = tracker_cli_writer_new (format);
+
+		retval = info_run ();
+		g_clear_pointer (&writer, tracker_cli_writer_free);
+
+		return retval;
 	}
 
 	return info_run_default ();
@@ -33,6 +33,7 @@
 
 #include <libtracker-miners-common/tracker-common.h>
 
+#include "tracker-cli-utils.h"
 #include "tracker-color.h"
 
 static gint limit = -1;
@@ -55,6 +56,9 @@ static gboolean document_files;
 static gboolean feeds;
 static gboolean software;
 static gboolean software_categories;
+static gchar *output_format;
+
+static TrackerCliWriter *writer;
 
 static const char *help_summary =
 	N_("Search for content matching TERMS, by type or across all types.");
@@ -123,7 +127,7 @@ static GOptionEntry entries_resource_type[] = {
 static GOptionEntry entries[] = {
 	/* Semantic options */
 	{ "limit", 'l', 0, G_OPTION_ARG_INT, &limit,
-	  N_("Limit the number of results shown"),
+	  N_("Limit the number of results shown, 0 shows all results"),
 	  NULL
 	},
 	{ "offset", 'o', 0, G_OPTION_ARG_INT, &offset,
@@ -154,6 +158,10 @@ static GOptionEntry entries[] = {
 	  N_("Disable color when printing snippets and results"),
 	  NULL,
 	},
+	{ "output-format", 0, 0, G_OPTION_ARG_STRING, &output_format,
+	  N_("Output format, “text” (the default), “json” for JSON Lines or “nul” for NUL separated fields"),
+	  N_("FORMAT"),
+	},
 
 	/* Main arguments, the search terms */
 	{ G_OPTION_REMAINING, 0, 0,
@@ -168,9 +176,6 @@ static gchar *
 get_fts_string (GStrv    search_words,
                 gboolean use_or_operator)
 {
-	GString *fts;
-	gint i, len;
-
 	if (disable_fts) {
 		return NULL;
 	}
@@ -179,30 +184,61 @@ get_fts_string (GStrv    search_words,
 		return NULL;
 	}
 
-	fts = g_string_new ("");
-	len = g_strv_length (search_words);
+	/* The string is bound as a statement parameter, so it
+	 * needs no escaping for the SPARQL parser.
+	 */
+	return g_strjoinv (use_or_operator ? " OR " : " ", search_words);
+}
 
-	for (i = 0; i < len; i++) {
-		gchar *escaped;
+static TrackerSparqlCursor *
+search_query (TrackerSparqlConnection  *connection,
+              const gchar              *query_name,
+              const gchar              *fts,
+              gboolean                  show_all,
+              gint                      search_offset,
+              gint                      search_limit,
+              GError                  **error)
+{
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
+	g_autofree gchar *query_filename = NULL;
 
-		/* Properly escape the input string as it's going to be passed
-		 * in a sparql query */
-		escaped = tracker_sparql_escape_string (search_words[i]);
+	query_filename = g_strdup_printf ("search-%s%s.rq",
+	                                  query_name,
+	                                  fts ? "-fts" : "");
 
-		g_string_append (fts, escaped);
+	stmt = tracker_cli_load_statement (connection, query_filename, error);
+	if (!stmt)
+		return NULL;
 
-		if (i < len - 1) {
-			if (use_or_operator) {
-				g_string_append (fts, " OR ");
-			} else {
-				g_string_append (fts, " ");
-			}
-		}
+	if (fts) {
+		tracker_sparql_statement_bind_string (stmt, "match", fts);
+		tracker_sparql_statement_bind_string (stmt, "snippetBegin",
+		                                      disable_color ? "" : SNIPPET_BEGIN);
+		tracker_sparql_statement_bind_string (stmt, "snippetEnd",
+		                                      disable_color ? "" : SNIPPET_END);
+	}
+
+	tracker_sparql_statement_bind_boolean (stmt, "showAll", show_all);
+	tracker_sparql_statement_bind_int (stmt, "offset", search_offset);
+	tracker_sparql_statement_bind_int (stmt, "limit",
+	                                   search_limit > 0 ? search_limit : G_MAXINT);
 
-		g_free (escaped);
+	return tracker_sparql_statement_execute (stmt, NULL, error);
+}
+
+static void
+write_results (TrackerSparqlCursor *cursor)
+{
+	/* Rows are written as they come, so arbitrarily large
+	 * result sets can be streamed in constant memory.
+	 */
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+		tracker_cli_writer_begin_record (writer);
+		tracker_cli_writer_add_cursor_row (writer, cursor);
+		tracker_cli_writer_end_record (writer);
 	}
 
-	return g_string_free (fts, FALSE);
+	g_object_unref (cursor);
 }
 
 static inline void
@@ -238,14 +274,21 @@ print_snippet (const gchar *snippet)
 
 static gboolean
 get_files_results (TrackerSparqlConnection *connection,
-                   const gchar             *query,
+                   const gchar             *query_name,
+                   GStrv                    search_terms,
+                   gboolean                 show_all,
+                   gint                     search_offset,
                    gint                     search_limit,
+                   gboolean                 use_or_operator,
                    gboolean                 details)
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
+	g_autofree gchar *fts = NULL;
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
+	fts = get_fts_string (search_terms, use_or_operator);
+	cursor = search_query (connection, query_name, fts, show_all,
+	                       search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -256,6 +299,11 @@ get_files_results (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
+	if (writer) {
+		write_results (cursor);
+		return TRUE;
+	}
+
 	if (!cursor) {
 		g_print ("%s\n",
 		         _("No files were found"));
@@ -296,290 +344,6 @@ get_files_results (TrackerSparqlConnection *connection,
 	return TRUE;
 }
 
-static gboolean
-get_document_files (TrackerSparqlConnection *connection,
-                    GStrv                    search_terms,
-                    gboolean                 show_all,
-                    gint                     search_offset,
-                    gint                     search_limit,
-                    gboolean                 use_or_operator,
-                    gboolean                 details)
-{
-	gchar *fts;
-	gchar *query;
-	const gchar *show_all_str;
-	gboolean success;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
-
-	show_all_str = show_all ? "" : "?u nie:dataSource/tracker:available true .";
-	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?document ?u fts:snippet(?document, \"%s\", \"%s\") "
-		                         "WHERE { "
-					 "  GRAPH tracker:Documents {"
-		                         "    ?document a nfo:Document ;"
-		                         "      nie:isStoredAs ?u ;"
-		                         "      fts:match \"%s\" ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(?u) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?document ?u "
-		                         "WHERE { "
-					 "  GRAPH tracker:Documents {"
-		                         "    ?document a nfo:Document ;"
-		                         "      nie:isStoredAs ?u ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(?u) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	}
-
-	success = get_files_results (connection, query, search_limit, details);
-	g_free (query);
-	g_free (fts);
-	g_free (limit_str);
-
-	return success;
-}
-
-static gboolean
-get_video_files (TrackerSparqlConnection *connection,
-                 GStrv                    search_terms,
-                 gboolean                 show_all,
-                 gint                     search_offset,
-                 gint                     search_limit,
-                 gboolean                 use_or_operator,
-                 gboolean                 details)
-{
-	gchar *fts;
-	gchar *query;
-	const gchar *show_all_str;
-	gboolean success;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
-
-	show_all_str = show_all ? "" : "?u nie:dataSource/tracker:available true . ";
-	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?video ?u fts:snippet(?video, \"%s\", \"%s\") "
-		                         "WHERE { "
-					 "  GRAPH tracker:Video {"
-		                         "    ?video a nfo:Video ;"
-		                         "      nie:isStoredAs ?u ;"
-		                         "      fts:match \"%s\" ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(?u) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?video ?u "
-		                         "WHERE { "
-					 "  GRAPH tracker:Video {"
-		                         "    ?video a nfo:Video ;"
-		                         "      nie:isStoredAs ?u ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(?u) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	}
-
-	success = get_files_results (connection, query, search_limit, details);
-	g_free (query);
-	g_free (fts);
-	g_free (limit_str);
-
-	return success;
-}
-
-static gboolean
-get_image_files (TrackerSparqlConnection *connection,
-                 GStrv                    search_terms,
-                 gboolean                 show_all,
-                 gint                     search_offset,
-                 gint                     search_limit,
-                 gboolean                 use_or_operator,
-                 gboolean                 details)
-{
-	gchar *fts;
-	gchar *query;
-	const gchar *show_all_str;
-	gboolean success;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
-
-	show_all_str = show_all ? "" : "?u nie:dataSource/tracker:available true . ";
-	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?image ?u fts:snippet(?image, \"%s\", \"%s\") "
-		                         "WHERE { "
-					 "  GRAPH tracker:Pictures {"
-		                         "    ?image a nfo:Image ;"
-					 "      nie:isStoredAs ?u ;"
-		                         "      fts:match \"%s\" ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-		                         "  }"
-		                         "}"
-		                         "ORDER BY ASC(?u) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?image ?u "
-		                         "WHERE { "
-					 "  GRAPH tracker:Pictures {"
-		                         "    ?image a nfo:Image ;"
-		                         "      nie:isStoredAs ?u ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-		                         "  }"
-		                         "}"
-		                         "ORDER BY ASC(?u) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	}
-
-	success = get_files_results (connection, query, search_limit, details);
-	g_free (query);
-	g_free (fts);
-	g_free (limit_str);
-
-	return success;
-}
-
-static gboolean
-get_music_files (TrackerSparqlConnection *connection,
-                 GStrv                    search_terms,
-                 gboolean                 show_all,
-                 gint                     search_offset,
-                 gint                     search_limit,
-                 gboolean                 use_or_operator,
-                 gboolean                 details)
-{
-	gchar *fts;
-	gchar *query;
-	const gchar *show_all_str;
-	gboolean success;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
-
-	show_all_str = show_all ? "" : "?u nie:dataSource/tracker:available true . ";
-	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?song ?u fts:snippet(?song, \"%s\", \"%s\")"
-		                         "WHERE { "
-					 "  GRAPH tracker:Audio {"
-		                         "    ?song a nmm:MusicPiece ;"
-					 "      nie:isStoredAs ?u ;"
-		                         "      fts:match \"%s\" ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-					 "  }"
-		                         "} "
-		                         "ORDER BY ASC(?u) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?song ?u "
-		                         "WHERE { "
-					 "  GRAPH tracker:Audio {"
-		                         "    ?song a nmm:MusicPiece ;"
-					 "      nie:isStoredAs ?u ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-					 "  }"
-		                         "} "
-		                         "ORDER BY ASC(?u) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	}
-
-	success = get_files_results (connection, query, search_limit, details);
-	g_free (query);
-	g_free (fts);
-	g_free (limit_str);
-
-	return success;
-}
-
 static gboolean
 get_music_artists (TrackerSparqlConnection *connection,
                    GStrv                    search_terms,
@@ -590,52 +354,11 @@ get_music_artists (TrackerSparqlConnection *connection,
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
-	gchar *fts;
-	gchar *query;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
+	g_autofree gchar *fts = NULL;
 
 	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?artist ?title "
-		                         "WHERE {"
-		                         "  GRAPH tracker:Audio {"
-		                         "    ?artist a nmm:Artist ;"
-		                         "    nmm:artistName ?title ;"
-		                         "    fts:match \"%s\" . "
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(?title) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         fts,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?artist ?title "
-		                         "WHERE {"
-		                         "  GRAPH tracker:Audio {"
-		                         "    ?artist a nmm:Artist ;"
-		                         "    nmm:artistName ?title . "
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(?title) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         search_offset,
-		                         limit_str);
-	}
-
-	g_free (fts);
-	g_free (limit_str);
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	cursor = search_query (connection, "music-artists", fts, TRUE,
+	                       search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -646,6 +369,11 @@ get_music_artists (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
+	if (writer) {
+		write_results (cursor);
+		return TRUE;
+	}
+
 	if (!cursor) {
 		g_print ("%s\n",
 		         _("No artists were found"));
@@ -688,50 +416,11 @@ get_music_albums (TrackerSparqlConnection *connection,
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
-	gchar *fts;
-	gchar *query;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
+	g_autofree gchar *fts = NULL;
 
 	fts = get_fts_string (search_words, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?album nie:title(?album) "
-		                         "WHERE {"
-					 "  GRAPH tracker:Audio {"
-		                         "    ?album a nmm:MusicAlbum ;"
-		                         "    fts:match \"%s\" ."
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?album)) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         fts,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?album nie:title(?album) "
-		                         "WHERE {"
-					 "  GRAPH tracker:Audio {"
-		                         "    ?album a nmm:MusicAlbum ."
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?album)) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         search_offset,
-		                         limit_str);
-	}
-
-	g_free (fts);
-	g_free (limit_str);
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	cursor = search_query (connection, "music-albums", fts, TRUE,
+	                       search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -742,6 +431,11 @@ get_music_albums (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
+	if (writer) {
+		write_results (cursor);
+		return TRUE;
+	}
+
 	if (!cursor) {
 		g_print ("%s\n",
 		         _("No music was found"));
@@ -784,46 +478,11 @@ get_feeds (TrackerSparqlConnection *connection,
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
-	gchar *fts;
-	gchar *query;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
+	g_autofree gchar *fts = NULL;
 
 	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?feed nie:title(?feed) "
-		                         "WHERE {"
-		                         "  ?feed a mfo:FeedMessage ;"
-		                         "  fts:match \"%s\" . "
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?feed)) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         fts,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?feed nie:title(?feed) "
-		                         "WHERE {"
-		                         "  ?feed a mfo:FeedMessage ."
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?feed)) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         search_offset,
-		                         limit_str);
-	}
-
-	g_free (fts);
-	g_free (limit_str);
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	cursor = search_query (connection, "feeds", fts, TRUE,
+	                       search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -834,6 +493,11 @@ get_feeds (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
+	if (writer) {
+		write_results (cursor);
+		return TRUE;
+	}
+
 	if (!cursor) {
 		g_print ("%s\n",
 		         _("No feeds were found"));
@@ -869,50 +533,11 @@ get_software (TrackerSparqlConnection *connection,
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
-	gchar *fts;
-	gchar *query;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
+	g_autofree gchar *fts = NULL;
 
 	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?soft nie:title(?soft) fts:snippet(?soft, \"%s\", \"%s\") "
-		                         "WHERE {"
-					 "  GRAPH tracker:Software {"
-		                         "    ?soft a nfo:Software ;"
-		                         "    fts:match \"%s\" . "
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?soft)) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?soft nie:title(?soft) "
-		                         "WHERE {"
-		                         "  ?soft a nfo:Software ."
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?soft)) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         search_offset,
-		                         limit_str);
-	}
-
-	g_free (fts);
-	g_free (limit_str);
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	cursor = search_query (connection, "software", fts, TRUE,
+	                       search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -923,6 +548,11 @@ get_software (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
+	if (writer) {
+		write_results (cursor);
+		return TRUE;
+	}
+
 	if (!cursor) {
 		g_print ("%s\n",
 		         _("No software was found"));
@@ -958,50 +588,11 @@ get_software_categories (TrackerSparqlConnection *connection,
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
-	gchar *fts;
-	gchar *query;
-	gchar *limit_str;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
+	g_autofree gchar *fts = NULL;
 
 	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?cat nie:title(?cat) "
-		                         "WHERE {"
-					 "  GRAPH tracker:Software {"
-		                         "    ?cat a nfo:SoftwareCategory ;"
-		                         "    fts:match \"%s\" . "
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?cat)) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         fts,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?cat nie:title(?cat) "
-		                         "WHERE {"
-					 "  GRAPH tracker:Software {"
-		                         "    ?cat a nfo:SoftwareCategory ."
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(nie:title(?cat)) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         search_offset,
-		                         limit_str);
-	}
-
-	g_free (fts);
-	g_free (limit_str);
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	cursor = search_query (connection, "software-categories", fts, TRUE,
+	                       search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -1012,6 +603,11 @@ get_software_categories (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
+	if (writer) {
+		write_results (cursor);
+		return TRUE;
+	}
+
 	if (!cursor) {
 		g_print ("%s\n",
 		         _("No software categories were found"));
@@ -1038,140 +634,6 @@ get_software_categories (TrackerSparqlConnection *connection,
 	return TRUE;
 }
 
-static gboolean
-get_files (TrackerSparqlConnection *connection,
-           GStrv                    search_terms,
-           gboolean                 show_all,
-           gint                     search_offset,
-           gint                     search_limit,
-           gboolean                 use_or_operator,
-           gboolean                 details)
-{
-	gchar *fts;
-	gchar *query;
-	const gchar *show_all_str;
-	gchar *limit_str;
-	gboolean success;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
-
-	show_all_str = show_all ? "" : "?url nie:dataSource/tracker:available true . ";
-	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT DISTINCT ?u ?url "
-		                         "WHERE { "
-		                         "  GRAPH ?g {"
-		                         "    ?u a nie:InformationElement ;"
-		                         "      nie:isStoredAs ?url ;"
-		                         "      fts:match \"%s\" ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(?urn) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT DISTINCT ?u ?url "
-		                         "WHERE { "
-					 "  GRAPH ?g {"
-		                         "    ?u a nie:InformationElement ;"
-		                         "      nie:isStoredAs ?url ."
-		                         "  }"
-		                         "  GRAPH tracker:FileSystem {"
-		                         "    %s"
-		                         "  }"
-		                         "} "
-		                         "ORDER BY ASC(?urn) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	}
-
-	success = get_files_results (connection, query, search_limit, details);
-	g_free (query);
-	g_free (fts);
-	g_free (limit_str);
-
-	return success;
-}
-
-static gboolean
-get_folders (TrackerSparqlConnection *connection,
-             GStrv                    search_terms,
-             gboolean                 show_all,
-             gint                     search_offset,
-             gint                     search_limit,
-             gboolean                 use_or_operator,
-             gboolean                 details)
-{
-	gchar *fts;
-	gchar *query;
-	const gchar *show_all_str;
-	gchar *limit_str;
-	gboolean success;
-
-	if (search_limit != -1)
-		limit_str = g_strdup_printf ("LIMIT %d", search_limit);
-	else
-		limit_str = g_strdup_printf (" ");
-
-	show_all_str = show_all ? "" : "?url nie:dataSource/tracker:available true . ";
-	fts = get_fts_string (search_terms, use_or_operator);
-
-	if (fts) {
-		query = g_strdup_printf ("SELECT ?u ?url "
-		                         "WHERE { "
-					 "  GRAPH tracker:FileSystem {"
-		                         "    ?u a nfo:Folder ;"
-		                         "       nie:isStoredAs ?url ."
-		                         "    ?url fts:match \"%s\" ."
-		                         "    %s"
-					 "  }"
-		                         "} "
-		                         "ORDER BY ASC(?url) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         fts,
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	} else {
-		query = g_strdup_printf ("SELECT ?u ?url "
-		                         "WHERE { "
-					 "  GRAPH tracker:FileSystem {"
-		                         "    ?u a nfo:Folder ;"
-					 "       nie:isStoredAs ?url ."
-		                         "    %s"
-					 "  }"
-		                         "} "
-		                         "ORDER BY ASC(?url) "
-		                         "OFFSET %d "
-		                         "%s",
-		                         show_all_str,
-		                         search_offset,
-		                         limit_str);
-	}
-
-	success = get_files_results (connection, query, search_limit, details);
-	g_free (query);
-	g_free (fts);
-	g_free (limit_str);
-
-	return success;
-}
-
 static gboolean
 get_all_by_search (TrackerSparqlConnection *connection,
                    GStrv                    search_words,
@@ -1183,112 +645,17 @@ get_all_by_search (TrackerSparqlConnection *connection,
 {
 	GError *error = NULL;
 	TrackerSparqlCursor *cursor;
-	gchar *fts;
-	gchar *query;
+	g_autofree gchar *fts = NULL;
 
 	fts = get_fts_string (search_words, use_or_operator);
 	if (!fts) {
 		return FALSE;
 	}
 
-	if (search_limit < 0)
-		search_limit = G_MAXINT;
-
-	if (details) {
-		query = g_strdup_printf ("SELECT ?uri ?mimetype ?type ?snippet "
-		                         "WHERE {"
-					 "  {"
-					 "    SELECT (?s AS ?uri) ?mimetype ?type (fts:snippet(?s, \"%s\", \"%s\") AS ?snippet) {"
-					 "      GRAPH tracker:FileSystem {"
-					 "        ?s a nfo:FileDataObject ;"
-					 "           fts:match \"%s\" ;"
-					 "           rdf:type ?type ;"
-					 "           nie:dataSource ?ds ."
-					 "         ?ie nie:isStoredAs ?s;"
-					 "           nie:mimeType ?mimetype ."
-					 "        OPTIONAL { ?ds tracker:available ?available } ."
-					 "        FILTER (IF (%s, true, ?available)) ."
-					 "      }"
-					 "    }"
-					 "  } UNION {"
-					 "    SELECT ?uri ?mimetype ?type (fts:snippet(?s, \"%s\", \"%s\") AS ?snippet) {"
-					 "      GRAPH ?g {"
-					 "        ?s a nie:InformationElement ;"
-					 "           fts:match \"%s\" ;"
-					 "           rdf:type ?type ;"
-					 "           nie:mimeType ?mimetype ;"
-					 "           nie:isStoredAs ?uri ."
-		                         "      }"
-		                         "      GRAPH tracker:FileSystem {"
-					 "        ?uri nie:dataSource ?ds ."
-					 "        OPTIONAL { ?ds tracker:available ?available } ."
-					 "        FILTER (IF (%s, true, ?available)) ."
-					 "      }"
-					 "    }"
-					 "  }"
-		                         "} "
-		                         "GROUP BY ?uri "
-		                         "ORDER BY ?uri "
-		                         "OFFSET %d "
-					 "LIMIT %d",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         show_all ? "true" : "false",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         show_all ? "true" : "false",
-		                         search_offset,
-		                         search_limit);
-	} else {
-		query = g_strdup_printf ("SELECT ?uri SAMPLE(?snippet) "
-		                         "WHERE {"
-					 "  {"
-					 "    SELECT (?s AS ?uri) (fts:snippet(?s, \"%s\", \"%s\") AS ?snippet) {"
-					 "      GRAPH tracker:FileSystem {"
-					 "        ?s a nfo:FileDataObject ;"
-					 "           fts:match \"%s\" ;"
-					 "           nie:dataSource ?ds ."
-					 "        OPTIONAL { ?ds tracker:available ?available } ."
-					 "        FILTER (IF (%s, true, ?available))"
-					 "      }"
-					 "    }"
-					 "  } UNION {"
-					 "    SELECT ?uri (fts:snippet(?s, \"%s\", \"%s\") AS ?snippet) {"
-					 "      GRAPH ?g {"
-					 "        ?s a nie:InformationElement ;"
-					 "           fts:match \"%s\" ;"
-					 "           nie:isStoredAs ?uri ."
-		                         "      }"
-		                         "      GRAPH tracker:FileSystem {"
-					 "        ?uri nie:dataSource ?ds ."
-					 "        OPTIONAL { ?ds tracker:available ?available } ."
-					 "        FILTER (IF (%s, true, ?available))"
-					 "      }"
-					 "    }"
-					 "  }"
-		                         "} "
-		                         "GROUP BY ?uri "
-		                         "ORDER BY ?uri "
-		                         "OFFSET %d "
-					 "LIMIT %d",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         show_all ? "true" : "false",
-		                         disable_color ? "" : SNIPPET_BEGIN,
-		                         disable_color ? "" : SNIPPET_END,
-		                         fts,
-		                         show_all ? "true" : "false",
-		                         search_offset,
-		                         search_limit);
-	}
-
-	g_free (fts);
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	cursor = search_query (connection,
+	                       details ? "all-detailed" : "all",
+	                       fts, show_all,
+	                       search_offset, search_limit, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -1299,6 +666,11 @@ get_all_by_search (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
+	if (writer) {
+		write_results (cursor);
+		return TRUE;
+	}
+
 	if (!cursor) {
 		g_print ("%s\n",
 		         _("No results were found matching your query"));
@@ -1370,6 +742,11 @@ search_run (void)
 		disable_snippets = TRUE;
 	}
 
+	if (writer) {
+		/* No terminal escapes in machine readable output */
+		disable_color = TRUE;
+	}
+
 	connection = tracker_sparql_connection_bus_new ("org.freedesktop.Tracker3.Miner.Files",
 							NULL, NULL, &error);
 
@@ -1381,12 +758,13 @@ search_run (void)
 		return EXIT_FAILURE;
 	}
 
-	tracker_term_pipe_to_pager ();
+	if (!writer)
+		tracker_term_pipe_to_pager ();
 
 	if (files) {
 		gboolean success;
 
-		success = get_files (connection, terms, all, offset, limit, or_operator, detailed);
+		success = get_files_results (connection, "files", terms, all, offset, limit, or_operator, detailed);
 		g_object_unref (connection);
 		tracker_term_pager_close ();
 
@@ -1396,7 +774,7 @@ search_run (void)
 	if (folders) {
 		gboolean success;
 
-		success = get_folders (connection, terms, all, offset, limit, or_operator, detailed);
+		success = get_files_results (connection, "folders", terms, all, offset, limit, or_operator, detailed);
 		g_object_unref (connection);
 		tracker_term_pager_close ();
 
@@ -1426,7 +804,7 @@ search_run (void)
 	if (music_files) {
 		gboolean success;
 
-		success = get_music_files (connection, terms, all, offset, limit, or_operator, detailed);
+		success = get_files_results (connection, "music", terms, all, offset, limit, or_operator, detailed);
 		g_object_unref (connection);
 		tracker_term_pager_close ();
 
@@ -1446,7 +824,7 @@ search_run (void)
 	if (image_files) {
 		gboolean success;
 
-		success = get_image_files (connection, terms, all, offset, limit, or_operator, detailed);
+		success = get_files_results (connection, "images", terms, all, offset, limit, or_operator, detailed);
 		g_object_unref (connection);
 		tracker_term_pager_close ();
 
@@ -1456,7 +834,7 @@ search_run (void)
 	if (video_files) {
 		gboolean success;
 
-		success = get_video_files (connection, terms, all, offset, limit, or_operator, detailed);
+		success = get_files_results (connection, "videos", terms, all, offset, limit, or_operator, detailed);
 		g_object_unref (connection);
 		tracker_term_pager_close ();
 
@@ -1466,7 +844,7 @@ search_run (void)
 	if (document_files) {
 		gboolean success;
 
-		success = get_document_files (connection, terms, all, offset, limit, or_operator, detailed);
+		success = get_files_results (connection, "documents", terms, all, offset, limit, or_operator, detailed);
 		g_object_unref (connection);
 		tracker_term_pager_close ();
 
@@ -1553,6 +931,7 @@ int
 tracker_search (int          argc,
                 const char **argv)
 {
+	TrackerCliOutputFormat format;
 	GOptionContext *context;
 	GError *error = NULL;
 
@@ -1575,8 +954,21 @@ tracker_search (int          argc,
 
 	g_option_context_free (context);
 
+	if (!tracker_cli_parse_output_format (output_format, &format)) {
+		g_printerr ("%s: %s\n", _("Unknown output format"), output_format);
+		return EXIT_FAILURE;
+	}
+
+	if (format != TRACKER_CLI_OUTPUT_FORMAT_TEXT)
+		writer = tracker_cli_writer_new (format);
+
 	if (search_options_enabled ()) {
-		return search_run ();
+		gint retval;
+
+		retval = search_run ();
+		g_clear_pointer (&writer, tracker_cli_writer_free);
+
+		return retval;
 	}
 
 	return search_run_default ();
@@ -46,13 +46,25 @@
 	(show_stat)
 
 static gboolean show_stat;
+static gboolean full_count;
 static gchar **terms;
+static gchar *output_format;
+
+static TrackerCliWriter *writer;
 
 static GOptionEntry entries[] = {
 	{ "stat", 'a', 0, G_OPTION_ARG_NONE, &show_stat,
 	  N_("Show statistics for current index / data set"),
 	  NULL
 	},
+	{ "full", 0, 0, G_OPTION_ARG_NONE, &full_count,
+	  N_("Count resources in the database instead of using the statistics kept by the indexer"),
+	  NULL
+	},
+	{ "output-format", 0, 0, G_OPTION_ARG_STRING, &output_format,
+	  N_("Output format, “text” (the default), “json” for JSON Lines or “nul” for NUL separated fields"),
+	  N_("FORMAT")
+	},
 	{ G_OPTION_REMAINING, 0, 0,
 	  G_OPTION_ARG_STRING_ARRAY, &terms,
 	  N_("search terms"),
@@ -77,8 +89,185 @@ statistics_query (TrackerSparqlConnection  *connection,
                                                NULL, error);
 }
 
+static gboolean
+matches_terms (const gchar *rdf_type)
+{
+	gint i, n_terms;
+
+	n_terms = g_strv_length (terms);
+
+	for (i = 0; i < n_terms; i++) {
+		if (g_str_match_string (terms[i], rdf_type, TRUE))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+typedef struct {
+	const gchar *class_name;
+	gint64 count;
+} ClassCount;
+
+static gint
+class_count_compare (gconstpointer a,
+                     gconstpointer b)
+{
+	const ClassCount *count_a = a, *count_b = b;
+
+	if (count_a->count != count_b->count)
+		return count_a->count > count_b->count ? -1 : 1;
+
+	return g_strcmp0 (count_a->class_name, count_b->class_name);
+}
+
+static GVariant *
+get_indexer_statistics (void)
+{
+	g_autoptr (GDBusConnection) connection = NULL;
+	GVariant *reply = NULL, *statistics;
+	GError *error = NULL;
+
+	connection = g_bus_get_sync (TRACKER_IPC_BUS, NULL, &error);
+
+	if (connection) {
+		reply = g_dbus_connection_call_sync (connection,
+		                                     "org.freedesktop.Tracker3.Miner.Files",
+		                                     "/org/freedesktop/Tracker3/Files",
+		                                     "org.freedesktop.Tracker3.Files",
+		                                     "GetStatistics",
+		                                     NULL,
+		                                     G_VARIANT_TYPE ("(a{sv})"),
+		                                     G_DBUS_CALL_FLAGS_NONE,
+		                                     /* Resources are counted on indexer startup,
+		                                      * this waits for that on large databases.
+		                                      */
+		                                     G_MAXINT,
+		                                     NULL,
+		                                     &error);
+	}
+
+	if (!reply) {
+		g_printerr ("%s, %s\n",
+		            _("Could not get Tracker statistics"),
+		            error->message);
+		g_printerr ("%s\n",
+		            _("Use --full to count resources in the database instead"));
+		g_error_free (error);
+		return NULL;
+	}
+
+	g_variant_get (reply, "(@a{sv})", &statistics);
+	g_variant_unref (reply);
+
+	return statistics;
+}
+
+static void
+print_graph_statistics (const gchar *graph,
+                        GVariant    *classes,
+                        GString     *output)
+{
+	GVariantIter iter;
+	GArray *counts;
+	ClassCount count;
+	gboolean header = FALSE;
+	guint i;
+
+	counts = g_array_new (FALSE, FALSE, sizeof (ClassCount));
+
+	g_variant_iter_init (&iter, classes);
+	while (g_variant_iter_next (&iter, "{&sx}", &count.class_name, &count.count)) {
+		if (terms && !matches_terms (count.class_name))
+			continue;
+
+		g_array_append_val (counts, count);
+	}
+
+	g_array_sort (counts, class_count_compare);
+
+	for (i = 0; i < counts->len; i++) {
+		ClassCount *elem = &g_array_index (counts, ClassCount, i);
+
+		if (writer) {
+			tracker_cli_writer_begin_record (writer);
+			tracker_cli_writer_add_string (writer, "graph", graph);
+			tracker_cli_writer_add_string (writer, "class", elem->class_name);
+			tracker_cli_writer_add_integer (writer, "count", elem->count);
+			tracker_cli_writer_end_record (writer);
+			continue;
+		}
+
+		if (!header) {
+			g_string_append_printf (output, "  %s\n", graph);
+			header = TRUE;
+		}
+
+		g_string_append_printf (output,
+		                        "    %s = %" G_GINT64_FORMAT "\n",
+		                        elem->class_name,
+		                        elem->count);
+	}
+
+	g_array_unref (counts);
+}
+
+static int
+status_stat_precomputed (void)
+{
+	g_autoptr (GVariant) statistics = NULL, graphs = NULL;
+	GVariantIter iter;
+	GString *output;
+	const gchar *graph;
+	GVariant *classes;
+	gboolean up_to_date = TRUE;
+
+	statistics = get_indexer_statistics ();
+	if (!statistics)
+		return EXIT_FAILURE;
+
+	graphs = g_variant_lookup_value (statistics, "graphs", G_VARIANT_TYPE ("a{sa{sx}}"));
+	g_variant_lookup (statistics, "up-to-date", "b", &up_to_date);
+
+	if (!writer)
+		tracker_term_pipe_to_pager ();
+
+	output = g_string_new ("");
+
+	if (graphs) {
+		g_variant_iter_init (&iter, graphs);
+		while (g_variant_iter_next (&iter, "{&s@a{sx}}", &graph, &classes)) {
+			print_graph_statistics (graph, classes, output);
+			g_variant_unref (classes);
+		}
+	}
+
+	if (!writer) {
+		if (output->len > 0) {
+			g_string_prepend (output, "\n");
+			g_string_prepend (output, _("Statistics:"));
+		} else {
+			g_string_append_printf (output,
+			                        "  %s\n", _("None"));
+		}
+
+		if (!up_to_date) {
+			g_string_append_printf (output, "\n%s\n",
+			                        _("Statistics do not include the most recent changes yet, use --full for exact numbers"));
+		}
+
+		g_print ("%s\n", output->str);
+	}
+
+	g_string_free (output, TRUE);
+
+	tracker_term_pager_close ();
+
+	return EXIT_SUCCESS;
+}
+
 static int
-status_stat (void)
+status_stat_full (void)
 {
 	TrackerSparqlConnection *connection;
 	TrackerSparqlCursor *cursor;
@@ -95,7 +284,8 @@ status_stat (void)
 		return EXIT_FAILURE;
 	}
 
-	tracker_term_pipe_to_pager ();
+	if (!writer)
+		tracker_term_pipe_to_pager ();
 
 	cursor = statistics_query (connection, &error);
 
@@ -109,7 +299,24 @@ status_stat (void)
 		return EXIT_FAILURE;
 	}
 
-	if (!cursor) {
+	if (writer) {
+		while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+			const gchar *rdf_type;
+
+			rdf_type = tracker_sparql_cursor_get_string (cursor, 0, NULL);
+
+			if (terms && !matches_terms (rdf_type))
+				continue;
+
+			tracker_cli_writer_begin_record (writer);
+			tracker_cli_writer_add_string (writer, "class", rdf_type);
+			tracker_cli_writer_add_integer (writer, "count",
+			                                tracker_sparql_cursor_get_integer (cursor, 1));
+			tracker_cli_writer_end_record (writer);
+		}
+
+		g_object_unref (cursor);
+	} else if (!cursor) {
 		g_print ("%s\n", _("No statistics available"));
 	} else {
 		GString *output;
@@ -123,21 +330,8 @@ status_stat (void)
 			rdf_type = tracker_sparql_cursor_get_string (cursor, 0, NULL);
 			rdf_type_count = tracker_sparql_cursor_get_string (cursor, 1, NULL);
 
-			if (terms) {
-				gint i, n_terms;
-				gboolean show_rdf_type = FALSE;
-
-				n_terms = g_strv_length (terms);
-
-				for (i = 0;
-				     i < n_terms && !show_rdf_type;
-				     i++) {
-					show_rdf_type = g_str_match_string (terms[i], rdf_type, TRUE);
-				}
-
-				if (!show_rdf_type) {
-					continue;
-				}
+			if (terms && !matches_terms (rdf_type)) {
+				continue;
 			}
 
 			g_string_append_printf (output,
@@ -172,7 +366,10 @@ static int
 status_run (void)
 {
 	if (show_stat) {
-		return status_stat ();
+		if (full_count)
+			return status_stat_full ();
+		else
+			return status_stat_precomputed ();
 	}
 
 	/* All known options have their own exit points */
@@ -181,6 +378,28 @@ status_run (void)
 	return EXIT_FAILURE;
 }
 
+static int
+get_indexed_file_and_folder_count (int *files,
+                                   int *folders)
+{
+	g_autoptr (GVariant) statistics = NULL;
+	gint64 value;
+
+	statistics = get_indexer_statistics ();
+	if (!statistics)
+		return EXIT_FAILURE;
+
+	if (files) {
+		*files = g_variant_lookup (statistics, "files", "x", &value) ? value : 0;
+	}
+
+	if (folders) {
+		*folders = g_variant_lookup (statistics, "folders", "x", &value) ? value : 0;
+	}
+
+	return EXIT_SUCCESS;
+}
+
 static int
 get_file_and_folder_count (int *files,
                            int *folders)
@@ -369,6 +588,37 @@ print_errors (GList *keyfiles)
 	return EXIT_SUCCESS;
 }
 
+static int
+write_summary (gint files,
+               gint folders)
+{
+	g_autofree gchar *data_dir = NULL;
+	GList *keyfiles;
+	gint remaining_time;
+	gboolean finished;
+
+	data_dir = g_build_filename (g_get_user_cache_dir (), "tracker3", NULL);
+	finished = are_miners_finished (&remaining_time);
+	keyfiles = tracker_cli_get_error_keyfiles ();
+
+	tracker_cli_writer_begin_record (writer);
+	tracker_cli_writer_add_integer (writer, "files", files);
+	tracker_cli_writer_add_integer (writer, "folders", folders);
+	tracker_cli_writer_add_integer (writer, "remainingSpace",
+	                                tracker_file_system_get_remaining_space (data_dir));
+	tracker_cli_writer_add_double (writer, "remainingSpacePercentage",
+	                               tracker_file_system_get_remaining_space_percentage (data_dir));
+	tracker_cli_writer_add_boolean (writer, "indexingComplete", finished);
+	tracker_cli_writer_add_integer (writer, "remainingTime",
+	                                finished ? 0 : remaining_time);
+	tracker_cli_writer_add_integer (writer, "failures", g_list_length (keyfiles));
+	tracker_cli_writer_end_record (writer);
+
+	g_list_free_full (keyfiles, (GDestroyNotify) g_key_file_unref);
+
+	return EXIT_SUCCESS;
+}
+
 static int
 get_no_args (void)
 {
@@ -381,13 +631,20 @@ get_no_args (void)
 	GList *keyfiles;
 	gboolean use_pager;
 
-	use_pager = tracker_term_pipe_to_pager ();
+	use_pager = !writer && tracker_term_pipe_to_pager ();
 
 	/* How many files / folders do we have? */
-	if (get_file_and_folder_count (&files, &folders) != 0) {
-		return EXIT_FAILURE;
+	if (full_count) {
+		if (get_file_and_folder_count (&files, &folders) != 0)
+			return EXIT_FAILURE;
+	} else {
+		if (get_indexed_file_and_folder_count (&files, &folders) != 0)
+			return EXIT_FAILURE;
 	}
 
+	if (writer)
+		return write_summary (files, folders);
+
 	g_print (_("Currently indexed"));
 	g_print (": ");
 	g_print (g_dngettext (NULL,
@@ -488,6 +745,21 @@ show_errors (gchar    **terms,
 				gchar *message = g_key_file_get_string (keyfile, GROUP, KEY_MESSAGE, NULL);
 
 				found = TRUE;
+
+				if (writer) {
+					tracker_cli_writer_begin_record (writer);
+					tracker_cli_writer_add_string (writer, "uri", uri);
+					tracker_cli_writer_add_string (writer, "message", message);
+					tracker_cli_writer_add_string (writer, "sparql", sparql);
+					tracker_cli_writer_end_record (writer);
+
+					g_free (sparql);
+					g_free (message);
+					g_free (uri);
+					g_free (path);
+					continue;
+				}
+
 				g_print (!piped ?
 				         BOLD_BEGIN "URI:" BOLD_END " %s\n" :
 				         "URI: %s\n", uri);
@@ -517,7 +789,7 @@ show_errors (gchar    **terms,
 		}
 	}
 
-	if (!found) {
+	if (!found && !writer) {
 		g_print (!piped ?
 		         BOLD_BEGIN "%s" BOLD_END "\n" :
 		         "%s\n",
@@ -543,8 +815,10 @@ int
 tracker_status (int          argc,
                 const char **argv)
 {
+	TrackerCliOutputFormat format;
 	GOptionContext *context;
 	GError *error = NULL;
+	gint result;
 
 	setlocale (LC_ALL, "");
 
@@ -566,19 +840,26 @@ tracker_status (int          argc,
 
 	g_option_context_free (context);
 
-	if (status_options_enabled ()) {
-		return status_run ();
+	if (!tracker_cli_parse_output_format (output_format, &format)) {
+		g_printerr ("%s: %s\n", _("Unknown output format"), output_format);
+		return EXIT_FAILURE;
 	}
 
-	if (terms) {
-		gint result;
+	if (format != TRACKER_CLI_OUTPUT_FORMAT_TEXT)
+		writer = tracker_cli_writer_new (format);
 
-		tracker_term_pipe_to_pager ();
+	if (status_options_enabled ()) {
+		result = status_run ();
+	} else if (terms) {
+		if (!writer)
+			tracker_term_pipe_to_pager ();
 		result = show_errors (terms, FALSE);
 		tracker_term_pager_close ();
-
-		return result;
+	} else {
+		result = status_run_default ();
 	}
 
-	return status_run_default ();
+	g_clear_pointer (&writer, tracker_cli_writer_free);
+
+	return result;
 }
@@ -30,6 +30,8 @@
 
 #include <tinysparql.h>
 
+#include "tracker-cli-utils.h"
+
 #define TAG_OPTIONS_ENABLED() \
 	(resources || \
 	 add_tag || \
@@ -101,53 +103,11 @@ show_limit_warning (void)
 	            _("NOTE: Limit was reached, there are more items in the database not listed here"));
 }
 
-static gchar *
-get_escaped_sparql_string (const gchar *str)
-{
-	GString *sparql;
-
-	sparql = g_string_new ("");
-	g_string_append_c (sparql, '"');
-
-	while (*str != '\0') {
-		gsize len = strcspn (str, "\t\n\r\"\\");
-		g_string_append_len (sparql, str, len);
-		str += len;
-		switch (*str) {
-		case '\t':
-			g_string_append (sparql, "\\t");
-			break;
-		case '\n':
-			g_string_append (sparql, "\\n");
-			break;
-		case '\r':
-			g_string_append (sparql, "\\r");
-			break;
-		case '"':
-			g_string_append (sparql, "\\\"");
-			break;
-		case '\\':
-			g_string_append (sparql, "\\\\");
-			break;
-		default:
-			continue;
-		}
-		str++;
-	}
-
-	g_string_append_c (sparql, '"');
-
-	return g_string_free (sparql, FALSE);
-}
-
-static gchar *
-get_filter_string (GStrv        resources,
-                   const gchar *subject,
-                   gboolean     resources_are_urns,
-                   const gchar *tag)
+static GStrv
+get_uris (GStrv resources)
 {
-	GString *filter;
-	gint i, len;
+	GStrv uris;
+	gint len, i;
 
 	if (!resources) {
 		return NULL;
@@ -159,90 +119,118 @@ get_filter_string (GStrv        resources,
 		return NULL;
 	}
 
-	filter = g_string_new ("");
+	uris = g_new0 (gchar *, len + 1);
 
-	g_string_append_printf (filter, "FILTER (");
+	for (i = 0; resources[i]; i++) {
+		GFile *file;
 
-	if (tag) {
-		g_string_append (filter, "(");
+		file = g_file_new_for_commandline_arg (resources[i]);
+		uris[i] = g_file_get_uri (file);
+		g_object_unref (file);
 	}
 
-	for (i = 0; i < len; i++) {
-		g_string_append_printf (filter, "%s = %s%s%s",
-		                        subject,
-		                        resources_are_urns ? "<" : "\"",
-		                        resources[i],
-		                        resources_are_urns ? ">" : "\"");
+	return uris;
+}
 
-		if (i < len - 1) {
-			g_string_append (filter, " || ");
-		}
-	}
+static gchar *
+get_parameter_list (const gchar *name,
+                    guint        n_parameters)
+{
+	GString *str;
+	guint i;
 
-	if (tag) {
-		g_string_append_printf (filter, ") && ?t = <%s>", tag);
+	/* e.g. '~label0, ~label1, ~label2' */
+	str = g_string_new (NULL);
+
+	for (i = 0; i < n_parameters; i++) {
+		g_string_append_printf (str, "%s~%s%u",
+		                        i > 0 ? ", " : "",
+		                        name, i);
 	}
 
-	g_string_append (filter, ")");
+	return g_string_free (str, FALSE);
+}
+
+static void
+bind_parameter_list (TrackerSparqlStatement *stmt,
+                     const gchar            *name,
+                     GStrv                   values)
+{
+	gint i;
+
+	for (i = 0; values[i]; i++) {
+		g_autofree gchar *parameter = NULL;
 
-	return g_string_free (filter, FALSE);
+		parameter = g_strdup_printf ("%s%d", name, i);
+		tracker_sparql_statement_bind_string (stmt, parameter, values[i]);
+	}
 }
 
-static GStrv
-get_uris (GStrv resources)
+/* Returns a table of file URI to URN for the given files that are
+ * indexed, and tagged with @tag if given.
+ */
+static GHashTable *
+get_file_urn_table (TrackerSparqlConnection  *connection,
+                    GStrv                     uris,
+                    const gchar              *tag,
+                    GError                  **error)
 {
-	GStrv uris;
-	gint len, i;
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
+	g_autoptr (TrackerSparqlCursor) cursor = NULL;
+	g_autofree gchar *parameters = NULL;
+	g_autofree gchar *query = NULL;
+	GHashTable *urns;
+
+	parameters = get_parameter_list ("uri", g_strv_length (uris));
+	query = g_strdup_printf ("SELECT ?url ?urn {"
+	                         "  ?urn nie:url ?url %s ."
+	                         "  FILTER (?url IN (%s))"
+	                         "}",
+	                         tag ? "; nao:hasTag ~tag" : "",
+	                         parameters);
 
-	if (!resources) {
+	stmt = tracker_sparql_connection_query_statement (connection, query,
+	                                                  NULL, error);
+	if (!stmt)
 		return NULL;
-	}
 
-	len = g_strv_length (resources);
+	bind_parameter_list (stmt, "uri", uris);
+	if (tag)
+		tracker_sparql_statement_bind_string (stmt, "tag", tag);
 
-	if (len < 1) {
+	cursor = tracker_sparql_statement_execute (stmt, NULL, error);
+	if (!cursor)
 		return NULL;
-	}
 
-	uris = g_new0 (gchar *, len + 1);
+	urns = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
-	for (i = 0; resources[i]; i++) {
-		GFile *file;
+	while (tracker_sparql_cursor_next (cursor, NULL, error)) {
+		g_hash_table_insert (urns,
+		                     g_strdup (tracker_sparql_cursor_get_string (cursor, 0, NULL)),
+		                     g_strdup (tracker_sparql_cursor_get_string (cursor, 1, NULL)));
+	}
 
-		file = g_file_new_for_commandline_arg (resources[i]);
-		uris[i] = g_file_get_uri (file);
-		g_object_unref (file);
+	if (error && *error) {
+		g_hash_table_unref (urns);
+		return NULL;
 	}
 
-	return uris;
+	return urns;
 }
 
-static TrackerSparqlCursor *
+static GStrv
 get_file_urns (TrackerSparqlConnection *connection,
-	       GStrv                    uris,
-	       const gchar             *tag)
+               GStrv                    uris,
+               const gchar             *tag)
 {
-	TrackerSparqlCursor *cursor;
-	gchar *query, *filter;
+	g_autoptr (GHashTable) urns = NULL;
+	GPtrArray *results;
 	GError *error = NULL;
+	gint i;
 
-	filter = get_filter_string (uris, "?f", FALSE, tag);
-	query = g_strdup_printf ("SELECT ?urn ?f "
-	                         "WHERE { "
-	                         "  ?urn "
-	                         "    %s "
-	                         "    nie:url ?f . "
-	                         "  %s "
-	                         "}",
-	                         tag ? "nao:hasTag ?t ; " : "",
-	                         filter ? filter : "");
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-
-	g_free (query);
-	g_free (filter);
+	urns = get_file_urn_table (connection, uris, tag, &error);
 
-	if (error) {
+	if (!urns) {
 		g_print ("    %s, %s\n",
 		         _("Could not get file URNs"),
 		         error->message);
@@ -250,26 +238,14 @@ get_file_urns (TrackerSparqlConnection *connection,
 		return NULL;
 	}
 
-	return cursor;
-}
-
-static GStrv
-result_to_strv (TrackerSparqlCursor *cursor,
-                gint                 n_col)
-{
-	GPtrArray *results;
-
-	if (!cursor) {
-		return NULL;
-	}
-
 	results = g_ptr_array_new ();
 
-	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
-		const gchar *str;
+	for (i = 0; uris[i]; i++) {
+		const gchar *urn;
 
-		str = tracker_sparql_cursor_get_string (cursor, n_col, NULL);
-		g_ptr_array_add (results, g_strdup (str));
+		urn = g_hash_table_lookup (urns, uris[i]);
+		if (urn)
+			g_ptr_array_add (results, g_strdup (urn));
 	}
 
 	g_ptr_array_add (results, NULL);
@@ -277,24 +253,32 @@ result_to_strv (TrackerSparqlCursor *cursor,
 	return (GStrv) g_ptr_array_free (results, FALSE);
 }
 
+static gchar *
+get_tag_urn (TrackerSparqlStatement  *stmt,
+             const gchar             *label,
+             GError                 **error)
+{
+	g_autoptr (TrackerSparqlCursor) cursor = NULL;
+
+	tracker_sparql_statement_bind_string (stmt, "label", label);
+	cursor = tracker_sparql_statement_execute (stmt, NULL, error);
+
+	if (!cursor || !tracker_sparql_cursor_next (cursor, NULL, error))
+		return NULL;
+
+	return g_strdup (tracker_sparql_cursor_get_string (cursor, 0, NULL));
+}
+
 static void
-get_all_tags_show_tag_id (TrackerSparqlConnection *connection,
-                          const gchar             *id)
+get_all_tags_show_tag_id (TrackerSparqlStatement *stmt,
+                          const gchar            *id)
 {
 	TrackerSparqlCursor *cursor;
 	GError *error = NULL;
-	gchar *query;
 
 	/* Get resources associated */
-	query = g_strdup_printf ("SELECT ?uri WHERE {"
-	                         "  ?urn nao:hasTag \"%s\" . "
-	                         "  BIND (nie:isStoredAs(?urn) AS ?sa). "
-	                         "  BIND (COALESCE (?sa, ?urn) AS ?uri). "
-	                         "}",
-	                         id);
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	tracker_sparql_statement_bind_string (stmt, "tag", id);
+	cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
 
 	if (error) {
 		g_printerr ("    %s, %s\n",
@@ -319,18 +303,61 @@ get_all_tags_show_tag_id (TrackerSparqlConnection *connection,
 	g_object_unref (cursor);
 }
 
-static inline gchar *
-get_filter_in_for_strv (GStrv        resources,
-                        const gchar *subject)
+static TrackerSparqlStatement *
+create_tags_by_label_statement (TrackerSparqlConnection  *connection,
+                                guint                     n_labels,
+                                GError                  **error)
 {
-	gchar *filter, *filter_in;
+	g_autofree gchar *parameters = NULL;
+	g_autofree gchar *query = NULL;
 
-	/* e.g. '?label IN ("foo", "bar")' */
-	filter_in = g_strjoinv ("\",\"", resources);
-	filter = g_strdup_printf ("FILTER (%s IN (\"%s\"))", subject, filter_in);
-	g_free (filter_in);
+	/* You might be asking, why not logical AND here, why
+	 * logical OR for FILTER, well, tags can't have
+	 * multiple labels is the simple answer.
+	 */
+	parameters = get_parameter_list ("label", n_labels);
+	query = g_strdup_printf ("SELECT ?tag ?label (nao:description(?tag) AS ?description) (COUNT(?urns) AS ?count) {"
+	                         "  ?tag a nao:Tag ;"
+	                         "    nao:prefLabel ?label ."
+	                         "  FILTER (?label IN (%s)) ."
+	                         "  OPTIONAL {"
+	                         "    ?urns nao:hasTag ?tag"
+	                         "  } ."
+	                         "} "
+	                         "GROUP BY ?tag "
+	                         "ORDER BY ASC(?label) "
+	                         "OFFSET ~offset "
+	                         "LIMIT ~limit",
+	                         parameters);
 
-	return filter;
+	return tracker_sparql_connection_query_statement (connection, query,
+	                                                  NULL, error);
+}
+
+static TrackerSparqlStatement *
+create_files_with_tags_statement (TrackerSparqlConnection  *connection,
+                                  guint                     n_tags,
+                                  GError                  **error)
+{
+	g_autoptr (GString) pattern = NULL;
+	g_autofree gchar *query = NULL;
+	guint i;
+
+	pattern = g_string_new ("?r a rdfs:Resource");
+
+	for (i = 0; i < n_tags; i++)
+		g_string_append_printf (pattern, " ; nao:hasTag ~tag%u", i);
+
+	query = g_strdup_printf ("SELECT DISTINCT (nie:url(?r) AS ?url) {"
+	                         "  %s ."
+	                         "} "
+	                         "ORDER BY ASC(?url) "
+	                         "OFFSET ~offset "
+	                         "LIMIT ~limit",
+	                         pattern->str);
+
+	return tracker_sparql_connection_query_statement (connection, query,
+	                                                  NULL, error);
 }
 
 static gboolean
@@ -339,29 +366,32 @@ get_all_resources_with_tags (TrackerSparqlConnection *connection,
                              gint                     search_offset,
                              gint                     search_limit)
 {
-	TrackerSparqlCursor *cursor;
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
+	g_autoptr (TrackerSparqlCursor) cursor = NULL;
+	g_autoptr (GPtrArray) tag_urns = NULL;
 	GError *error = NULL;
-	GStrv tag_urns, p;
-	GString *s;
-	gchar *filter, *query;
+	gint count = 0;
 
 	if (!tags) {
 		return FALSE;
 	}
 
 	/* First, get matching tags */
-	filter = get_filter_in_for_strv (tags, "?label");
-	query = g_strdup_printf ("SELECT ?t "
-	                         "WHERE { "
-	                         "  ?t a nao:Tag ;"
-	                         "     nao:prefLabel ?label ."
-	                         "  %s"
-	                         "}",
-	                         filter);
-	g_free (filter);
+	stmt = create_tags_by_label_statement (connection, g_strv_length (tags), &error);
+
+	if (stmt) {
+		bind_parameter_list (stmt, "label", tags);
+		tracker_sparql_statement_bind_int (stmt, "offset", 0);
+		tracker_sparql_statement_bind_int (stmt, "limit", G_MAXINT);
+		cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
+	}
+
+	tag_urns = g_ptr_array_new_with_free_func (g_free);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	while (cursor && tracker_sparql_cursor_next (cursor, NULL, &error)) {
+		g_ptr_array_add (tag_urns,
+		                 g_strdup (tracker_sparql_cursor_get_string (cursor, 0, NULL)));
+	}
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -372,41 +402,26 @@ get_all_resources_with_tags (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
-	tag_urns = result_to_strv (cursor, 0);
-	if (!tag_urns || !*tag_urns) {
+	if (tag_urns->len == 0) {
 		g_print ("%s\n",
 		         _("No files have been tagged"));
 
-		if (cursor) {
-			g_object_unref (cursor);
-		}
-
 		return TRUE;
 	}
 
-	s = g_string_new ("");
-
-	for (p = tag_urns; p && *p; p++) {
-		g_string_append_printf (s, "; nao:hasTag <%s>", *p);
-	}
+	g_ptr_array_add (tag_urns, NULL);
+	g_clear_object (&cursor);
+	g_clear_object (&stmt);
 
-	s = g_string_append (s, " .");
-	filter = g_string_free (s, FALSE);
-	g_strfreev (tag_urns);
+	/* Then the files having all of them */
+	stmt = create_files_with_tags_statement (connection, tag_urns->len - 1, &error);
 
-	query = g_strdup_printf ("SELECT DISTINCT nie:url(?r) "
-	                         "WHERE {"
-	                         "  ?r a rdfs:Resource %s"
-	                         "} "
-	                         "OFFSET %d "
-	                         "LIMIT %d",
-	                         filter,
-	                         search_offset,
-	                         search_limit);
-	g_free (filter);
-
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	if (stmt) {
+		bind_parameter_list (stmt, "tag", (GStrv) tag_urns->pdata);
+		tracker_sparql_statement_bind_int (stmt, "offset", search_offset);
+		tracker_sparql_statement_bind_int (stmt, "limit", search_limit);
+		cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
+	}
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -417,43 +432,72 @@ get_all_resources_with_tags (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
-	if (!cursor) {
-		g_print ("%s\n",
-		         _("No files were found matching ALL of those tags"));
-	} else {
-		gint count = 0;
-
-		g_print ("%s:\n", _("Files"));
+	g_print ("%s:\n", _("Files"));
 
-		while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
-			g_print ("  %s\n",
-			         tracker_sparql_cursor_get_string (cursor, 0, NULL));
-			count++;
-		}
-
-		if (count == 0) {
-			/* To translators: This is to say there are no
-			 * files found associated with multiple tags, e.g.:
-			 *
-			 *   Files:
-			 *     None
-			 *
-			 */
-			g_print ("  %s\n", _("None"));
-		}
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+		g_print ("  %s\n",
+		         tracker_sparql_cursor_get_string (cursor, 0, NULL));
+		count++;
+	}
 
-		g_print ("\n");
+	if (count == 0) {
+		/* To translators: This is to say there are no
+		 * files found associated with multiple tags, e.g.:
+		 *
+		 *   Files:
+		 *     None
+		 *
+		 */
+		g_print ("  %s\n", _("None"));
+	}
 
-		if (count >= search_limit) {
-			show_limit_warning ();
-		}
+	g_print ("\n");
 
-		g_object_unref (cursor);
+	if (count >= search_limit) {
+		show_limit_warning ();
 	}
 
 	return TRUE;
 }
 
+static void
+print_tag (TrackerSparqlCursor    *cursor,
+           TrackerSparqlStatement *resources_stmt)
+{
+	const gchar *id;
+	const gchar *tag;
+	const gchar *description;
+	gint n_resources = 0;
+
+	id = tracker_sparql_cursor_get_string (cursor, 0, NULL);
+	n_resources = tracker_sparql_cursor_get_integer (cursor, 3);
+
+	tag = tracker_sparql_cursor_get_string (cursor, 1, NULL);
+	description = tracker_sparql_cursor_get_string (cursor, 2, NULL);
+
+	if (description && *description == '\0') {
+		description = NULL;
+	}
+
+	g_print ("  %s %s%s%s\n",
+	         tag,
+	         description ? "(" : "",
+	         description ? description : "",
+	         description ? ")" : "");
+
+	if (resources_stmt && n_resources > 0) {
+		get_all_tags_show_tag_id (resources_stmt, id);
+	} else {
+		g_print ("    %s\n", id);
+		g_print ("    ");
+		g_print (g_dngettext (NULL,
+		                      "%d file",
+		                      "%d files",
+		                      n_resources),
+		         n_resources);
+		g_print ("\n");
+	}
+}
 
 static gboolean
 get_all_tags (TrackerSparqlConnection *connection,
@@ -462,39 +506,30 @@ get_all_tags (TrackerSparqlConnection *connection,
               gint                     search_limit,
               gboolean                 show_resources)
 {
-	TrackerSparqlCursor *cursor;
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
+	g_autoptr (TrackerSparqlStatement) resources_stmt = NULL;
+	g_autoptr (TrackerSparqlCursor) cursor = NULL;
 	GError *error = NULL;
-	gchar *query;
-	gchar *filter = NULL;
+	gint count = 0;
 
 	if (resources && g_strv_length (resources) > 0) {
-		filter = get_filter_in_for_strv (resources, "?label");
+		stmt = create_tags_by_label_statement (connection,
+		                                       g_strv_length (resources),
+		                                       &error);
+		if (stmt)
+			bind_parameter_list (stmt, "label", resources);
+	} else {
+		stmt = tracker_cli_load_statement (connection, "get-tags.rq", &error);
 	}
 
-	/* You might be asking, why not logical AND here, why
-	 * logical OR for FILTER, well, tags can't have
-	 * multiple labels is the simple answer.
-	 */
-	query = g_strdup_printf ("SELECT ?tag ?label nao:description(?tag) COUNT(?urns) "
-	                         "WHERE {"
-	                         "  ?tag a nao:Tag ;"
-	                         "  nao:prefLabel ?label ."
-	                         "  OPTIONAL {"
-	                         "     ?urns nao:hasTag ?tag"
-	                         "  } ."
-	                         "  %s"
-	                         "} "
-	                         "GROUP BY ?tag "
-	                         "ORDER BY ASC(?label) "
-	                         "OFFSET %d "
-	                         "LIMIT %d",
-	                         filter ? filter : "",
-	                         search_offset,
-	                         search_limit);
-	g_free (filter);
+	if (stmt && show_resources)
+		resources_stmt = tracker_cli_load_statement (connection, "get-tag-resources.rq", &error);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	if (stmt && !error) {
+		tracker_sparql_statement_bind_int (stmt, "offset", search_offset);
+		tracker_sparql_statement_bind_int (stmt, "limit", search_limit);
+		cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
+	}
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -505,72 +540,28 @@ get_all_tags (TrackerSparqlConnection *connection,
 		return FALSE;
 	}
 
-	if (!cursor) {
-		g_print ("%s\n",
-		         _("No tags were found"));
-	} else {
-		gint count = 0;
-
-		g_print ("%s:\n", _("Tags (shown by name)"));
-
-		while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
-			const gchar *id;
-			const gchar *tag;
-			const gchar *description;
-			const gchar *resources;
-			gint n_resources = 0;
-
-			id = tracker_sparql_cursor_get_string (cursor, 0, NULL);
-			resources = tracker_sparql_cursor_get_string (cursor, 3, NULL);
-			n_resources = atoi (resources);
+	g_print ("%s:\n", _("Tags (shown by name)"));
 
-			tag = tracker_sparql_cursor_get_string (cursor, 1, NULL);
-			description = tracker_sparql_cursor_get_string (cursor, 2, NULL);
-
-			if (description && *description == '\0') {
-				description = NULL;
-			}
-
-			g_print ("  %s %s%s%s\n",
-			         tag,
-			         description ? "(" : "",
-			         description ? description : "",
-			         description ? ")" : "");
-
-			if (show_resources && n_resources > 0) {
-				get_all_tags_show_tag_id (connection, id);
-			} else {
-				g_print ("    %s\n", id);
-				g_print ("    ");
-				g_print (g_dngettext (NULL,
-				                      "%d file",
-				                      "%d files",
-				                      n_resources),
-				         n_resources);
-				g_print ("\n");
-			}
-
-			count++;
-		}
-
-		if (count == 0) {
-			/* To translators: This is to say there are no
-			 * resources found associated with this tag, e.g.:
-			 *
-			 *   Tags (shown by name):
-			 *     None
-			 *
-			 */
-			g_print ("  %s\n", _("None"));
-		}
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL)) {
+		print_tag (cursor, resources_stmt);
+		count++;
+	}
 
-		g_print ("\n");
+	if (count == 0) {
+		/* To translators: This is to say there are no
+		 * resources found associated with this tag, e.g.:
+		 *
+		 *   Tags (shown by name):
+		 *     None
+		 *
+		 */
+		g_print ("  %s\n", _("None"));
+	}
 
-		if (count >= search_limit) {
-			show_limit_warning ();
-		}
+	g_print ("\n");
 
-		g_object_unref (cursor);
+	if (count >= search_limit) {
+		show_limit_warning ();
 	}
 
 	return TRUE;
@@ -583,6 +574,7 @@ print_file_report (TrackerSparqlConnection *connection,
                    const gchar             *found_msg,
                    const gchar             *not_found_msg)
 {
+	g_autoptr (GHashTable) urns = NULL;
 	gint i;
 
 	if (!uris) {
@@ -590,20 +582,17 @@ print_file_report (TrackerSparqlConnection *connection,
 		return;
 	}
 
+	urns = get_file_urn_table (connection, uris, urn, NULL);
+
 	for (i = 0; uris[i]; i++) {
-		g_autoptr (TrackerSparqlCursor) cursor = NULL;
-		gboolean found = FALSE;
-		gchar *arr[2] = { uris[i], NULL };
+		gboolean found;
+
+		found = urns && g_hash_table_contains (urns, uris[i]);
 
-		cursor = get_file_urns (connection, arr, urn);
-		found = cursor && tracker_sparql_cursor_next (cursor, NULL, NULL);
 		g_print ("  %s: %s\n",
 		         found ? found_msg : not_found_msg,
 		         uris[i]);
 	}
-
-
-
 }
 
 static gboolean
@@ -612,13 +601,9 @@ add_tag_for_urns (TrackerSparqlConnection *connection,
                   const gchar             *tag,
                   const gchar             *description)
 {
-	g_autoptr (TrackerSparqlCursor) cursor = NULL;
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
 	GError *error = NULL;
 	GStrv  uris = NULL, urns_strv = NULL;
-	gchar *tag_escaped;
-	gchar *query;
-
-	tag_escaped = get_escaped_sparql_string (tag);
 
 	if (resources) {
 		uris = get_uris (resources);
@@ -627,63 +612,36 @@ add_tag_for_urns (TrackerSparqlConnection *connection,
 			return FALSE;
 		}
 
-		cursor = get_file_urns (connection, uris, NULL);
-
-		if (!cursor) {
-			g_printerr ("%s\n", _("Files do not exist or aren’t indexed"));
-			g_strfreev (uris);
-			return FALSE;
-		}
-
-		urns_strv = result_to_strv (cursor, 0);
+		urns_strv = get_file_urns (connection, uris, NULL);
 
 		if (!urns_strv || g_strv_length (urns_strv) < 1) {
 			g_printerr ("%s\n", _("Files do not exist or aren’t indexed"));
+			g_strfreev (urns_strv);
 			g_strfreev (uris);
 			return FALSE;
 		}
 	}
 
-	if (description) {
-		gchar *description_escaped;
-
-		description_escaped = get_escaped_sparql_string (description);
+	stmt = tracker_cli_load_statement (connection,
+	                                   description ?
+	                                   "add-tag-with-description.rq" :
+	                                   "add-tag.rq",
+	                                   &error);
 
-		query = g_strdup_printf ("INSERT { "
-		                         "  _:tag a nao:Tag;"
-		                         "  nao:prefLabel %s ;"
-		                         "  nao:description %s ."
-		                         "} "
-		                         "WHERE {"
-		                         "  FILTER (!EXISTS { ?u nao:prefLabel %s }) "
-		                         "}",
-		                         tag_escaped,
-		                         description_escaped,
-		                         tag_escaped);
+	if (stmt) {
+		tracker_sparql_statement_bind_string (stmt, "label", tag);
+		if (description)
+			tracker_sparql_statement_bind_string (stmt, "description", description);
 
-		g_free (description_escaped);
-	} else {
-		query = g_strdup_printf ("INSERT { "
-		                         "  _:tag a nao:Tag;"
-		                         "  nao:prefLabel %s ."
-		                         "} "
-		                         "WHERE {"
-		                         "  FILTER (!EXISTS { ?u nao:prefLabel %s }) "
-		                         "}",
-		                         tag_escaped,
-		                         tag_escaped);
+		tracker_sparql_statement_update (stmt, NULL, &error);
 	}
 
-	tracker_sparql_connection_update (connection, query, NULL, &error);
-	g_free (query);
-
 	if (error) {
 		g_printerr ("%s, %s\n",
 		            _("Could not add tag"),
 		            error->message);
 
 		g_error_free (error);
-		g_free (tag_escaped);
 		g_strfreev (urns_strv);
 		g_strfreev (uris);
 
@@ -697,35 +655,33 @@ add_tag_for_urns (TrackerSparqlConnection *connection,
 	 * is, then we add the urns specified to the new tag.
 	 */
 	if (urns_strv) {
-		gchar *filter;
-
-		filter = get_filter_string (urns_strv, "?urn", TRUE, NULL);
+		g_autoptr (TrackerSparqlStatement) tag_stmt = NULL;
+		g_autoptr (TrackerBatch) batch = NULL;
+		gint i;
 
 		/* Add tag to specific urns */
-		query = g_strdup_printf ("INSERT { "
-		                         "  ?urn a rdfs:Resource ;"
-		                         "    nao:hasTag ?id "
-		                         "} "
-		                         "WHERE {"
-		                         "  ?urn nie:url ?f ."
-		                         "  ?id nao:prefLabel %s "
-		                         "  %s "
-		                         "}",
-		                         tag_escaped,
-		                         filter ? filter : "");
-
-		tracker_sparql_connection_update (connection, query, NULL, &error);
+		tag_stmt = tracker_cli_load_statement (connection, "tag-file.rq", &error);
+
+		if (tag_stmt) {
+			batch = tracker_sparql_connection_create_batch (connection);
+
+			for (i = 0; urns_strv[i]; i++) {
+				tracker_batch_add_statement (batch, tag_stmt,
+				                             "urn", G_TYPE_STRING, urns_strv[i],
+				                             "label", G_TYPE_STRING, tag,
+				                             NULL);
+			}
+
+			tracker_batch_execute (batch, NULL, &error);
+		}
+
 		g_strfreev (urns_strv);
-		g_free (filter);
-		g_free (query);
 
 		if (error) {
 			g_printerr ("%s, %s\n",
 			            _("Could not add tag to files"),
 			            error->message);
-			g_object_unref (cursor);
 			g_error_free (error);
-			g_free (tag_escaped);
 			g_strfreev (uris);
 
 			return FALSE;
@@ -737,7 +693,6 @@ add_tag_for_urns (TrackerSparqlConnection *connection,
 	}
 
 	g_strfreev (uris);
-	g_free (tag_escaped);
 
 	return TRUE;
 }
@@ -747,107 +702,80 @@ remove_tag_for_urns (TrackerSparqlConnection *connection,
                      GStrv                    resources,
                      const gchar             *tag)
 {
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
+	g_autoptr (TrackerBatch) batch = NULL;
 	GError *error = NULL;
-	gchar *tag_escaped;
-	gchar *query;
 	g_autofree gchar *urn = NULL;
 	GStrv uris;
 
-	tag_escaped = get_escaped_sparql_string (tag);
 	uris = get_uris (resources);
 
 	if (uris && *uris) {
-		TrackerSparqlCursor *urns_cursor;
-		TrackerSparqlCursor *tag_cursor;
-		gchar *filter;
+		g_autoptr (TrackerSparqlStatement) tag_stmt = NULL;
 		GStrv urns_strv;
+		gint i;
 
-		/* Get all tags urns */
-		query = g_strdup_printf ("SELECT ?tag "
-		                         "WHERE {"
-		                         "  ?tag a nao:Tag ."
-		                         "  ?tag nao:prefLabel %s "
-		                         "}",
-		                         tag_escaped);
-
-		tag_cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-		g_free (query);
+		/* Get tag urn */
+		tag_stmt = tracker_cli_load_statement (connection, "get-tag-by-label.rq", &error);
+		if (tag_stmt)
+			urn = get_tag_urn (tag_stmt, tag, &error);
 
 		if (error) {
 			g_printerr ("%s, %s\n",
 			            _("Could not get tag by label"),
 			            error->message);
 			g_error_free (error);
-			g_free (tag_escaped);
 			g_strfreev (uris);
 
 			return FALSE;
 		}
 
-		if (!tag_cursor || !tracker_sparql_cursor_next (tag_cursor, NULL, NULL)) {
+		if (!urn) {
 			g_print ("%s\n",
 			         _("No tags were found by that name"));
 
-			g_free (tag_escaped);
 			g_strfreev (uris);
 
-			if (tag_cursor) {
-				g_object_unref (tag_cursor);
-			}
-
 			return TRUE;
 		}
 
-		urn = g_strdup (tracker_sparql_cursor_get_string (tag_cursor, 0, NULL));
-		urns_cursor = get_file_urns (connection, uris, urn);
-		urns_strv = result_to_strv (urns_cursor, 0);
+		urns_strv = get_file_urns (connection, uris, urn);
 
 		if (!urns_strv || !*urns_strv) {
 			g_print ("%s\n",
 			         _("None of the files had this tag set"));
 
+			g_strfreev (urns_strv);
 			g_strfreev (uris);
-			g_free (tag_escaped);
-			g_object_unref (tag_cursor);
 
-			if (urns_cursor) {
-				g_object_unref (urns_cursor);
+			return TRUE;
+		}
+
+		stmt = tracker_cli_load_statement (connection, "untag-file.rq", &error);
+
+		if (stmt) {
+			batch = tracker_sparql_connection_create_batch (connection);
+
+			for (i = 0; urns_strv[i]; i++) {
+				tracker_batch_add_statement (batch, stmt,
+				                             "urn", G_TYPE_STRING, urns_strv[i],
+				                             "tag", G_TYPE_STRING, urn,
+				                             NULL);
 			}
 
-			return TRUE;
+			tracker_batch_execute (batch, NULL, &error);
 		}
 
-		filter = get_filter_string (urns_strv, "?urn", TRUE, urn);
 		g_strfreev (urns_strv);
-
-		query = g_strdup_printf ("DELETE { "
-		                         "  ?urn nao:hasTag ?t "
-		                         "} "
-		                         "WHERE { "
-		                         "  ?urn nao:hasTag ?t . "
-		                         "  %s "
-		                         "}",
-		                         filter ? filter : "");
-		g_free (filter);
-
-		g_object_unref (tag_cursor);
 	} else {
 		/* Remove tag completely */
-		query = g_strdup_printf ("DELETE { "
-		                         "  ?tag a rdfs:Resource . "
-		                         "  ?r nao:hasTag ?tag . "
-		                         "} "
-		                         "WHERE {"
-		                         "  ?tag nao:prefLabel %s . "
-		                         "  OPTIONAL { ?r nao:hasTag ?tag } . "
-		                         "}",
-		                         tag_escaped);
-	}
+		stmt = tracker_cli_load_statement (connection, "delete-tag.rq", &error);
 
-	g_free (tag_escaped);
-
-	tracker_sparql_connection_update (connection, query, NULL, &error);
-	g_free (query);
+		if (stmt) {
+			tracker_sparql_statement_bind_string (stmt, "label", tag);
+			tracker_sparql_statement_update (stmt, NULL, &error);
+		}
+	}
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -873,25 +801,14 @@ remove_tag_for_urns (TrackerSparqlConnection *connection,
 }
 
 static gboolean
-get_tags_by_file (TrackerSparqlConnection *connection,
-                  const gchar             *uri)
+get_tags_by_file (TrackerSparqlStatement *stmt,
+                  const gchar            *uri)
 {
 	TrackerSparqlCursor *cursor;
 	GError *error = NULL;
-	gchar *query;
-
-	query = g_strdup_printf ("SELECT ?tags ?labels "
-	                         "WHERE {"
-	                         "  ?urn nao:hasTag ?tags ;"
-	                         "  nie:url <%s> ."
-	                         "  ?tags a nao:Tag ;"
-	                         "  nao:prefLabel ?labels "
-	                         "} "
-	                         "ORDER BY ASC(?labels)",
-	                         uri);
 
-	cursor = tracker_sparql_connection_query (connection, query, NULL, &error);
-	g_free (query);
+	tracker_sparql_statement_bind_string (stmt, "uri", uri);
+	cursor = tracker_sparql_statement_execute (stmt, NULL, &error);
 
 	if (error) {
 		g_printerr ("%s, %s\n",
@@ -981,9 +898,22 @@ tag_run (void)
 	}
 
 	if (resources) {
+		g_autoptr (TrackerSparqlStatement) stmt = NULL;
 		gboolean success = TRUE;
 		gchar **p;
 
+		stmt = tracker_cli_load_statement (connection, "get-file-tags.rq", &error);
+
+		if (!stmt) {
+			g_printerr ("%s, %s\n",
+			            _("Could not get all tags"),
+			            error->message);
+			g_error_free (error);
+			g_object_unref (connection);
+
+			return EXIT_FAILURE;
+		}
+
 		for (p = resources; *p; p++) {
 			GFile *file;
 			gchar *uri;
@@ -993,7 +923,7 @@ tag_run (void)
 			g_object_unref (file);
 
 			g_print ("%s\n", uri);
-			success &= get_tags_by_file (connection, uri);
+			success &= get_tags_by_file (stmt, uri);
 
 			g_free (uri);
 		}
@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/* Runs the same scripted sequence of full text searches against a
+ * generated store, once building a new query string per search (as
+ * the CLI used to do) and once reusing the prepared statement that
+ * "localsearch search --documents" loads from its gresource.
+ */
+
+#include <stdlib.h>
+
+#include <glib.h>
+#include <tinysparql.h>
+
+#define SEARCH_STATEMENT "/org/freedesktop/Tracker3/CLI/queries/search-documents-fts.rq"
+#define WORDS_PER_DOCUMENT 24
+#define INSERT_CHUNK 500
+
+static gint n_documents = 20000;
+static gint n_rounds = 5;
+
+static GOptionEntry entries[] = {
+	{ "documents", 'n', 0, G_OPTION_ARG_INT, &n_documents,
+	  "Number of documents in the generated store", "N" },
+	{ "rounds", 'r', 0, G_OPTION_ARG_INT, &n_rounds,
+	  "Number of times the search script is replayed", "N" },
+	{ NULL }
+};
+
+static const gchar *vocabulary[] = {
+	"alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+	"hotel", "india", "juliett", "kilo", "lima", "mike", "november",
+	"oscar", "papa", "quebec", "romeo", "sierra", "tango", "uniform",
+	"victor", "whiskey", "xray", "yankee", "zulu", "amber", "basalt",
+	"cobalt", "dune", "ember", "fjord", "glacier", "harbor", "island",
+	"jungle", "kelp", "lagoon", "meadow", "nebula", "orchid", "prairie",
+	"quartz", "river", "savanna", "tundra", "umber", "valley", "willow",
+	"yarrow", "zephyr",
+};
+
+/* The search script, as a user refining a search would type it */
+static const gchar *script[] = {
+	"alpha", "alpha bravo", "alpha bravo charlie",
+	"river", "river valley", "river valley willow",
+	"nebula", "nebula OR quartz", "nebula OR quartz OR orchid",
+	"glacier", "glacier fjord", "tundra", "tundra savanna",
+	"zephyr", "kelp lagoon", "amber ember",
+};
+
+static TrackerSparqlConnection *
+create_store (GError **error)
+{
+	TrackerSparqlConnection *conn;
+	GFile *ontology;
+	GRand *rand;
+	GString *sparql;
+	gint i, j;
+
+	ontology = tracker_sparql_get_ontology_nepomuk ();
+	conn = tracker_sparql_connection_new (TRACKER_SPARQL_CONNECTION_FLAGS_NONE,
+	                                      NULL, ontology, NULL, error);
+	g_object_unref (ontology);
+
+	if (!conn)
+		return NULL;
+
+	if (!tracker_sparql_connection_update (conn,
+	                                       "INSERT DATA {"
+	                                       "  GRAPH tracker:FileSystem {"
+	                                       "    <file:///bench> a tracker:IndexedFolder, nfo:Folder ;"
+	                                       "      tracker:available true ."
+	                                       "  }"
+	                                       "}",
+	                                       NULL, error)) {
+		g_object_unref (conn);
+		return NULL;
+	}
+
+	/* Fixed seed, so every run searches the same corpus */
+	rand = g_rand_new_with_seed (0x5eed);
+	sparql = g_string_new (NULL);
+
+	for (i = 0; i < n_documents; i++) {
+		if (sparql->len == 0)
+			g_string_append (sparql, "INSERT DATA {");
+
+		g_string_append_printf (sparql,
+		                        "GRAPH tracker:FileSystem {"
+		                        "  <file:///bench/%d.txt> a nfo:FileDataObject ;"
+		                        "    nie:url \"file:///bench/%d.txt\" ;"
+		                        "    nfo:fileName \"%d.txt\" ;"
+		                        "    nie:dataSource <file:///bench> ."
+		                        "}"
+		                        "GRAPH tracker:Documents {"
+		                        "  <urn:bench:%d> a nfo:PlainTextDocument ;"
+		                        "    nie:isStoredAs <file:///bench/%d.txt> ;"
+		                        "    nie:plainTextContent \"",
+		                        i, i, i, i, i);
+
+		for (j = 0; j < WORDS_PER_DOCUMENT; j++) {
+			gint word;
+
+			word = g_rand_int_range (rand, 0, G_N_ELEMENTS (vocabulary));
+			g_string_append_printf (sparql, "%s%s",
+			                        j > 0 ? " " : "",
+			                        vocabulary[word]);
+		}
+
+		g_string_append (sparql, "\" . }");
+
+		if ((i + 1) % INSERT_CHUNK == 0 || i == n_documents - 1) {
+			g_string_append (sparql, "}");
+
+			if (!tracker_sparql_connection_update (conn, sparql->str, NULL, error)) {
+				g_clear_object (&conn);
+				break;
+			}
+
+			g_string_truncate (sparql, 0);
+		}
+	}
+
+	g_string_free (sparql, TRUE);
+	g_rand_free (rand);
+
+	return conn;
+}
+
+static gint
+consume_cursor (TrackerSparqlCursor *cursor)
+{
+	gint n_results = 0;
+
+	while (tracker_sparql_cursor_next (cursor, NULL, NULL))
+		n_results++;
+
+	return n_results;
+}
+
+static gboolean
+run_interpolated (TrackerSparqlConnection  *conn,
+                  gint                     *n_results,
+                  GError                  **error)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (script); i++) {
+		g_autoptr (TrackerSparqlCursor) cursor = NULL;
+		g_autofree gchar *escaped = NULL;
+		g_autofree gchar *query = NULL;
+
+		escaped = tracker_sparql_escape_string (script[i]);
+		query = g_strdup_printf ("SELECT ?document ?u fts:snippet(?document, \"\", \"\") "
+		                         "WHERE { "
+		                         "  GRAPH tracker:Documents {"
+		                         "    ?document a nfo:Document ;"
+		                         "      nie:isStoredAs ?u ;"
+		                         "      fts:match \"%s\" ."
+		                         "  }"
+		                         "  GRAPH tracker:FileSystem {"
+		                         "    ?u nie:dataSource/tracker:available true ."
+		                         "  }"
+		                         "} "
+		                         "ORDER BY ASC(?u) "
+		                         "OFFSET %d "
+		                         "LIMIT %d",
+		                         escaped, 0, 50);
+
+		cursor = tracker_sparql_connection_query (conn, query, NULL, error);
+		if (!cursor)
+			return FALSE;
+
+		*n_results += consume_cursor (cursor);
+	}
+
+	return TRUE;
+}
+
+static gboolean
+run_prepared (TrackerSparqlStatement  *stmt,
+              gint                    *n_results,
+              GError                 **error)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (script); i++) {
+		g_autoptr (TrackerSparqlCursor) cursor = NULL;
+
+		tracker_sparql_statement_bind_string (stmt, "match", script[i]);
+		tracker_sparql_statement_bind_string (stmt, "snippetBegin", "");
+		tracker_sparql_statement_bind_string (stmt, "snippetEnd", "");
+		tracker_sparql_statement_bind_boolean (stmt, "showAll", FALSE);
+		tracker_sparql_statement_bind_int (stmt, "offset", 0);
+		tracker_sparql_statement_bind_int (stmt, "limit", 50);
+
+		cursor = tracker_sparql_statement_execute (stmt, NULL, error);
+		if (!cursor)
+			return FALSE;
+
+		*n_results += consume_cursor (cursor);
+	}
+
+	return TRUE;
+}
+
+static void
+print_result (const gchar *mode,
+              gdouble      elapsed,
+              gint         n_results)
+{
+	guint n_queries = n_rounds * G_N_ELEMENTS (script);
+
+	g_print ("%s: queries=%u results=%d total_ms=%.3f mean_ms=%.3f\n",
+	         mode, n_queries, n_results,
+	         elapsed * 1000,
+	         elapsed * 1000 / n_queries);
+}
+
+int
+main (int argc, char *argv[])
+{
+	g_autoptr (GOptionContext) context = NULL;
+	g_autoptr (TrackerSparqlConnection) conn = NULL;
+	g_autoptr (TrackerSparqlStatement) stmt = NULL;
+	g_autoptr (GTimer) timer = NULL;
+	GError *error = NULL;
+	gint n_interpolated = 0, n_prepared = 0;
+	gdouble elapsed;
+	gint i;
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+		goto error;
+
+	timer = g_timer_new ();
+	conn = create_store (&error);
+	if (!conn)
+		goto error;
+
+	g_print ("store: documents=%d setup_ms=%.3f\n",
+	         n_documents, g_timer_elapsed (timer, NULL) * 1000);
+
+	/* Warm up the database pages, so both modes start equal */
+	if (!run_interpolated (conn, &n_interpolated, &error))
+		goto error;
+	n_interpolated = 0;
+
+	g_timer_start (timer);
+	for (i = 0; i < n_rounds; i++) {
+		if (!run_interpolated (conn, &n_interpolated, &error))
+			goto error;
+	}
+	elapsed = g_timer_elapsed (timer, NULL);
+	print_result ("interpolated", elapsed, n_interpolated);
+
+	g_timer_start (timer);
+	stmt = tracker_sparql_connection_load_statement_from_gresource (conn,
+	                                                                SEARCH_STATEMENT,
+	                                                                NULL,
+	                                                                &error);
+	if (!stmt)
+		goto error;
+
+	for (i = 0; i < n_rounds; i++) {
+		if (!run_prepared (stmt, &n_prepared, &error))
+			goto error;
+	}
+	elapsed = g_timer_elapsed (timer, NULL);
+	print_result ("prepared", elapsed, n_prepared);
+
+	if (n_prepared != n_interpolated) {
+		g_printerr ("Result count mismatch: %d interpolated, %d prepared\n",
+		            n_interpolated, n_prepared);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+
+ error:
+	g_printerr ("%s\n", error->message);
+	g_error_free (error);
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,608 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/* Runs the extract modules in-process over a generated corpus, with
+ * small, typical and pathological files for each MIME type, and
+ * prints one JSON object per MIME type and size class, so results
+ * can be compared between releases.
+ *
+ * Files are extracted repeatedly, so the numbers reflect the cost of
+ * the extractors themselves over a warm page cache.
+ */
+
+#include "config-miners.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libtracker-extract/tracker-extract.h>
+#include <libtracker-extract/tracker-module-manager.h>
+
+#include "tracker-benchmark-utils.h"
+
+typedef enum {
+	SIZE_SMALL,
+	SIZE_TYPICAL,
+	SIZE_PATHOLOGICAL,
+	N_SIZES,
+} SizeClass;
+
+static const gchar *size_names[] = {
+	"small", "typical", "pathological",
+};
+
+typedef GBytes * (* GenerateFunc) (GRand     *rand,
+                                   SizeClass  size);
+
+typedef struct {
+	const gchar *mimetype;
+	const gchar *extension;
+	GenerateFunc generate;
+} CorpusType;
+
+static gint n_iterations = 20;
+static gchar *only_mimetype = NULL;
+static gchar *corpus_dir = NULL;
+
+static GOptionEntry entries[] = {
+	{ "iterations", 'i', 0, G_OPTION_ARG_INT, &n_iterations,
+	  "Number of times each file is extracted", "N" },
+	{ "mimetype", 'm', 0, G_OPTION_ARG_STRING, &only_mimetype,
+	  "Only benchmark this MIME type", "MIME" },
+	{ "corpus", 'c', 0, G_OPTION_ARG_FILENAME, &corpus_dir,
+	  "Also benchmark the files in this directory, as the \"sample\" size class", "DIR" },
+	{ NULL }
+};
+
+static const gchar *vocabulary[] = {
+	"alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+	"hotel", "india", "juliett", "kilo", "lima", "mike", "november",
+	"oscar", "papa", "quebec", "romeo", "sierra", "tango", "uniform",
+	"victor", "whiskey", "xray", "yankee", "zulu", "ñandú", "größe",
+	"café", "ελλάδα", "日本語",
+};
+
+static void
+append_words (GString *str,
+              GRand   *rand,
+              gsize    len,
+              gboolean newlines)
+{
+	gsize target = str->len + len;
+	gint n_words = 0;
+
+	while (str->len < target) {
+		g_string_append (str, vocabulary[g_rand_int_range (rand, 0, G_N_ELEMENTS (vocabulary))]);
+		n_words++;
+
+		if (newlines && n_words % 12 == 0)
+			g_string_append_c (str, '\n');
+		else
+			g_string_append_c (str, ' ');
+	}
+}
+
+static GBytes *
+generate_text (GRand     *rand,
+               SizeClass  size)
+{
+	GString *str = g_string_new (NULL);
+
+	if (size == SIZE_SMALL)
+		append_words (str, rand, 1024, TRUE);
+	else if (size == SIZE_TYPICAL)
+		append_words (str, rand, 64 * 1024, TRUE);
+	else
+		append_words (str, rand, 16 * 1024 * 1024, FALSE);
+
+	return g_string_free_to_bytes (str);
+}
+
+static GBytes *
+generate_html (GRand     *rand,
+               SizeClass  size)
+{
+	GString *str = g_string_new ("<!DOCTYPE html>\n<html><head><title>");
+	gint i, n_paragraphs;
+
+	append_words (str, rand, 32, FALSE);
+	g_string_append (str, "</title><meta name=\"author\" content=\"Bench\"></head><body>\n");
+
+	if (size == SIZE_PATHOLOGICAL) {
+		/* Deeply nested, never closed elements */
+		for (i = 0; i < 100000; i++)
+			g_string_append (str, "<div><span>");
+		append_words (str, rand, 1024, FALSE);
+	} else {
+		n_paragraphs = (size == SIZE_SMALL) ? 4 : 400;
+
+		for (i = 0; i < n_paragraphs; i++) {
+			g_string_append (str, "<p>");
+			append_words (str, rand, 256, FALSE);
+			g_string_append (str, "</p>\n");
+		}
+
+		g_string_append (str, "</body></html>\n");
+	}
+
+	return g_string_free_to_bytes (str);
+}
+
+static void
+put_le (guint8  *data,
+        guint32  value,
+        gint     n_bytes)
+{
+	gint i;
+
+	for (i = 0; i < n_bytes; i++)
+		data[i] = (value >> (i * 8)) & 0xff;
+}
+
+static GBytes *
+generate_bmp (GRand     *rand,
+              SizeClass  size)
+{
+	GByteArray *array;
+	gint32 width, height;
+	guint32 data_size, pixel_data_size;
+	guint8 header[54] = { 'B', 'M', 0 };
+	guint32 i;
+
+	if (size == SIZE_SMALL)
+		width = height = 16;
+	else if (size == SIZE_TYPICAL)
+		width = 1024, height = 768;
+	else
+		width = height = G_MAXINT16;
+
+	data_size = width * height * 3;
+
+	/* Pathological files claim a huge bitmap but are truncated */
+	pixel_data_size = (size == SIZE_PATHOLOGICAL) ? 4096 : data_size;
+
+	put_le (&header[2], sizeof (header) + data_size, 4);
+	put_le (&header[10], sizeof (header), 4);
+	put_le (&header[14], 40, 4);
+	put_le (&header[18], width, 4);
+	put_le (&header[22], height, 4);
+	put_le (&header[26], 1, 2);
+	put_le (&header[28], 24, 2);
+	put_le (&header[34], data_size, 4);
+
+	array = g_byte_array_sized_new (sizeof (header) + pixel_data_size);
+	g_byte_array_append (array, header, sizeof (header));
+
+	for (i = 0; i < pixel_data_size; i++) {
+		guint8 pixel = g_rand_int (rand) & 0xff;
+		g_byte_array_append (array, &pixel, 1);
+	}
+
+	return g_byte_array_free_to_bytes (array);
+}
+
+static void
+append_id3v2_frame (GByteArray  *array,
+                    const gchar *id,
+                    const gchar *text,
+                    gsize        len)
+{
+	guint32 frame_size = GUINT32_TO_BE (len + 1);
+	guint8 flags[2] = { 0, 0 }, encoding = 3;
+
+	/* ID3v2.3 frame sizes are plain big endian integers */
+	g_byte_array_append (array, (const guint8 *) id, 4);
+	g_byte_array_append (array, (const guint8 *) &frame_size, 4);
+	g_byte_array_append (array, flags, 2);
+	g_byte_array_append (array, &encoding, 1);
+	g_byte_array_append (array, (const guint8 *) text, len);
+}
+
+static GBytes *
+generate_mp3 (GRand     *rand,
+              SizeClass  size)
+{
+	/* MPEG-1 layer III, 128kbps, 44.1KHz, no padding */
+	const guint8 frame_header[4] = { 0xff, 0xfb, 0x90, 0x64 };
+	const gsize frame_len = 417;
+	g_autoptr (GString) title = g_string_new (NULL);
+	GByteArray *array, *tag;
+	gint i, n_frames;
+	guint32 tag_size;
+	guint8 header[10] = { 'I', 'D', '3', 3, 0, 0 };
+
+	append_words (title, rand, 24, FALSE);
+
+	tag = g_byte_array_new ();
+	append_id3v2_frame (tag, "TIT2", title->str, title->len);
+	append_id3v2_frame (tag, "TPE1", "Benchmark Artist", strlen ("Benchmark Artist"));
+	append_id3v2_frame (tag, "TALB", "Benchmark Album", strlen ("Benchmark Album"));
+	append_id3v2_frame (tag, "TRCK", "1/12", strlen ("1/12"));
+
+	if (size == SIZE_PATHOLOGICAL) {
+		g_autoptr (GString) comment = g_string_new (NULL);
+
+		/* An oversized tag in front of the audio data */
+		append_words (comment, rand, 8 * 1024 * 1024, FALSE);
+		append_id3v2_frame (tag, "TXXX", comment->str, comment->len);
+	}
+
+	/* Tag size is a 28 bit syncsafe integer */
+	tag_size = tag->len;
+	header[6] = (tag_size >> 21) & 0x7f;
+	header[7] = (tag_size >> 14) & 0x7f;
+	header[8] = (tag_size >> 7) & 0x7f;
+	header[9] = tag_size & 0x7f;
+
+	array = g_byte_array_new ();
+	g_byte_array_append (array, header, sizeof (header));
+	g_byte_array_append (array, tag->data, tag->len);
+	g_byte_array_unref (tag);
+
+	n_frames = (size == SIZE_SMALL) ? 16 : 10000;
+
+	for (i = 0; i < n_frames; i++) {
+		gsize j;
+
+		g_byte_array_append (array, frame_header, sizeof (frame_header));
+
+		for (j = sizeof (frame_header); j < frame_len; j++) {
+			guint8 byte = g_rand_int (rand) & 0xff;
+			g_byte_array_append (array, &byte, 1);
+		}
+	}
+
+	return g_byte_array_free_to_bytes (array);
+}
+
+static GBytes *
+generate_desktop (GRand     *rand,
+                  SizeClass  size)
+{
+	GString *str = g_string_new ("[Desktop Entry]\n"
+	                             "Type=Application\n"
+	                             "Exec=bench %U\n"
+	                             "Icon=bench\n"
+	                             "Categories=Utility;\n");
+	gint i, n_translations;
+
+	if (size == SIZE_SMALL)
+		n_translations = 0;
+	else if (size == SIZE_TYPICAL)
+		n_translations = 80;
+	else
+		n_translations = 100000;
+
+	g_string_append (str, "Name=Benchmark\nComment=");
+	append_words (str, rand, 64, FALSE);
+	g_string_append_c (str, '\n');
+
+	for (i = 0; i < n_translations; i++) {
+		g_string_append_printf (str, "Name[x%d]=", i);
+		append_words (str, rand, 16, FALSE);
+		g_string_append_printf (str, "\nComment[x%d]=", i);
+		append_words (str, rand, 64, FALSE);
+		g_string_append_c (str, '\n');
+	}
+
+	return g_string_free_to_bytes (str);
+}
+
+static const CorpusType corpus_types[] = {
+	{ "text/plain", "txt", generate_text },
+	{ "text/html", "html", generate_html },
+	{ "image/bmp", "bmp", generate_bmp },
+	{ "audio/mpeg", "mp3", generate_mp3 },
+	{ "application/x-desktop", "desktop", generate_desktop },
+};
+
+static guint64
+read_proc_value (const gchar *path,
+                 const gchar *key)
+{
+	g_autofree gchar *contents = NULL;
+	gchar *line;
+	gsize key_len = strlen (key);
+
+	if (!g_file_get_contents (path, &contents, NULL, NULL))
+		return 0;
+
+	for (line = contents; line && *line; line = strchr (line, '\n')) {
+		if (*line == '\n')
+			line++;
+		if (strncmp (line, key, key_len) == 0)
+			return g_ascii_strtoull (line + key_len, NULL, 10);
+	}
+
+	return 0;
+}
+
+static guint64
+get_bytes_read (void)
+{
+	/* Only accounts read() calls, mmap() page faults are not seen here */
+	return read_proc_value ("/proc/self/io", "rchar:");
+}
+
+static void
+reset_peak_rss (void)
+{
+	/* Writing 5 resets VmHWM, available since Linux 4.0 */
+	g_file_set_contents ("/proc/self/clear_refs", "5", 1, NULL);
+}
+
+static guint64
+get_peak_rss_kb (void)
+{
+	return read_proc_value ("/proc/self/status", "VmHWM:");
+}
+
+static gboolean
+extract_once (GFile                      *file,
+              const gchar                *mimetype,
+              TrackerExtractMetadataFunc  func,
+              GError                    **error)
+{
+	TrackerExtractInfo *info;
+	g_autofree gchar *content_id = NULL;
+	gboolean success;
+
+	content_id = g_file_get_uri (file);
+	info = tracker_extract_info_new (file, content_id, mimetype,
+	                                 tracker_extract_module_manager_get_graph (mimetype),
+	                                 1024 * 1024);
+	success = func (info, error);
+	tracker_extract_info_unref (info);
+
+	return success;
+}
+
+static gboolean
+run_benchmark (const gchar  *mimetype,
+               const gchar  *size_class,
+               GList        *files,
+               GError      **error)
+{
+	TrackerExtractMetadataFunc func = NULL;
+	g_autoptr (GArray) latencies = NULL;
+	g_autoptr (GTimer) timer = NULL;
+	guint64 bytes_read, file_bytes = 0;
+	gint allocations = -1;
+	guint n_failures = 0;
+	GList *l;
+	gint i;
+
+	if (!tracker_extract_module_manager_get_module (mimetype, NULL, &func) || !func) {
+		g_printerr ("No extract module for %s, skipping\n", mimetype);
+		return TRUE;
+	}
+
+	latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	timer = g_timer_new ();
+
+	/* Warm up the page cache and any per-module state */
+	for (l = files; l; l = l->next) {
+		g_autoptr (GFileInfo) file_info = NULL;
+
+		file_info = g_file_query_info (l->data, G_FILE_ATTRIBUTE_STANDARD_SIZE,
+		                               G_FILE_QUERY_INFO_NONE, NULL, error);
+		if (!file_info)
+			return FALSE;
+
+		file_bytes += g_file_info_get_size (file_info);
+		extract_once (l->data, mimetype, func, NULL);
+	}
+
+	reset_peak_rss ();
+	bytes_read = get_bytes_read ();
+#ifdef TRACKER_BENCHMARK_HAVE_ALLOCATION_TRACKING
+	allocations = tracker_benchmark_get_n_allocations ();
+#endif
+
+	for (i = 0; i < n_iterations; i++) {
+		for (l = files; l; l = l->next) {
+			g_autoptr (GError) extract_error = NULL;
+			gdouble elapsed;
+
+			g_timer_start (timer);
+			if (!extract_once (l->data, mimetype, func, &extract_error))
+				n_failures++;
+			elapsed = g_timer_elapsed (timer, NULL) * G_USEC_PER_SEC;
+			g_array_append_val (latencies, elapsed);
+		}
+	}
+
+	bytes_read = get_bytes_read () - bytes_read;
+#ifdef TRACKER_BENCHMARK_HAVE_ALLOCATION_TRACKING
+	allocations = tracker_benchmark_get_n_allocations () - allocations;
+#endif
+
+	g_array_sort (latencies, tracker_benchmark_compare_doubles);
+
+	g_print ("{\"mimetype\":\"%s\",\"size\":\"%s\",\"files\":%u,\"file_bytes\":%" G_GUINT64_FORMAT ","
+	         "\"extractions\":%u,\"failures\":%u,"
+	         "\"p50_us\":%.1f,\"p90_us\":%.1f,\"p99_us\":%.1f,\"max_us\":%.1f,"
+	         "\"bytes_read\":%" G_GUINT64_FORMAT ",\"peak_rss_kb\":%" G_GUINT64_FORMAT ","
+	         "\"allocations\":%d}\n",
+	         mimetype, size_class, g_list_length (files), file_bytes,
+	         latencies->len, n_failures,
+	         tracker_benchmark_percentile (latencies, 50),
+	         tracker_benchmark_percentile (latencies, 90),
+	         tracker_benchmark_percentile (latencies, 99),
+	         tracker_benchmark_percentile (latencies, 100),
+	         bytes_read / MAX (latencies->len, 1), get_peak_rss_kb (),
+	         allocations >= 0 ? allocations / (gint) MAX (latencies->len, 1) : -1);
+
+	return TRUE;
+}
+
+static gboolean
+run_generated_corpus (const gchar  *tmpdir,
+                      GError      **error)
+{
+	guint i;
+	gint size;
+
+	for (i = 0; i < G_N_ELEMENTS (corpus_types); i++) {
+		const CorpusType *type = &corpus_types[i];
+
+		if (only_mimetype && g_strcmp0 (only_mimetype, type->mimetype) != 0)
+			continue;
+
+		for (size = 0; size < N_SIZES; size++) {
+			g_autoptr (GRand) rand = NULL;
+			g_autoptr (GBytes) bytes = NULL;
+			g_autoptr (GFile) file = NULL;
+			g_autofree gchar *path = NULL, *name = NULL;
+			g_autoptr (GList) files = NULL;
+			gboolean success;
+
+			/* Fixed seeds, so every run generates the same corpus */
+			rand = g_rand_new_with_seed (0x5eed + i * N_SIZES + size);
+			bytes = type->generate (rand, size);
+
+			name = g_strdup_printf ("%s.%s", size_names[size], type->extension);
+			path = g_build_filename (tmpdir, name, NULL);
+
+			if (!g_file_set_contents (path,
+			                          g_bytes_get_data (bytes, NULL),
+			                          g_bytes_get_size (bytes),
+			                          error))
+				return FALSE;
+
+			file = g_file_new_for_path (path);
+			files = g_list_prepend (NULL, file);
+			success = run_benchmark (type->mimetype, size_names[size], files, error);
+			g_unlink (path);
+
+			if (!success)
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gboolean
+run_sample_corpus (const gchar  *dir,
+                   GError      **error)
+{
+	g_autoptr (GFile) root = NULL;
+	g_autoptr (GFileEnumerator) enumerator = NULL;
+	g_autoptr (GHashTable) by_mimetype = NULL;
+	GHashTableIter iter;
+	gpointer key, value;
+	gboolean success = TRUE;
+
+	root = g_file_new_for_path (dir);
+	enumerator = g_file_enumerate_children (root,
+	                                        G_FILE_ATTRIBUTE_STANDARD_NAME ","
+	                                        G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+	                                        G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+	                                        G_FILE_QUERY_INFO_NONE,
+	                                        NULL, error);
+	if (!enumerator)
+		return FALSE;
+
+	by_mimetype = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	while (TRUE) {
+		GFileInfo *info;
+		GFile *child;
+		GList *files;
+		gchar *mimetype;
+
+		if (!g_file_enumerator_iterate (enumerator, &info, &child, NULL, error))
+			return FALSE;
+		if (!info)
+			break;
+		if (g_file_info_get_file_type (info) != G_FILE_TYPE_REGULAR)
+			continue;
+
+		mimetype = g_content_type_get_mime_type (g_file_info_get_content_type (info));
+		if (!mimetype)
+			continue;
+		if (only_mimetype && g_strcmp0 (only_mimetype, mimetype) != 0) {
+			g_free (mimetype);
+			continue;
+		}
+
+		files = g_hash_table_lookup (by_mimetype, mimetype);
+		files = g_list_prepend (files, g_object_ref (child));
+		g_hash_table_insert (by_mimetype, mimetype, files);
+	}
+
+	g_hash_table_iter_init (&iter, by_mimetype);
+
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		if (success)
+			success = run_benchmark (key, "sample", value, error);
+		g_list_free_full (value, g_object_unref);
+	}
+
+	return success;
+}
+
+int
+main (int argc, char *argv[])
+{
+	g_autoptr (GOptionContext) context = NULL;
+	g_autofree gchar *tmpdir = NULL;
+	GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+		goto error;
+
+	/* Use the modules and rules of this build */
+	if (!g_getenv ("TRACKER_EXTRACTOR_RULES_DIR"))
+		g_setenv ("TRACKER_EXTRACTOR_RULES_DIR", EXTRACTOR_RULES_DIR, TRUE);
+	if (!g_getenv ("TRACKER_EXTRACTORS_DIR"))
+		g_setenv ("TRACKER_EXTRACTORS_DIR", EXTRACTORS_DIR, TRUE);
+
+	if (!tracker_extract_module_manager_init ())
+		return EXIT_FAILURE;
+
+	tmpdir = g_dir_make_tmp ("tracker-extract-benchmark-XXXXXX", &error);
+	if (!tmpdir)
+		goto error;
+
+	if (!run_generated_corpus (tmpdir, &error)) {
+		g_rmdir (tmpdir);
+		goto error;
+	}
+
+	g_rmdir (tmpdir);
+
+	if (corpus_dir && !run_sample_corpus (corpus_dir, &error))
+		goto error;
+
+	return EXIT_SUCCESS;
+
+ error:
+	g_printerr ("%s\n", error->message);
+	g_error_free (error);
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "config-miners.h"
+
+#include <ftw.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <glib/gstdio.h>
+
+#include "tracker-benchmark-utils.h"
+
+static gint n_allocations = 0;
+static gssize heap_used = 0;
+
+#ifdef __GLIBC__
+#include <malloc.h>
+
+/* Count allocations and the heap in use by wrapping the glibc
+ * allocator. This file is built into each benchmark executable, so
+ * the wrappers take over malloc() for the whole process.
+ */
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void __libc_free (void *ptr);
+
+void *
+malloc (size_t size)
+{
+	void *ptr;
+
+	g_atomic_int_inc (&n_allocations);
+	ptr = __libc_malloc (size);
+	if (ptr)
+		g_atomic_pointer_add (&heap_used, malloc_usable_size (ptr));
+
+	return ptr;
+}
+
+void *
+calloc (size_t nmemb,
+        size_t size)
+{
+	void *ptr;
+
+	g_atomic_int_inc (&n_allocations);
+	ptr = __libc_calloc (nmemb, size);
+	if (ptr)
+		g_atomic_pointer_add (&heap_used, malloc_usable_size (ptr));
+
+	return ptr;
+}
+
+void *
+realloc (void   *ptr,
+         size_t  size)
+{
+	gssize old_size;
+	void *new_ptr;
+
+	g_atomic_int_inc (&n_allocations);
+	old_size = ptr ? malloc_usable_size (ptr) : 0;
+	new_ptr = __libc_realloc (ptr, size);
+
+	if (new_ptr)
+		g_atomic_pointer_add (&heap_used, malloc_usable_size (new_ptr) - old_size);
+	else if (size == 0)
+		g_atomic_pointer_add (&heap_used, -old_size);
+
+	return new_ptr;
+}
+
+void
+free (void *ptr)
+{
+	if (ptr)
+		g_atomic_pointer_add (&heap_used, - (gssize) malloc_usable_size (ptr));
+
+	__libc_free (ptr);
+}
+#endif
+
+gint
+tracker_benchmark_compare_doubles (gconstpointer a,
+                                   gconstpointer b)
+{
+	gdouble da = *(const gdouble *) a, db = *(const gdouble *) b;
+
+	return (da > db) - (da < db);
+}
+
+/* Returns the given percentile of an array of doubles, which must
+ * have been sorted with tracker_benchmark_compare_doubles().
+ */
+gdouble
+tracker_benchmark_percentile (GArray  *values,
+                              gdouble  pct)
+{
+	guint idx;
+
+	if (values->len == 0)
+		return 0;
+
+	idx = (guint) (pct / 100 * (values->len - 1) + 0.5);
+
+	return g_array_index (values, gdouble, idx);
+}
+
+static int
+remove_cb (const char        *path,
+           const struct stat *st,
+           int                flag,
+           struct FTW        *ftw)
+{
+	g_remove (path);
+
+	return 0;
+}
+
+void
+tracker_benchmark_remove_tree (const gchar *path)
+{
+	nftw (path, remove_cb, 64, FTW_DEPTH | FTW_PHYS);
+}
+
+gint
+tracker_benchmark_get_n_allocations (void)
+{
+	return g_atomic_int_get (&n_allocations);
+}
+
+gssize
+tracker_benchmark_get_heap_used (void)
+{
+	return (gssize) g_atomic_pointer_get (&heap_used);
+}
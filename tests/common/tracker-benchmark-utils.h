@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef __TRACKER_BENCHMARK_UTILS_H__
+#define __TRACKER_BENCHMARK_UTILS_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#ifdef __GLIBC__
+/* The glibc allocator is wrapped, allocations and heap use are tracked */
+#define TRACKER_BENCHMARK_HAVE_ALLOCATION_TRACKING 1
+#endif
+
+gint    tracker_benchmark_compare_doubles   (gconstpointer  a,
+                                             gconstpointer  b);
+gdouble tracker_benchmark_percentile        (GArray        *values,
+                                             gdouble        pct);
+
+void    tracker_benchmark_remove_tree       (const gchar   *path);
+
+gint    tracker_benchmark_get_n_allocations (void);
+gssize  tracker_benchmark_get_heap_used     (void);
+
+G_END_DECLS
+
+#endif /* __TRACKER_BENCHMARK_UTILS_H__ */
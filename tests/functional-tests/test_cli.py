@@ -21,6 +21,7 @@ Test `tracker` commandline tool
 
 from typing import *
 import dataclasses
+import json
 import pathlib
 import os
 import re
@@ -82,6 +83,112 @@ class TestCli(fixtures.TrackerCommandLineTestCase):
         self.assertIn(target1.as_uri(), search_output)
         self.assertNotIn(target2.as_uri(), search_output)
 
+    def test_info_multiple(self):
+        datadir = pathlib.Path(__file__).parent.joinpath("data/content")
+
+        targets = []
+        for name in ["Document 1.txt", "Document 2.txt"]:
+            target = pathlib.Path(os.path.join(self.indexed_dir, name))
+            with self.await_document_inserted(target):
+                shutil.copy(datadir.joinpath("text", name), self.indexed_dir)
+            targets.append(target)
+
+        missing = pathlib.Path(os.path.join(self.indexed_dir, "missing.txt"))
+
+        # Arguments are resolved in batches, the output for each of them
+        # must match the one of querying the file alone.
+        output = self.run_cli(["localsearch", "info", *targets, missing])
+        lines = set(output.splitlines())
+
+        for target in targets:
+            single_output = self.run_cli(["localsearch", "info", target])
+            self.assertIn(target.as_uri(), single_output)
+            self.assertLessEqual(set(single_output.splitlines()), lines)
+
+        self.assertIn("No metadata available for that URI", output)
+
+    def test_info_url_property(self):
+        targets = [
+            self.copy_document("Document 1.txt"),
+            self.copy_document("Document 2.txt"),
+        ]
+
+        # Arguments are looked up by the value of the given property,
+        # in batches as well.
+        output = self.run_cli(
+            ["localsearch", "info", "--url=nfo:fileName"]
+            + [t.name for t in targets]
+            + ["missing.txt"]
+        )
+
+        for target in targets:
+            self.assertIn(target.as_uri(), output)
+
+        self.assertIn("No metadata available for that URI", output)
+
+    def copy_document(self, name):
+        datadir = pathlib.Path(__file__).parent.joinpath("data/content")
+        target = pathlib.Path(os.path.join(self.indexed_dir, name))
+        with self.await_document_inserted(target):
+            shutil.copy(datadir.joinpath("text", name), self.indexed_dir)
+        return target
+
+    def parse_json_output(self, output):
+        return [json.loads(line) for line in output.splitlines()]
+
+    def parse_nul_output(self, output):
+        # Fields end with a NUL, records with an additional one
+        records = []
+        for record in output.split("\0\0"):
+            if not record:
+                continue
+            fields = [f for f in record.split("\0") if f]
+            records.append(dict(f.split("=", 1) for f in fields))
+        return records
+
+    def test_search_output_formats(self):
+        target1 = self.copy_document("Document 1.txt")
+        target2 = self.copy_document("Document 2.txt")
+
+        command = ["localsearch", "search", "--all", "banana"]
+
+        records = self.parse_json_output(
+            self.run_cli(command + ["--output-format=json"])
+        )
+        urls = [r["url"] for r in records]
+        self.assertIn(target1.as_uri(), urls)
+        self.assertNotIn(target2.as_uri(), urls)
+        for record in records:
+            self.assertIn("snippet", record)
+
+        records = self.parse_nul_output(
+            self.run_cli(command + ["--output-format=nul"])
+        )
+        urls = [r["url"] for r in records]
+        self.assertIn(target1.as_uri(), urls)
+        self.assertNotIn(target2.as_uri(), urls)
+
+    def test_info_output_formats(self):
+        target = self.copy_document("Document 1.txt")
+
+        command = ["localsearch", "info", target]
+
+        for output_format, parse in [
+            ("json", self.parse_json_output),
+            ("nul", self.parse_nul_output),
+        ]:
+            output = self.run_cli(command + ["--output-format=" + output_format])
+            records = parse(output)
+            self.assertGreater(len(records), 0)
+            for record in records:
+                self.assertEqual(
+                    set(record.keys()), {"subject", "predicate", "object"}
+                )
+
+            stored_as = [r for r in records if r["predicate"] == "nie:isStoredAs"]
+            self.assertEqual(len(stored_as), 1)
+            self.assertEqual(stored_as[0]["object"], target.as_uri())
+
 
 @dataclasses.dataclass
 class TagInfo:
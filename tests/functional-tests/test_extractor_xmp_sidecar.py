@@ -0,0 +1,72 @@
+# Copyright (C) 2026, Red Hat Inc.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the
+# Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+# Boston, MA  02110-1301, USA.
+
+"""
+Tests that images are extracted again when their XMP sidecar changes.
+"""
+
+import os
+import shutil
+
+import configuration as cfg
+import fixtures
+
+
+DATA_DIR = os.path.join(
+    os.path.dirname(__file__), "data", "extractor-content", "images"
+)
+IMAGE_FILE = os.path.join(DATA_DIR, "jpeg-xmp-sidecar-1.jpg")
+SIDECAR_FILE = os.path.join(DATA_DIR, "jpeg-xmp-sidecar-1.xmp")
+SIDECAR_TITLE = "Photograph"
+
+
+class ExtractorXmpSidecarTest(fixtures.TrackerMinerTest):
+    def test_sidecar_added(self):
+        """Tests whether a new sidecar triggers extraction of its image."""
+        image_path = os.path.join(self.indexed_dir, "photo.jpg")
+        sidecar_path = os.path.join(self.indexed_dir, "photo.xmp")
+
+        # Without sidecar, the title is taken from the file name
+        with self.tracker.await_insert(
+            fixtures.PICTURES_GRAPH,
+            'a nmm:Photo ; nie:title "photo"',
+            timeout=cfg.AWAIT_TIMEOUT,
+        ) as resource:
+            shutil.copy(IMAGE_FILE, image_path)
+        image_urn = resource.urn
+
+        try:
+            with self.tracker.await_insert(
+                fixtures.PICTURES_GRAPH,
+                f'nie:title "{SIDECAR_TITLE}"',
+                timeout=cfg.AWAIT_TIMEOUT,
+            ):
+                shutil.copy(SIDECAR_FILE, sidecar_path)
+
+            title_result = self.tracker.query(
+                "SELECT ?title { <%s> nie:title ?title }" % image_urn
+            )
+            assert len(title_result) == 1
+            self.assertEqual(title_result[0][0], SIDECAR_TITLE)
+        finally:
+            os.remove(image_path)
+            if os.path.exists(sidecar_path):
+                os.remove(sidecar_path)
+
+
+if __name__ == "__main__":
+    fixtures.tracker_test_main()
@@ -0,0 +1,235 @@
+# Copyright (C) 2026, Red Hat Inc.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the
+# Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+# Boston, MA  02110-1301, USA.
+
+"""
+Test that files moved while monitors are not looking are still
+handled as moves once the miner sees the deletion and the creation.
+"""
+
+import os
+import shutil
+import time
+import unittest as ut
+
+from gi.repository import Gio, GLib
+
+import configuration as cfg
+import fixtures
+
+
+DEFAULT_TEXT = "Some stupid content, to have a test file"
+
+
+class MinerUnmonitoredMovesTest(fixtures.TrackerMinerTest):
+    """
+    Tests moves, renames, hardlinks and reused inodes with monitors
+    disabled.
+    """
+
+    def setUp(self):
+        # Create the test data before the initial crawl, nothing
+        # else will notice it.
+        monitored_files = self.create_test_data()
+
+        try:
+            fixtures.TrackerMinerTest.setUp(self)
+
+            for tf in monitored_files:
+                self.ensure_document_inserted(tf)
+        except Exception:
+            cfg.remove_monitored_test_dir(self.workdir)
+            raise
+
+    def config(self):
+        settings = super(MinerUnmonitoredMovesTest, self).config()
+        settings["org.freedesktop.Tracker3.Miner.Files"][
+            "enable-monitors"
+        ] = GLib.Variant.new_boolean(False)
+        return settings
+
+    def create_test_data(self):
+        monitored_files = [
+            "test-monitored/file1.txt",
+            "test-monitored/file2.txt",
+            "test-monitored/dir/file3.txt",
+        ]
+
+        for tf in monitored_files:
+            testfile = self.path(tf)
+            os.makedirs(os.path.dirname(testfile), exist_ok=True)
+            with open(testfile, "w") as f:
+                f.write(DEFAULT_TEXT)
+
+        return monitored_files
+
+    def tag_file(self, filename, label):
+        self.tracker.update(
+            f"""
+            INSERT {{
+              ?tag a nao:Tag ;
+                nao:prefLabel "{label}" .
+              <{self.uri(filename)}> a rdfs:Resource ;
+                nao:hasTag ?tag .
+            }} WHERE {{
+              BIND (BNODE () AS ?tag)
+            }}
+            """
+        )
+
+    def file_has_tag(self, filename, label):
+        return self.tracker.ask(
+            f"""
+            ASK {{
+              <{self.uri(filename)}> nao:hasTag/nao:prefLabel "{label}"
+            }}
+            """
+        )
+
+    def reindex(self):
+        self.miner_fs.index_location(self.uri("test-monitored"), [], [])
+
+    def require_birth_time(self, filename):
+        info = Gio.File.new_for_path(self.path(filename)).query_info(
+            Gio.FILE_ATTRIBUTE_TIME_CREATED, Gio.FileQueryInfoFlags.NONE, None
+        )
+        if not info.has_attribute(Gio.FILE_ATTRIBUTE_TIME_CREATED):
+            self.skipTest("Directories need a birth time to be moved")
+
+    def make_dir_with_inode(self, inode):
+        """
+        Creates directories until one gets @inode, and removes the others.
+        """
+        found = None
+        created = []
+
+        for i in range(100):
+            dirname = f"test-monitored/new-{i}"
+            os.mkdir(self.path(dirname))
+            if os.stat(self.path(dirname)).st_ino == inode:
+                found = dirname
+                break
+            created.append(dirname)
+
+        for dirname in created:
+            os.rmdir(self.path(dirname))
+
+        return found
+
+    def test_01_rename_is_move(self):
+        """
+        A rename nobody saw keeps the indexed content, and its tags.
+        """
+        source = "test-monitored/file1.txt"
+        dest = "test-monitored/renamed.txt"
+        resource_id = self.tracker.get_content_resource_id(self.uri(source))
+        self.tag_file(source, "moved")
+
+        with self.await_document_uri_change(resource_id, source, dest):
+            os.rename(self.path(source), self.path(dest))
+            self.reindex()
+
+        self.assertEqual(
+            self.tracker.get_content_resource_id(self.uri(dest)), resource_id
+        )
+        self.assertTrue(self.file_has_tag(dest, "moved"))
+        self.assertFalse(self.file_has_tag(source, "moved"))
+
+    def test_02_hardlink_is_not_move(self):
+        """
+        A hardlink shares the inode of a file that is still there, even
+        if something else was deleted at the same time.
+        """
+        source = "test-monitored/file1.txt"
+        link = "test-monitored/link.txt"
+        deleted = "test-monitored/file2.txt"
+        deleted_id = self.tracker.get_content_resource_id(self.uri(deleted))
+        self.tag_file(source, "linked")
+
+        with self.tracker.await_insert(
+            fixtures.FILESYSTEM_GRAPH,
+            f"a nfo:FileDataObject ; nie:url <{self.uri(link)}>",
+            timeout=cfg.AWAIT_TIMEOUT,
+        ):
+            with self.tracker.await_delete(
+                fixtures.DOCUMENTS_GRAPH, deleted_id, timeout=cfg.AWAIT_TIMEOUT
+            ):
+                os.link(self.path(source), self.path(link))
+                os.unlink(self.path(deleted))
+                self.reindex()
+
+        self.assertResourceExists(self.uri(source))
+        self.assertResourceExists(self.uri(link))
+        self.assertTrue(self.file_has_tag(source, "linked"))
+        self.assertFalse(self.file_has_tag(link, "linked"))
+
+    def test_03_directory_rename_is_move(self):
+        """
+        A renamed directory keeps its indexed resource, and its tags.
+        """
+        source = "test-monitored/dir"
+        dest = "test-monitored/renamed-dir"
+        self.require_birth_time(source)
+        resource_id = self.tracker.get_content_resource_id(self.uri(source))
+        self.tag_file(source, "moved")
+
+        with self.tracker.await_property_update(
+            fixtures.FILESYSTEM_GRAPH,
+            resource_id,
+            f"nie:isStoredAs <{self.uri(source)}>",
+            f"nie:isStoredAs <{self.uri(dest)}>",
+            timeout=cfg.AWAIT_TIMEOUT,
+        ):
+            os.rename(self.path(source), self.path(dest))
+            self.reindex()
+
+        self.assertEqual(
+            self.tracker.get_content_resource_id(self.uri(dest)), resource_id
+        )
+        self.assertTrue(self.file_has_tag(dest, "moved"))
+        self.assertResourceExists(self.uri(dest + "/file3.txt"))
+        self.assertResourceMissing(self.uri(source + "/file3.txt"))
+
+    def test_04_reused_inode_is_not_move(self):
+        """
+        A directory created in place of a deleted one may get the same
+        inode number, that does not make it the same directory.
+        """
+        source = "test-monitored/dir"
+        stale = "test-monitored/dir/file3.txt"
+        self.require_birth_time(source)
+        inode = os.stat(self.path(source)).st_ino
+        stale_id = self.tracker.get_content_resource_id(self.uri(stale))
+
+        shutil.rmtree(self.path(source))
+        # Birth times are compared to the second
+        time.sleep(1)
+        dest = self.make_dir_with_inode(inode)
+        if dest is None:
+            self.skipTest("The filesystem did not reuse the inode")
+
+        with self.await_insert_dir(dest):
+            with self.tracker.await_delete(
+                fixtures.DOCUMENTS_GRAPH, stale_id, timeout=cfg.AWAIT_TIMEOUT
+            ):
+                self.reindex()
+
+        self.assertResourceMissing(self.uri(source))
+        self.assertResourceMissing(self.uri(dest + "/file3.txt"))
+
+
+if __name__ == "__main__":
+    fixtures.tracker_test_main()
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/* Runs a fuzz target over the files given in the command line, for
+ * builds without libFuzzer. This is used to run the corpus as a test.
+ */
+
+#include "config-miners.h"
+
+#include <glib.h>
+
+int LLVMFuzzerTestOneInput (const unsigned char *data,
+                            size_t               size);
+
+int
+main (int argc, char **argv)
+{
+	gint i;
+
+	for (i = 1; i < argc; i++) {
+		g_autofree gchar *contents = NULL;
+		g_autoptr (GError) error = NULL;
+		gsize len;
+
+		if (!g_file_get_contents (argv[i], &contents, &len, &error)) {
+			g_printerr ("%s: %s\n", argv[i], error->message);
+			return 1;
+		}
+
+		LLVMFuzzerTestOneInput ((const unsigned char *) contents, len);
+	}
+
+	/* And some input that is definitely not a zip file */
+	LLVMFuzzerTestOneInput ((const unsigned char *) "PK\x03\x04", 4);
+
+	return 0;
+}
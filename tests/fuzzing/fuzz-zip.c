@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include "config-miners.h"
+
+#include <gio/gio.h>
+
+#include "tracker-gsf.h"
+
+#define MAX_TEXT (1 << 20)
+
+static void
+text_cb (GMarkupParseContext  *context,
+         const gchar          *text,
+         gsize                 text_len,
+         gpointer              user_data,
+         GError              **error)
+{
+	gsize *remaining = user_data;
+
+	/* Behave like extractors, which stop at the text limit */
+	if (*remaining < text_len) {
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+		                     "Maximum text limit reached");
+		return;
+	}
+
+	*remaining -= text_len;
+}
+
+int
+LLVMFuzzerTestOneInput (const unsigned char *data,
+                        size_t               size)
+{
+	/* Members looked up by the OOXML, ODF and EPUB extractors */
+	const gchar *members[] = {
+		"[Content_Types].xml",
+		"word/document.xml",
+		"meta.xml",
+		"content.xml",
+		"META-INF/container.xml",
+		"./OEBPS/content.opf",
+	};
+	GMarkupParser parser = { NULL, NULL, text_cb, NULL, NULL };
+	g_autoptr (TrackerZip) zip = NULL;
+	gsize remaining = MAX_TEXT;
+	guint i;
+
+	zip = tracker_zip_open_from_data (data, size, NULL);
+	if (!zip)
+		return 0;
+
+	for (i = 0; i < G_N_ELEMENTS (members); i++) {
+		GMarkupParseContext *context;
+
+		context = g_markup_parse_context_new (&parser, 0, &remaining, NULL);
+		tracker_zip_parse_xml (zip, members[i], context, NULL);
+		g_markup_parse_context_free (context);
+	}
+
+	return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include "config-miners.h"
+
+#include <glib.h>
+
+#include "tracker-decorator-device.h"
+
+typedef struct {
+	const gchar *name;
+	const gchar *content_id;
+	TrackerDecoratorDevice *device;
+} TestItem;
+
+static TrackerDecoratorDevice *
+test_item_get_device (gconstpointer item)
+{
+	const TestItem *test_item = item;
+
+	return test_item->device;
+}
+
+static void
+test_decorator_device_lookup (void)
+{
+	g_autoptr (GHashTable) devices = NULL;
+	TrackerDecoratorDevice *device;
+
+	devices = tracker_decorator_device_table_new ();
+
+	device = tracker_decorator_device_lookup (devices, "urn:fileid:aaaa:1");
+	g_assert_cmpstr (device->id, ==, "aaaa");
+	g_assert_true (tracker_decorator_device_lookup (devices, "urn:fileid:aaaa:2") == device);
+	g_assert_true (tracker_decorator_device_lookup (devices, "urn:fileid:bbbb:1") != device);
+
+	device = tracker_decorator_device_lookup (devices, "file:///a");
+	g_assert_cmpstr (device->id, ==, "unknown");
+	g_assert_true (tracker_decorator_device_lookup (devices, NULL) == device);
+
+	g_assert_cmpuint (g_hash_table_size (devices), ==, 3);
+}
+
+static void
+test_decorator_device_rotation (void)
+{
+	TestItem items[] = {
+		{ "A1", "urn:fileid:aaaa:1", NULL },
+		{ "A2", "urn:fileid:aaaa:2", NULL },
+		{ "A3", "urn:fileid:aaaa:3", NULL },
+		{ "A4", "urn:fileid:aaaa:4", NULL },
+		{ "B1", "urn:fileid:bbbb:1", NULL },
+		{ "B2", "urn:fileid:bbbb:2", NULL },
+	};
+	const gchar *expected[] = { "A1", "B1", "A2", "B2", "A3", "A4" };
+	g_autoptr (GHashTable) devices = NULL;
+	GList *queue = NULL;
+	guint64 n_served = 0;
+	guint i;
+
+	devices = tracker_decorator_device_table_new ();
+
+	for (i = 0; i < G_N_ELEMENTS (items); i++) {
+		items[i].device = tracker_decorator_device_lookup (devices,
+		                                                   items[i].content_id);
+		queue = g_list_append (queue, &items[i]);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (expected); i++) {
+		TestItem *item;
+		GList *next;
+
+		next = tracker_decorator_device_find_next (queue, test_item_get_device);
+		g_assert_nonnull (next);
+
+		item = next->data;
+		g_assert_cmpstr (item->name, ==, expected[i]);
+
+		item->device->last_served = ++n_served;
+		queue = g_list_delete_link (queue, next);
+	}
+
+	g_assert_null (queue);
+	g_assert_null (tracker_decorator_device_find_next (NULL, test_item_get_device));
+}
+
+int
+main (int argc, char **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-extract/tracker-decorator-device/lookup",
+	                 test_decorator_device_lookup);
+	g_test_add_func ("/libtracker-extract/tracker-decorator-device/rotation",
+	                 test_decorator_device_rotation);
+
+	return g_test_run ();
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include "config-miners.h"
+
+#include <string.h>
+
+#include <glib-object.h>
+
+#include <libtracker-extract/tracker-extract.h>
+
+#define TITLE_XMP \
+"<x:xmpmeta xmlns:x=\"adobe:ns:meta/\"" \
+"           xmlns:dc=\"http://purl.org/dc/elements/1.1/\"" \
+"           xmlns:exif=\"http://ns.adobe.com/exif/1.0/\">" \
+"  <rdf:RDF xmlns:rdf=\"http://www.w3.org/1999/02/22-rdf-syntax-ns#\">" \
+"    <rdf:Description rdf:about=\"\">" \
+"      <dc:title>Title in xmp</dc:title>" \
+"      <exif:Make>Make in xmp</exif:Make>" \
+"    </rdf:Description>" \
+"  </rdf:RDF>" \
+"</x:xmpmeta>"
+
+static TrackerImageMetadata *
+create_metadata (void)
+{
+	GFile *file;
+	TrackerImageMetadata *metadata;
+
+	file = g_file_new_for_path (TOP_SRCDIR "/tests/libtracker-extract/exif-img.jpg");
+	metadata = tracker_image_metadata_new (file);
+	g_object_unref (file);
+
+	return metadata;
+}
+
+static void
+test_image_metadata_merge (void)
+{
+	TrackerImageMetadata *metadata;
+	TrackerResource *resource, *equipment;
+	gchar *blob;
+	gsize length;
+
+	g_assert_true (g_file_get_contents (TOP_SRCDIR "/tests/libtracker-extract/exif-img.jpg", &blob, &length, NULL));
+
+	metadata = create_metadata ();
+	g_assert_true (tracker_image_metadata_add_exif (metadata, (guchar *) blob, length));
+	g_assert_true (tracker_image_metadata_add_xmp (metadata, TITLE_XMP, strlen (TITLE_XMP)));
+
+	/* Further blocks of the same kind are not parsed */
+	g_assert_false (tracker_image_metadata_add_exif (metadata, (guchar *) blob, length));
+	g_assert_false (tracker_image_metadata_add_xmp (metadata, TITLE_XMP, strlen (TITLE_XMP)));
+
+	resource = tracker_resource_new ("test://file");
+	tracker_image_metadata_apply_to_resource (metadata, resource);
+
+	/* XMP has precedence over EXIF */
+	g_assert_cmpstr (tracker_resource_get_first_string (resource, "nie:title"), ==, "Title in xmp");
+
+	equipment = tracker_resource_get_first_relation (resource, "nfo:equipment");
+	g_assert_nonnull (equipment);
+	g_assert_cmpstr (tracker_resource_get_first_string (equipment, "nfo:manufacturer"), ==, "Make in xmp");
+
+	/* EXIF fills in the rest */
+	g_assert_cmpstr (tracker_resource_get_first_string (equipment, "nfo:model"), ==, "SD3000");
+	g_assert_cmpstr (tracker_resource_get_first_string (resource, "nie:description"), ==, "Justfortest");
+	g_assert_cmpfloat (tracker_resource_get_first_double (resource, "nmm:fnumber"), ==, 5.6);
+	g_assert_cmpfloat (tracker_resource_get_first_double (resource, "nfo:horizontalResolution"), ==, 72);
+
+	g_object_unref (resource);
+	tracker_image_metadata_free (metadata);
+	g_free (blob);
+}
+
+static void
+test_image_metadata_take_exif (void)
+{
+	TrackerImageMetadata *metadata;
+	TrackerResource *resource;
+	TrackerExifData *data;
+
+	metadata = create_metadata ();
+
+	data = g_new0 (TrackerExifData, 1);
+	data->document_name = g_strdup ("Title in container");
+	data->x_resolution = g_strdup ("100");
+	data->resolution_unit = EXIF_RESOLUTION_UNIT_PER_CENTIMETER;
+	g_assert_true (tracker_image_metadata_take_exif (metadata, data));
+
+	data = g_new0 (TrackerExifData, 1);
+	g_assert_false (tracker_image_metadata_take_exif (metadata, data));
+
+	resource = tracker_resource_new ("test://file");
+	tracker_image_metadata_apply_to_resource (metadata, resource);
+
+	g_assert_cmpstr (tracker_resource_get_first_string (resource, "nie:title"), ==, "Title in container");
+	g_assert_cmpfloat_with_epsilon (tracker_resource_get_first_double (resource, "nfo:horizontalResolution"), 254, 0.001);
+
+	g_object_unref (resource);
+	tracker_image_metadata_free (metadata);
+}
+
+int
+main (int argc, char **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-extract/image-metadata/merge",
+	                 test_image_metadata_merge);
+	g_test_add_func ("/libtracker-extract/image-metadata/take-exif",
+	                 test_image_metadata_take_exif);
+
+	return g_test_run ();
+}
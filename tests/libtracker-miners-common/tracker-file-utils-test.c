@@ -395,6 +395,23 @@ test_file_utils_cmp ()
         g_assert_true (tracker_file_cmp (two, three));
 }
 
+static void
+test_content_identifier_get_filesystem_id (void)
+{
+	g_autofree gchar *id = NULL, *other_id = NULL;
+
+	id = tracker_content_identifier_get_filesystem_id ("urn:fileid:f00d-cafe:1234");
+	g_assert_cmpstr (id, ==, "f00d-cafe");
+
+	other_id = tracker_content_identifier_get_filesystem_id ("urn:fileid:f00d-cafe:5678");
+	g_assert_cmpstr (other_id, ==, id);
+
+	g_assert_null (tracker_content_identifier_get_filesystem_id (NULL));
+	g_assert_null (tracker_content_identifier_get_filesystem_id ("urn:fileid:1234"));
+	g_assert_null (tracker_content_identifier_get_filesystem_id ("urn:fileid::1234"));
+	g_assert_null (tracker_content_identifier_get_filesystem_id ("file:///foo"));
+}
+
 int
 main (int argc, char **argv)
 {
@@ -432,6 +449,8 @@ main (int argc, char **argv)
                          test_file_utils_is_hidden);
         g_test_add_func ("/libtracker-common/file-utils/cmp",
                          test_file_utils_cmp);
+	g_test_add_func ("/libtracker-common/file-utils/content_identifier_get_filesystem_id",
+	                 test_content_identifier_get_filesystem_id);
 
 	result = g_test_run ();
 
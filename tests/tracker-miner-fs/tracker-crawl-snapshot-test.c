@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+
+/* NOTE: We're not including tracker-miner.h here because this is private. */
+#include <tracker-crawl-snapshot.h>
+
+static const gchar *directories[] = { "", "a", "a/b", "c", NULL };
+
+typedef struct {
+	GFile *root;
+	TrackerCrawlSnapshot *snapshot;
+} TestFixture;
+
+static void
+record_directory (TrackerCrawlSnapshot *snapshot,
+                  GFile                *directory)
+{
+	g_autoptr (GFileInfo) info = NULL;
+	GError *error = NULL;
+
+	info = g_file_query_info (directory,
+	                          TRACKER_CRAWL_SNAPSHOT_ATTRIBUTES,
+	                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+	                          NULL, &error);
+	g_assert_no_error (error);
+
+	tracker_crawl_snapshot_add_directory (snapshot, directory, info);
+}
+
+static void
+fixture_setup (TestFixture   *fixture,
+               gconstpointer  data)
+{
+	g_autofree gchar *path = NULL;
+	gint i;
+
+	path = g_dir_make_tmp ("tracker-crawl-snapshot-test-XXXXXX", NULL);
+	g_assert_nonnull (path);
+	fixture->root = g_file_new_for_path (path);
+	fixture->snapshot = tracker_crawl_snapshot_new (fixture->root, "checksum");
+
+	for (i = 0; directories[i]; i++) {
+		g_autoptr (GFile) directory = NULL;
+
+		directory = g_file_resolve_relative_path (fixture->root, directories[i]);
+		g_file_make_directory (directory, NULL, NULL);
+		record_directory (fixture->snapshot, directory);
+	}
+
+	/* Nothing counts as modified in the second it was recorded */
+	tracker_crawl_snapshot_set_timestamp (fixture->snapshot, G_MAXINT64);
+}
+
+static void
+fixture_teardown (TestFixture   *fixture,
+                  gconstpointer  data)
+{
+	gint i;
+
+	for (i = g_strv_length ((gchar **) directories) - 1; i >= 0; i--) {
+		g_autoptr (GFile) directory = NULL;
+
+		directory = g_file_resolve_relative_path (fixture->root, directories[i]);
+		g_file_delete (directory, NULL, NULL);
+	}
+
+	tracker_crawl_snapshot_free (fixture->snapshot);
+	g_object_unref (fixture->root);
+}
+
+static GList *
+check_snapshot (TrackerCrawlSnapshot *snapshot)
+{
+	GError *error = NULL;
+	GList *changed;
+
+	changed = tracker_crawl_snapshot_check (snapshot, NULL, &error);
+	g_assert_no_error (error);
+
+	return changed;
+}
+
+static void
+test_crawl_snapshot_unchanged (TestFixture   *fixture,
+                               gconstpointer  data)
+{
+	GList *changed;
+
+	changed = check_snapshot (fixture->snapshot);
+	g_assert_null (changed);
+	g_assert_cmpuint (tracker_crawl_snapshot_get_n_directories (fixture->snapshot), ==, 4);
+}
+
+static void
+test_crawl_snapshot_changed (TestFixture   *fixture,
+                             gconstpointer  data)
+{
+	g_autoptr (GFile) directory = NULL;
+	g_autofree gchar *path = NULL;
+	GError *error = NULL;
+	GList *changed;
+
+	directory = g_file_resolve_relative_path (fixture->root, "a/b");
+	g_file_set_attribute_uint64 (directory, G_FILE_ATTRIBUTE_TIME_MODIFIED, 1000,
+	                             G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+	                             NULL, &error);
+	g_assert_no_error (error);
+
+	changed = check_snapshot (fixture->snapshot);
+	g_assert_cmpint (g_list_length (changed), ==, 1);
+	path = g_file_get_relative_path (fixture->root, changed->data);
+	g_assert_cmpstr (path, ==, "a/b");
+	g_list_free_full (changed, g_object_unref);
+
+	/* Recording the directory again makes it current */
+	record_directory (fixture->snapshot, directory);
+	changed = check_snapshot (fixture->snapshot);
+	g_assert_null (changed);
+}
+
+static void
+test_crawl_snapshot_racy (TestFixture   *fixture,
+                          gconstpointer  data)
+{
+	GList *changed;
+
+	/* Directories modified in the second they were recorded
+	 * may have changed without the mtime telling.
+	 */
+	tracker_crawl_snapshot_set_timestamp (fixture->snapshot,
+	                                      g_get_real_time () / G_USEC_PER_SEC - 60);
+
+	changed = check_snapshot (fixture->snapshot);
+	g_assert_cmpint (g_list_length (changed), ==, 3);
+	g_list_free_full (changed, g_object_unref);
+}
+
+static void
+test_crawl_snapshot_removed (TestFixture   *fixture,
+                             gconstpointer  data)
+{
+	g_autoptr (GFile) directory = NULL;
+	GList *changed;
+
+	directory = g_file_resolve_relative_path (fixture->root, "c");
+	g_assert_true (g_file_delete (directory, NULL, NULL));
+
+	/* The parent directory is the one to reconcile the removal */
+	changed = check_snapshot (fixture->snapshot);
+	g_assert_null (changed);
+	g_assert_cmpuint (tracker_crawl_snapshot_get_n_directories (fixture->snapshot), ==, 3);
+}
+
+static void
+test_crawl_snapshot_load (TestFixture   *fixture,
+                          gconstpointer  data)
+{
+	g_autoptr (GBytes) bytes = NULL, truncated = NULL;
+	g_autoptr (GFile) other_root = NULL;
+	TrackerCrawlSnapshot *snapshot;
+	GError *error = NULL;
+	GList *changed;
+
+	bytes = tracker_crawl_snapshot_serialize (fixture->snapshot);
+
+	snapshot = tracker_crawl_snapshot_load (fixture->root, "checksum", bytes, &error);
+	g_assert_no_error (error);
+	g_assert_cmpuint (tracker_crawl_snapshot_get_n_directories (snapshot), ==, 4);
+	changed = check_snapshot (snapshot);
+	g_assert_null (changed);
+	tracker_crawl_snapshot_free (snapshot);
+
+	/* Configuration changed */
+	snapshot = tracker_crawl_snapshot_load (fixture->root, "other", bytes, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_null (snapshot);
+	g_clear_error (&error);
+
+	/* Recorded for another root */
+	other_root = g_file_get_child (fixture->root, "a");
+	snapshot = tracker_crawl_snapshot_load (other_root, "checksum", bytes, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_null (snapshot);
+	g_clear_error (&error);
+
+	/* Corrupt */
+	truncated = g_bytes_new_from_bytes (bytes, 0, g_bytes_get_size (bytes) / 2);
+	snapshot = tracker_crawl_snapshot_load (fixture->root, "checksum", truncated, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_assert_null (snapshot);
+	g_clear_error (&error);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add ("/libtracker-miner/tracker-crawl-snapshot/unchanged",
+	            TestFixture, NULL,
+	            fixture_setup, test_crawl_snapshot_unchanged, fixture_teardown);
+	g_test_add ("/libtracker-miner/tracker-crawl-snapshot/changed",
+	            TestFixture, NULL,
+	            fixture_setup, test_crawl_snapshot_changed, fixture_teardown);
+	g_test_add ("/libtracker-miner/tracker-crawl-snapshot/racy",
+	            TestFixture, NULL,
+	            fixture_setup, test_crawl_snapshot_racy, fixture_teardown);
+	g_test_add ("/libtracker-miner/tracker-crawl-snapshot/removed",
+	            TestFixture, NULL,
+	            fixture_setup, test_crawl_snapshot_removed, fixture_teardown);
+	g_test_add ("/libtracker-miner/tracker-crawl-snapshot/load",
+	            TestFixture, NULL,
+	            fixture_setup, test_crawl_snapshot_load, fixture_teardown);
+
+	return g_test_run ();
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+/* NOTE: We're not including tracker-miner.h here because this is private. */
+#include <tracker-event-spill.h>
+
+static GFile *
+get_file (guint i)
+{
+	g_autofree gchar *path = NULL;
+
+	path = g_strdup_printf ("/test/dir-%u/file-%u", i % 7, i);
+
+	return g_file_new_for_path (path);
+}
+
+static void
+push_event (TrackerEventSpill *spill,
+            guint              i)
+{
+	g_autoptr (GFile) file = NULL, other_file = NULL;
+	GError *error = NULL;
+
+	file = get_file (i);
+	/* Every third event is a move */
+	if (i % 3 == 0)
+		other_file = get_file (i + 1000);
+
+	tracker_event_spill_push (spill, i % 5, i % 4, file, other_file, &error);
+	g_assert_no_error (error);
+}
+
+static void
+pop_event (TrackerEventSpill *spill,
+           guint              i)
+{
+	g_autoptr (GFile) file = NULL, other_file = NULL, expected = NULL;
+	GError *error = NULL;
+	guint type, flags;
+
+	g_assert_true (tracker_event_spill_pop (spill, &type, &flags,
+	                                        &file, &other_file, &error));
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (type, ==, i % 5);
+	g_assert_cmpuint (flags, ==, i % 4);
+
+	expected = get_file (i);
+	g_assert_true (g_file_equal (file, expected));
+	g_clear_object (&expected);
+
+	if (i % 3 == 0) {
+		expected = get_file (i + 1000);
+		g_assert_nonnull (other_file);
+		g_assert_true (g_file_equal (other_file, expected));
+	} else {
+		g_assert_null (other_file);
+	}
+}
+
+static void
+test_event_spill_order (void)
+{
+	TrackerEventSpill *spill;
+	GFile *file = NULL, *other_file = NULL;
+	guint i, type, flags;
+
+	spill = tracker_event_spill_new (NULL);
+	g_assert_cmpuint (tracker_event_spill_get_length (spill), ==, 0);
+	g_assert_false (tracker_event_spill_pop (spill, &type, &flags,
+	                                         &file, &other_file, NULL));
+
+	for (i = 0; i < 1000; i++)
+		push_event (spill, i);
+
+	g_assert_cmpuint (tracker_event_spill_get_length (spill), ==, 1000);
+
+	for (i = 0; i < 1000; i++)
+		pop_event (spill, i);
+
+	g_assert_cmpuint (tracker_event_spill_get_length (spill), ==, 0);
+	g_assert_false (tracker_event_spill_pop (spill, &type, &flags,
+	                                         &file, &other_file, NULL));
+
+	tracker_event_spill_free (spill);
+}
+
+static void
+test_event_spill_interleaved (void)
+{
+	TrackerEventSpill *spill;
+	guint pushed = 0, popped = 0, round;
+
+	spill = tracker_event_spill_new (NULL);
+
+	/* Events keep coming in while older ones are replayed */
+	for (round = 0; round < 10; round++) {
+		guint i;
+
+		for (i = 0; i < 50; i++)
+			push_event (spill, pushed++);
+
+		for (i = 0; i < 30; i++)
+			pop_event (spill, popped++);
+	}
+
+	g_assert_cmpuint (tracker_event_spill_get_length (spill), ==, pushed - popped);
+
+	while (popped < pushed)
+		pop_event (spill, popped++);
+
+	/* The spill is reusable once drained */
+	push_event (spill, pushed);
+	pop_event (spill, pushed);
+	g_assert_cmpuint (tracker_event_spill_get_length (spill), ==, 0);
+
+	tracker_event_spill_free (spill);
+}
+
+static void
+test_event_spill_directory (void)
+{
+	g_autofree gchar *tmp_dir = NULL, *spill_path = NULL;
+	g_autoptr (GFile) spill_dir = NULL;
+	TrackerEventSpill *spill;
+	guint i;
+
+	tmp_dir = g_dir_make_tmp ("tracker-event-spill-test-XXXXXX", NULL);
+	g_assert_nonnull (tmp_dir);
+	spill_path = g_build_filename (tmp_dir, "spill", NULL);
+	spill_dir = g_file_new_for_path (spill_path);
+
+	/* The directory is created as needed */
+	spill = tracker_event_spill_new (spill_dir);
+
+	for (i = 0; i < 100; i++)
+		push_event (spill, i);
+
+	g_assert_true (g_file_test (spill_path, G_FILE_TEST_IS_DIR));
+
+	for (i = 0; i < 100; i++)
+		pop_event (spill, i);
+
+	tracker_event_spill_free (spill);
+
+	/* Nothing is left behind */
+	g_assert_cmpint (g_rmdir (spill_path), ==, 0);
+	g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-miner/tracker-event-spill/order",
+	                 test_event_spill_order);
+	g_test_add_func ("/libtracker-miner/tracker-event-spill/interleaved",
+	                 test_event_spill_interleaved);
+	g_test_add_func ("/libtracker-miner/tracker-event-spill/directory",
+	                 test_event_spill_directory);
+
+	return g_test_run ();
+}
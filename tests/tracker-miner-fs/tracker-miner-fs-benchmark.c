@@ -0,0 +1,588 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/* Indexes a generated directory tree with a TrackerMinerFS that logs
+ * the same file and folder resources as localsearch does, and times
+ * the initial crawl, a restart without changes, a restart after all
+ * mtimes changed, and a restart after bulk moves and deletions.
+ *
+ * Each phase prints a JSON line with the wall clock time and the
+ * breakdown given by tracker_miner_fs_get_timings(), followed by a
+ * line per slab given by tracker_miner_fs_get_allocator_stats(). Big trees are
+ * best generated on a tmpfs or loop mounted image, see --root.
+ */
+
+#include "config-miners.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <tracker-miner-fs.h>
+#include <libtracker-miners-common/tracker-common.h>
+
+#include "tracker-benchmark-utils.h"
+
+typedef struct {
+	TrackerMinerFS parent_instance;
+	guint finished : 1;
+} BenchMiner;
+
+typedef struct {
+	TrackerMinerFSClass parent_class;
+} BenchMinerClass;
+
+typedef struct {
+	TrackerSparqlConnection *connection;
+	GFile *tree;
+	gchar *tree_path;
+	guint n_directories;
+	guint n_files;
+} Benchmark;
+
+G_DEFINE_TYPE (BenchMiner, bench_miner, TRACKER_TYPE_MINER_FS)
+
+static gchar *root_dir = NULL;
+static gint depth = 3;
+static gint fanout = 8;
+static gint files_per_directory = 16;
+static gint min_size = 0;
+static gint max_size = 4 * 1024 * 1024;
+static gdouble delete_ratio = 0.1;
+static gboolean in_memory = FALSE;
+static gboolean keep = FALSE;
+
+static GOptionEntry entries[] = {
+	{ "root", 'r', 0, G_OPTION_ARG_FILENAME, &root_dir,
+	  "Directory to generate the tree in (Defaults to the temporary directory)", "DIR" },
+	{ "depth", 'd', 0, G_OPTION_ARG_INT, &depth,
+	  "Depth of the generated tree", "N" },
+	{ "fanout", 'f', 0, G_OPTION_ARG_INT, &fanout,
+	  "Subdirectories per directory", "N" },
+	{ "files", 'n', 0, G_OPTION_ARG_INT, &files_per_directory,
+	  "Files per directory", "N" },
+	{ "min-size", 0, 0, G_OPTION_ARG_INT, &min_size,
+	  "Minimum file size, sizes are distributed logarithmically", "BYTES" },
+	{ "max-size", 0, 0, G_OPTION_ARG_INT, &max_size,
+	  "Maximum file size", "BYTES" },
+	{ "delete-ratio", 0, 0, G_OPTION_ARG_DOUBLE, &delete_ratio,
+	  "Ratio of files deleted in the bulk changes phase", "RATIO" },
+	{ "in-memory", 0, 0, G_OPTION_ARG_NONE, &in_memory,
+	  "Use an in-memory database", NULL },
+	{ "keep", 'k', 0, G_OPTION_ARG_NONE, &keep,
+	  "Keep the generated tree and database", NULL },
+	{ NULL }
+};
+
+static void
+bench_miner_process_file (TrackerMinerFS      *fs,
+                          GFile               *file,
+                          GFileInfo           *info,
+                          TrackerSparqlBuffer *buffer,
+                          gboolean             created)
+{
+	TrackerIndexingTree *indexing_tree;
+	g_autoptr (TrackerResource) resource = NULL, folder_resource = NULL;
+	g_autoptr (GDateTime) modified = NULL;
+	g_autoptr (GFile) parent = NULL;
+	g_autofree gchar *uri = NULL;
+	const gchar *parent_urn;
+	GFile *root;
+	gboolean is_root;
+
+	uri = g_file_get_uri (file);
+	indexing_tree = tracker_miner_fs_get_indexing_tree (fs);
+	is_root = tracker_indexing_tree_file_is_root (indexing_tree, file);
+
+	modified = g_file_info_get_modification_date_time (info);
+	if (!modified)
+		modified = g_date_time_new_from_unix_utc (0);
+
+	resource = tracker_resource_new (uri);
+	tracker_resource_add_uri (resource, "rdf:type", "nfo:FileDataObject");
+
+	parent = g_file_get_parent (file);
+	parent_urn = tracker_miner_fs_get_identifier (fs, parent);
+	if (parent_urn)
+		tracker_resource_set_uri (resource, "nfo:belongsToContainer", parent_urn);
+
+	tracker_resource_set_string (resource, "nfo:fileName",
+	                             g_file_info_get_display_name (info));
+	tracker_resource_set_int64 (resource, "nfo:fileSize",
+	                            g_file_info_get_size (info));
+	tracker_resource_set_datetime (resource, "nfo:fileLastModified", modified);
+	tracker_resource_set_string (resource, "nie:url", uri);
+
+	root = tracker_indexing_tree_get_root (indexing_tree, file, NULL);
+
+	if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY) {
+		g_autoptr (TrackerResource) file_resource = NULL;
+
+		folder_resource = tracker_resource_new (tracker_miner_fs_get_identifier (fs, file));
+		tracker_resource_add_uri (folder_resource, "rdf:type", "nie:InformationElement");
+		tracker_resource_add_uri (folder_resource, "rdf:type", "nfo:Folder");
+		tracker_resource_set_string (folder_resource, "nie:mimeType", "inode/directory");
+
+		if (is_root) {
+			tracker_resource_add_uri (folder_resource, "rdf:type", "tracker:IndexedFolder");
+			tracker_resource_set_boolean (folder_resource, "tracker:available", TRUE);
+			tracker_resource_set_uri (folder_resource, "nie:rootElementOf",
+			                          tracker_resource_get_identifier (folder_resource));
+		}
+
+		file_resource = tracker_resource_new (uri);
+		tracker_resource_add_uri (file_resource, "rdf:type", "nfo:FileDataObject");
+		tracker_resource_set_relation (folder_resource, "nie:isStoredAs", file_resource);
+		tracker_resource_set_uri (file_resource, "nie:interpretedAs",
+		                          tracker_resource_get_identifier (folder_resource));
+
+		if (root) {
+			tracker_resource_set_uri (resource, "nie:dataSource",
+			                          tracker_miner_fs_get_identifier (fs, root));
+			tracker_resource_set_uri (folder_resource, "nie:dataSource",
+			                          tracker_miner_fs_get_identifier (fs, root));
+		}
+
+		tracker_sparql_buffer_log_folder (buffer, file, is_root,
+		                                  resource, folder_resource);
+	} else {
+		if (root) {
+			tracker_resource_set_uri (resource, "nie:dataSource",
+			                          tracker_miner_fs_get_identifier (fs, root));
+		}
+
+		tracker_sparql_buffer_log_file (buffer, file, NULL, resource, NULL);
+	}
+}
+
+static void
+bench_miner_process_file_attributes (TrackerMinerFS      *fs,
+                                     GFile               *file,
+                                     GFileInfo           *info,
+                                     TrackerSparqlBuffer *buffer)
+{
+	bench_miner_process_file (fs, file, info, buffer, FALSE);
+}
+
+static void
+bench_miner_remove_file (TrackerMinerFS      *fs,
+                         GFile               *file,
+                         TrackerSparqlBuffer *buffer,
+                         gboolean             is_dir)
+{
+	if (is_dir)
+		tracker_sparql_buffer_log_delete_content (buffer, file);
+	tracker_sparql_buffer_log_delete (buffer, file);
+}
+
+static void
+bench_miner_remove_children (TrackerMinerFS      *fs,
+                             GFile               *file,
+                             TrackerSparqlBuffer *buffer)
+{
+	tracker_sparql_buffer_log_delete_content (buffer, file);
+}
+
+static void
+bench_miner_move_file (TrackerMinerFS      *fs,
+                       GFile               *dest,
+                       GFile               *source,
+                       TrackerSparqlBuffer *buffer,
+                       gboolean             recursive)
+{
+	g_autofree gchar *data_source = NULL;
+	GFile *root;
+
+	root = tracker_indexing_tree_get_root (tracker_miner_fs_get_indexing_tree (fs),
+	                                       dest, NULL);
+	if (root)
+		data_source = g_file_get_uri (root);
+
+	tracker_sparql_buffer_log_move (buffer, source, dest, data_source);
+	if (recursive)
+		tracker_sparql_buffer_log_move_content (buffer, source, dest);
+}
+
+static void
+bench_miner_finished (TrackerMinerFS *fs,
+                      gdouble         elapsed,
+                      gint            directories_found,
+                      gint            directories_ignored,
+                      gint            files_found,
+                      gint            files_ignored)
+{
+	((BenchMiner *) fs)->finished = TRUE;
+}
+
+static void
+bench_miner_class_init (BenchMinerClass *klass)
+{
+	TrackerMinerFSClass *fs_class = TRACKER_MINER_FS_CLASS (klass);
+
+	fs_class->process_file = bench_miner_process_file;
+	fs_class->process_file_attributes = bench_miner_process_file_attributes;
+	fs_class->remove_file = bench_miner_remove_file;
+	fs_class->remove_children = bench_miner_remove_children;
+	fs_class->move_file = bench_miner_move_file;
+	fs_class->finished = bench_miner_finished;
+}
+
+static void
+bench_miner_init (BenchMiner *miner)
+{
+}
+
+static gboolean
+create_file (const gchar  *path,
+             gsize         size,
+             GError      **error)
+{
+	int fd;
+
+	fd = g_open (path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0 || ftruncate (fd, size) < 0) {
+		int saved_errno = errno;
+
+		if (fd >= 0)
+			close (fd);
+
+		g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+		             "Could not create %s: %s", path, g_strerror (saved_errno));
+		return FALSE;
+	}
+
+	close (fd);
+
+	return TRUE;
+}
+
+static gsize
+random_size (GRand *rand)
+{
+	gdouble min, max;
+
+	if (max_size <= min_size)
+		return min_size;
+
+	/* Log-uniform, so there are many more small files than big ones */
+	min = log (MAX (min_size, 1));
+	max = log (max_size);
+
+	return (gsize) exp (g_rand_double_range (rand, min, max));
+}
+
+static gboolean
+generate_directory (Benchmark    *bench,
+                    GRand        *rand,
+                    const gchar  *path,
+                    gint          level,
+                    GError      **error)
+{
+	gint i;
+
+	for (i = 0; i < files_per_directory; i++) {
+		g_autofree gchar *name = NULL, *child = NULL;
+
+		name = g_strdup_printf ("file-%d.dat", i);
+		child = g_build_filename (path, name, NULL);
+
+		if (!create_file (child, random_size (rand), error))
+			return FALSE;
+
+		bench->n_files++;
+	}
+
+	if (level >= depth)
+		return TRUE;
+
+	for (i = 0; i < fanout; i++) {
+		g_autofree gchar *name = NULL, *child = NULL;
+
+		name = g_strdup_printf ("dir-%d", i);
+		child = g_build_filename (path, name, NULL);
+
+		if (g_mkdir (child, 0755) < 0) {
+			int saved_errno = errno;
+
+			g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+			             "Could not create %s: %s", child, g_strerror (saved_errno));
+			return FALSE;
+		}
+
+		bench->n_directories++;
+
+		if (!generate_directory (bench, rand, child, level + 1, error))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gint64 touch_time = 0;
+
+static int
+touch_cb (const char        *path,
+          const struct stat *st,
+          int                flag,
+          struct FTW        *ftw)
+{
+	struct timeval times[2] = { 0, };
+
+	times[0].tv_sec = times[1].tv_sec = touch_time;
+	utimes (path, times);
+
+	return 0;
+}
+
+static guint n_deleted = 0;
+static GRand *delete_rand = NULL;
+
+static int
+delete_cb (const char        *path,
+           const struct stat *st,
+           int                flag,
+           struct FTW        *ftw)
+{
+	if (flag == FTW_F && g_rand_double (delete_rand) < delete_ratio) {
+		g_remove (path);
+		n_deleted++;
+	}
+
+	return 0;
+}
+
+static gboolean
+apply_bulk_changes (Benchmark  *bench,
+                    GError    **error)
+{
+	guint n_moved = 0;
+	gint i;
+
+	/* Rename every other top level directory */
+	for (i = 0; i < fanout; i += 2) {
+		g_autofree gchar *name = NULL, *new_name = NULL;
+		g_autofree gchar *path = NULL, *new_path = NULL;
+
+		name = g_strdup_printf ("dir-%d", i);
+		new_name = g_strdup_printf ("moved-%d", i);
+		path = g_build_filename (bench->tree_path, name, NULL);
+		new_path = g_build_filename (bench->tree_path, new_name, NULL);
+
+		if (g_rename (path, new_path) < 0) {
+			int saved_errno = errno;
+
+			g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+			             "Could not move %s: %s", path, g_strerror (saved_errno));
+			return FALSE;
+		}
+
+		n_moved++;
+	}
+
+	delete_rand = g_rand_new_with_seed (0xde1);
+	nftw (bench->tree_path, delete_cb, 64, FTW_PHYS);
+	g_rand_free (delete_rand);
+	bench->n_files -= n_deleted;
+
+	g_printerr ("Moved %u directories, deleted %u files\n", n_moved, n_deleted);
+
+	return TRUE;
+}
+
+static void
+print_values (GVariant *dict)
+{
+	GVariantIter iter;
+	const gchar *key;
+	GVariant *value;
+
+	g_variant_iter_init (&iter, dict);
+
+	while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+		if (g_variant_is_of_type (value, G_VARIANT_TYPE_DOUBLE))
+			g_print (",\"%s\":%.3f", key, g_variant_get_double (value));
+		else if (g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32))
+			g_print (",\"%s\":%u", key, g_variant_get_uint32 (value));
+
+		g_variant_unref (value);
+	}
+}
+
+static void
+print_timings (const gchar *phase,
+               Benchmark   *bench,
+               gdouble      wall,
+               GVariant    *timings)
+{
+	g_print ("{\"phase\":\"%s\",\"directories\":%u,\"files\":%u,\"wall_s\":%.3f",
+	         phase, bench->n_directories, bench->n_files, wall);
+	print_values (timings);
+	g_print ("}\n");
+}
+
+/* One line per slab, e.g. to compare peak usage and fragmentation */
+static void
+print_allocator_stats (const gchar *phase,
+                       GVariant    *stats)
+{
+	GVariantIter iter;
+	const gchar *key;
+	GVariant *value;
+
+	g_variant_iter_init (&iter, stats);
+
+	while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+		g_print ("{\"phase\":\"%s\",\"slab\":\"%s\"", phase, key);
+		print_values (value);
+		g_print ("}\n");
+		g_variant_unref (value);
+	}
+}
+
+static void
+run_phase (Benchmark   *bench,
+           const gchar *phase)
+{
+	g_autoptr (TrackerIndexingTree) indexing_tree = NULL;
+	g_autoptr (GVariant) timings = NULL, allocator_stats = NULL;
+	g_autoptr (GTimer) timer = NULL;
+	BenchMiner *miner;
+
+	indexing_tree = tracker_indexing_tree_new ();
+	miner = g_object_new (bench_miner_get_type (),
+	                      "indexing-tree", indexing_tree,
+	                      "connection", bench->connection,
+	                      "file-attributes", "standard::*,time::*",
+	                      NULL);
+
+	tracker_indexing_tree_add (indexing_tree, bench->tree,
+	                           TRACKER_DIRECTORY_FLAG_RECURSE |
+	                           TRACKER_DIRECTORY_FLAG_CHECK_MTIME);
+
+	timer = g_timer_new ();
+	tracker_miner_start (TRACKER_MINER (miner));
+
+	while (!miner->finished)
+		g_main_context_iteration (NULL, TRUE);
+
+	timings = g_variant_ref_sink (tracker_miner_fs_get_timings (TRACKER_MINER_FS (miner)));
+	print_timings (phase, bench, g_timer_elapsed (timer, NULL), timings);
+
+	allocator_stats = g_variant_ref_sink (tracker_miner_fs_get_allocator_stats (TRACKER_MINER_FS (miner)));
+	print_allocator_stats (phase, allocator_stats);
+
+	g_object_unref (miner);
+}
+
+int
+main (int argc, char *argv[])
+{
+	g_autoptr (GOptionContext) context = NULL;
+	g_autoptr (GFile) ontology = NULL, db = NULL;
+	g_autofree gchar *base_path = NULL, *db_path = NULL;
+	g_autoptr (GTimer) timer = NULL;
+	g_autoptr (GRand) rand = NULL;
+	Benchmark bench = { 0, };
+	GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+		goto error;
+
+	base_path = g_build_filename (root_dir ? root_dir : g_get_tmp_dir (),
+	                              "tracker-miner-fs-benchmark-XXXXXX", NULL);
+	if (!g_mkdtemp (base_path)) {
+		g_set_error (&error, G_IO_ERROR, g_io_error_from_errno (errno),
+		             "Could not create %s: %s", base_path, g_strerror (errno));
+		goto error;
+	}
+
+	bench.tree_path = g_build_filename (base_path, "tree", NULL);
+	bench.tree = g_file_new_for_path (bench.tree_path);
+	g_mkdir (bench.tree_path, 0755);
+	bench.n_directories = 1;
+
+	timer = g_timer_new ();
+	/* Fixed seed, so every run generates the same tree */
+	rand = g_rand_new_with_seed (0x5eed);
+
+	if (!generate_directory (&bench, rand, bench.tree_path, 1, &error))
+		goto error;
+
+	g_printerr ("Generated %u directories and %u files in %.3f seconds\n",
+	            bench.n_directories, bench.n_files, g_timer_elapsed (timer, NULL));
+
+	if (!in_memory) {
+		db_path = g_build_filename (base_path, "db", NULL);
+		db = g_file_new_for_path (db_path);
+	}
+
+	ontology = tracker_sparql_get_ontology_nepomuk ();
+	bench.connection = tracker_sparql_connection_new (0, db, ontology, NULL, &error);
+	if (!bench.connection)
+		goto error;
+
+	if (!tracker_sparql_connection_update (bench.connection,
+	                                       "CREATE SILENT GRAPH tracker:FileSystem",
+	                                       NULL, &error))
+		goto error;
+
+	run_phase (&bench, "initial-crawl");
+	run_phase (&bench, "no-change-restart");
+
+	/* Move all mtimes one hour ahead */
+	touch_time = (g_get_real_time () / G_USEC_PER_SEC) + 3600;
+	nftw (bench.tree_path, touch_cb, 64, FTW_PHYS);
+	run_phase (&bench, "mtime-sweep");
+
+	if (!apply_bulk_changes (&bench, &error))
+		goto error;
+	run_phase (&bench, "bulk-move-delete");
+
+	g_object_unref (bench.connection);
+	g_object_unref (bench.tree);
+
+	if (keep)
+		g_printerr ("Tree and database kept at %s\n", base_path);
+	else
+		tracker_benchmark_remove_tree (base_path);
+
+	g_free (bench.tree_path);
+
+	return EXIT_SUCCESS;
+
+ error:
+	g_printerr ("%s\n", error->message);
+	g_error_free (error);
+
+	if (base_path && !keep)
+		tracker_benchmark_remove_tree (base_path);
+
+	return EXIT_FAILURE;
+}
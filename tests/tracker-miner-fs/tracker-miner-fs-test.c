@@ -1821,6 +1821,73 @@ test_event_queue_move_and_move_back (TrackerMinerFSTestFixture *fixture,
 	g_free (content);
 }
 
+static void
+fixture_enable_crawl_snapshots (TrackerMinerFSTestFixture *fixture)
+{
+	g_autoptr (GFile) snapshot_dir = NULL;
+
+	snapshot_dir = g_file_get_child (fixture->test_root, ".snapshots");
+	tracker_miner_fs_set_crawl_snapshots (fixture->miner, snapshot_dir, "test");
+}
+
+static void
+test_crawl_snapshot_monitors (TrackerMinerFSTestFixture *fixture,
+                              gconstpointer              data)
+{
+	gchar *content;
+
+	CREATE_FOLDER (fixture, "recursive");
+	CREATE_FOLDER (fixture, "recursive/1");
+	CREATE_FOLDER (fixture, "recursive/2");
+	CREATE_UPDATE_FILE (fixture, "recursive/1/a");
+
+	/* Directories changed within the second of the crawl are
+	 * always rechecked, make them predate it.
+	 */
+	g_usleep (2 * G_USEC_PER_SEC);
+
+	fixture_enable_crawl_snapshots (fixture);
+	fixture_add_indexed_folder (fixture, "recursive",
+	                            TRACKER_DIRECTORY_FLAG_MONITOR |
+	                            TRACKER_DIRECTORY_FLAG_CHECK_MTIME |
+	                            TRACKER_DIRECTORY_FLAG_RECURSE);
+
+	tracker_miner_start (TRACKER_MINER (fixture->miner));
+
+	fixture_iterate (fixture);
+
+	/* Restart the miner, it resumes from the crawl snapshot */
+	g_object_unref (fixture->miner);
+	fixture->miner = test_miner_new (fixture->connection);
+
+	fixture_enable_crawl_snapshots (fixture);
+	fixture_add_indexed_folder (fixture, "recursive",
+	                            TRACKER_DIRECTORY_FLAG_MONITOR |
+	                            TRACKER_DIRECTORY_FLAG_CHECK_MTIME |
+	                            TRACKER_DIRECTORY_FLAG_RECURSE);
+
+	tracker_miner_start (TRACKER_MINER (fixture->miner));
+
+	fixture_iterate (fixture);
+
+	/* Nothing changed, nothing was processed */
+	g_assert_cmpint (((TestMiner *) fixture->miner)->n_process_file, ==, 0);
+
+	/* Unchanged directories are monitored anyway */
+	CREATE_UPDATE_FILE (fixture, "recursive/2/b");
+
+	fixture_iterate (fixture);
+
+	content = fixture_get_content (fixture);
+	g_assert_cmpstr (content, ==,
+	                 "recursive,"
+	                 "recursive/1,"
+	                 "recursive/1/a,"
+	                 "recursive/2,"
+	                 "recursive/2/b");
+	g_free (content);
+}
+
 gint
 main (gint    argc,
       gchar **argv)
@@ -1905,5 +1972,9 @@ main (gint    argc,
 	ADD_TEST ("event-queue/move-and-move-back",
 	          test_event_queue_move_and_move_back);
 
+	/* Tests for resuming crawls from snapshots */
+	ADD_TEST ("/crawl-snapshot/monitors",
+	          test_crawl_snapshot_monitors);
+
 	return g_test_run ();
 }
@@ -0,0 +1,821 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+/* Replays bursts of filesystem operations against each TrackerMonitor
+ * backend, and measures how many changes went unnoticed, how much the
+ * events were coalesced, the latency between each operation and the
+ * signal reporting it, and the CPU time spent by the monitor.
+ *
+ * Operations are replayed from a child process, so the CPU time of the
+ * benchmark process is that of the monitor. Traces are either generated
+ * (untar, checkout, rsync-delete) or read from a file with one
+ * operation per line:
+ *
+ *   mkdir|rmdir|create|write|delete PATH
+ *   move PATH DEST
+ *
+ * Paths are relative to the monitored directory, and operations
+ * before a "---" line are applied before monitoring starts.
+ */
+
+#include "config-miners.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <tracker-monitor.h>
+#include <tracker-monitor-glib.h>
+#ifdef HAVE_FANOTIFY
+#include <tracker-monitor-fanotify.h>
+#endif
+
+#include "tracker-benchmark-utils.h"
+
+typedef enum {
+	OP_MKDIR,
+	OP_RMDIR,
+	OP_CREATE,
+	OP_WRITE,
+	OP_DELETE,
+	OP_MOVE,
+} OpType;
+
+static const gchar *op_names[] = {
+	"mkdir", "rmdir", "create", "write", "delete", "move",
+};
+
+typedef struct {
+	OpType type;
+	gchar *path;
+	gchar *dest;
+	/* Absolute paths, set up before replaying */
+	gchar *abs_path;
+	gchar *abs_dest;
+} Op;
+
+typedef struct {
+	gchar *name;
+	GArray *setup;
+	GArray *trace;
+} Workload;
+
+typedef struct {
+	TrackerMonitor *monitor;
+	GFile *root;
+	Workload *workload;
+	/* Shared with the replaying child */
+	gint64 *timestamps;
+	/* Path -> GArray of trace indexes touching it */
+	GHashTable *ops_by_path;
+	/* Paths that got any signal */
+	GHashTable *notified;
+	GArray *latencies;
+	GArray *created_latencies;
+	guint n_signals;
+	gint64 last_signal;
+	gboolean replaying;
+} Run;
+
+static gint n_files = 5000;
+static gint settle_time = 5;
+static gchar *trace_file = NULL;
+static gchar *only_backend = NULL;
+static gchar *root_dir = NULL;
+
+static GOptionEntry entries[] = {
+	{ "files", 'n', 0, G_OPTION_ARG_INT, &n_files,
+	  "Number of files in the generated workloads", "N" },
+	{ "settle", 's', 0, G_OPTION_ARG_INT, &settle_time,
+	  "Seconds without signals after the replay to consider the monitor idle", "SECONDS" },
+	{ "trace", 't', 0, G_OPTION_ARG_FILENAME, &trace_file,
+	  "Replay this trace instead of the generated workloads", "FILE" },
+	{ "backend", 'b', 0, G_OPTION_ARG_STRING, &only_backend,
+	  "Only benchmark this backend (glib or fanotify)", "BACKEND" },
+	{ "root", 'r', 0, G_OPTION_ARG_FILENAME, &root_dir,
+	  "Directory to replay the traces in (Defaults to the temporary directory)", "DIR" },
+	{ NULL }
+};
+
+static void
+op_clear (Op *op)
+{
+	g_free (op->path);
+	g_free (op->dest);
+	g_free (op->abs_path);
+	g_free (op->abs_dest);
+}
+
+static void
+add_op (GArray      *array,
+        OpType       type,
+        const gchar *path,
+        const gchar *dest)
+{
+	Op op = { type, g_strdup (path), g_strdup (dest), NULL, NULL };
+
+	g_array_append_val (array, op);
+}
+
+static Workload *
+workload_new (const gchar *name)
+{
+	Workload *workload;
+
+	workload = g_new0 (Workload, 1);
+	workload->name = g_strdup (name);
+	workload->setup = g_array_new (FALSE, FALSE, sizeof (Op));
+	g_array_set_clear_func (workload->setup, (GDestroyNotify) op_clear);
+	workload->trace = g_array_new (FALSE, FALSE, sizeof (Op));
+	g_array_set_clear_func (workload->trace, (GDestroyNotify) op_clear);
+
+	return workload;
+}
+
+static void
+workload_free (Workload *workload)
+{
+	g_array_unref (workload->setup);
+	g_array_unref (workload->trace);
+	g_free (workload->name);
+	g_free (workload);
+}
+
+/* Lays out files in directories of 100 files, 10 directories per level */
+static gchar *
+file_path (gint i)
+{
+	return g_strdup_printf ("d%d/d%d/f%d", i / 1000, (i / 100) % 10, i);
+}
+
+static void
+add_tree (GArray *ops,
+          gint    count)
+{
+	gint i;
+
+	for (i = 0; i < count; i++) {
+		g_autofree gchar *path = NULL;
+
+		if (i % 1000 == 0) {
+			g_autofree gchar *dir = g_strdup_printf ("d%d", i / 1000);
+			add_op (ops, OP_MKDIR, dir, NULL);
+		}
+
+		if (i % 100 == 0) {
+			g_autofree gchar *dir = g_strdup_printf ("d%d/d%d", i / 1000, (i / 100) % 10);
+			add_op (ops, OP_MKDIR, dir, NULL);
+		}
+
+		path = file_path (i);
+		add_op (ops, OP_CREATE, path, NULL);
+	}
+}
+
+static Workload *
+generate_untar (void)
+{
+	Workload *workload = workload_new ("untar");
+
+	add_tree (workload->trace, n_files);
+
+	return workload;
+}
+
+static Workload *
+generate_checkout (void)
+{
+	Workload *workload = workload_new ("checkout");
+	g_autoptr (GRand) rand = g_rand_new_with_seed (0xc4ec);
+	gint i;
+
+	add_tree (workload->setup, n_files);
+
+	/* Git replaces changed files by unlinking and creating them */
+	for (i = 0; i < n_files; i++) {
+		g_autofree gchar *path = file_path (i);
+		gdouble p = g_rand_double (rand);
+
+		if (p < 0.4) {
+			add_op (workload->trace, OP_DELETE, path, NULL);
+			add_op (workload->trace, OP_CREATE, path, NULL);
+		} else if (p < 0.5) {
+			add_op (workload->trace, OP_DELETE, path, NULL);
+		}
+	}
+
+	for (i = 0; i < n_files / 10; i++) {
+		g_autofree gchar *existing = NULL, *dir = NULL, *path = NULL;
+
+		/* Spread new files over the existing directories */
+		existing = file_path ((i * 100) % n_files);
+		dir = g_path_get_dirname (existing);
+		path = g_strdup_printf ("%s/new%d", dir, i);
+		add_op (workload->trace, OP_CREATE, path, NULL);
+	}
+
+	return workload;
+}
+
+static Workload *
+generate_rsync_delete (void)
+{
+	Workload *workload = workload_new ("rsync-delete");
+	g_autoptr (GRand) rand = g_rand_new_with_seed (0x5bc);
+	gint i;
+
+	add_tree (workload->setup, n_files);
+
+	for (i = 0; i < n_files; i++) {
+		g_autofree gchar *path = file_path (i);
+
+		if (g_rand_double (rand) < 0.2)
+			add_op (workload->trace, OP_WRITE, path, NULL);
+	}
+
+	/* Delete the second half of the tree, files then directories */
+	for (i = n_files / 2; i < n_files; i++) {
+		g_autofree gchar *path = file_path (i);
+
+		add_op (workload->trace, OP_DELETE, path, NULL);
+
+		if (i % 100 == 99 || i == n_files - 1) {
+			g_autofree gchar *dir = g_strdup_printf ("d%d/d%d", i / 1000, (i / 100) % 10);
+			add_op (workload->trace, OP_RMDIR, dir, NULL);
+		}
+	}
+
+	return workload;
+}
+
+static Workload *
+load_trace (const gchar  *filename,
+            GError      **error)
+{
+	g_autofree gchar *contents = NULL;
+	g_auto (GStrv) lines = NULL;
+	Workload *workload;
+	GArray *ops;
+	guint i;
+
+	if (!g_file_get_contents (filename, &contents, NULL, error))
+		return NULL;
+
+	workload = workload_new (filename);
+	lines = g_strsplit (contents, "\n", -1);
+	ops = g_strv_contains ((const gchar * const *) lines, "---") ?
+		workload->setup : workload->trace;
+
+	for (i = 0; lines[i]; i++) {
+		g_auto (GStrv) fields = NULL;
+		guint type, n_fields;
+
+		if (lines[i][0] == '\0' || lines[i][0] == '#')
+			continue;
+
+		if (strcmp (lines[i], "---") == 0) {
+			ops = workload->trace;
+			continue;
+		}
+
+		fields = g_strsplit (lines[i], " ", 3);
+		n_fields = g_strv_length (fields);
+
+		for (type = 0; type < G_N_ELEMENTS (op_names); type++) {
+			if (strcmp (fields[0], op_names[type]) == 0)
+				break;
+		}
+
+		if (type == G_N_ELEMENTS (op_names) || n_fields < 2 ||
+		    (type == OP_MOVE) != (n_fields == 3)) {
+			g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+			             "%s:%d: Invalid operation '%s'",
+			             filename, i + 1, lines[i]);
+			workload_free (workload);
+			return NULL;
+		}
+
+		add_op (ops, type, fields[1], fields[2]);
+	}
+
+	return workload;
+}
+
+static void
+resolve_ops (GArray      *ops,
+             const gchar *root)
+{
+	guint i;
+
+	for (i = 0; i < ops->len; i++) {
+		Op *op = &g_array_index (ops, Op, i);
+
+		g_free (op->abs_path);
+		op->abs_path = g_build_filename (root, op->path, NULL);
+		g_free (op->abs_dest);
+		op->abs_dest = op->dest ? g_build_filename (root, op->dest, NULL) : NULL;
+	}
+}
+
+/* Called from the forked child, so it must not allocate */
+static int
+apply_op (Op *op)
+{
+	static const gchar data[4096] = { 0, };
+	const gchar *path = op->abs_path;
+	int fd, retval = 0;
+
+	switch (op->type) {
+	case OP_MKDIR:
+		return mkdir (path, 0755);
+	case OP_RMDIR:
+		return rmdir (path);
+	case OP_DELETE:
+		return unlink (path);
+	case OP_CREATE:
+	case OP_WRITE:
+		fd = open (path,
+		           op->type == OP_CREATE ?
+		           O_WRONLY | O_CREAT | O_TRUNC : O_WRONLY | O_APPEND,
+		           0644);
+		if (fd < 0)
+			return -1;
+		if (write (fd, data, sizeof (data)) < 0)
+			retval = -1;
+		close (fd);
+		return retval;
+	case OP_MOVE:
+		return rename (path, op->abs_dest);
+	}
+
+	g_assert_not_reached ();
+}
+
+static void
+track_path (Run         *run,
+            const gchar *path,
+            guint        op_index)
+{
+	GArray *indexes;
+
+	indexes = g_hash_table_lookup (run->ops_by_path, path);
+	if (!indexes) {
+		indexes = g_array_new (FALSE, FALSE, sizeof (guint));
+		g_hash_table_insert (run->ops_by_path, g_strdup (path), indexes);
+	}
+
+	g_array_append_val (indexes, op_index);
+}
+
+static gdouble
+signal_latency (Run   *run,
+                GFile *file)
+{
+	g_autofree gchar *path = NULL;
+	GArray *indexes;
+	gint64 now;
+	gint i;
+
+	path = g_file_get_relative_path (run->root, file);
+	if (!path)
+		return -1;
+
+	g_hash_table_add (run->notified, g_strdup (path));
+
+	indexes = g_hash_table_lookup (run->ops_by_path, path);
+	if (!indexes)
+		return -1;
+
+	now = g_get_monotonic_time ();
+
+	/* The latest operation on this file that already happened */
+	for (i = indexes->len - 1; i >= 0; i--) {
+		gint64 timestamp;
+
+		timestamp = run->timestamps[g_array_index (indexes, guint, i)];
+		if (timestamp > 0 && timestamp <= now)
+			return (gdouble) (now - timestamp) / 1000;
+	}
+
+	return -1;
+}
+
+static void
+record_signal (Run      *run,
+               GFile    *file,
+               gboolean  created)
+{
+	gdouble latency;
+
+	run->n_signals++;
+	run->last_signal = g_get_monotonic_time ();
+
+	latency = signal_latency (run, file);
+	if (latency < 0)
+		return;
+
+	g_array_append_val (run->latencies, latency);
+	if (created)
+		g_array_append_val (run->created_latencies, latency);
+}
+
+static void
+item_created_cb (TrackerMonitor *monitor,
+                 GFile          *file,
+                 gboolean        is_directory,
+                 Run            *run)
+{
+	/* As the file notifier does, watch new directories */
+	if (is_directory)
+		tracker_monitor_add (monitor, file);
+
+	record_signal (run, file, TRUE);
+}
+
+static void
+item_changed_cb (TrackerMonitor *monitor,
+                 GFile          *file,
+                 gboolean        is_directory,
+                 Run            *run)
+{
+	record_signal (run, file, FALSE);
+}
+
+static void
+item_deleted_cb (TrackerMonitor *monitor,
+                 GFile          *file,
+                 gboolean        is_directory,
+                 Run            *run)
+{
+	if (is_directory)
+		tracker_monitor_remove_recursively (monitor, file);
+
+	record_signal (run, file, FALSE);
+}
+
+static void
+item_moved_cb (TrackerMonitor *monitor,
+               GFile          *file,
+               GFile          *other_file,
+               gboolean        is_directory,
+               gboolean        is_source_monitored,
+               Run            *run)
+{
+	if (is_directory)
+		tracker_monitor_move (monitor, file, other_file);
+
+	record_signal (run, file, FALSE);
+	record_signal (run, other_file, FALSE);
+	/* Both ends count as a single signal */
+	run->n_signals--;
+}
+
+static void
+child_watch_cb (GPid     pid,
+                gint     status,
+                gpointer user_data)
+{
+	Run *run = user_data;
+
+	run->replaying = FALSE;
+	run->last_signal = MAX (run->last_signal, g_get_monotonic_time ());
+	g_spawn_close_pid (pid);
+}
+
+static gboolean
+tick_cb (gpointer user_data)
+{
+	/* Just wakes up the main loop to check for idleness */
+	return G_SOURCE_CONTINUE;
+}
+
+static void
+monitor_directories (TrackerMonitor *monitor,
+                     GFile          *directory)
+{
+	g_autoptr (GFileEnumerator) enumerator = NULL;
+
+	tracker_monitor_add (monitor, directory);
+
+	enumerator = g_file_enumerate_children (directory,
+	                                        G_FILE_ATTRIBUTE_STANDARD_TYPE,
+	                                        G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+	                                        NULL, NULL);
+	if (!enumerator)
+		return;
+
+	while (TRUE) {
+		GFileInfo *info;
+		GFile *child;
+
+		if (!g_file_enumerator_iterate (enumerator, &info, &child, NULL, NULL) || !info)
+			break;
+
+		if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+			monitor_directories (monitor, child);
+	}
+}
+
+static gdouble
+get_cpu_time (void)
+{
+	struct rusage usage;
+
+	getrusage (RUSAGE_SELF, &usage);
+
+	return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+		(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+/* Changes that must be reported: those not undone within the trace,
+ * and not inside directories created by the trace, since those are
+ * crawled by the file notifier when reported.
+ */
+static void
+count_expected (Run   *run,
+                guint *n_expected,
+                guint *n_lost,
+                guint *n_crawled)
+{
+	g_autoptr (GHashTable) created = NULL, deleted = NULL;
+	g_autoptr (GHashTable) changed = NULL, created_dirs = NULL;
+	GHashTableIter iter;
+	gpointer key;
+	guint i;
+
+	created = g_hash_table_new (g_str_hash, g_str_equal);
+	deleted = g_hash_table_new (g_str_hash, g_str_equal);
+	changed = g_hash_table_new (g_str_hash, g_str_equal);
+	created_dirs = g_hash_table_new (g_str_hash, g_str_equal);
+
+	for (i = 0; i < run->workload->trace->len; i++) {
+		Op *op = &g_array_index (run->workload->trace, Op, i);
+
+		if (op->type == OP_MKDIR)
+			g_hash_table_add (created_dirs, op->path);
+		if (op->type == OP_MKDIR || op->type == OP_CREATE)
+			g_hash_table_add (created, op->path);
+		if (op->type == OP_RMDIR || op->type == OP_DELETE)
+			g_hash_table_add (deleted, op->path);
+
+		g_hash_table_add (changed, op->type == OP_MOVE ? op->dest : op->path);
+	}
+
+	*n_expected = *n_lost = *n_crawled = 0;
+	g_hash_table_iter_init (&iter, changed);
+
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		g_autofree gchar *parent = NULL;
+		gboolean crawled = FALSE;
+
+		/* Created and deleted again */
+		if (g_hash_table_contains (created, key) &&
+		    g_hash_table_contains (deleted, key) &&
+		    !g_hash_table_contains (run->notified, key))
+			continue;
+
+		parent = g_path_get_dirname (key);
+
+		while (strcmp (parent, ".") != 0) {
+			gchar *next;
+
+			if (g_hash_table_contains (created_dirs, parent)) {
+				crawled = TRUE;
+				break;
+			}
+
+			next = g_path_get_dirname (parent);
+			g_free (parent);
+			parent = next;
+		}
+
+		if (crawled) {
+			(*n_crawled)++;
+			continue;
+		}
+
+		(*n_expected)++;
+		if (!g_hash_table_contains (run->notified, key))
+			(*n_lost)++;
+	}
+}
+
+static gboolean
+run_workload (const gchar  *backend,
+              GType         type,
+              Workload     *workload,
+              GError      **error)
+{
+	g_autofree gchar *path = NULL;
+	g_autoptr (GFile) root = NULL;
+	Run run = { 0, };
+	gdouble cpu_time;
+	guint n_expected, n_lost, n_crawled, i;
+	gsize timestamps_size;
+	guint tick_id;
+	GPid pid;
+
+	path = g_build_filename (root_dir ? root_dir : g_get_tmp_dir (),
+	                         "tracker-monitor-benchmark-XXXXXX", NULL);
+	if (!g_mkdtemp (path)) {
+		g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+		             "Could not create %s: %s", path, g_strerror (errno));
+		return FALSE;
+	}
+
+	resolve_ops (workload->setup, path);
+	resolve_ops (workload->trace, path);
+
+	for (i = 0; i < workload->setup->len; i++)
+		apply_op (&g_array_index (workload->setup, Op, i));
+
+	root = g_file_new_for_path (path);
+
+	run.monitor = g_initable_new (type, NULL, error, NULL);
+	if (!run.monitor) {
+		tracker_benchmark_remove_tree (path);
+		return FALSE;
+	}
+
+	run.root = root;
+	run.workload = workload;
+	run.ops_by_path = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                         (GDestroyNotify) g_array_unref);
+	run.notified = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	run.latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+	run.created_latencies = g_array_new (FALSE, FALSE, sizeof (gdouble));
+
+	for (i = 0; i < workload->trace->len; i++) {
+		Op *op = &g_array_index (workload->trace, Op, i);
+
+		track_path (&run, op->path, i);
+		if (op->dest)
+			track_path (&run, op->dest, i);
+	}
+
+	timestamps_size = MAX (workload->trace->len, 1) * sizeof (gint64);
+	run.timestamps = mmap (NULL, timestamps_size, PROT_READ | PROT_WRITE,
+	                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	g_assert (run.timestamps != MAP_FAILED);
+
+	g_signal_connect (run.monitor, "item-created",
+	                  G_CALLBACK (item_created_cb), &run);
+	g_signal_connect (run.monitor, "item-updated",
+	                  G_CALLBACK (item_changed_cb), &run);
+	g_signal_connect (run.monitor, "item-attribute-updated",
+	                  G_CALLBACK (item_changed_cb), &run);
+	g_signal_connect (run.monitor, "item-deleted",
+	                  G_CALLBACK (item_deleted_cb), &run);
+	g_signal_connect (run.monitor, "item-moved",
+	                  G_CALLBACK (item_moved_cb), &run);
+
+	monitor_directories (run.monitor, root);
+
+	/* Let the monitor settle after adding the watches */
+	while (g_main_context_iteration (NULL, FALSE));
+
+	cpu_time = get_cpu_time ();
+	run.replaying = TRUE;
+
+	pid = fork ();
+	if (pid == 0) {
+		for (i = 0; i < workload->trace->len; i++) {
+			apply_op (&g_array_index (workload->trace, Op, i));
+			run.timestamps[i] = g_get_monotonic_time ();
+		}
+
+		_exit (0);
+	}
+
+	g_child_watch_add (pid, child_watch_cb, &run);
+	tick_id = g_timeout_add (100, tick_cb, NULL);
+
+	while (run.replaying ||
+	       g_get_monotonic_time () - run.last_signal < settle_time * G_USEC_PER_SEC)
+		g_main_context_iteration (NULL, TRUE);
+
+	g_source_remove (tick_id);
+	cpu_time = get_cpu_time () - cpu_time;
+	count_expected (&run, &n_expected, &n_lost, &n_crawled);
+
+	g_array_sort (run.latencies, tracker_benchmark_compare_doubles);
+	g_array_sort (run.created_latencies, tracker_benchmark_compare_doubles);
+
+	g_print ("{\"backend\":\"%s\",\"workload\":\"%s\",\"operations\":%u,"
+	         "\"signals\":%u,\"coalescing_ratio\":%.3f,"
+	         "\"expected\":%u,\"lost\":%u,\"crawled\":%u,"
+	         "\"latency_p50_ms\":%.1f,\"latency_p99_ms\":%.1f,"
+	         "\"created_p50_ms\":%.1f,\"created_p99_ms\":%.1f,"
+	         "\"cpu_ms_per_1k_ops\":%.3f}\n",
+	         backend, workload->name, workload->trace->len,
+	         run.n_signals,
+	         run.n_signals > 0 ? (gdouble) workload->trace->len / run.n_signals : 0,
+	         n_expected, n_lost, n_crawled,
+	         tracker_benchmark_percentile (run.latencies, 50),
+	         tracker_benchmark_percentile (run.latencies, 99),
+	         tracker_benchmark_percentile (run.created_latencies, 50),
+	         tracker_benchmark_percentile (run.created_latencies, 99),
+	         workload->trace->len > 0 ? cpu_time * 1000 / workload->trace->len : 0);
+
+	g_object_unref (run.monitor);
+	munmap (run.timestamps, timestamps_size);
+	g_hash_table_unref (run.ops_by_path);
+	g_hash_table_unref (run.notified);
+	g_array_unref (run.latencies);
+	g_array_unref (run.created_latencies);
+
+	tracker_benchmark_remove_tree (path);
+
+	return TRUE;
+}
+
+int
+main (int argc, char *argv[])
+{
+	g_autoptr (GOptionContext) context = NULL;
+	g_autoptr (GPtrArray) workloads = NULL;
+	struct {
+		const gchar *name;
+		GType type;
+	} backends[2];
+	guint n_backends = 0, i, j;
+	GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &error))
+		goto error;
+
+	workloads = g_ptr_array_new_with_free_func ((GDestroyNotify) workload_free);
+
+	if (trace_file) {
+		Workload *workload;
+
+		workload = load_trace (trace_file, &error);
+		if (!workload)
+			goto error;
+
+		g_ptr_array_add (workloads, workload);
+	} else {
+		g_ptr_array_add (workloads, generate_untar ());
+		g_ptr_array_add (workloads, generate_checkout ());
+		g_ptr_array_add (workloads, generate_rsync_delete ());
+	}
+
+	backends[n_backends].name = "glib";
+	backends[n_backends++].type = TRACKER_TYPE_MONITOR_GLIB;
+#ifdef HAVE_FANOTIFY
+	backends[n_backends].name = "fanotify";
+	backends[n_backends++].type = TRACKER_TYPE_MONITOR_FANOTIFY;
+#endif
+
+	for (i = 0; i < n_backends; i++) {
+		if (only_backend && strcmp (only_backend, backends[i].name) != 0)
+			continue;
+
+		for (j = 0; j < workloads->len; j++) {
+			g_autoptr (GError) run_error = NULL;
+
+			if (!run_workload (backends[i].name, backends[i].type,
+			                   g_ptr_array_index (workloads, j),
+			                   &run_error)) {
+				/* fanotify may need privileges not available here */
+				g_printerr ("Skipping %s backend: %s\n",
+				            backends[i].name, run_error->message);
+				break;
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+
+ error:
+	g_printerr ("%s\n", error->message);
+	g_error_free (error);
+	return EXIT_FAILURE;
+}
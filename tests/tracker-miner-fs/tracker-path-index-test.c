@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include <glib.h>
+
+/* NOTE: We're not including tracker-miner.h here because this is private. */
+#include <tracker-path-index.h>
+
+static TrackerPathIndexEntry *
+add_path (TrackerPathIndex *index,
+          const gchar      *path)
+{
+	g_autoptr (GFile) file = NULL;
+
+	file = g_file_new_for_path (path);
+
+	return tracker_path_index_add (index, file, (gpointer) path);
+}
+
+static GList *
+remove_descendants (TrackerPathIndex *index,
+                    const gchar      *path)
+{
+	g_autoptr (GFile) file = NULL;
+
+	file = g_file_new_for_path (path);
+
+	return tracker_path_index_remove_descendants (index, file);
+}
+
+static gboolean
+list_contains (GList       *list,
+               const gchar *path)
+{
+	return g_list_find_custom (list, path, (GCompareFunc) g_strcmp0) != NULL;
+}
+
+static void
+test_path_index_descendants (void)
+{
+	TrackerPathIndex *index;
+	GList *removed;
+
+	index = tracker_path_index_new ();
+	add_path (index, "/a");
+	add_path (index, "/a/b");
+	add_path (index, "/a/b/c");
+	add_path (index, "/a/b/c");
+	add_path (index, "/a/bc");
+	add_path (index, "/a/d/e/f");
+	add_path (index, "/g");
+	g_assert_cmpuint (tracker_path_index_get_size (index), ==, 7);
+
+	removed = remove_descendants (index, "/a/b");
+	g_assert_cmpuint (g_list_length (removed), ==, 3);
+	g_assert_true (list_contains (removed, "/a/b"));
+	g_assert_true (list_contains (removed, "/a/b/c"));
+	g_assert_false (list_contains (removed, "/a/bc"));
+	g_list_free (removed);
+	g_assert_cmpuint (tracker_path_index_get_size (index), ==, 4);
+
+	/* Intermediate directories without entries are not an issue */
+	removed = remove_descendants (index, "/a/d");
+	g_assert_cmpuint (g_list_length (removed), ==, 1);
+	g_assert_true (list_contains (removed, "/a/d/e/f"));
+	g_list_free (removed);
+
+	removed = remove_descendants (index, "/nonexistent");
+	g_assert_null (removed);
+
+	removed = remove_descendants (index, "/");
+	g_assert_cmpuint (g_list_length (removed), ==, 3);
+	g_list_free (removed);
+	g_assert_cmpuint (tracker_path_index_get_size (index), ==, 0);
+
+	tracker_path_index_free (index);
+}
+
+static void
+test_path_index_remove (void)
+{
+	TrackerPathIndex *index;
+	TrackerPathIndexEntry *parent, *child;
+	GList *removed;
+
+	index = tracker_path_index_new ();
+	parent = add_path (index, "/a");
+	child = add_path (index, "/a/b/c");
+
+	tracker_path_index_remove (index, parent);
+	g_assert_cmpuint (tracker_path_index_get_size (index), ==, 1);
+
+	/* The child is still found through the parent */
+	removed = remove_descendants (index, "/a");
+	g_assert_cmpuint (g_list_length (removed), ==, 1);
+	g_assert_true (list_contains (removed, "/a/b/c"));
+	g_list_free (removed);
+
+	child = add_path (index, "/a/b/c");
+	tracker_path_index_remove (index, child);
+	g_assert_cmpuint (tracker_path_index_get_size (index), ==, 0);
+
+	/* Nodes were pruned along with the last entry */
+	removed = remove_descendants (index, "/a");
+	g_assert_null (removed);
+
+	tracker_path_index_free (index);
+}
+
+static void
+test_path_index_lookup (void)
+{
+	TrackerPathIndex *index;
+	TrackerPathIndexEntry *entry;
+	g_autoptr (GFile) file = NULL, expected = NULL;
+
+	index = tracker_path_index_new ();
+	add_path (index, "/a/b");
+	entry = add_path (index, "/a/b/c");
+	add_path (index, "/a/b/c/d");
+
+	/* Files are rebuilt from their parent directory */
+	file = tracker_path_index_entry_get_file (entry);
+	expected = g_file_new_for_path ("/a/b/c");
+	g_assert_true (g_file_equal (file, expected));
+	g_assert_cmpstr (tracker_path_index_lookup (index, file), ==, "/a/b/c");
+
+	/* The last added entry is returned */
+	tracker_path_index_add (index, file, "last");
+	g_assert_cmpstr (tracker_path_index_lookup (index, file), ==, "last");
+
+	g_clear_object (&file);
+	file = g_file_new_for_path ("/a");
+	g_assert_null (tracker_path_index_lookup (index, file));
+
+	g_clear_object (&file);
+	file = g_file_new_for_path ("/a/e");
+	g_assert_null (tracker_path_index_lookup (index, file));
+
+	tracker_path_index_free (index);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-miner/tracker-path-index/descendants",
+	                 test_path_index_descendants);
+	g_test_add_func ("/libtracker-miner/tracker-path-index/remove",
+	                 test_path_index_remove);
+	g_test_add_func ("/libtracker-miner/tracker-path-index/lookup",
+	                 test_path_index_lookup);
+
+	return g_test_run ();
+}
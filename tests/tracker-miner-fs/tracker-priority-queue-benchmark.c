@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/* Compares the throughput of TrackerPriorityQueue with the list based
+ * implementation it replaced, on the operations the miner performs:
+ * adding and popping events, removing queued events by handle, and
+ * filtering or searching the whole queue.
+ *
+ * Each workload prints a JSON line per implementation.
+ */
+
+#include "config-miners.h"
+
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include <tracker-priority-queue.h>
+
+/* The list based queue: a GQueue of all elements, plus the first and
+ * last link of each priority.
+ */
+typedef struct {
+	gint priority;
+	GList *first_elem;
+	GList *last_elem;
+} ListSegment;
+
+typedef struct {
+	GQueue queue;
+	GArray *segments;
+} ListQueue;
+
+static ListQueue *
+list_queue_new (void)
+{
+	ListQueue *queue;
+
+	queue = g_new0 (ListQueue, 1);
+	queue->segments = g_array_new (FALSE, FALSE, sizeof (ListSegment));
+
+	return queue;
+}
+
+static void
+list_queue_free (ListQueue *queue)
+{
+	g_queue_clear (&queue->queue);
+	g_array_free (queue->segments, TRUE);
+	g_free (queue);
+}
+
+static GList *
+list_queue_add (ListQueue *queue,
+                gpointer   data,
+                gint       priority)
+{
+	ListSegment *segment;
+	GList *node;
+	guint i;
+
+	node = g_list_alloc ();
+	node->data = data;
+
+	for (i = 0; i < queue->segments->len; i++) {
+		segment = &g_array_index (queue->segments, ListSegment, i);
+
+		if (segment->priority == priority) {
+			if (segment->last_elem == queue->queue.tail) {
+				g_queue_push_tail_link (&queue->queue, node);
+			} else {
+				node->prev = segment->last_elem;
+				node->next = segment->last_elem->next;
+				node->next->prev = node;
+				segment->last_elem->next = node;
+				queue->queue.length++;
+			}
+
+			segment->last_elem = node;
+			return node;
+		} else if (segment->priority > priority) {
+			break;
+		}
+	}
+
+	/* New segment before segment i */
+	if (i < queue->segments->len) {
+		GList *sibling;
+
+		segment = &g_array_index (queue->segments, ListSegment, i);
+		sibling = segment->first_elem;
+
+		if (sibling == queue->queue.head) {
+			g_queue_push_head_link (&queue->queue, node);
+		} else {
+			node->next = sibling;
+			node->prev = sibling->prev;
+			sibling->prev->next = node;
+			sibling->prev = node;
+			queue->queue.length++;
+		}
+	} else {
+		g_queue_push_tail_link (&queue->queue, node);
+	}
+
+	g_array_insert_val (queue->segments, i,
+	                    ((ListSegment) { priority, node, node }));
+
+	return node;
+}
+
+static void
+list_queue_unlink (ListQueue *queue,
+                   GList     *node)
+{
+	guint i;
+
+	for (i = 0; i < queue->segments->len; i++) {
+		ListSegment *segment;
+
+		segment = &g_array_index (queue->segments, ListSegment, i);
+
+		if (segment->first_elem == node) {
+			if (segment->last_elem == node)
+				g_array_remove_index (queue->segments, i);
+			else
+				segment->first_elem = node->next;
+			break;
+		}
+
+		if (segment->last_elem == node) {
+			segment->last_elem = node->prev;
+			break;
+		}
+	}
+
+	g_queue_unlink (&queue->queue, node);
+}
+
+static void
+list_queue_remove_node (ListQueue *queue,
+                        GList     *node)
+{
+	list_queue_unlink (queue, node);
+	g_list_free_1 (node);
+}
+
+static gpointer
+list_queue_pop (ListQueue *queue)
+{
+	GList *node;
+	gpointer data;
+
+	node = queue->queue.head;
+	if (!node)
+		return NULL;
+
+	data = node->data;
+	list_queue_remove_node (queue, node);
+
+	return data;
+}
+
+static void
+list_queue_foreach_remove (ListQueue  *queue,
+                           GEqualFunc  func,
+                           gpointer    user_data)
+{
+	GList *l, *next;
+
+	for (l = queue->queue.head; l; l = next) {
+		next = l->next;
+
+		if (func (l->data, user_data))
+			list_queue_remove_node (queue, l);
+	}
+}
+
+static gpointer
+list_queue_find (ListQueue  *queue,
+                 GEqualFunc  func,
+                 gpointer    user_data)
+{
+	GList *l;
+
+	for (l = queue->queue.head; l; l = l->next) {
+		if (func (l->data, user_data))
+			return l->data;
+	}
+
+	return NULL;
+}
+
+static gint n_items = 1000000;
+/* Keeps searches from being optimized away */
+static gpointer found = NULL;
+
+static GOptionEntry entries[] = {
+	{ "items", 'n', 0, G_OPTION_ARG_INT, &n_items,
+	  "Number of queued items", "N" },
+	{ NULL }
+};
+
+/* Most events go in the default priority, some in the high one */
+static gint
+item_priority (gint i)
+{
+	return (i % 10 == 0) ? G_PRIORITY_HIGH : G_PRIORITY_DEFAULT;
+}
+
+static gboolean
+is_multiple_of_ten (gconstpointer a,
+                    gconstpointer b)
+{
+	return GPOINTER_TO_INT (a) % 10 == 0;
+}
+
+static gboolean
+is_last (gconstpointer a,
+         gconstpointer b)
+{
+	return GPOINTER_TO_INT (a) == n_items;
+}
+
+static void
+print_result (const gchar *workload,
+              const gchar *implementation,
+              guint        n_ops,
+              gdouble      elapsed)
+{
+	g_print ("{\"workload\":\"%s\",\"implementation\":\"%s\",\"items\":%d,"
+	         "\"wall_s\":%.3f,\"mops_per_s\":%.2f}\n",
+	         workload, implementation, n_items, elapsed,
+	         n_ops / MAX (elapsed, 1e-9) / 1000000);
+}
+
+static void
+bench_add_pop (void)
+{
+	TrackerPriorityQueue *array;
+	ListQueue *list;
+	GTimer *timer;
+	gint i;
+
+	timer = g_timer_new ();
+	list = list_queue_new ();
+	for (i = 1; i <= n_items; i++)
+		list_queue_add (list, GINT_TO_POINTER (i), item_priority (i));
+	while (list_queue_pop (list))
+		;
+	list_queue_free (list);
+	print_result ("add-pop", "list", 2 * n_items, g_timer_elapsed (timer, NULL));
+
+	g_timer_start (timer);
+	array = tracker_priority_queue_new ();
+	for (i = 1; i <= n_items; i++)
+		tracker_priority_queue_add (array, GINT_TO_POINTER (i), item_priority (i));
+	while (tracker_priority_queue_pop (array, NULL))
+		;
+	tracker_priority_queue_unref (array);
+	print_result ("add-pop", "array", 2 * n_items, g_timer_elapsed (timer, NULL));
+
+	g_timer_destroy (timer);
+}
+
+/* Fisher-Yates, with a fixed seed so runs are comparable */
+static gint *
+shuffled_order (void)
+{
+	GRand *rand;
+	gint *order;
+	gint i;
+
+	order = g_new (gint, n_items);
+	for (i = 0; i < n_items; i++)
+		order[i] = i;
+
+	rand = g_rand_new_with_seed (0x9e3779b9);
+
+	for (i = n_items - 1; i > 0; i--) {
+		gint j, tmp;
+
+		j = g_rand_int_range (rand, 0, i + 1);
+		tmp = order[i];
+		order[i] = order[j];
+		order[j] = tmp;
+	}
+
+	g_rand_free (rand);
+
+	return order;
+}
+
+/* Removes half the elements in random order, as coalesced or
+ * deleted events are, then pops the rest.
+ */
+static void
+bench_remove_node (void)
+{
+	TrackerPriorityQueue *array;
+	TrackerPriorityQueueNode *array_nodes;
+	ListQueue *list;
+	GList **list_nodes;
+	GTimer *timer;
+	gint *order;
+	gint i;
+
+	order = shuffled_order ();
+	list_nodes = g_new (GList *, n_items);
+	array_nodes = g_new (TrackerPriorityQueueNode, n_items);
+	timer = g_timer_new ();
+
+	list = list_queue_new ();
+	for (i = 0; i < n_items; i++)
+		list_nodes[i] = list_queue_add (list, GINT_TO_POINTER (i + 1), item_priority (i));
+	g_timer_start (timer);
+	for (i = 0; i < n_items / 2; i++)
+		list_queue_remove_node (list, list_nodes[order[i]]);
+	while (list_queue_pop (list))
+		;
+	print_result ("remove-node", "list", n_items, g_timer_elapsed (timer, NULL));
+	list_queue_free (list);
+
+	array = tracker_priority_queue_new ();
+	for (i = 0; i < n_items; i++)
+		array_nodes[i] = tracker_priority_queue_add (array, GINT_TO_POINTER (i + 1), item_priority (i));
+	g_timer_start (timer);
+	for (i = 0; i < n_items / 2; i++)
+		tracker_priority_queue_remove_node (array, array_nodes[order[i]]);
+	while (tracker_priority_queue_pop (array, NULL))
+		;
+	print_result ("remove-node", "array", n_items, g_timer_elapsed (timer, NULL));
+	tracker_priority_queue_unref (array);
+
+	g_timer_destroy (timer);
+	g_free (list_nodes);
+	g_free (array_nodes);
+	g_free (order);
+}
+
+/* Traverses the whole queue, once filtering a tenth of the elements
+ * out and once looking for the last element.
+ */
+static void
+bench_traversal (void)
+{
+	TrackerPriorityQueue *array;
+	ListQueue *list;
+	GTimer *timer;
+	gint i;
+
+	timer = g_timer_new ();
+
+	list = list_queue_new ();
+	for (i = 1; i <= n_items; i++)
+		list_queue_add (list, GINT_TO_POINTER (i), G_PRIORITY_DEFAULT);
+	g_timer_start (timer);
+	list_queue_foreach_remove (list, is_multiple_of_ten, NULL);
+	print_result ("foreach-remove", "list", n_items, g_timer_elapsed (timer, NULL));
+	g_timer_start (timer);
+	found = list_queue_find (list, is_last, NULL);
+	print_result ("find", "list", n_items, g_timer_elapsed (timer, NULL));
+	list_queue_free (list);
+
+	array = tracker_priority_queue_new ();
+	for (i = 1; i <= n_items; i++)
+		tracker_priority_queue_add (array, GINT_TO_POINTER (i), G_PRIORITY_DEFAULT);
+	g_timer_start (timer);
+	tracker_priority_queue_foreach_remove (array, is_multiple_of_ten, NULL, NULL);
+	print_result ("foreach-remove", "array", n_items, g_timer_elapsed (timer, NULL));
+	g_timer_start (timer);
+	found = tracker_priority_queue_find (array, NULL, is_last, NULL);
+	print_result ("find", "array", n_items, g_timer_elapsed (timer, NULL));
+	tracker_priority_queue_unref (array);
+
+	g_timer_destroy (timer);
+}
+
+int
+main (int argc, char *argv[])
+{
+	g_autoptr (GOptionContext) context = NULL;
+	GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &error)) {
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+		return EXIT_FAILURE;
+	}
+
+	if (n_items <= 0) {
+		g_printerr ("The number of items must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	bench_add_pop ();
+	bench_remove_node ();
+	bench_traversal ();
+
+	return EXIT_SUCCESS;
+}
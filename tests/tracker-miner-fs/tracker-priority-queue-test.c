@@ -234,6 +234,99 @@ test_priority_queue_branches (void)
         tracker_priority_queue_unref (queue);
 }
 
+static void
+test_priority_queue_remove_node (void)
+{
+	TrackerPriorityQueue *queue;
+	TrackerPriorityQueueNode nodes[100];
+	gint i, priority;
+
+	queue = tracker_priority_queue_new ();
+
+	for (i = 0; i < 100; i++) {
+		nodes[i] = tracker_priority_queue_add (queue, GINT_TO_POINTER (i + 1),
+		                                       i % 2 == 0 ? 1 : -1);
+	}
+
+	/* Remove from the middle and both ends of each priority */
+	for (i = 0; i < 100; i += 3)
+		tracker_priority_queue_remove_node (queue, nodes[i]);
+	tracker_priority_queue_remove_node (queue, nodes[98]);
+	tracker_priority_queue_remove_node (queue, nodes[1]);
+
+	g_assert_cmpint (tracker_priority_queue_get_length (queue), ==, 64);
+
+	/* Handles stay valid as the queue grows */
+	for (i = 0; i < 100; i++)
+		tracker_priority_queue_add (queue, GINT_TO_POINTER (i + 101), 2);
+	tracker_priority_queue_remove_node (queue, nodes[97]);
+
+	for (i = 0; i < 100; i++) {
+		if (i % 3 == 0 || i == 1 || i == 97 || i % 2 == 0)
+			continue;
+
+		g_assert_cmpint (GPOINTER_TO_INT (tracker_priority_queue_pop (queue, &priority)), ==, i + 1);
+		g_assert_cmpint (priority, ==, -1);
+	}
+
+	for (i = 0; i < 100; i++) {
+		if (i % 3 == 0 || i == 98 || i % 2 != 0)
+			continue;
+
+		g_assert_cmpint (GPOINTER_TO_INT (tracker_priority_queue_pop (queue, &priority)), ==, i + 1);
+		g_assert_cmpint (priority, ==, 1);
+	}
+
+	g_assert_cmpint (tracker_priority_queue_get_length (queue), ==, 100);
+
+	tracker_priority_queue_unref (queue);
+}
+
+static void
+test_priority_queue_compaction (void)
+{
+	TrackerPriorityQueue *queue;
+	TrackerPriorityQueueNode nodes[1000];
+	GVariant *stats;
+	guint tombstones, capacity;
+	gint i;
+
+	queue = tracker_priority_queue_new ();
+
+	for (i = 0; i < 1000; i++)
+		nodes[i] = tracker_priority_queue_add (queue, GINT_TO_POINTER (i + 1), 0);
+
+	/* Leave the ends in place, so tombstones can't be skipped */
+	for (i = 1; i < 999; i++) {
+		if (i % 10 != 0)
+			tracker_priority_queue_remove_node (queue, nodes[i]);
+	}
+
+	g_assert_cmpint (tracker_priority_queue_get_length (queue), ==, 101);
+
+	stats = tracker_priority_queue_get_allocator_stats (queue);
+	g_variant_ref_sink (stats);
+	g_assert_true (g_variant_lookup (stats, "tombstones", "u", &tombstones));
+	g_assert_true (g_variant_lookup (stats, "capacity", "u", &capacity));
+	g_assert_cmpuint (tombstones, <, 101 * 4);
+	g_assert_cmpuint (capacity, <, 1000);
+	g_variant_unref (stats);
+
+	/* Handles stay valid after the ring was compacted */
+	for (i = 10; i < 999; i += 20)
+		tracker_priority_queue_remove_node (queue, nodes[i]);
+	tracker_priority_queue_remove_node (queue, nodes[999]);
+
+	g_assert_cmpint (GPOINTER_TO_INT (tracker_priority_queue_pop (queue, NULL)), ==, 1);
+
+	for (i = 20; i < 999; i += 20)
+		g_assert_cmpint (GPOINTER_TO_INT (tracker_priority_queue_pop (queue, NULL)), ==, i + 1);
+
+	g_assert_true (tracker_priority_queue_is_empty (queue));
+
+	tracker_priority_queue_unref (queue);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -257,6 +350,10 @@ main (int    argc,
 
         g_test_add_func ("/libtracker-miner/tracker-priority-queue/branches",
                          test_priority_queue_branches);
+	g_test_add_func ("/libtracker-miner/tracker-priority-queue/remove_node",
+	                 test_priority_queue_remove_node);
+	g_test_add_func ("/libtracker-miner/tracker-priority-queue/compaction",
+	                 test_priority_queue_compaction);
 
 	return g_test_run ();
 }
@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <glib.h>
+
+/* NOTE: We're not including tracker-miner.h here because this is private. */
+#include <tracker-query-cache.h>
+
+#define QUERY "SELECT ?u { ?u a nfo:Document ; nie:title ~title } ORDER BY ?u"
+
+static TrackerSparqlConnection *
+create_connection (void)
+{
+	TrackerSparqlConnection *conn;
+	GFile *ontology;
+	GError *error = NULL;
+
+	ontology = tracker_sparql_get_ontology_nepomuk ();
+	conn = tracker_sparql_connection_new (0, NULL, ontology, NULL, &error);
+	g_assert_no_error (error);
+	g_object_unref (ontology);
+
+	tracker_sparql_connection_update (conn,
+	                                  "INSERT DATA {"
+	                                  "  <file:///a> a nfo:Document ; nie:title 'a' ."
+	                                  "  <file:///b> a nfo:Document ; nie:title 'b' ."
+	                                  "}",
+	                                  NULL, &error);
+	g_assert_no_error (error);
+
+	return conn;
+}
+
+static void
+query_cb (GObject      *object,
+          GAsyncResult *res,
+          gpointer      user_data)
+{
+	GVariant **result = user_data;
+	GError *error = NULL;
+
+	*result = tracker_query_cache_query_finish (TRACKER_QUERY_CACHE (object), res, &error);
+	g_assert_no_error (error);
+}
+
+static GVariant *
+run_query (TrackerQueryCache *cache,
+           const gchar       *sparql,
+           const gchar       *title)
+{
+	GVariantBuilder builder;
+	GVariant *result = NULL;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "title", g_variant_new_string (title));
+
+	tracker_query_cache_query_async (cache, sparql,
+	                                 g_variant_builder_end (&builder),
+	                                 NULL, query_cb, &result);
+
+	while (!result)
+		g_main_context_iteration (NULL, TRUE);
+
+	return result;
+}
+
+static guint64
+lookup_counter (TrackerQueryCache *cache,
+                const gchar       *name)
+{
+	g_autoptr (GVariant) variant = NULL;
+	guint64 value = 0;
+
+	variant = g_variant_ref_sink (tracker_query_cache_to_variant (cache));
+	g_assert_true (g_variant_lookup (variant, name, "t", &value));
+
+	return value;
+}
+
+static void
+test_query_cache_hit (void)
+{
+	TrackerSparqlConnection *conn;
+	TrackerQueryCache *cache;
+	g_autoptr (GVariant) first = NULL, second = NULL, third = NULL, rows = NULL;
+
+	conn = create_connection ();
+	cache = tracker_query_cache_new (conn, NULL, 1024 * 1024);
+
+	first = run_query (cache, QUERY, "a");
+	g_assert_cmpuint (lookup_counter (cache, "misses"), ==, 1);
+	rows = g_variant_get_child_value (first, 1);
+	g_assert_cmpuint (g_variant_n_children (rows), ==, 1);
+
+	/* Whitespace differences do not matter */
+	second = run_query (cache, "  SELECT ?u {\n\t?u a nfo:Document ;  nie:title ~title }  ORDER BY ?u ", "a");
+	g_assert_cmpuint (lookup_counter (cache, "hits"), ==, 1);
+	g_assert_true (g_variant_equal (first, second));
+
+	/* Bound values do */
+	third = run_query (cache, QUERY, "b");
+	g_assert_cmpuint (lookup_counter (cache, "misses"), ==, 2);
+	g_assert_false (g_variant_equal (first, third));
+
+	g_object_unref (cache);
+	g_object_unref (conn);
+}
+
+static void
+test_query_cache_invalidate (void)
+{
+	TrackerSparqlConnection *conn;
+	TrackerStatistics *statistics;
+	TrackerQueryCache *cache;
+	g_autoptr (GVariant) first = NULL, second = NULL;
+	GError *error = NULL;
+
+	conn = create_connection ();
+	statistics = tracker_statistics_new (conn);
+	cache = tracker_query_cache_new (conn, statistics, 1024 * 1024);
+
+	first = run_query (cache, QUERY, "a");
+
+	tracker_sparql_connection_update (conn,
+	                                  "INSERT DATA {"
+	                                  "  <file:///c> a nfo:Document ; nie:title 'a' ."
+	                                  "}",
+	                                  NULL, &error);
+	g_assert_no_error (error);
+	tracker_statistics_invalidate (statistics);
+
+	second = run_query (cache, QUERY, "a");
+	g_assert_cmpuint (lookup_counter (cache, "hits"), ==, 0);
+	g_assert_cmpuint (lookup_counter (cache, "misses"), ==, 2);
+	g_assert_false (g_variant_equal (first, second));
+
+	g_object_unref (cache);
+	g_object_unref (statistics);
+	g_object_unref (conn);
+}
+
+static void
+test_query_cache_note_changes (void)
+{
+	TrackerSparqlConnection *conn;
+	TrackerStatistics *statistics;
+	TrackerQueryCache *cache;
+	g_autoptr (GVariant) first = NULL, second = NULL;
+	GError *error = NULL;
+
+	conn = create_connection ();
+	statistics = tracker_statistics_new (conn);
+	cache = tracker_query_cache_new (conn, statistics, 1024 * 1024);
+
+	first = run_query (cache, QUERY, "a");
+
+	/* Title changes are not notified, the miner notes its commits */
+	tracker_sparql_connection_update (conn,
+	                                  "DELETE { <file:///b> nie:title ?t } "
+	                                  "INSERT { <file:///b> nie:title 'a' } "
+	                                  "WHERE { <file:///b> nie:title ?t }",
+	                                  NULL, &error);
+	g_assert_no_error (error);
+	tracker_statistics_note_changes (statistics);
+
+	second = run_query (cache, QUERY, "a");
+	g_assert_cmpuint (lookup_counter (cache, "hits"), ==, 0);
+	g_assert_false (g_variant_equal (first, second));
+
+	g_object_unref (cache);
+	g_object_unref (statistics);
+	g_object_unref (conn);
+}
+
+static void
+test_query_cache_evict (void)
+{
+	TrackerSparqlConnection *conn;
+	TrackerQueryCache *cache;
+	g_autoptr (GVariant) first = NULL, second = NULL;
+
+	conn = create_connection ();
+	/* Too small to hold anything */
+	cache = tracker_query_cache_new (conn, NULL, 16);
+
+	first = run_query (cache, QUERY, "a");
+	second = run_query (cache, QUERY, "a");
+	g_assert_cmpuint (lookup_counter (cache, "hits"), ==, 0);
+	g_assert_cmpuint (lookup_counter (cache, "size"), ==, 0);
+	g_assert_true (g_variant_equal (first, second));
+
+	g_object_unref (cache);
+	g_object_unref (conn);
+}
+
+static void
+query_error_cb (GObject      *object,
+                GAsyncResult *res,
+                gpointer      user_data)
+{
+	GError **error = user_data;
+	GVariant *result;
+
+	result = tracker_query_cache_query_finish (TRACKER_QUERY_CACHE (object), res, error);
+	g_assert_null (result);
+}
+
+static void
+test_query_cache_too_large (void)
+{
+	TrackerSparqlConnection *conn;
+	TrackerQueryCache *cache;
+	GString *sparql;
+	GError *error = NULL;
+	gint i;
+
+	conn = create_connection ();
+	cache = tracker_query_cache_new (conn, NULL, 1024 * 1024);
+
+	sparql = g_string_new ("INSERT DATA {");
+	for (i = 0; i < 10000; i++)
+		g_string_append_printf (sparql, " <file:///many/%d> a nfo:Document .", i);
+	g_string_append (sparql, " }");
+
+	tracker_sparql_connection_update (conn, sparql->str, NULL, &error);
+	g_assert_no_error (error);
+	g_string_free (sparql, TRUE);
+
+	tracker_query_cache_query_async (cache, "SELECT ?u { ?u a nfo:Document }",
+	                                 NULL, NULL, query_error_cb, &error);
+
+	while (!error)
+		g_main_context_iteration (NULL, TRUE);
+
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_MESSAGE_TOO_LARGE);
+	g_clear_error (&error);
+	g_assert_cmpuint (lookup_counter (cache, "size"), ==, 0);
+
+	g_object_unref (cache);
+	g_object_unref (conn);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-miner/tracker-query-cache/hit",
+	                 test_query_cache_hit);
+	g_test_add_func ("/libtracker-miner/tracker-query-cache/invalidate",
+	                 test_query_cache_invalidate);
+	g_test_add_func ("/libtracker-miner/tracker-query-cache/note-changes",
+	                 test_query_cache_note_changes);
+	g_test_add_func ("/libtracker-miner/tracker-query-cache/evict",
+	                 test_query_cache_evict);
+	g_test_add_func ("/libtracker-miner/tracker-query-cache/too-large",
+	                 test_query_cache_too_large);
+
+	return g_test_run ();
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/* Measures the heap used by the per file state of queued and crawled
+ * files, comparing GFile based bookkeeping with the compact layouts
+ * used by the miner: path index entries for queued events, integer
+ * mtimes and interned strings for crawled file data.
+ *
+ * Each layout prints a JSON line with the heap bytes used per item,
+ * a last line gives the memory saved per million queued items.
+ */
+
+#include "config-miners.h"
+
+#include <stdlib.h>
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include <tracker-path-index.h>
+
+#include "tracker-benchmark-utils.h"
+
+/* Per file data of crawled files, as previously stored */
+typedef struct {
+	GDateTime *store_mtime;
+	GDateTime *disk_mtime;
+	gchar *extractor_hash;
+	gchar *mimetype;
+} FileDataDateTime;
+
+/* Per file data of crawled files, as currently stored */
+typedef struct {
+	gint64 store_mtime;
+	gint64 disk_mtime;
+	const gchar *extractor_hash;
+	const gchar *mimetype;
+} FileDataCompact;
+
+static const gchar *mimetypes[] = {
+	"text/plain", "image/png", "image/jpeg", "audio/mpeg",
+	"application/pdf", "video/mp4",
+};
+
+static gint n_items = 1000000;
+static gint files_per_directory = 32;
+static gint fanout = 32;
+
+static GOptionEntry entries[] = {
+	{ "items", 'n', 0, G_OPTION_ARG_INT, &n_items,
+	  "Number of queued items", "N" },
+	{ "files", 'f', 0, G_OPTION_ARG_INT, &files_per_directory,
+	  "Files per directory", "N" },
+	{ "fanout", 0, 0, G_OPTION_ARG_INT, &fanout,
+	  "Subdirectories per directory", "N" },
+	{ NULL }
+};
+
+static GFile *
+create_item_file (guint i)
+{
+	g_autofree gchar *path = NULL;
+	guint dir;
+
+	dir = i / files_per_directory;
+	path = g_strdup_printf ("/tmp/tracker-queue-memory-benchmark/"
+	                        "dir-%u/dir-%u/file-%u.dat",
+	                        dir / fanout, dir % fanout, i);
+
+	return g_file_new_for_path (path);
+}
+
+static gdouble
+print_layout (const gchar *layout,
+              gssize       bytes,
+              gdouble      wall)
+{
+	gdouble per_item;
+
+	per_item = (gdouble) bytes / n_items;
+	g_print ("{\"layout\":\"%s\",\"items\":%d,\"bytes\":%" G_GSSIZE_FORMAT
+	         ",\"bytes_per_item\":%.1f,\"wall_s\":%.3f}\n",
+	         layout, n_items, bytes, per_item, wall);
+
+	return per_item;
+}
+
+static gdouble
+measure_gfile_queue (void)
+{
+	GHashTable *items;
+	GTimer *timer;
+	gssize before, bytes;
+	gint i;
+
+	before = tracker_benchmark_get_heap_used ();
+	timer = g_timer_new ();
+	items = g_hash_table_new_full (g_file_hash,
+	                               (GEqualFunc) g_file_equal,
+	                               g_object_unref, NULL);
+
+	for (i = 0; i < n_items; i++)
+		g_hash_table_add (items, create_item_file (i));
+
+	bytes = tracker_benchmark_get_heap_used () - before;
+	g_timer_stop (timer);
+	g_hash_table_unref (items);
+
+	return print_layout ("gfile-queue", bytes, g_timer_elapsed (timer, NULL));
+}
+
+static gdouble
+measure_path_index_queue (void)
+{
+	TrackerPathIndex *index;
+	GTimer *timer;
+	gssize before, bytes;
+	gint i;
+
+	before = tracker_benchmark_get_heap_used ();
+	timer = g_timer_new ();
+	index = tracker_path_index_new ();
+
+	for (i = 0; i < n_items; i++) {
+		g_autoptr (GFile) file = NULL;
+
+		file = create_item_file (i);
+		tracker_path_index_add (index, file, NULL);
+	}
+
+	bytes = tracker_benchmark_get_heap_used () - before;
+	g_timer_stop (timer);
+	tracker_path_index_free (index);
+
+	return print_layout ("path-index-queue", bytes, g_timer_elapsed (timer, NULL));
+}
+
+static gdouble
+measure_datetime_file_data (void)
+{
+	FileDataDateTime *data;
+	GTimer *timer;
+	gssize before, bytes;
+	gint i;
+
+	before = tracker_benchmark_get_heap_used ();
+	timer = g_timer_new ();
+	data = g_new0 (FileDataDateTime, n_items);
+
+	for (i = 0; i < n_items; i++) {
+		data[i].store_mtime = g_date_time_new_from_unix_utc (i);
+		data[i].disk_mtime = g_date_time_new_from_unix_utc (i);
+		data[i].mimetype = g_strdup (mimetypes[i % G_N_ELEMENTS (mimetypes)]);
+		data[i].extractor_hash = g_compute_checksum_for_string (G_CHECKSUM_MD5,
+		                                                        data[i].mimetype, -1);
+	}
+
+	bytes = tracker_benchmark_get_heap_used () - before;
+	g_timer_stop (timer);
+
+	for (i = 0; i < n_items; i++) {
+		g_date_time_unref (data[i].store_mtime);
+		g_date_time_unref (data[i].disk_mtime);
+		g_free (data[i].mimetype);
+		g_free (data[i].extractor_hash);
+	}
+
+	g_free (data);
+
+	return print_layout ("datetime-file-data", bytes, g_timer_elapsed (timer, NULL));
+}
+
+static gdouble
+measure_compact_file_data (void)
+{
+	FileDataCompact *data;
+	GTimer *timer;
+	gssize before, bytes;
+	gint i;
+
+	before = tracker_benchmark_get_heap_used ();
+	timer = g_timer_new ();
+	data = g_new0 (FileDataCompact, n_items);
+
+	for (i = 0; i < n_items; i++) {
+		g_autofree gchar *hash = NULL;
+
+		data[i].store_mtime = (gint64) i * G_USEC_PER_SEC;
+		data[i].disk_mtime = (gint64) i * G_USEC_PER_SEC;
+		data[i].mimetype = g_intern_string (mimetypes[i % G_N_ELEMENTS (mimetypes)]);
+		hash = g_compute_checksum_for_string (G_CHECKSUM_MD5,
+		                                      data[i].mimetype, -1);
+		data[i].extractor_hash = g_intern_string (hash);
+	}
+
+	bytes = tracker_benchmark_get_heap_used () - before;
+	g_timer_stop (timer);
+	g_free (data);
+
+	return print_layout ("compact-file-data", bytes, g_timer_elapsed (timer, NULL));
+}
+
+int
+main (int argc, char *argv[])
+{
+	g_autoptr (GOptionContext) context = NULL;
+	g_autoptr (GFile) warmup = NULL;
+	gdouble gfile_queue, path_index_queue;
+	gdouble datetime_data, compact_data;
+	GError *error = NULL;
+
+	/* Older GLib versions allocate slices in pages not seen by the wrappers */
+	g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+	context = g_option_context_new (NULL);
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (!g_option_context_parse (context, &argc, &argv, &error)) {
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+		return EXIT_FAILURE;
+	}
+
+#ifndef __GLIBC__
+	g_printerr ("Heap usage can only be measured with the GNU C library\n");
+	return 77;
+#endif
+
+	if (n_items <= 0 || files_per_directory <= 0 || fanout <= 0) {
+		g_printerr ("Item, file and fanout counts must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	/* Initialize the default VFS and type system outside measurements */
+	warmup = create_item_file (0);
+
+	gfile_queue = measure_gfile_queue ();
+	path_index_queue = measure_path_index_queue ();
+	datetime_data = measure_datetime_file_data ();
+	compact_data = measure_compact_file_data ();
+
+	g_print ("{\"queue_saved_per_million_mb\":%.1f,"
+	         "\"file_data_saved_per_million_mb\":%.1f}\n",
+	         (gfile_queue - path_index_queue) * 1000000 / (1024 * 1024),
+	         (datetime_data - compact_data) * 1000000 / (1024 * 1024));
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include <glib.h>
+
+/* NOTE: We're not including tracker-miner.h here because this is private. */
+#include <tracker-slab.h>
+
+typedef struct {
+	gpointer pointer;
+	gint64 value;
+	guint8 bytes[5];
+} Element;
+
+static guint
+get_stat (TrackerSlab *slab,
+          const gchar *name)
+{
+	g_autoptr (GVariant) stats = NULL;
+	guint value = 0;
+
+	stats = g_variant_ref_sink (tracker_slab_get_stats (slab));
+	g_assert_true (g_variant_lookup (stats, name, "u", &value));
+
+	return value;
+}
+
+static void
+test_slab_alloc (void)
+{
+	TrackerSlab *slab;
+	Element *elements[1000];
+	Element *element;
+	guint i;
+
+	slab = tracker_slab_new (sizeof (Element));
+
+	for (i = 0; i < G_N_ELEMENTS (elements); i++) {
+		elements[i] = tracker_slab_alloc (slab);
+		g_assert_null (elements[i]->pointer);
+		g_assert_cmpint (elements[i]->value, ==, 0);
+		g_assert_true (((gsize) elements[i]) % sizeof (gpointer) == 0);
+		elements[i]->pointer = elements[i];
+		elements[i]->value = i;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (elements); i++) {
+		g_assert_true (elements[i]->pointer == elements[i]);
+		g_assert_cmpint (elements[i]->value, ==, i);
+	}
+
+	g_assert_cmpuint (get_stat (slab, "in-use"), ==, G_N_ELEMENTS (elements));
+	g_assert_cmpuint (get_stat (slab, "chunks"), >, 1);
+
+	/* Released elements are reused, and handed out zeroed */
+	tracker_slab_release (slab, elements[10]);
+	element = tracker_slab_alloc (slab);
+	g_assert_true (element == elements[10]);
+	g_assert_null (element->pointer);
+
+	for (i = 0; i < G_N_ELEMENTS (elements); i++)
+		tracker_slab_release (slab, elements[i]);
+
+	tracker_slab_free (slab);
+}
+
+static void
+test_slab_bulk_release (void)
+{
+	TrackerSlab *slab;
+	gpointer elements[1000];
+	guint i, n_chunks;
+	gsize size;
+
+	slab = tracker_slab_new (sizeof (Element));
+
+	for (i = 0; i < G_N_ELEMENTS (elements); i++)
+		elements[i] = tracker_slab_alloc (slab);
+
+	n_chunks = get_stat (slab, "chunks");
+	size = tracker_slab_get_size (slab);
+	g_assert_cmpuint (size, >=, G_N_ELEMENTS (elements) * sizeof (Element));
+
+	/* Chunks are kept while any element is in use */
+	for (i = 1; i < G_N_ELEMENTS (elements); i++)
+		tracker_slab_release (slab, elements[i]);
+
+	g_assert_cmpuint (get_stat (slab, "chunks"), ==, n_chunks);
+	g_assert_cmpuint (get_stat (slab, "released-chunks"), ==, 0);
+
+	/* And all but one are released with the last element */
+	tracker_slab_release (slab, elements[0]);
+	g_assert_cmpuint (get_stat (slab, "chunks"), ==, 1);
+	g_assert_cmpuint (get_stat (slab, "released-chunks"), ==, n_chunks - 1);
+	g_assert_cmpuint (tracker_slab_get_size (slab), ==, size / n_chunks);
+	g_assert_cmpuint (tracker_slab_get_n_in_use (slab), ==, 0);
+	g_assert_cmpuint (get_stat (slab, "peak-in-use"), ==, G_N_ELEMENTS (elements));
+
+	/* The kept chunk is reused from its start */
+	for (i = 0; i < G_N_ELEMENTS (elements); i++)
+		elements[i] = tracker_slab_alloc (slab);
+
+	g_assert_cmpuint (get_stat (slab, "chunks"), ==, n_chunks);
+
+	/* Elements still in use are freed along with the slab */
+	tracker_slab_free (slab);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-miner/tracker-slab/alloc",
+	                 test_slab_alloc);
+	g_test_add_func ("/libtracker-miner/tracker-slab/bulk-release",
+	                 test_slab_bulk_release);
+
+	return g_test_run ();
+}
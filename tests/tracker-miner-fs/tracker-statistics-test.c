@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2026, Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+#include <glib.h>
+
+/* NOTE: We're not including tracker-miner.h here because this is private. */
+#include <tracker-statistics.h>
+
+#define TRACKER_PREFIX "http://tracker.api.gnome.org/ontology/v3/tracker#"
+#define NFO_PREFIX "http://tracker.api.gnome.org/ontology/v3/nfo#"
+#define NMM_PREFIX "http://tracker.api.gnome.org/ontology/v3/nmm#"
+
+static TrackerSparqlConnection *
+create_connection (void)
+{
+	TrackerSparqlConnection *conn;
+	GFile *ontology;
+	GError *error = NULL;
+
+	ontology = tracker_sparql_get_ontology_nepomuk ();
+	conn = tracker_sparql_connection_new (0, NULL, ontology, NULL, &error);
+	g_assert_no_error (error);
+	g_object_unref (ontology);
+
+	tracker_sparql_connection_update (conn,
+	                                  "CREATE SILENT GRAPH tracker:FileSystem; "
+	                                  "CREATE SILENT GRAPH tracker:Documents; "
+	                                  "INSERT DATA {"
+	                                  "  GRAPH tracker:Documents {"
+	                                  "    <file:///a> a nfo:Document ."
+	                                  "    <file:///b> a nfo:Document ."
+	                                  "  }"
+	                                  "  GRAPH tracker:FileSystem {"
+	                                  "    <file:///c> a nfo:Folder ."
+	                                  "  }"
+	                                  "}",
+	                                  NULL, &error);
+	g_assert_no_error (error);
+
+	return conn;
+}
+
+static void
+update_cb (GObject      *object,
+           GAsyncResult *res,
+           gpointer      user_data)
+{
+	GMainLoop *loop = user_data;
+	GError *error = NULL;
+
+	tracker_statistics_update_finish (TRACKER_STATISTICS (object), res, &error);
+	g_assert_no_error (error);
+	g_main_loop_quit (loop);
+}
+
+static void
+update_statistics (TrackerStatistics *statistics)
+{
+	GMainLoop *loop;
+
+	loop = g_main_loop_new (NULL, FALSE);
+	tracker_statistics_update_async (statistics, NULL, update_cb, loop);
+	g_main_loop_run (loop);
+	g_main_loop_unref (loop);
+}
+
+static gint64
+lookup_count (GVariant    *variant,
+              const gchar *graph,
+              const gchar *class_name)
+{
+	g_autoptr (GVariant) graphs = NULL, classes = NULL;
+	gint64 count = 0;
+
+	graphs = g_variant_lookup_value (variant, "graphs", G_VARIANT_TYPE ("a{sa{sx}}"));
+	g_assert_nonnull (graphs);
+
+	classes = g_variant_lookup_value (graphs, graph, G_VARIANT_TYPE ("a{sx}"));
+	if (classes)
+		g_variant_lookup (classes, class_name, "x", &count);
+
+	return count;
+}
+
+static gboolean
+is_up_to_date (GVariant *variant)
+{
+	gboolean up_to_date = FALSE;
+
+	g_assert_true (g_variant_lookup (variant, "up-to-date", "b", &up_to_date));
+
+	return up_to_date;
+}
+
+static void
+wait_for_changes (TrackerStatistics *statistics,
+                  guint64            sequence)
+{
+	gint64 timeout;
+
+	timeout = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+
+	while (g_get_monotonic_time () < timeout) {
+		g_autoptr (GVariant) variant = NULL;
+
+		g_main_context_iteration (NULL, FALSE);
+
+		if (tracker_statistics_get_sequence (statistics) == sequence)
+			continue;
+
+		variant = g_variant_ref_sink (tracker_statistics_to_variant (statistics));
+		if (is_up_to_date (variant))
+			return;
+	}
+
+	g_assert_not_reached ();
+}
+
+static void
+test_statistics_count (void)
+{
+	TrackerSparqlConnection *conn;
+	TrackerStatistics *statistics;
+	g_autoptr (GVariant) variant = NULL;
+
+	conn = create_connection ();
+	statistics = tracker_statistics_new (conn);
+
+	/* Waits for the initial counts */
+	update_statistics (statistics);
+
+	variant = g_variant_ref_sink (tracker_statistics_to_variant (statistics));
+	g_assert_true (is_up_to_date (variant));
+	g_assert_cmpint (lookup_count (variant, TRACKER_PREFIX "Documents", NFO_PREFIX "Document"), ==, 2);
+	g_assert_cmpint (lookup_count (variant, TRACKER_PREFIX "FileSystem", NFO_PREFIX "Folder"), ==, 1);
+	g_assert_cmpint (lookup_count (variant, TRACKER_PREFIX "FileSystem", NFO_PREFIX "Document"), ==, 0);
+
+	g_object_unref (statistics);
+	g_object_unref (conn);
+}
+
+static void
+test_statistics_invalidate (void)
+{
+	TrackerSparqlConnection *conn;
+	TrackerStatistics *statistics;
+	g_autoptr (GVariant) variant = NULL;
+	guint64 sequence;
+
+	conn = create_connection ();
+	statistics = tracker_statistics_new (conn);
+	update_statistics (statistics);
+
+	sequence = tracker_statistics_get_sequence (statistics);
+	tracker_statistics_invalidate (statistics);
+	g_assert_cmpuint (tracker_statistics_get_sequence (statistics), ==, sequence + 1);
+
+	/* Only the number of files and folders is queried again */
+	update_statistics (statistics);
+
+	variant = g_variant_ref_sink (tracker_statistics_to_variant (statistics));
+	g_assert_true (is_up_to_date (variant));
+	g_assert_cmpint (lookup_count (variant, TRACKER_PREFIX "Documents", NFO_PREFIX "Document"), ==, 2);
+
+	g_object_unref (statistics);
+	g_object_unref (conn);
+}
+
+static void
+test_statistics_notify (void)
+{
+	TrackerSparqlConnection *conn;
+	TrackerStatistics *statistics;
+	GVariant *variant;
+	GError *error = NULL;
+	guint64 sequence;
+
+	conn = create_connection ();
+	statistics = tracker_statistics_new (conn);
+	update_statistics (statistics);
+
+	sequence = tracker_statistics_get_sequence (statistics);
+
+	/* Updates not going through the miner are followed too */
+	tracker_sparql_connection_update (conn,
+	                                  "CREATE SILENT GRAPH tracker:Audio; "
+	                                  "INSERT DATA {"
+	                                  "  GRAPH tracker:Audio {"
+	                                  "    <file:///e> a nmm:MusicPiece ."
+	                                  "    <file:///f> a nmm:MusicPiece ."
+	                                  "  }"
+	                                  "}",
+	                                  NULL, &error);
+	g_assert_no_error (error);
+
+	wait_for_changes (statistics, sequence);
+
+	variant = g_variant_ref_sink (tracker_statistics_to_variant (statistics));
+	g_assert_cmpint (lookup_count (variant, TRACKER_PREFIX "Audio", NMM_PREFIX "MusicPiece"), ==, 2);
+	g_variant_unref (variant);
+
+	sequence = tracker_statistics_get_sequence (statistics);
+
+	/* Deletions are applied without a recount */
+	tracker_sparql_connection_update (conn,
+	                                  "DELETE DATA {"
+	                                  "  GRAPH tracker:Audio {"
+	                                  "    <file:///e> a rdfs:Resource ."
+	                                  "  }"
+	                                  "}",
+	                                  NULL, &error);
+	g_assert_no_error (error);
+
+	wait_for_changes (statistics, sequence);
+
+	variant = g_variant_ref_sink (tracker_statistics_to_variant (statistics));
+	g_assert_cmpint (lookup_count (variant, TRACKER_PREFIX "Audio", NMM_PREFIX "MusicPiece"), ==, 1);
+	g_assert_cmpint (lookup_count (variant, TRACKER_PREFIX "Documents", NFO_PREFIX "Document"), ==, 2);
+	g_variant_unref (variant);
+
+	g_object_unref (statistics);
+	g_object_unref (conn);
+}
+
+gint
+main (gint argc, gchar **argv)
+{
+	g_test_init (&argc, &argv, NULL);
+
+	g_test_add_func ("/libtracker-miner/tracker-statistics/count",
+	                 test_statistics_count);
+	g_test_add_func ("/libtracker-miner/tracker-statistics/invalidate",
+	                 test_statistics_invalidate);
+	g_test_add_func ("/libtracker-miner/tracker-statistics/notify",
+	                 test_statistics_notify);
+
+	return g_test_run ();
+}